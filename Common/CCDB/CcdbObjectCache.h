@@ -0,0 +1,334 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CcdbObjectCache.h
+/// \brief Process-wide cache of deserialised CCDB objects, shared by all the tasks and modules of a device
+///
+/// Objects are keyed by (URL, creation-time limit, path, metadata) and by their validity interval [Valid-From, Valid-Until), so
+/// that requests with different timestamps inside the validity of an object (e.g. the first BC of the
+/// DataFrame and the middle of the run) are served by the same copy. Each object is fetched and
+/// deserialised once and handed out as std::shared_ptr<const T>: callers keep their copy alive
+/// independently of the cache and must not modify it.
+/// prefetch() starts the download in the background, typically for all run-wise objects on a run change,
+/// so that the downloads overlap with each other and with the processing; a later get() waits for it.
+/// An object not cached nor being downloaded is downloaded by get() on the calling thread. Hits, misses and
+/// fetch latencies are counted and can be printed with printCounters().
+/// The URL and the creation-time limit are taken from the BasicCCDBManager of the caller (sourceOf()), so that
+/// setCreatedNotAfter() and ALICEO2_CCDB_CONDITION_NOT_AFTER apply as for the objects of the manager.
+/// The objects of prefetch() are deserialised on background threads: the first prefetch() calls
+/// ROOT::EnableThreadSafety(), processes which only use get() never start a thread nor enable it.
+
+#ifndef COMMON_CCDB_CCDBOBJECTCACHE_H_
+#define COMMON_CCDB_CCDBOBJECTCACHE_H_
+
+#include <CCDB/CcdbApi.h>
+#include <Framework/Logger.h>
+
+#include <TROOT.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace o2::common
+{
+
+class CcdbObjectCache
+{
+ public:
+  /// where the objects are taken from
+  struct Source {
+    std::string url;
+    std::string createdNotAfter; // ms since epoch, empty for no limit
+  };
+
+  struct Counters {
+    uint64_t nHits = 0;          // object found in the cache
+    uint64_t nPrefetchHits = 0;  // object being downloaded (e.g. prefetched), waited for the download
+    uint64_t nMisses = 0;        // object downloaded on request
+    uint64_t nFetches = 0;       // downloads, including prefetches
+    uint64_t nFailedFetches = 0; // downloads which returned no object
+    double fetchTimeMs = 0.;     // total time of the downloads and deserialisation
+    double maxFetchTimeMs = 0.;
+    double waitTimeMs = 0.; // total time get() waited for downloads
+  };
+
+  /// the cache shared by everything in the process
+  static CcdbObjectCache& instance()
+  {
+    static CcdbObjectCache cache;
+    return cache;
+  }
+
+  CcdbObjectCache(CcdbObjectCache const&) = delete;
+  CcdbObjectCache& operator=(CcdbObjectCache const&) = delete;
+
+  /// URL and creation-time limit of a BasicCCDBManager (or of a Service of it)
+  template <typename TCCDB>
+  static Source sourceOf(TCCDB const& ccdb)
+  {
+    Source source{ccdb->getURL(), ""};
+    int64_t createdNotAfter = ccdb->getCreatedNotAfter();
+    if (createdNotAfter <= 0) {
+      if (const char* conditionNotAfter = std::getenv("ALICEO2_CCDB_CONDITION_NOT_AFTER")) {
+        createdNotAfter = std::strtoll(conditionNotAfter, nullptr, 10);
+      }
+    }
+    if (createdNotAfter > 0) {
+      source.createdNotAfter = std::to_string(createdNotAfter);
+    }
+    return source;
+  }
+
+  /// objects kept per (source, path, metadata); the oldest one is dropped beyond this number
+  void setMaxObjectsPerPath(std::size_t maxObjects) { mMaxObjectsPerPath = std::max<std::size_t>(1, maxObjects); }
+
+  /// object valid at timestamp, nullptr if there is none in the CCDB
+  template <typename T>
+  std::shared_ptr<const T> get(Source const& source, std::string const& path, int64_t timestamp, std::map<std::string, std::string> const& metadata = {})
+  {
+    const std::string key = makeKey(source, path, metadata);
+    std::unique_lock<std::mutex> lock(mMutex);
+    collectDownloads(key);
+    if (auto object = findObject(key, timestamp, typeid(T))) {
+      mCounters.nHits++;
+      return std::static_pointer_cast<const T>(object);
+    }
+    // running downloads of this path (prefetches or requests from other threads) likely cover timestamp
+    std::vector<std::shared_future<Object>> downloads;
+    for (const auto& pending : mPending[key]) {
+      downloads.push_back(pending.download);
+    }
+    if (!downloads.empty()) {
+      waitFor(downloads, lock);
+      collectDownloads(key);
+      if (auto object = findObject(key, timestamp, typeid(T))) {
+        mCounters.nPrefetchHits++;
+        return std::static_pointer_cast<const T>(object);
+      }
+    }
+    mCounters.nMisses++;
+    mCounters.nFetches++;
+    lock.unlock();
+    Object result = fetch<T>(source, path, timestamp, metadata);
+    lock.lock();
+    addObject(key, result);
+    return std::static_pointer_cast<const T>(result.object);
+  }
+
+  /// starts the download of the object valid at timestamp in the background, unless it is already cached
+  template <typename T>
+  void prefetch(Source const& source, std::string const& path, int64_t timestamp, std::map<std::string, std::string> const& metadata = {})
+  {
+    const std::string key = makeKey(source, path, metadata);
+    std::lock_guard<std::mutex> lock(mMutex);
+    collectDownloads(key);
+    if (findObject(key, timestamp, typeid(T)) || findPending(key, timestamp)) {
+      return;
+    }
+    // ROOT objects are deserialised on the download thread
+    static std::once_flag enableThreadSafety;
+    std::call_once(enableThreadSafety, []() { ROOT::EnableThreadSafety(); });
+    startFetch<T>(key, source, path, timestamp, metadata);
+  }
+
+  Counters getCounters() const
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCounters;
+  }
+
+  void printCounters() const
+  {
+    const Counters counters = getCounters();
+    LOGF(debug, "CcdbObjectCache: %llu hits, %llu prefetch hits, %llu misses; %llu downloads (%llu failed) in %.1f ms (max %.1f ms), %.1f ms waited",
+         counters.nHits, counters.nPrefetchHits, counters.nMisses, counters.nFetches, counters.nFailedFetches,
+         counters.fetchTimeMs, counters.maxFetchTimeMs, counters.waitTimeMs);
+  }
+
+ private:
+  struct Object {
+    int64_t validFrom = 0;
+    int64_t validUntil = 0;
+    std::type_index type = typeid(void);
+    std::shared_ptr<const void> object;
+  };
+
+  struct PendingFetch {
+    int64_t timestamp;
+    std::shared_future<Object> download;
+  };
+
+  CcdbObjectCache() = default;
+
+  static std::string makeKey(Source const& source, std::string const& path, std::map<std::string, std::string> const& metadata)
+  {
+    std::string key = source.url + '|' + source.createdNotAfter + '|' + path;
+    for (const auto& [name, value] : metadata) {
+      key += '|' + name + '=' + value;
+    }
+    return key;
+  }
+
+  std::shared_ptr<const void> findObject(std::string const& key, int64_t timestamp, std::type_info const& type) const
+  {
+    auto it = mObjects.find(key);
+    if (it == mObjects.end()) {
+      return nullptr;
+    }
+    for (const auto& object : it->second) {
+      if (timestamp >= object.validFrom && timestamp < object.validUntil) {
+        if (object.type != std::type_index(type)) {
+          LOGF(fatal, "CcdbObjectCache: object %s requested with type %s, but it was downloaded as %s", key.c_str(), type.name(), object.type.name());
+        }
+        return object.object;
+      }
+    }
+    return nullptr;
+  }
+
+  PendingFetch* findPending(std::string const& key, int64_t timestamp)
+  {
+    auto it = mPending.find(key);
+    if (it == mPending.end()) {
+      return nullptr;
+    }
+    // the validity of a running download is not known yet, only the same timestamp is merged
+    for (auto& pending : it->second) {
+      if (pending.timestamp == timestamp) {
+        return &pending;
+      }
+    }
+    return nullptr;
+  }
+
+  /// waits for the downloads with the mutex unlocked
+  void waitFor(std::vector<std::shared_future<Object>> const& downloads, std::unique_lock<std::mutex>& lock)
+  {
+    lock.unlock();
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& download : downloads) {
+      download.wait();
+    }
+    const double waitTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    lock.lock();
+    mCounters.waitTimeMs += waitTimeMs;
+  }
+
+  /// moves the finished downloads of key to the cache, to be called with the mutex locked
+  void collectDownloads(std::string const& key)
+  {
+    auto& pendings = mPending[key];
+    for (auto it = pendings.begin(); it != pendings.end();) {
+      if (it->download.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        ++it;
+        continue;
+      }
+      addObject(key, it->download.get());
+      it = pendings.erase(it);
+    }
+  }
+
+  /// adds a downloaded object to the cache, to be called with the mutex locked
+  void addObject(std::string const& key, Object const& result)
+  {
+    auto& objects = mObjects[key];
+    if (result.object && std::none_of(objects.begin(), objects.end(), [&](const Object& object) { return object.validFrom == result.validFrom && object.validUntil == result.validUntil; })) {
+      objects.push_back(result);
+      if (objects.size() > mMaxObjectsPerPath) {
+        objects.erase(objects.begin());
+      }
+    }
+  }
+
+  /// starts a download, to be called with the mutex locked
+  template <typename T>
+  std::shared_future<Object> startFetch(std::string const& key, Source const& source, std::string const& path, int64_t timestamp, std::map<std::string, std::string> const& metadata)
+  {
+    auto fetchObject = [this, source, path, timestamp, metadata]() {
+      return fetch<T>(source, path, timestamp, metadata);
+    };
+    std::shared_future<Object> download = std::async(std::launch::async, fetchObject).share();
+    mPending[key].push_back({timestamp, download});
+    mCounters.nFetches++;
+    return download;
+  }
+
+  template <typename T>
+  Object fetch(Source const& source, std::string const& path, int64_t timestamp, std::map<std::string, std::string> const& metadata)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<o2::ccdb::CcdbApi> api = acquireApi(source.url);
+    std::map<std::string, std::string> headers;
+    T* object = api->retrieveFromTFileAny<T>(path, metadata, timestamp, &headers, "", source.createdNotAfter);
+    const double fetchTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    Object result;
+    if (object) {
+      result.object = std::shared_ptr<const T>(object);
+      result.type = typeid(T);
+      result.validFrom = headers.count("Valid-From") ? std::strtoll(headers["Valid-From"].c_str(), nullptr, 0) : timestamp;
+      result.validUntil = headers.count("Valid-Until") ? std::strtoll(headers["Valid-Until"].c_str(), nullptr, 0) : timestamp + 1;
+      if (!(timestamp >= result.validFrom && timestamp < result.validUntil)) { // inconsistent headers: valid for this timestamp only
+        result.validFrom = timestamp;
+        result.validUntil = timestamp + 1;
+      }
+    } else {
+      LOGF(warning, "CcdbObjectCache: no object for %s at timestamp %lld", path.c_str(), static_cast<long long>(timestamp));
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    mIdleApis[source.url].push_back(std::move(api));
+    mCounters.fetchTimeMs += fetchTimeMs;
+    mCounters.maxFetchTimeMs = std::max(mCounters.maxFetchTimeMs, fetchTimeMs);
+    mCounters.nFailedFetches += object ? 0 : 1;
+    return result;
+  }
+
+  /// CcdbApi is not meant to be used by several threads at once: each download takes an idle instance, or
+  /// initialises a new one if all are in use, and gives it back when done
+  std::unique_ptr<o2::ccdb::CcdbApi> acquireApi(std::string const& url)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      auto& idleApis = mIdleApis[url];
+      if (!idleApis.empty()) {
+        std::unique_ptr<o2::ccdb::CcdbApi> api = std::move(idleApis.back());
+        idleApis.pop_back();
+        return api;
+      }
+    }
+    auto api = std::make_unique<o2::ccdb::CcdbApi>();
+    api->init(url);
+    return api;
+  }
+
+  mutable std::mutex mMutex;
+  std::map<std::string, std::vector<Object>> mObjects;                           // per (source, path, metadata), in order of download
+  std::map<std::string, std::vector<PendingFetch>> mPending;                     // running downloads
+  std::map<std::string, std::vector<std::unique_ptr<o2::ccdb::CcdbApi>>> mIdleApis; // per URL, not in use by a download
+  std::size_t mMaxObjectsPerPath = 4;
+  Counters mCounters;
+};
+
+} // namespace o2::common
+
+#endif // COMMON_CCDB_CCDBOBJECTCACHE_H_
@@ -0,0 +1,216 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file GlobalBcTimeline.h
+/// \brief Sorted global-BC index of detector signals, replacing per-task std::map<globalBC, row index>
+///
+/// The timeline is filled once per DataFrame with (channel, global BC, row index) entries, e.g. FT0
+/// rows with TVX, FV0A or ZDC rows passing the task's timing cuts. It keeps one sorted flat array of
+/// global BCs per channel and a merged array of all BCs with a presence bitmap of the channels, and
+/// answers exact, nearest, range and any-in-window queries with branch-free binary searches.
+/// The storage is kept between DataFrames, so one timeline member can serve all the process functions
+/// of a task.
+
+#ifndef COMMON_CORE_GLOBALBCTIMELINE_H_
+#define COMMON_CORE_GLOBALBCTIMELINE_H_
+
+#include <Framework/Logger.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace o2::common::core
+{
+
+/// Channels shared between tasks. Task-specific selections (e.g. FT0 rows with a timing cut) use
+/// channel numbers from kNCommonBcChannels up to GlobalBcTimeline::MaxChannels - 1.
+enum BcTimelineChannel : int {
+  kBcChannelFT0 = 0,
+  kBcChannelFV0A,
+  kBcChannelFDD,
+  kBcChannelZDC,
+  kBcChannelTVX,
+  kNCommonBcChannels
+};
+
+class GlobalBcTimeline
+{
+ public:
+  static constexpr int MaxChannels = 16;
+
+  /// removes all entries, keeping the allocated storage
+  void clear()
+  {
+    mEntries.clear();
+    for (auto& channel : mChannels) {
+      channel.globalBCs.clear();
+      channel.rows.clear();
+    }
+    mGlobalBCs.clear();
+    mMasks.clear();
+    mIsBuilt = false;
+  }
+
+  /// adds the row index of a signal in a channel. If the same global BC is added twice to a channel,
+  /// the last row is kept, as with std::map::operator[]
+  void add(int channel, int64_t globalBC, int32_t row)
+  {
+    if (channel < 0 || channel >= MaxChannels) {
+      LOGF(fatal, "GlobalBcTimeline: channel %d out of range [0, %d)", channel, MaxChannels);
+    }
+    mEntries.push_back({globalBC, row, static_cast<uint16_t>(channel)});
+    mIsBuilt = false;
+  }
+
+  /// sorts the entries added since clear() and fills the per-channel and merged arrays
+  void build()
+  {
+    auto lessBC = [](const Entry& a, const Entry& b) { return a.globalBC < b.globalBC; };
+    if (!std::is_sorted(mEntries.begin(), mEntries.end(), lessBC)) {
+      std::stable_sort(mEntries.begin(), mEntries.end(), lessBC);
+    }
+    for (auto& channel : mChannels) {
+      channel.globalBCs.clear();
+      channel.rows.clear();
+    }
+    mGlobalBCs.clear();
+    mMasks.clear();
+    for (const auto& entry : mEntries) {
+      auto& channel = mChannels[entry.channel];
+      if (!channel.globalBCs.empty() && channel.globalBCs.back() == entry.globalBC) {
+        channel.rows.back() = entry.row;
+      } else {
+        channel.globalBCs.push_back(entry.globalBC);
+        channel.rows.push_back(entry.row);
+      }
+      if (mGlobalBCs.empty() || mGlobalBCs.back() != entry.globalBC) {
+        mGlobalBCs.push_back(entry.globalBC);
+        mMasks.push_back(0);
+      }
+      mMasks.back() |= static_cast<uint16_t>(1u << entry.channel);
+    }
+    mIsBuilt = true;
+  }
+
+  bool isBuilt() const { return mIsBuilt; }
+
+  /// number of distinct global BCs in a channel
+  std::size_t size(int channel) const { return mChannels[channel].globalBCs.size(); }
+  bool empty(int channel) const { return mChannels[channel].globalBCs.empty(); }
+
+  /// global BC and row index of the i-th (in BC order) signal of a channel
+  int64_t globalBC(int channel, std::size_t i) const { return mChannels[channel].globalBCs[i]; }
+  int32_t row(int channel, std::size_t i) const { return mChannels[channel].rows[i]; }
+
+  /// position of globalBC in a channel, -1 if the channel has no signal in this BC
+  int64_t find(int channel, int64_t globalBC) const
+  {
+    const auto& bcs = mChannels[channel].globalBCs;
+    const std::size_t i = lowerBound(bcs, globalBC);
+    return (i < bcs.size() && bcs[i] == globalBC) ? static_cast<int64_t>(i) : -1;
+  }
+
+  /// row index of the signal of a channel in globalBC, -1 if none
+  int32_t findRow(int channel, int64_t globalBC) const
+  {
+    const int64_t i = find(channel, globalBC);
+    return i >= 0 ? mChannels[channel].rows[i] : -1;
+  }
+
+  /// position of the signal of a channel closest to globalBC, -1 if the channel is empty.
+  /// For equal distances the later BC is returned
+  int64_t findClosest(int channel, int64_t globalBC) const
+  {
+    const auto& bcs = mChannels[channel].globalBCs;
+    if (bcs.empty()) {
+      return -1;
+    }
+    const std::size_t i = lowerBound(bcs, globalBC);
+    if (i == bcs.size()) {
+      return i - 1;
+    }
+    if (i == 0) {
+      return 0;
+    }
+    return (bcs[i] - globalBC <= globalBC - bcs[i - 1]) ? i : i - 1;
+  }
+
+  /// range [first, last) of positions of the signals of a channel with minBC <= global BC <= maxBC
+  std::pair<std::size_t, std::size_t> range(int channel, int64_t minBC, int64_t maxBC) const
+  {
+    const auto& bcs = mChannels[channel].globalBCs;
+    const std::size_t first = lowerBound(bcs, minBC);
+    const std::size_t last = maxBC < minBC ? first : std::max(first, lowerBound(bcs, maxBC + 1));
+    return {first, last};
+  }
+
+  /// channel bitmap of globalBC (bit c set if channel c has a signal), 0 if no channel has a signal
+  uint16_t mask(int64_t globalBC) const
+  {
+    const std::size_t i = lowerBound(mGlobalBCs, globalBC);
+    return (i < mGlobalBCs.size() && mGlobalBCs[i] == globalBC) ? mMasks[i] : 0;
+  }
+
+  /// whether any of the channels in channelMask has a signal with minBC <= global BC <= maxBC
+  bool anyInWindow(uint16_t channelMask, int64_t minBC, int64_t maxBC) const
+  {
+    for (std::size_t i = lowerBound(mGlobalBCs, minBC); i < mGlobalBCs.size() && mGlobalBCs[i] <= maxBC; i++) {
+      if (mMasks[i] & channelMask) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static constexpr uint16_t channelBit(int channel) { return static_cast<uint16_t>(1u << channel); }
+
+ private:
+  struct Entry {
+    int64_t globalBC;
+    int32_t row;
+    uint16_t channel;
+  };
+
+  struct Channel {
+    std::vector<int64_t> globalBCs;
+    std::vector<int32_t> rows;
+  };
+
+  /// branch-free lower bound: first position with bcs[i] >= value
+  static std::size_t lowerBound(const std::vector<int64_t>& bcs, int64_t value)
+  {
+    std::size_t length = bcs.size();
+    if (length == 0) {
+      return 0;
+    }
+    const int64_t* base = bcs.data();
+    while (length > 1) {
+      const std::size_t half = length / 2;
+      base += (base[half - 1] < value) * half;
+      length -= half;
+    }
+    return (base - bcs.data()) + (*base < value);
+  }
+
+  std::vector<Entry> mEntries;
+  std::array<Channel, MaxChannels> mChannels;
+  std::vector<int64_t> mGlobalBCs; // all global BCs with at least one signal
+  std::vector<uint16_t> mMasks;    // channel bitmap per global BC
+  bool mIsBuilt{false};
+};
+
+} // namespace o2::common::core
+
+#endif // COMMON_CORE_GLOBALBCTIMELINE_H_
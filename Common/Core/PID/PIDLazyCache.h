@@ -0,0 +1,152 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   PIDLazyCache.h
+/// \brief  Cache of the nsigma of (species, track), computed on first access.
+/// \author agent <agent@local>
+///
+///         For tasks which evaluate the PID response themselves (e.g. with o2::pid::tof::ExpTimes or
+///         o2::pid::tpc::Response) instead of joining the pidTOF/pidTPC tables, and which ask for the same
+///         (species, track) several times. The storage of a species is allocated when it is first asked for.
+///         The values are kept with the given binning: the binning of the tiny tables
+///         (o2::aod::pidtof_tiny::binning, o2::aod::pidtpc_tiny::binning) returns the nsigma a consumer of the
+///         tiny table would read, o2::pid::FullPrecisionBinning the computed value.
+///         The species asked for are accumulated over the DataFrames, report() prints them together with the
+///         enableParticle setting of the PID producers to be used if the tables are needed instead.
+///
+///         Usage:
+///           per DataFrame: cache.reset(tracks.size());
+///           per collision, if the response depends on it: cache.invalidate();
+///           per access: cache.get(o2::track::PID::Pion, track.globalIndex(), [&]() { return response.GetNumberOfSigma(...); });
+///
+
+#ifndef COMMON_CORE_PID_PIDLAZYCACHE_H_
+#define COMMON_CORE_PID_PIDLAZYCACHE_H_
+
+#include <Framework/Logger.h>
+#include <ReconstructionDataFormats/PID.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace o2::pid
+{
+
+/// Binning keeping the value as it is, same interface as the binning of the tiny tables
+struct FullPrecisionBinning {
+  typedef float binned_t;
+
+  template <typename T>
+  static void packInTable(const float& valueToBin, T& table)
+  {
+    table(valueToBin);
+  }
+
+  static float unPackInTable(const binned_t& valueToUnpack)
+  {
+    return valueToUnpack;
+  }
+};
+
+/// \tparam Binning packing of the values, e.g. o2::aod::pidtof_tiny::binning or o2::pid::FullPrecisionBinning
+template <typename Binning>
+class LazyNSigmaCache
+{
+ public:
+  using binned_t = typename Binning::binned_t;
+  static constexpr int NSpecies = o2::track::PID::NIDs;
+  static_assert(NSpecies <= 32, "LazyNSigmaCache: the consumed species do not fit in the bit mask");
+
+  /// to be called at the beginning of each DataFrame with the number of tracks which can be asked for
+  void reset(std::size_t nTracks)
+  {
+    mNTracks = nTracks;
+    invalidate();
+    mNDataFrames++;
+  }
+
+  /// forgets all the values computed so far, e.g. at a new collision when the response depends on it
+  void invalidate()
+  {
+    if (++mGeneration == 0) { // wrap-around, the stamps of old entries could match again
+      for (auto& stamps : mStamps) {
+        stamps.assign(stamps.size(), 0);
+      }
+      mGeneration = 1;
+    }
+  }
+
+  /// nsigma of the species for track iTrack, compute() is called on the first access only
+  template <typename F>
+  float get(o2::track::PID::ID id, std::size_t iTrack, F&& compute)
+  {
+    if (iTrack >= mNTracks) {
+      LOG(fatal) << "LazyNSigmaCache: track " << iTrack << " out of the " << mNTracks << " tracks given to reset()";
+    }
+    if (mStamps[id].size() < mNTracks) {
+      if (!isConsumed(id)) {
+        LOG(debug) << "LazyNSigmaCache: first access to " << o2::track::PID::getName(id);
+        mConsumed |= 1u << id;
+      }
+      mValues[id].resize(mNTracks);
+      mStamps[id].resize(mNTracks, 0);
+    }
+    mNAccesses[id]++;
+    binned_t& value = mValues[id][iTrack];
+    if (mStamps[id][iTrack] != mGeneration) {
+      auto store = [&value](binned_t binned) { value = binned; };
+      Binning::packInTable(compute(), store);
+      mStamps[id][iTrack] = mGeneration;
+      mNComputed[id]++;
+    }
+    return Binning::unPackInTable(value);
+  }
+
+  /// true if the nsigma of the species for track iTrack is computed since the last reset() or invalidate()
+  bool isComputed(o2::track::PID::ID id, std::size_t iTrack) const { return iTrack < mStamps[id].size() && mStamps[id][iTrack] == mGeneration; }
+
+  /// species asked for since the construction, bit i for o2::track::PID::ID i
+  uint32_t getConsumedSpecies() const { return mConsumed; }
+  bool isConsumed(o2::track::PID::ID id) const { return mConsumed & (1u << id); }
+
+  /// prints the species asked for and the number of accesses and of computations
+  void report() const
+  {
+    LOG(info) << "LazyNSigmaCache: species asked for in " << mNDataFrames << " DataFrames";
+    std::string enableParticle;
+    for (int id = 0; id < NSpecies; id++) {
+      enableParticle += std::string(enableParticle.empty() ? "" : ",") + (isConsumed(id) ? "1" : "0");
+      if (!isConsumed(id)) {
+        continue;
+      }
+      LOG(info) << "  " << o2::track::PID::getName(id) << ": " << mNAccesses[id] << " accesses, " << mNComputed[id] << " computed";
+    }
+    LOG(info) << "LazyNSigmaCache: enableParticle of the PID producers for these species: " << enableParticle;
+  }
+
+ private:
+  std::size_t mNTracks = 0;
+  uint32_t mGeneration = 1;                            // entries are valid if their stamp is the current generation
+  std::array<std::vector<binned_t>, NSpecies> mValues; // per species, per track, empty if never asked for
+  std::array<std::vector<uint32_t>, NSpecies> mStamps; // generation in which the value was computed
+  uint32_t mConsumed = 0;                              // species asked for since the construction
+  std::array<int64_t, NSpecies> mNAccesses{};
+  std::array<int64_t, NSpecies> mNComputed{};
+  int64_t mNDataFrames = 0;
+};
+
+} // namespace o2::pid
+
+#endif // COMMON_CORE_PID_PIDLAZYCACHE_H_
@@ -0,0 +1,397 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   SparseHistAccumulator.h
+/// \brief  Fast accumulator for multidimensional sparse histograms.
+///
+///         Bin indices of all axes are packed into one 64-bit key which is stored in a compact
+///         open-addressing hash table together with the sum of weights (and of squared weights).
+///         The contents are added to a standard THnSparse only when flushed, so that the per-fill
+///         cost of THnSparse (coordinate linearisation, chunk lookup) is avoided. The sums are kept in double
+///         by default as in THnSparseD; float halves the table but loses precision at large counts.
+///
+///         flush() adds the bin contents, the errors and the number of entries. The other statistics of
+///         THnBase (GetSumw(), GetSumw2(), GetSumwx(), GetSumwx2()) have no setter and keep only the direct
+///         fills: statistics derived from them are to be recomputed from the bin contents, e.g. on projections.
+///
+///         SparseHistFiller is a drop-in adapter for a THnSparse booked in a HistogramRegistry:
+///           registry.fill(HIST("hSparse"), x0, x1, ...)  ->  hSparseFiller.fill(x0, x1, ...)
+///         with hSparseFiller.bind(registry.get<THnSparse>(HIST("hSparse"))) in init() and
+///         hSparseFiller.flush() at the end of the process function.
+///
+
+#ifndef COMMON_CORE_SPARSEHISTACCUMULATOR_H_
+#define COMMON_CORE_SPARSEHISTACCUMULATOR_H_
+
+#include <Framework/Logger.h>
+
+#include <TAxis.h>
+#include <THnBase.h>
+
+#include <Rtypes.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace o2::common::core
+{
+
+/// Binning of one axis with ROOT conventions: 0 is the underflow and nBins + 1 the overflow bin
+struct SparseAxisBinning {
+  int nBins = 0;
+  double min = 0.;
+  double max = 0.;
+  double invWidth = 0.;
+  std::vector<double> edges; // only for variable binning
+  int shift = 0;             // position of the bin index in the packed key
+  uint64_t mask = 0;
+
+  int findBin(double x) const
+  {
+    if (!(x >= min)) { // also catches NaN, as TAxis::FindBin
+      return x < min ? 0 : nBins + 1;
+    }
+    if (x >= max) {
+      return nBins + 1;
+    }
+    if (edges.empty()) {
+      return std::min(nBins, 1 + static_cast<int>((x - min) * invWidth));
+    }
+    return std::upper_bound(edges.begin(), edges.end(), x) - edges.begin();
+  }
+};
+
+template <typename ValueType = double>
+class SparseHistAccumulator
+{
+ public:
+  SparseHistAccumulator() = default;
+  explicit SparseHistAccumulator(const THnBase* hist) { configure(hist); }
+
+  /// whether the bin indices of all axes of the histogram fit into the packed key
+  static bool canPack(const THnBase* hist)
+  {
+    int nBitsTotal = 0;
+    for (int iDim = 0; iDim < hist->GetNdimensions(); iDim++) {
+      nBitsTotal += std::bit_width(static_cast<uint64_t>(hist->GetAxis(iDim)->GetNbins() + 1));
+    }
+    // the all-ones key marks empty slots, so one bit is kept free
+    return nBitsTotal <= 63;
+  }
+
+  /// copies the binning of the histogram; the histogram itself is only accessed again in flush()
+  void configure(const THnBase* hist)
+  {
+    if (!canPack(hist)) {
+      LOGF(fatal, "SparseHistAccumulator: the bin indices of %s do not fit into 63 bits", hist->GetName());
+    }
+    mAxes.clear();
+    int nBitsTotal = 0;
+    for (int iDim = 0; iDim < hist->GetNdimensions(); iDim++) {
+      const TAxis* axis = hist->GetAxis(iDim);
+      SparseAxisBinning binning;
+      binning.nBins = axis->GetNbins();
+      binning.min = axis->GetXmin();
+      binning.max = axis->GetXmax();
+      binning.invWidth = binning.nBins / (binning.max - binning.min);
+      if (axis->GetXbins()->GetSize() > 0) {
+        binning.edges.assign(axis->GetXbins()->GetArray(), axis->GetXbins()->GetArray() + axis->GetXbins()->GetSize());
+      }
+      const int nBits = std::bit_width(static_cast<uint64_t>(binning.nBins + 1));
+      binning.shift = nBitsTotal;
+      binning.mask = (uint64_t{1} << nBits) - 1;
+      nBitsTotal += nBits;
+      mAxes.push_back(std::move(binning));
+    }
+    mSumw2 = hist->GetCalculateErrors();
+    mKeys.clear();
+    reset();
+  }
+
+  int getNdimensions() const { return mAxes.size(); }
+  std::size_t getNFilledBins() const { return mNFilled; }
+  uint64_t getEntries() const { return mEntries; }
+
+  /// removes all contents, keeping the binning and the allocated table
+  void reset()
+  {
+    if (mKeys.empty()) {
+      allocate(InitialCapacity);
+    } else {
+      std::fill(mKeys.begin(), mKeys.end(), EmptyKey);
+      std::fill(mSumW.begin(), mSumW.end(), ValueType{0});
+      std::fill(mSumW2.begin(), mSumW2.end(), ValueType{0});
+    }
+    mNFilled = 0;
+    mEntries = 0;
+  }
+
+  /// fills one point given by getNdimensions() coordinates
+  void fill(const double* x, ValueType weight = 1)
+  {
+    add(packBins(x), weight, weight * weight);
+    mEntries++;
+  }
+
+  /// fills nPoints points stored row-major in x (getNdimensions() values per point), with optional weights
+  void fillN(std::size_t nPoints, const double* x, const ValueType* weights = nullptr)
+  {
+    const std::size_t nDim = mAxes.size();
+    reserve(mNFilled + nPoints);
+    for (std::size_t iPoint = 0; iPoint < nPoints; iPoint++) {
+      const ValueType weight = weights ? weights[iPoint] : ValueType{1};
+      add(packBins(x + iPoint * nDim), weight, weight * weight);
+    }
+    mEntries += nPoints;
+  }
+
+  /// adds the contents of another accumulator with the same binning
+  void merge(const SparseHistAccumulator& other)
+  {
+    for (std::size_t iSlot = 0; iSlot < other.mKeys.size(); iSlot++) {
+      if (other.mKeys[iSlot] != EmptyKey) {
+        add(other.mKeys[iSlot], other.mSumW[iSlot], mSumw2 ? other.mSumW2[iSlot] : ValueType{0});
+      }
+    }
+    mEntries += other.mEntries;
+  }
+
+  /// adds the accumulated contents to the histogram and resets the accumulator
+  void flush(THnBase* hist)
+  {
+    std::vector<Int_t> bins(mAxes.size());
+    for (std::size_t iSlot = 0; iSlot < mKeys.size(); iSlot++) {
+      const uint64_t key = mKeys[iSlot];
+      if (key == EmptyKey) {
+        continue;
+      }
+      for (std::size_t iDim = 0; iDim < mAxes.size(); iDim++) {
+        bins[iDim] = (key >> mAxes[iDim].shift) & mAxes[iDim].mask;
+      }
+      const Long64_t bin = hist->GetBin(bins.data(), kTRUE);
+      hist->SetBinContent(bin, hist->GetBinContent(bin) + mSumW[iSlot]);
+      if (mSumw2) {
+        hist->SetBinError2(bin, hist->GetBinError2(bin) + mSumW2[iSlot]);
+      }
+    }
+    hist->SetEntries(hist->GetEntries() + mEntries);
+    reset();
+  }
+
+ private:
+  static constexpr uint64_t EmptyKey = ~uint64_t{0};
+  static constexpr std::size_t InitialCapacity = 1024;
+
+  uint64_t packBins(const double* x) const
+  {
+    uint64_t key = 0;
+    for (std::size_t iDim = 0; iDim < mAxes.size(); iDim++) {
+      key |= static_cast<uint64_t>(mAxes[iDim].findBin(x[iDim])) << mAxes[iDim].shift;
+    }
+    return key;
+  }
+
+  static uint64_t hash(uint64_t key)
+  {
+    // splitmix64 finaliser, cheap and good enough to spread the packed indices
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+  }
+
+  void add(uint64_t key, ValueType sumW, ValueType sumW2)
+  {
+    std::size_t slot = hash(key) & mMask;
+    while (mKeys[slot] != key) {
+      if (mKeys[slot] == EmptyKey) {
+        if ((mNFilled + 1) * 4 > mKeys.size() * 3) { // keep the load factor below 3/4
+          rehash(mKeys.size() * 2);
+          add(key, sumW, sumW2);
+          return;
+        }
+        mKeys[slot] = key;
+        mNFilled++;
+        break;
+      }
+      slot = (slot + 1) & mMask;
+    }
+    mSumW[slot] += sumW;
+    if (mSumw2) {
+      mSumW2[slot] += sumW2;
+    }
+  }
+
+  void reserve(std::size_t nBins)
+  {
+    std::size_t capacity = mKeys.size();
+    while (nBins * 4 > capacity * 3) {
+      capacity *= 2;
+    }
+    if (capacity != mKeys.size()) {
+      rehash(capacity);
+    }
+  }
+
+  void allocate(std::size_t capacity)
+  {
+    mKeys.assign(capacity, EmptyKey);
+    mSumW.assign(capacity, ValueType{0});
+    mSumW2.assign(mSumw2 ? capacity : 0, ValueType{0});
+    mMask = capacity - 1;
+  }
+
+  void rehash(std::size_t capacity)
+  {
+    std::vector<uint64_t> keys;
+    std::vector<ValueType> sumW, sumW2;
+    keys.swap(mKeys);
+    sumW.swap(mSumW);
+    sumW2.swap(mSumW2);
+    allocate(capacity);
+    mNFilled = 0;
+    for (std::size_t iSlot = 0; iSlot < keys.size(); iSlot++) {
+      if (keys[iSlot] != EmptyKey) {
+        add(keys[iSlot], sumW[iSlot], mSumw2 ? sumW2[iSlot] : ValueType{0});
+      }
+    }
+  }
+
+  std::vector<SparseAxisBinning> mAxes;
+  std::vector<uint64_t> mKeys;
+  std::vector<ValueType> mSumW;
+  std::vector<ValueType> mSumW2;
+  std::size_t mMask = 0;
+  std::size_t mNFilled = 0;
+  uint64_t mEntries = 0;
+  bool mSumw2 = false;
+};
+
+/// One accumulator per filling thread, all merged into the histogram in flush(). Each thread fills its own
+/// accumulator without locking; the mutex only guards the creation of the accumulators and the flush
+template <typename ValueType = double>
+class PerThreadSparseHistAccumulator
+{
+ public:
+  explicit PerThreadSparseHistAccumulator(const THnBase* hist) : mHist(hist), mId(sNextId++) {}
+
+  /// accumulator of the calling thread, created on its first call
+  SparseHistAccumulator<ValueType>& getThreadAccumulator()
+  {
+    // last accumulator used by this thread, the ids of the instances are never reused
+    thread_local uint64_t cachedId = 0;
+    thread_local SparseHistAccumulator<ValueType>* cached = nullptr;
+    if (cachedId == mId) {
+      return *cached;
+    }
+    const auto threadId = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = std::find_if(mAccumulators.begin(), mAccumulators.end(), [&threadId](const auto& entry) { return entry.first == threadId; });
+    if (it == mAccumulators.end()) {
+      mAccumulators.emplace_back(threadId, std::make_unique<SparseHistAccumulator<ValueType>>(mHist));
+      it = std::prev(mAccumulators.end());
+    }
+    cachedId = mId;
+    cached = it->second.get();
+    return *cached;
+  }
+
+  /// merges the accumulators of all threads into the histogram; must not run concurrently with fills
+  void flush(THnBase* hist)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mAccumulators.empty()) {
+      return;
+    }
+    auto& first = *mAccumulators.front().second;
+    for (std::size_t iThread = 1; iThread < mAccumulators.size(); iThread++) {
+      first.merge(*mAccumulators[iThread].second);
+      mAccumulators[iThread].second->reset();
+    }
+    first.flush(hist);
+  }
+
+ private:
+  static inline std::atomic<uint64_t> sNextId{1};
+
+  const THnBase* mHist;
+  const uint64_t mId;
+  std::mutex mMutex;
+  std::vector<std::pair<std::thread::id, std::unique_ptr<SparseHistAccumulator<ValueType>>>> mAccumulators;
+};
+
+/// Drop-in replacement for filling a registry THnSparse, with the same arguments as HistogramRegistry::fill
+template <typename ValueType = double>
+class SparseHistFiller
+{
+ public:
+  /// histograms whose bin indices do not fit into the packed key are filled directly
+  template <typename HistPtr>
+  void bind(HistPtr const& hist)
+  {
+    mHist = &*hist;
+    mNDimensions = mHist->GetNdimensions();
+    mAccumulate = SparseHistAccumulator<ValueType>::canPack(mHist);
+    if (mAccumulate) {
+      mAccumulator.configure(mHist);
+    } else {
+      LOGF(info, "SparseHistFiller: bin indices of %s do not fit into 63 bits, filling it directly", mHist->GetName());
+    }
+  }
+
+  /// coordinates of all axes, optionally followed by the weight
+  template <typename... Ts>
+  void fill(Ts... values)
+  {
+    const std::array<double, sizeof...(Ts)> x{static_cast<double>(values)...};
+    const bool isWeighted = static_cast<int>(x.size()) == mNDimensions + 1;
+    if (!isWeighted && static_cast<int>(x.size()) != mNDimensions) {
+      LOGF(fatal, "SparseHistFiller: %d values given for %s with %d dimensions", x.size(), mHist ? mHist->GetName() : "unbound histogram", mNDimensions);
+    }
+    const double weight = isWeighted ? x.back() : 1.;
+    if (mAccumulate) {
+      mAccumulator.fill(x.data(), static_cast<ValueType>(weight));
+    } else {
+      mHist->Fill(x.data(), weight);
+    }
+  }
+
+  /// moves the accumulated contents to the histogram, at the latest before the output is written
+  void flush()
+  {
+    if (mAccumulate) {
+      mAccumulator.flush(mHist);
+    }
+  }
+
+ private:
+  THnBase* mHist = nullptr;
+  int mNDimensions = -1;
+  bool mAccumulate = false;
+  SparseHistAccumulator<ValueType> mAccumulator;
+};
+
+} // namespace o2::common::core
+
+#endif // COMMON_CORE_SPARSEHISTACCUMULATOR_H_
@@ -0,0 +1,220 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   StratifiedReservoirSampler.h
+/// \brief  Streaming stratified downsampling for calibration skims.
+///
+///         Tracks are sorted into strata of (species, momentum, pseudorapidity, occupancy). Each stratum keeps
+///         a reservoir of the targetPerStratum largest random keys seen in the run, i.e. a uniform sample of its tracks.
+///         Since a skimmed row cannot be taken back, a track is accepted when it enters the reservoir of its
+///         stratum, i.e. when its key beats the current threshold. The accepted rows of a stratum are thus a
+///         superset of the final reservoir, of about targetPerStratum * (1 + ln(nSeen / targetPerStratum))
+///         rows, so that populated strata no longer dominate the output. A hard limit per run can be added.
+///         The superset is not uniform: the i-th track of a stratum is accepted with probability
+///         min(1, targetPerStratum / i), so the start of the run is overrepresented. The key and this probability
+///         of each accepted track are kept (getLastKey(), getLastAcceptanceProbability()) to be written with the
+///         row: offline, either the final reservoir is applied by keeping the targetPerStratum largest keys per
+///         stratum, or the rows are weighted with the inverse of the probability. With the hard limit, the tracks
+///         after the limit is reached are dropped and neither correction holds.
+///         The keys are unweighted, i.e. all the tracks of a stratum are equivalent.
+///
+///         The sampler lives in one task instance: the reservoirs and the limit are per run *and per job*.
+///         If the input of a run is split over N jobs, the skim of the run contains up to N times the rows above,
+///         so targetPerStratum and the hard limit have to be divided by the number of jobs per run.
+///         The random numbers are hashed from the seed, the run number and the position of the track in the
+///         input of the job, so that a rerun over the same input and with the same splitting gives the same sample.
+///
+
+#ifndef COMMON_CORE_STRATIFIEDRESERVOIRSAMPLER_H_
+#define COMMON_CORE_STRATIFIEDRESERVOIRSAMPLER_H_
+
+#include <Framework/Logger.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace o2::common::core
+{
+
+class StratifiedReservoirSampler
+{
+ public:
+  enum Axis : int {
+    kMomentum = 0,
+    kEta,
+    kOccupancy,
+    kNAxes
+  };
+
+  void setNSpecies(int nSpecies) { mNSpecies = nSpecies; }
+  void setTargetPerStratum(int target) { mTargetPerStratum = target; }
+  /// maximum number of accepted tracks per run (and job), < 0: no limit
+  void setMaxAcceptedPerRun(int64_t maxAccepted) { mMaxAcceptedPerRun = maxAccepted; }
+  void setSeed(uint64_t seed) { mSeed = seed; }
+
+  /// binning in the ConfigurableAxis convention: {VARIABLE_WIDTH (= 0), edge0, edge1, ...} or {nBins, min, max}.
+  /// Values outside the axis are put in the first or last bin. Axes without binning are not stratified
+  void setBinning(int axis, const std::vector<double>& binning)
+  {
+    auto& edges = mEdges[axis];
+    edges.clear();
+    if (binning.size() < 3) {
+      LOGF(fatal, "StratifiedReservoirSampler: binning of axis %d needs at least 3 values", axis);
+    }
+    if (binning[0] == 0.) {
+      edges.assign(binning.begin() + 1, binning.end());
+    } else {
+      const int nBins = static_cast<int>(binning[0]);
+      for (int i = 0; i <= nBins; i++) {
+        edges.push_back(binning[1] + (binning[2] - binning[1]) * i / nBins);
+      }
+    }
+    if (!std::is_sorted(edges.begin(), edges.end())) {
+      LOGF(fatal, "StratifiedReservoirSampler: bin edges of axis %d are not sorted", axis);
+    }
+  }
+
+  /// allocates the reservoirs, to be called after the setters
+  void init()
+  {
+    if (mNSpecies <= 0 || mTargetPerStratum <= 0) {
+      LOGF(fatal, "StratifiedReservoirSampler: invalid number of species (%d) or target per stratum (%d)", mNSpecies, mTargetPerStratum);
+    }
+    std::size_t nStrata = mNSpecies;
+    for (const auto& edges : mEdges) {
+      nStrata *= nBins(edges);
+    }
+    mKeys.assign(nStrata * mTargetPerStratum, 0.);
+    mReservoirSizes.assign(nStrata, 0);
+    mNSeen.assign(nStrata, 0);
+    mNAccepted.assign(nStrata, 0);
+    mRunNumber = -1;
+  }
+
+  /// resets the reservoirs and counters if the run number changed
+  void startRun(int runNumber)
+  {
+    if (runNumber == mRunNumber) {
+      return;
+    }
+    std::fill(mReservoirSizes.begin(), mReservoirSizes.end(), 0);
+    std::fill(mNSeen.begin(), mNSeen.end(), 0);
+    std::fill(mNAccepted.begin(), mNAccepted.end(), 0);
+    mNAcceptedInRun = 0;
+    mSequence = 0;
+    mRunNumber = runNumber;
+  }
+
+  /// stratum index, -1 for a species out of range
+  int getStratum(int species, double momentum, double eta, double occupancy) const
+  {
+    if (species < 0 || species >= mNSpecies) {
+      return -1;
+    }
+    const std::array<double, kNAxes> values{momentum, eta, occupancy};
+    int stratum = species;
+    for (int axis = 0; axis < kNAxes; axis++) {
+      stratum = stratum * nBins(mEdges[axis]) + findBin(mEdges[axis], values[axis]);
+    }
+    return stratum;
+  }
+
+  /// whether the track enters the reservoir of its stratum, i.e. has to be written. Each call advances the sequence
+  /// of random numbers, so the tracks of a run have to be passed in a reproducible order
+  bool accept(int species, double momentum, double eta, double occupancy)
+  {
+    const double key = uniform(mSequence++);
+    const int stratum = getStratum(species, momentum, eta, occupancy);
+    if (stratum < 0) {
+      return false;
+    }
+    mNSeen[stratum]++;
+    if (mMaxAcceptedPerRun >= 0 && mNAcceptedInRun >= mMaxAcceptedPerRun) {
+      return false;
+    }
+    // larger is better. The reservoir is a min-heap of the best keys
+    double* heap = mKeys.data() + static_cast<std::size_t>(stratum) * mTargetPerStratum;
+    int& size = mReservoirSizes[stratum];
+    if (size < mTargetPerStratum) {
+      heap[size++] = key;
+      std::push_heap(heap, heap + size, std::greater<>{});
+    } else if (key > heap[0]) {
+      std::pop_heap(heap, heap + size, std::greater<>{});
+      heap[size - 1] = key;
+      std::push_heap(heap, heap + size, std::greater<>{});
+    } else {
+      return false;
+    }
+    mNAccepted[stratum]++;
+    mNAcceptedInRun++;
+    mLastKey = key;
+    mLastAcceptanceProbability = std::min(1., static_cast<double>(mTargetPerStratum) / mNSeen[stratum]);
+    return true;
+  }
+
+  /// random key of the last accepted track, in (0, 1)
+  double getLastKey() const { return mLastKey; }
+  /// probability min(1, targetPerStratum / i) with which the last accepted track, the i-th of its stratum, was accepted
+  double getLastAcceptanceProbability() const { return mLastAcceptanceProbability; }
+
+  int getNStrata() const { return mReservoirSizes.size(); }
+  int64_t getNSeen(int stratum) const { return mNSeen[stratum]; }
+  int64_t getNAccepted(int stratum) const { return mNAccepted[stratum]; }
+  int64_t getNAcceptedInRun() const { return mNAcceptedInRun; }
+
+ private:
+  static int nBins(const std::vector<double>& edges) { return edges.size() < 2 ? 1 : edges.size() - 1; }
+
+  static int findBin(const std::vector<double>& edges, double value)
+  {
+    if (edges.size() < 2) {
+      return 0;
+    }
+    // underflow and NaN in the first bin, overflow in the last one
+    return std::upper_bound(edges.begin() + 1, edges.end() - 1, value) - (edges.begin() + 1);
+  }
+
+  /// uniform number in (0, 1) from the splitmix64 hash of (seed, run, sequence)
+  double uniform(uint64_t sequence) const
+  {
+    uint64_t x = mSeed ^ (static_cast<uint64_t>(mRunNumber) * 0xd1b54a32d192ed03ULL) ^ (sequence * 0x9e3779b97f4a7c15ULL);
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return ((x >> 11) + 0.5) * 0x1.0p-53;
+  }
+
+  int mNSpecies{0};
+  int mTargetPerStratum{0};
+  int64_t mMaxAcceptedPerRun{-1};
+  uint64_t mSeed{0};
+  std::array<std::vector<double>, kNAxes> mEdges;
+
+  int mRunNumber{-1};
+  uint64_t mSequence{0}; // tracks passed to accept() in the run
+  int64_t mNAcceptedInRun{0};
+  std::vector<double> mKeys; // targetPerStratum keys per stratum, min-heap ordered
+  std::vector<int> mReservoirSizes;
+  std::vector<int64_t> mNSeen;
+  std::vector<int64_t> mNAccepted;
+  double mLastKey{-1.};
+  double mLastAcceptanceProbability{1.};
+};
+
+} // namespace o2::common::core
+
+#endif // COMMON_CORE_STRATIFIEDRESERVOIRSAMPLER_H_
@@ -0,0 +1,202 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   TimeSeriesAccumulator.h
+/// \brief  Accumulator for histograms vs time (e.g. seconds from the start of run) with fixed-width time bins.
+///
+///         The time axis is split into chunks of ChunkTimeBins bins, which are allocated only when a fill
+///         falls into them. A fill is a direct array index into the chunk (no bin search on the time axis,
+///         no TH1 virtual calls), and the counters are compact: uint32_t for unweighted counts, sums of
+///         weights and of squared weights of type TCounter (float, or double for large sums per flush)
+///         otherwise. The contents are added to the bound TH1/TH2 when flushed, after which the chunks are
+///         recycled, so that the memory of the accumulator follows the time span of the data filled since
+///         the last flush rather than the length of the run.
+///
+///         Usage with a histogram booked in a HistogramRegistry:
+///           registry.fill(HIST("hSecondsVsPhi"), secFromSOR, phi)  ->  hSecondsVsPhiFiller.fill(secFromSOR, phi)
+///         with hSecondsVsPhiFiller.bind(registry.get<TH2>(HIST("hSecondsVsPhi"))) after booking and
+///         hSecondsVsPhiFiller.flush() at the end of the process function.
+///
+
+#ifndef COMMON_CORE_TIMESERIESACCUMULATOR_H_
+#define COMMON_CORE_TIMESERIESACCUMULATOR_H_
+
+#include <Framework/Logger.h>
+
+#include <TAxis.h>
+#include <TH1.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace o2::common::core
+{
+
+/// \tparam TCounter uint32_t for unweighted fills, float (or double) for weighted fills
+template <typename TCounter = uint32_t>
+class TimeSeriesAccumulator
+{
+ public:
+  static constexpr int ChunkTimeBins = 64;
+  static constexpr bool IsWeighted = std::is_floating_point_v<TCounter>;
+
+  /// takes the binning from the histogram: fixed-width time bins on the x axis, any binning on the y axis of a TH2.
+  /// Previously accumulated contents are dropped
+  template <typename HistPtr>
+  void bind(HistPtr const& hist)
+  {
+    mHist = &*hist;
+    const TAxis* axisTime = mHist->GetXaxis();
+    if (axisTime->IsVariableBinSize()) {
+      LOGF(fatal, "TimeSeriesAccumulator: time axis of %s has variable bin widths", mHist->GetName());
+    }
+    if (mHist->GetDimension() > 2) {
+      LOGF(fatal, "TimeSeriesAccumulator: %s has %d dimensions, only TH1 and TH2 are supported", mHist->GetName(), mHist->GetDimension());
+    }
+    mNTimeBins = axisTime->GetNbins();
+    mTimeMin = axisTime->GetXmin();
+    mTimeMax = axisTime->GetXmax();
+    mAxisY = mHist->GetDimension() == 2 ? mHist->GetYaxis() : nullptr;
+    mNCellsY = mAxisY ? mAxisY->GetNbins() + 2 : 1;
+
+    mChunks.clear();
+    mChunks.resize((mNTimeBins + 2 + ChunkTimeBins - 1) / ChunkTimeBins);
+    mUsedChunks.clear();
+    mFreeChunks.clear();
+    mNFills = 0;
+  }
+
+  /// as TH1::Fill: fill(time) or fill(time, weight) for a TH1, fill(time, y) or fill(time, y, weight) for a TH2
+  void fill(double time) { fillCell(findTimeBin(time), 0, 1.); }
+
+  void fill(double time, double value)
+  {
+    if (mAxisY) {
+      fillCell(findTimeBin(time), findBinY(value), 1.);
+    } else {
+      fillCell(findTimeBin(time), 0, value);
+    }
+  }
+
+  void fill(double time, double y, double weight) { fillCell(findTimeBin(time), findBinY(y), weight); }
+
+  /// y bin of a TH2 (ROOT convention, 0 is the underflow), to fill several histograms with the same binning
+  int findBinY(double y) const { return mAxisY->FindFixBin(y); }
+
+  /// fill of a TH2 with the y bin known in advance
+  void fillBin(double time, int yBin, double weight = 1.) { fillCell(findTimeBin(time), yBin, weight); }
+
+  /// adds the accumulated contents to the histogram and recycles the chunks
+  void flush()
+  {
+    if (mUsedChunks.empty()) {
+      return;
+    }
+    if (IsWeighted && mHist->GetSumw2N() == 0) {
+      mHist->Sumw2();
+    }
+    const std::size_t chunkSize = static_cast<std::size_t>(ChunkTimeBins) * mNCellsY;
+    for (const int iChunk : mUsedChunks) {
+      Cell* cells = mChunks[iChunk].get();
+      const int firstTimeBin = iChunk * ChunkTimeBins;
+      for (std::size_t iCell = 0; iCell < chunkSize; iCell++) {
+        if (cells[iCell].isEmpty()) {
+          continue;
+        }
+        const int timeBin = firstTimeBin + iCell / mNCellsY;
+        const int bin = mAxisY ? mHist->GetBin(timeBin, iCell % mNCellsY) : timeBin;
+        mHist->AddBinContent(bin, cells[iCell].sumw);
+        if (mHist->GetSumw2N() > 0) {
+          mHist->GetSumw2()->AddAt(mHist->GetSumw2()->At(bin) + cells[iCell].sumw2(), bin);
+        }
+        cells[iCell] = Cell{};
+      }
+      mFreeChunks.push_back(std::move(mChunks[iChunk]));
+    }
+    mUsedChunks.clear();
+    // the statistics are recomputed from the bin contents by ROOT when requested, since no Fill() was done
+    mHist->SetEntries(mHist->GetEntries() + mNFills);
+    mNFills = 0;
+  }
+
+  /// number of chunks allocated by the accumulator, in use or free
+  std::size_t getNAllocatedChunks() const { return mUsedChunks.size() + mFreeChunks.size(); }
+
+ private:
+  struct CountCell {
+    TCounter sumw = 0;
+    TCounter sumw2() const { return sumw; }
+    bool isEmpty() const { return sumw == 0; }
+    void add(double) { sumw++; }
+  };
+  struct WeightCell {
+    TCounter sumw = 0;
+    TCounter sumw2Value = 0;
+    TCounter sumw2() const { return sumw2Value; }
+    bool isEmpty() const { return sumw == 0 && sumw2Value == 0; }
+    void add(double weight)
+    {
+      sumw += weight;
+      sumw2Value += weight * weight;
+    }
+  };
+  using Cell = std::conditional_t<IsWeighted, WeightCell, CountCell>;
+
+  /// time bin with ROOT conventions: 0 is the underflow and nTimeBins + 1 the overflow bin (also for NaN)
+  int findTimeBin(double time) const
+  {
+    if (time < mTimeMin) {
+      return 0;
+    }
+    if (!(time < mTimeMax)) {
+      return mNTimeBins + 1;
+    }
+    // same arithmetic as TAxis::FindFixBin, so that bin edges are treated identically
+    const int bin = 1 + static_cast<int>(mNTimeBins * (time - mTimeMin) / (mTimeMax - mTimeMin));
+    return bin > mNTimeBins ? mNTimeBins : bin;
+  }
+
+  void fillCell(int timeBin, int yBin, double weight)
+  {
+    const int iChunk = timeBin / ChunkTimeBins;
+    auto& chunk = mChunks[iChunk];
+    if (!chunk) {
+      if (mFreeChunks.empty()) {
+        chunk = std::make_unique<Cell[]>(static_cast<std::size_t>(ChunkTimeBins) * mNCellsY);
+      } else {
+        chunk = std::move(mFreeChunks.back());
+        mFreeChunks.pop_back();
+      }
+      mUsedChunks.push_back(iChunk);
+    }
+    chunk[static_cast<std::size_t>(timeBin - iChunk * ChunkTimeBins) * mNCellsY + yBin].add(weight);
+    mNFills++;
+  }
+
+  TH1* mHist = nullptr;
+  const TAxis* mAxisY = nullptr;
+  int mNTimeBins = 0;
+  double mTimeMin = 0.;
+  double mTimeMax = 0.;
+  int mNCellsY = 1;                                 // y bins including underflow and overflow, 1 for a TH1
+  std::vector<std::unique_ptr<Cell[]>> mChunks;     // per chunk of the time axis, null until filled
+  std::vector<int> mUsedChunks;                     // chunks filled since the last flush
+  std::vector<std::unique_ptr<Cell[]>> mFreeChunks; // zeroed chunks for reuse
+  int64_t mNFills = 0;
+};
+
+} // namespace o2::common::core
+
+#endif // COMMON_CORE_TIMESERIESACCUMULATOR_H_
@@ -28,6 +28,11 @@
 #include <utility>
 #include <vector>
 
+namespace o2::common::core
+{
+class TrackSelectionKernel;
+} // namespace o2::common::core
+
 class TrackSelection
 {
  public:
@@ -242,6 +247,8 @@ class TrackSelection
   void print() const;
 
  private:
+  friend class o2::common::core::TrackSelectionKernel; // evaluates the cuts on arrays of tracks
+
   bool FulfillsITSHitRequirements(uint8_t itsClusterMap) const;
 
   o2::aod::track::TrackTypeEnum mTrackType{o2::aod::track::TrackTypeEnum::Track};
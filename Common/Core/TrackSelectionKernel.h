@@ -0,0 +1,212 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   TrackSelectionKernel.h
+/// \brief  Evaluation of several TrackSelection variants on all the tracks of a table in one pass.
+///
+///         The quantities used by the cuts (most of them dynamic columns of TracksExtra, e.g. tpcNClsFound())
+///         are read once per track into one array each. Each cut of each variant is then evaluated by a loop
+///         over these arrays, by blocks of tracks so that the masks of a block stay in cache, which the
+///         compiler vectorises. The masks are bit for bit the ones of TrackSelection::IsSelectedMask(), and a
+///         track passes a variant as in TrackSelection::IsSelected() when all its bits are set.
+///
+///         Usage:
+///           kernel.addSelection(selection) per variant, after its setters;
+///           per table: kernel.process(tracks); kernel.getMask(variant, iTrack), kernel.isSelected(variant, iTrack)
+///
+
+#ifndef COMMON_CORE_TRACKSELECTIONKERNEL_H_
+#define COMMON_CORE_TRACKSELECTIONKERNEL_H_
+
+#include "Common/Core/TrackSelection.h"
+
+#include <Framework/DataTypes.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace o2::common::core
+{
+
+/// quantities of the tracks used by TrackSelection, one array each
+struct TrackSelectionColumns {
+  std::vector<uint8_t> trackType;
+  std::vector<float> pt, eta;
+  std::vector<int> tpcNClsFound, tpcNClsCrossedRows;
+  std::vector<float> tpcCrossedRowsOverFindableCls, tpcChi2NCl, tpcFractionSharedCls;
+  std::vector<int> itsNCls;
+  std::vector<float> itsChi2NCl;
+  std::vector<uint8_t> itsClusterMap;
+  std::vector<uint8_t> tpcRefit, itsRefit; // TPC (ITS) refit for Run 2, TPC (ITS) present for Run 3
+  std::vector<uint8_t> goldenChi2Failed;   // Run 2 track without the golden chi2 flag
+  std::vector<float> dcaXY, dcaZ;
+
+  std::size_t size() const { return pt.size(); }
+
+  void clear()
+  {
+    for (auto* v : {&trackType, &itsClusterMap, &tpcRefit, &itsRefit, &goldenChi2Failed}) {
+      v->clear();
+    }
+    for (auto* v : {&pt, &eta, &tpcCrossedRowsOverFindableCls, &tpcChi2NCl, &tpcFractionSharedCls, &itsChi2NCl, &dcaXY, &dcaZ}) {
+      v->clear();
+    }
+    for (auto* v : {&tpcNClsFound, &tpcNClsCrossedRows, &itsNCls}) {
+      v->clear();
+    }
+  }
+
+  template <typename T>
+  void add(T const& track)
+  {
+    const bool isRun2 = track.trackType() == o2::aod::track::Run2Track || track.trackType() == o2::aod::track::Run2Tracklet;
+    trackType.push_back(track.trackType());
+    pt.push_back(track.pt());
+    eta.push_back(track.eta());
+    tpcNClsFound.push_back(track.tpcNClsFound());
+    tpcNClsCrossedRows.push_back(track.tpcNClsCrossedRows());
+    tpcCrossedRowsOverFindableCls.push_back(track.tpcCrossedRowsOverFindableCls());
+    tpcChi2NCl.push_back(track.tpcChi2NCl());
+    tpcFractionSharedCls.push_back(track.tpcFractionSharedCls());
+    itsNCls.push_back(track.itsNCls());
+    itsChi2NCl.push_back(track.itsChi2NCl());
+    itsClusterMap.push_back(track.itsClusterMap());
+    tpcRefit.push_back(isRun2 ? (track.flags() & o2::aod::track::TPCrefit) != 0 : track.hasTPC());
+    itsRefit.push_back(isRun2 ? (track.flags() & o2::aod::track::ITSrefit) != 0 : track.hasITS());
+    goldenChi2Failed.push_back(isRun2 && !(track.flags() & o2::aod::track::GoldenChi2));
+    dcaXY.push_back(track.dcaXY());
+    dcaZ.push_back(track.dcaZ());
+  }
+};
+
+class TrackSelectionKernel
+{
+ public:
+  using TrackCuts = TrackSelection::TrackCuts;
+
+  static constexpr std::size_t BlockSize = 1024;
+  static constexpr uint16_t AllCuts = (1u << static_cast<int>(TrackCuts::kNCuts)) - 1;
+
+  /// adds a copy of the selection, to be called after its setters. Returns the index of the variant
+  int addSelection(TrackSelection const& selection)
+  {
+    mSelections.push_back(selection);
+    mMasks.emplace_back();
+    return mSelections.size() - 1;
+  }
+
+  int getNSelections() const { return mSelections.size(); }
+
+  /// evaluates all the variants on all the tracks of the table
+  template <typename TTracks>
+  void process(TTracks const& tracks)
+  {
+    mColumns.clear();
+    for (const auto& track : tracks) {
+      mColumns.add(track);
+    }
+    const std::size_t nTracks = mColumns.size();
+    for (auto& masks : mMasks) {
+      masks.resize(nTracks);
+    }
+    for (std::size_t first = 0; first < nTracks; first += BlockSize) {
+      const std::size_t last = std::min(first + BlockSize, nTracks);
+      for (std::size_t iSelection = 0; iSelection < mSelections.size(); iSelection++) {
+        evaluate(mSelections[iSelection], first, last, mMasks[iSelection].data() + first);
+      }
+    }
+  }
+
+  /// as TrackSelection::IsSelectedMask() of the variant for the track at position iTrack of the table
+  uint16_t getMask(int selection, std::size_t iTrack) const { return mMasks[selection][iTrack]; }
+
+  /// as TrackSelection::IsSelected() of the variant for the track at position iTrack of the table
+  bool isSelected(int selection, std::size_t iTrack) const { return mMasks[selection][iTrack] == AllCuts; }
+
+  TrackSelectionColumns const& getColumns() const { return mColumns; }
+
+ private:
+  /// masks of one variant for the tracks [first, last)
+  void evaluate(TrackSelection const& s, std::size_t first, std::size_t last, uint16_t* masks)
+  {
+    const std::size_t n = last - first;
+    std::fill(masks, masks + n, 0);
+    const auto& c = mColumns;
+    auto setBit = [&](TrackCuts cut, auto const& pass) {
+      const uint16_t bit = 1u << static_cast<int>(cut);
+      for (std::size_t i = 0; i < n; i++) {
+        masks[i] |= pass(first + i) ? bit : 0;
+      }
+    };
+
+    const uint8_t trackType = static_cast<uint8_t>(s.mTrackType);
+    setBit(TrackCuts::kTrackType, [&](std::size_t i) { return c.trackType[i] == trackType; });
+    setBit(TrackCuts::kPtRange, [&](std::size_t i) { return (c.pt[i] >= s.mMinPt) & (c.pt[i] <= s.mMaxPt); });
+    setBit(TrackCuts::kEtaRange, [&](std::size_t i) { return (c.eta[i] >= s.mMinEta) & (c.eta[i] <= s.mMaxEta); });
+    setBit(TrackCuts::kTPCNCls, [&](std::size_t i) { return c.tpcNClsFound[i] >= s.mMinNClustersTPC; });
+    setBit(TrackCuts::kTPCCrossedRows, [&](std::size_t i) { return c.tpcNClsCrossedRows[i] >= s.mMinNCrossedRowsTPC; });
+    setBit(TrackCuts::kTPCCrossedRowsOverNCls, [&](std::size_t i) { return c.tpcCrossedRowsOverFindableCls[i] >= s.mMinNCrossedRowsOverFindableClustersTPC; });
+    setBit(TrackCuts::kTPCChi2NDF, [&](std::size_t i) { return c.tpcChi2NCl[i] <= s.mMaxChi2PerClusterTPC; });
+    const bool requireTPCRefit = s.mRequireTPCRefit;
+    setBit(TrackCuts::kTPCRefit, [&](std::size_t i) { return !requireTPCRefit | (c.tpcRefit[i] != 0); });
+    setBit(TrackCuts::kITSNCls, [&](std::size_t i) { return c.itsNCls[i] >= s.mMinNClustersITS; });
+    setBit(TrackCuts::kITSChi2NDF, [&](std::size_t i) { return c.itsChi2NCl[i] <= s.mMaxChi2PerClusterITS; });
+    const bool requireITSRefit = s.mRequireITSRefit;
+    setBit(TrackCuts::kITSRefit, [&](std::size_t i) { return !requireITSRefit | (c.itsRefit[i] != 0); });
+
+    // ITS hits: all the requirements, each as a mask of layers, see TrackSelection::FulfillsITSHitRequirements()
+    setBit(TrackCuts::kITSHits, [](std::size_t) { return true; });
+    for (const auto& [minNRequiredHits, layers] : s.mRequiredITSHits) {
+      uint8_t layerMask = 0;
+      for (const auto layer : layers) {
+        if (layer < 8) {
+          layerMask |= 1 << layer;
+        }
+      }
+      const int minHits = minNRequiredHits;
+      const uint16_t clearBit = static_cast<uint16_t>(~(1u << static_cast<int>(TrackCuts::kITSHits)));
+      for (std::size_t i = 0; i < n; i++) {
+        const int hits = std::popcount(static_cast<uint8_t>(c.itsClusterMap[first + i] & layerMask));
+        const bool failed = minHits == -1 ? hits > 0 : hits < minHits;
+        masks[i] &= failed ? clearBit : 0xffff;
+      }
+    }
+
+    const bool requireGoldenChi2 = s.mRequireGoldenChi2;
+    setBit(TrackCuts::kGoldenChi2, [&](std::size_t i) { return !(requireGoldenChi2 & (c.goldenChi2Failed[i] != 0)); });
+    if (s.mMaxDcaXYPtDep) {
+      mMaxDcaXY.resize(n);
+      for (std::size_t i = 0; i < n; i++) {
+        mMaxDcaXY[i] = s.mMaxDcaXYPtDep(c.pt[first + i]);
+      }
+      setBit(TrackCuts::kDCAxy, [&](std::size_t i) { return std::fabs(c.dcaXY[i]) <= mMaxDcaXY[i - first]; });
+    } else {
+      setBit(TrackCuts::kDCAxy, [&](std::size_t i) { return std::fabs(c.dcaXY[i]) <= s.mMaxDcaXY; });
+    }
+    setBit(TrackCuts::kDCAz, [&](std::size_t i) { return std::fabs(c.dcaZ[i]) <= s.mMaxDcaZ; });
+    setBit(TrackCuts::kTPCFracSharedCls, [&](std::size_t i) { return c.tpcFractionSharedCls[i] <= s.mMaxTPCFractionSharedCls; });
+  }
+
+  std::vector<TrackSelection> mSelections;
+  std::vector<std::vector<uint16_t>> mMasks; // per variant, per track
+  TrackSelectionColumns mColumns;
+  std::vector<float> mMaxDcaXY; // pt-dependent DCAxy cut of a block
+};
+
+} // namespace o2::common::core
+
+#endif // COMMON_CORE_TRACKSELECTIONKERNEL_H_
@@ -21,6 +21,7 @@
 
 #include "Common/Core/TableHelper.h"
 #include "Common/Core/TrackSelectionDefaults.h"
+#include "Common/Core/TrackSelectionKernel.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 
 #include <Framework/AnalysisDataModel.h>
@@ -31,6 +32,7 @@
 #include <Framework/InitContext.h>
 #include <Framework/runDataProcessing.h>
 
+#include <cstddef>
 #include <cstdint>
 
 using namespace o2;
@@ -54,6 +56,7 @@ struct TrackSelectionTask {
   Configurable<float> ptMax{"ptMax", 1e10f, "Upper cut on pt for the track selected"};
   Configurable<float> etaMin{"etaMin", -0.8, "Lower cut on eta for the track selected"};
   Configurable<float> etaMax{"etaMax", 0.8, "Upper cut on eta for the track selected"};
+  Configurable<bool> useSelectionKernel{"useSelectionKernel", false, "evaluate all the track selections in one column-wise pass over the tracks"};
 
   Produces<aod::TrackSelection> filterTable;
   Produces<aod::TrackSelectionExtension> filterTableDetail;
@@ -65,6 +68,18 @@ struct TrackSelectionTask {
   TrackSelection filtBit4;
   TrackSelection filtBit5;
 
+  // selections evaluated by selectionKernel, in the order of addSelection(); globalTracksSDD only in Run 2
+  enum SelectionVariant : int {
+    kGlobalTracks = 0,
+    kFiltBit1,
+    kFiltBit2,
+    kFiltBit3,
+    kFiltBit4,
+    kFiltBit5,
+    kGlobalTracksSDD
+  };
+  o2::common::core::TrackSelectionKernel selectionKernel;
+
   void init(InitContext& initContext)
   {
     // Check which tables are used
@@ -142,6 +157,28 @@ struct TrackSelectionTask {
 
     LOG(info) << "setting up filtBit5 = getJEGlobalTrackSelectionRun2();";
     filtBit5 = getJEGlobalTrackSelectionRun2(); // Jet validation requires reduced set of cuts
+
+    if (useSelectionKernel) {
+      for (const auto* selection : {&globalTracks, &filtBit1, &filtBit2, &filtBit3, &filtBit4, &filtBit5}) {
+        selectionKernel.addSelection(*selection);
+      }
+      if (!isRun3) {
+        selectionKernel.addSelection(globalTracksSDD);
+      }
+    }
+  }
+
+  // iTrack: position of the track in the table given to selectionKernel.process()
+  template <typename T>
+  o2::aod::track::TrackSelectionFlags::flagtype getMask(SelectionVariant variant, TrackSelection const& selection, T const& track, std::size_t iTrack)
+  {
+    return useSelectionKernel ? selectionKernel.getMask(variant, iTrack) : selection.IsSelectedMask(track);
+  }
+
+  template <typename T>
+  bool isSelected(SelectionVariant variant, TrackSelection const& selection, T const& track, std::size_t iTrack)
+  {
+    return useSelectionKernel ? selectionKernel.isSelected(variant, iTrack) : selection.IsSelected(track);
   }
 
   void process(soa::Join<aod::FullTracks, aod::TracksDCA> const& tracks)
@@ -155,22 +192,26 @@ struct TrackSelectionTask {
     if (produceTable == 0 && produceFBextendedTable == 0) {
       return;
     }
+    if (useSelectionKernel) {
+      selectionKernel.process(tracks);
+    }
+    std::size_t iTrack = 0;
     if (isRun3) {
       for (const auto& track : tracks) {
 
         if (produceTable == 1) {
           filterTable((uint8_t)0,
-                      globalTracks.IsSelectedMask(track),
-                      filtBit1.IsSelected(track),
-                      filtBit2.IsSelected(track),
-                      filtBit3.IsSelected(track),
-                      filtBit4.IsSelected(track),
-                      filtBit5.IsSelected(track));
+                      getMask(kGlobalTracks, globalTracks, track, iTrack),
+                      isSelected(kFiltBit1, filtBit1, track, iTrack),
+                      isSelected(kFiltBit2, filtBit2, track, iTrack),
+                      isSelected(kFiltBit3, filtBit3, track, iTrack),
+                      isSelected(kFiltBit4, filtBit4, track, iTrack),
+                      isSelected(kFiltBit5, filtBit5, track, iTrack));
         }
         if (produceFBextendedTable == 1) {
-          o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = globalTracks.IsSelectedMask(track);
-          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB1 = filtBit1.IsSelectedMask(track);
-          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB2 = filtBit2.IsSelectedMask(track);
+          o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = getMask(kGlobalTracks, globalTracks, track, iTrack);
+          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB1 = getMask(kFiltBit1, filtBit1, track, iTrack);
+          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB2 = getMask(kFiltBit2, filtBit2, track, iTrack);
           // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB3 = filtBit3.IsSelectedMask(track); // only temporarily commented, will be used
           // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB4 = filtBit4.IsSelectedMask(track);
           // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB5 = filtBit5.IsSelectedMask(track);
@@ -193,20 +234,21 @@ struct TrackSelectionTask {
                             o2::aod::track::TrackSelectionFlags::checkFlag(trackflagFB1, o2::aod::track::TrackSelectionFlags::kITSHits),
                             o2::aod::track::TrackSelectionFlags::checkFlag(trackflagFB2, o2::aod::track::TrackSelectionFlags::kITSHits));
         }
+        iTrack++;
       }
       return;
     }
 
     for (const auto& track : tracks) {
-      o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = globalTracks.IsSelectedMask(track);
+      o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = getMask(kGlobalTracks, globalTracks, track, iTrack);
       if (produceTable == 1) {
-        filterTable((uint8_t)globalTracksSDD.IsSelected(track),
-                    globalTracks.IsSelectedMask(track),
-                    filtBit1.IsSelected(track),
-                    filtBit2.IsSelected(track),
-                    filtBit3.IsSelected(track),
-                    filtBit4.IsSelected(track),
-                    filtBit5.IsSelected(track));
+        filterTable((uint8_t)isSelected(kGlobalTracksSDD, globalTracksSDD, track, iTrack),
+                    getMask(kGlobalTracks, globalTracks, track, iTrack),
+                    isSelected(kFiltBit1, filtBit1, track, iTrack),
+                    isSelected(kFiltBit2, filtBit2, track, iTrack),
+                    isSelected(kFiltBit3, filtBit3, track, iTrack),
+                    isSelected(kFiltBit4, filtBit4, track, iTrack),
+                    isSelected(kFiltBit5, filtBit5, track, iTrack));
       }
       if (produceFBextendedTable == 1) {
         filterTableDetail(o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTrackType),
@@ -227,6 +269,7 @@ struct TrackSelectionTask {
                           0,
                           0);
       }
+      iTrack++;
     }
   }
 };
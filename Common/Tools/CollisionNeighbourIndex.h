@@ -0,0 +1,218 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CollisionNeighbourIndex.h
+/// \brief Neighbour-collision index (same ITS ROF, previous ITS ROF, time window) for occupancy estimation
+///
+/// The neighbour lists of all collisions of a DataFrame are stored in CSR layout (offsets + flat
+/// indices), filled with a two-pointer sweep over the collisions ordered by global BC, so that no
+/// per-collision vectors are allocated. The storage is kept between DataFrames.
+
+#ifndef COMMON_TOOLS_COLLISIONNEIGHBOURINDEX_H_
+#define COMMON_TOOLS_COLLISIONNEIGHBOURINDEX_H_
+
+#include <CommonConstants/LHCConstants.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace o2
+{
+namespace common
+{
+namespace eventselection
+{
+
+/// \brief Neighbour collisions of each collision of a DataFrame
+///
+/// For collision i (index in the collision table) the index provides
+///  - sameRof(i): other collisions in the same TF and ITS ROF, i.e. the contiguous run of collisions with equal (TF, ROF),
+///  - prevRof(i): collisions in the same TF and in the previous ITS ROF, found scanning backwards from i,
+///  - timeWindow(i): collisions in the same TF within [timeWinMinNS, timeWinMaxNS] wrt collision i, found scanning
+///    backwards and forwards from i, with timeWindowDeltaNS(i) the corresponding time differences (ns).
+/// Neighbours before i are listed in descending index order, followed by neighbours after i in ascending order,
+/// as in the original per-collision scans, so that sums over the lists are unchanged.
+/// If the global BCs of the collisions are not sorted, the time-window and previous-ROF lists are filled with
+/// per-collision scans, which give the same result as the sweep without its linear cost.
+class CollisionNeighbourIndex
+{
+ public:
+  /// \brief builds all neighbour lists
+  /// \param globalBCs global BC of each collision, in collision-table order
+  /// \param bcSOR global BC of the start of the first orbit
+  /// \param nBCsPerTF duration of a TF in BCs
+  /// \param rofOffset ITS ROF offset in BCs
+  /// \param rofLength ITS ROF length in BCs
+  /// \param timeWinMinNS lower edge of the time window wrt the collision (ns, negative)
+  /// \param timeWinMaxNS upper edge of the time window wrt the collision (ns)
+  void build(const std::vector<int64_t>& globalBCs, int64_t bcSOR, int64_t nBCsPerTF, int rofOffset, int rofLength, float timeWinMinNS, float timeWinMaxNS)
+  {
+    const int nCols = globalBCs.size();
+    mTfIds.resize(nCols);
+    mRofIds.resize(nCols);
+    mIsSorted = true;
+    for (int i = 0; i < nCols; i++) {
+      mTfIds[i] = (globalBCs[i] - bcSOR) / nBCsPerTF;
+      mRofIds[i] = (globalBCs[i] + o2::constants::lhc::LHCMaxBunches - rofOffset) / rofLength;
+      if (i > 0 && globalBCs[i] < globalBCs[i - 1]) {
+        mIsSorted = false;
+      }
+    }
+
+    // runs of consecutive collisions with equal (TF, ROF)
+    mRunBegin.resize(nCols);
+    mRunEnd.resize(nCols);
+    for (int begin = 0; begin < nCols;) {
+      int end = begin + 1;
+      while (end < nCols && mTfIds[end] == mTfIds[begin] && mRofIds[end] == mRofIds[begin]) {
+        end++;
+      }
+      std::fill(mRunBegin.begin() + begin, mRunBegin.begin() + end, begin);
+      std::fill(mRunEnd.begin() + begin, mRunEnd.begin() + end, end);
+      begin = end;
+    }
+
+    // same ROF: the run without the collision itself
+    mSameRofOffsets.resize(nCols + 1);
+    mSameRofIds.clear();
+    mSameRofOffsets[0] = 0;
+    for (int i = 0; i < nCols; i++) {
+      for (int j = i - 1; j >= mRunBegin[i]; j--) {
+        mSameRofIds.push_back(j);
+      }
+      for (int j = i + 1; j < mRunEnd[i]; j++) {
+        mSameRofIds.push_back(j);
+      }
+      mSameRofOffsets[i + 1] = mSameRofIds.size();
+    }
+
+    // previous ROF
+    mPrevRofOffsets.resize(nCols + 1);
+    mPrevRofIds.clear();
+    mPrevRofOffsets[0] = 0;
+    for (int i = 0; i < nCols; i++) {
+      if (mIsSorted) {
+        // only the run preceding the one of collision i can be in the previous ROF
+        const int begin = mRunBegin[i];
+        if (begin > 0 && mTfIds[begin - 1] == mTfIds[i] && mRofIds[begin - 1] == mRofIds[i] - 1) {
+          for (int j = begin - 1; j >= mRunBegin[begin - 1]; j--) {
+            mPrevRofIds.push_back(j);
+          }
+        }
+      } else {
+        for (int j = i - 1; j >= 0; j--) {
+          if (mTfIds[j] != mTfIds[i]) {
+            break;
+          }
+          if (mRofIds[j] == mRofIds[i] - 1) {
+            mPrevRofIds.push_back(j);
+          } else if (mRofIds[j] < mRofIds[i] - 1) {
+            break;
+          }
+        }
+      }
+      mPrevRofOffsets[i + 1] = mPrevRofIds.size();
+    }
+
+    // time window: [low, i) and (i, high] are contiguous, and both edges only move forward for sorted BCs
+    auto deltaNS = [&globalBCs](int j, int i) -> float { return (globalBCs[j] - globalBCs[i]) * o2::constants::lhc::LHCBunchSpacingNS; };
+    mTimeWinOffsets.resize(nCols + 1);
+    mTimeWinIds.clear();
+    mTimeWinDeltaNS.clear();
+    mTimeWinOffsets[0] = 0;
+    int low = 0, high = 0;
+    for (int i = 0; i < nCols; i++) {
+      if (mIsSorted) {
+        while (low < i && (mTfIds[low] != mTfIds[i] || deltaNS(low, i) < timeWinMinNS)) {
+          low++;
+        }
+        high = std::max(high, i);
+        while (high + 1 < nCols && mTfIds[high + 1] == mTfIds[i] && deltaNS(high + 1, i) <= timeWinMaxNS) {
+          high++;
+        }
+      } else {
+        low = i;
+        while (low > 0 && mTfIds[low - 1] == mTfIds[i] && deltaNS(low - 1, i) >= timeWinMinNS) {
+          low--;
+        }
+        high = i;
+        while (high + 1 < nCols && mTfIds[high + 1] == mTfIds[i] && deltaNS(high + 1, i) <= timeWinMaxNS) {
+          high++;
+        }
+      }
+      for (int j = i - 1; j >= low; j--) {
+        mTimeWinIds.push_back(j);
+        mTimeWinDeltaNS.push_back(deltaNS(j, i));
+      }
+      for (int j = i + 1; j <= high; j++) {
+        mTimeWinIds.push_back(j);
+        mTimeWinDeltaNS.push_back(deltaNS(j, i));
+      }
+      mTimeWinOffsets[i + 1] = mTimeWinIds.size();
+    }
+  }
+
+  std::size_t size() const { return mRunBegin.size(); }
+  bool isSorted() const { return mIsSorted; }
+  int64_t tfId(int i) const { return mTfIds[i]; }
+  int64_t rofId(int i) const { return mRofIds[i]; }
+
+  std::span<const int> sameRof(int i) const { return {mSameRofIds.data() + mSameRofOffsets[i], mSameRofIds.data() + mSameRofOffsets[i + 1]}; }
+  std::span<const int> prevRof(int i) const { return {mPrevRofIds.data() + mPrevRofOffsets[i], mPrevRofIds.data() + mPrevRofOffsets[i + 1]}; }
+  std::span<const int> timeWindow(int i) const { return {mTimeWinIds.data() + mTimeWinOffsets[i], mTimeWinIds.data() + mTimeWinOffsets[i + 1]}; }
+  std::span<const float> timeWindowDeltaNS(int i) const { return {mTimeWinDeltaNS.data() + mTimeWinOffsets[i], mTimeWinDeltaNS.data() + mTimeWinOffsets[i + 1]}; }
+
+  /// range [begin, end) of collisions in the same TF and ROF as collision i, including i
+  std::pair<int, int> sameRofRange(int i) const { return {mRunBegin[i], mRunEnd[i]}; }
+
+  /// running sum of a per-collision quantity: runningSum[i] = sum of values[0..i-1]
+  template <typename T>
+  static void fillRunningSum(const std::vector<T>& values, std::vector<T>& runningSum)
+  {
+    runningSum.resize(values.size() + 1);
+    runningSum[0] = 0;
+    for (std::size_t i = 0; i < values.size(); i++) {
+      runningSum[i + 1] = runningSum[i] + values[i];
+    }
+  }
+
+  /// sum of a per-collision quantity over the other collisions in the same ROF, from its running sum.
+  /// Meant for integer quantities, for which the result does not depend on the summation order
+  template <typename T>
+  T sumInSameRof(int i, const std::vector<T>& runningSum) const
+  {
+    return runningSum[mRunEnd[i]] - runningSum[mRunBegin[i]] - (runningSum[i + 1] - runningSum[i]);
+  }
+
+ private:
+  bool mIsSorted{true};
+  std::vector<int64_t> mTfIds;
+  std::vector<int64_t> mRofIds;
+  std::vector<int> mRunBegin;
+  std::vector<int> mRunEnd;
+  std::vector<std::size_t> mSameRofOffsets;
+  std::vector<int> mSameRofIds;
+  std::vector<std::size_t> mPrevRofOffsets;
+  std::vector<int> mPrevRofIds;
+  std::vector<std::size_t> mTimeWinOffsets;
+  std::vector<int> mTimeWinIds;
+  std::vector<float> mTimeWinDeltaNS;
+};
+
+} // namespace eventselection
+} // namespace common
+} // namespace o2
+
+#endif // COMMON_TOOLS_COLLISIONNEIGHBOURINDEX_H_
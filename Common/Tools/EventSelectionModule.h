@@ -16,11 +16,14 @@
 #ifndef COMMON_TOOLS_EVENTSELECTIONMODULE_H_
 #define COMMON_TOOLS_EVENTSELECTIONMODULE_H_
 
+#include "Common/CCDB/CcdbObjectCache.h"
 #include "Common/CCDB/EventSelectionParams.h"
 #include "Common/CCDB/RCTSelectionFlags.h"
 #include "Common/CCDB/TriggerAliases.h"
+#include "Common/Core/GlobalBcTimeline.h"
 #include "Common/Core/TableHelper.h"
 #include "Common/DataModel/EventSelection.h"
+#include "Common/Tools/CollisionNeighbourIndex.h"
 
 #include <CCDB/BasicCCDBManager.h>
 #include <CommonConstants/LHCConstants.h>
@@ -54,6 +57,7 @@
 #include <iterator>
 #include <limits>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -98,6 +102,7 @@ struct bcselConfigurables : o2::framework::ConfigurableGroup {
   o2::framework::Configurable<bool> confCheckRunDurationLimits{"checkRunDurationLimits", false, "Check if the BCs are within the run duration limits"};                           // o2-linter: disable=name/configurable (temporary fix)
   o2::framework::Configurable<std::vector<int>> maxInactiveChipsPerLayer{"maxInactiveChipsPerLayer", {8, 8, 8, 111, 111, 195, 195}, "Maximum allowed number of inactive ITS chips per layer"};
   o2::framework::Configurable<int> confNumberOfOrbitsPerTF{"NumberOfOrbitsPerTF", -1, "Number of orbits per Time Frame. Take from CCDB if -1"}; // o2-linter: disable=name/configurable (temporary fix)
+  o2::framework::Configurable<bool> confPrefetchCcdb{"prefetchCcdb", false, "Download the run-wise CCDB objects in parallel on a run change (enables ROOT thread safety)"}; // o2-linter: disable=name/configurable (temporary fix)
 };
 
 // event selection configurables
@@ -158,8 +163,10 @@ class BcSelectionModule
   int mTimeFrameEndBorderMargin = 4000;  // default value
   std::string strLPMProductionTag = "";  // MC production tag to be retrieved from AO2D metadata
 
-  TriggerAliases* aliases = nullptr;
-  EventSelectionParams* par = nullptr;
+  const TriggerAliases* aliases = nullptr;
+  const EventSelectionParams* par = nullptr;
+  std::shared_ptr<const TriggerAliases> runAliases;   // run-wise objects from the shared CCDB cache,
+  std::shared_ptr<const EventSelectionParams> runPar; // pointed to by aliases and par in Run 3
   std::map<uint64_t, uint32_t>* mapRCT = nullptr;
   std::map<int64_t, std::vector<int16_t>> mapInactiveChips; // number of inactive chips vs orbit per layer
   int64_t prevOrbitForInactiveChips = 0;                    // cached next stored orbit in the inactive chip map
@@ -233,18 +240,38 @@ class BcSelectionModule
 
       // timestamp of the middle of the run used to access run-wise CCDB entries
       int64_t ts = sorTimestamp / 2 + eorTimestamp / 2;
+      // run-wise objects, shared with the other modules through the cache, optionally downloaded in parallel
+      auto& ccdbCache = o2::common::CcdbObjectCache::instance();
+      const auto ccdbSource = o2::common::CcdbObjectCache::sourceOf(ccdb);
+      if (bcselOpts.confPrefetchCcdb) {
+        ccdbCache.prefetch<EventSelectionParams>(ccdbSource, "EventSelection/EventSelectionParams", ts);
+        ccdbCache.prefetch<o2::itsmft::DPLAlpideParam<0>>(ccdbSource, "ITS/Config/AlpideParam", ts);
+        ccdbCache.prefetch<TriggerAliases>(ccdbSource, "EventSelection/TriggerAliases", ts);
+        ccdbCache.prefetch<o2::parameters::GRPLHCIFData>(ccdbSource, "GLO/Config/GRPLHCIF", ts);
+      }
       // access ITSROF and TF border margins
-      par = ccdb->template getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", ts);
+      runPar = ccdbCache.get<EventSelectionParams>(ccdbSource, "EventSelection/EventSelectionParams", ts);
+      if (!runPar) {
+        LOGP(fatal, "EventSelectionParams not in database, timestamp: {}", ts);
+      }
+      par = runPar.get();
       mITSROFrameStartBorderMargin = bcselOpts.confITSROFrameStartBorderMargin < 0 ? par->fITSROFrameStartBorderMargin : bcselOpts.confITSROFrameStartBorderMargin;
       mITSROFrameEndBorderMargin = bcselOpts.confITSROFrameEndBorderMargin < 0 ? par->fITSROFrameEndBorderMargin : bcselOpts.confITSROFrameEndBorderMargin;
       mTimeFrameStartBorderMargin = bcselOpts.confTimeFrameStartBorderMargin < 0 ? par->fTimeFrameStartBorderMargin : bcselOpts.confTimeFrameStartBorderMargin;
       mTimeFrameEndBorderMargin = bcselOpts.confTimeFrameEndBorderMargin < 0 ? par->fTimeFrameEndBorderMargin : bcselOpts.confTimeFrameEndBorderMargin;
       // ITSROF parameters
-      auto alppar = ccdb->template getForTimeStamp<o2::itsmft::DPLAlpideParam<0>>("ITS/Config/AlpideParam", ts);
+      auto alppar = ccdbCache.get<o2::itsmft::DPLAlpideParam<0>>(ccdbSource, "ITS/Config/AlpideParam", ts);
+      if (!alppar) {
+        LOGP(fatal, "ITS AlpideParam not in database, timestamp: {}", ts);
+      }
       rofOffset = alppar->roFrameBiasInBC;
       rofLength = alppar->roFrameLengthInBC;
       // Trigger aliases
-      aliases = ccdb->template getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", ts);
+      runAliases = ccdbCache.get<TriggerAliases>(ccdbSource, "EventSelection/TriggerAliases", ts);
+      if (!runAliases) {
+        LOGP(fatal, "TriggerAliases not in database, timestamp: {}", ts);
+      }
+      aliases = runAliases.get();
 
       // prepare map of inactive chips
       auto itsDeadMap = ccdb->template getForTimeStamp<o2::itsmft::TimeDeadMap>("ITS/Calib/TimeDeadMap", ts);
@@ -281,6 +308,7 @@ class BcSelectionModule
         uint32_t dummyValue = 1u << 31; // setting bit 31 to indicate that rct object is missing
         mapRCT->insert(std::pair<uint64_t, uint32_t>(sorTimestamp, dummyValue));
       }
+      ccdbCache.printCounters();
     }
     return true;
   }
@@ -635,18 +663,18 @@ class EventSelectionModule
   std::vector<float> diffVzParMean;  // parameterization for mean of diff vZ by FT0 vs by tracks
   std::vector<float> diffVzParSigma; // parameterization for stddev of diff vZ by FT0 vs by tracks
 
-  int32_t findClosest(const int64_t globalBC, const std::map<int64_t, int32_t>& bcs)
+  CollisionNeighbourIndex collNeighbours;   // neighbour collisions for occupancy calculation, storage reused across DataFrames
+  std::vector<int> vTracksITS567RunningSum; // running sum of ITS tracks per collision, for in-ROF occupancy
+
+  o2::common::core::GlobalBcTimeline bcTimeline; // colliding BCs with FT0 and TVX in the current DataFrame
+  std::vector<float> vTvxVtxZ;                   // FT0 vertex z per TVX BC of the timeline
+  std::vector<bool> vIsTvxMatched;               // TVX BC already matched to a collision
+
+  // helper function to find the bc index of the closest signal of a timeline channel, -1 if none
+  int32_t findClosest(const int64_t globalBC, int channel)
   {
-    auto it = bcs.lower_bound(globalBC);
-    int64_t bc1 = it->first;
-    int32_t index1 = it->second;
-    if (it != bcs.begin())
-      --it;
-    int64_t bc2 = it->first;
-    int32_t index2 = it->second;
-    int64_t dbc1 = std::abs(bc1 - globalBC);
-    int64_t dbc2 = std::abs(bc2 - globalBC);
-    return (dbc1 <= dbc2) ? index1 : index2;
+    int64_t i = bcTimeline.findClosest(channel, globalBC);
+    return i >= 0 ? bcTimeline.row(channel, i) : -1;
   }
 
   // helper function to find median time in the vector of TOF or TRD-track times
@@ -658,7 +686,8 @@ class EventSelectionModule
   }
 
   // helper function to find closest TVX signal in time and in zVtx
-  int64_t findBestGlobalBC(int64_t meanBC, int64_t sigmaBC, int32_t nContrib, float zVtxCol, std::map<int64_t, float>& mapGlobalBcVtxZ)
+  // (TVX bcs already matched to a collision are skipped)
+  int64_t findBestGlobalBC(int64_t meanBC, int64_t sigmaBC, int32_t nContrib, float zVtxCol)
   {
     // protection against
     if (sigmaBC < 1)
@@ -671,16 +700,18 @@ class EventSelectionModule
     float zVtxSigma = 2.7 * std::pow(nContrib, -0.466) + 0.024;
     zVtxSigma += 1.0; // additional uncertainty due to imperfectections of FT0 time calibration
 
-    auto itMin = mapGlobalBcVtxZ.lower_bound(minBC);
-    auto itMax = mapGlobalBcVtxZ.upper_bound(maxBC);
+    auto [first, last] = bcTimeline.range(o2::common::core::kBcChannelTVX, minBC, maxBC);
 
     float bestChi2 = 1e+10;
     int64_t bestGlobalBC = 0;
-    for (std::map<int64_t, float>::iterator it = itMin; it != itMax; ++it) {
-      float chi2 = std::pow((it->second - zVtxCol) / zVtxSigma, 2) + std::pow(static_cast<float>(it->first - meanBC) / sigmaBC, 2.);
+    for (std::size_t i = first; i < last; i++) {
+      if (vIsTvxMatched[i])
+        continue;
+      int64_t thisGlobalBC = bcTimeline.globalBC(o2::common::core::kBcChannelTVX, i);
+      float chi2 = std::pow((vTvxVtxZ[i] - zVtxCol) / zVtxSigma, 2) + std::pow(static_cast<float>(thisGlobalBC - meanBC) / sigmaBC, 2.);
       if (chi2 < bestChi2) {
         bestChi2 = chi2;
-        bestGlobalBC = it->first;
+        bestGlobalBC = thisGlobalBC;
       }
     }
 
@@ -757,9 +788,13 @@ class EventSelectionModule
       // colliding bc pattern
       int64_t ts = timestamps[0];
 
-      // getForTimeStamp replaced with getSpecific to set metadata to zero
-      // avoids crash related to specific run number
-      auto grplhcif = ccdb->template getSpecific<o2::parameters::GRPLHCIFData>("GLO/Config/GRPLHCIF", ts);
+      // no metadata (as with getSpecific), avoids crash related to specific run number
+      auto& ccdbCache = o2::common::CcdbObjectCache::instance();
+      const auto ccdbSource = o2::common::CcdbObjectCache::sourceOf(ccdb);
+      auto grplhcif = ccdbCache.get<o2::parameters::GRPLHCIFData>(ccdbSource, "GLO/Config/GRPLHCIF", ts);
+      if (!grplhcif) {
+        LOGP(fatal, "GRPLHCIFData not in database, timestamp: {}", ts);
+      }
       bcPatternB = grplhcif->getBunchFilling().getBCPattern();
       bcsPattern = grplhcif->getBunchFilling().getFilledBCs();
       if (runLightIons >= 0) {
@@ -768,7 +803,10 @@ class EventSelectionModule
       }
 
       // extract ITS ROF parameters
-      auto alppar = ccdb->template getForTimeStamp<o2::itsmft::DPLAlpideParam<0>>("ITS/Config/AlpideParam", ts);
+      auto alppar = ccdbCache.get<o2::itsmft::DPLAlpideParam<0>>(ccdbSource, "ITS/Config/AlpideParam", ts);
+      if (!alppar) {
+        LOGP(fatal, "ITS AlpideParam not in database, timestamp: {}", ts);
+      }
       rofOffset = alppar->roFrameBiasInBC;
       rofLength = alppar->roFrameLengthInBC;
       LOGP(debug, "ITS ROF Offset={} ITS ROF Length={}", rofOffset, rofLength);
@@ -890,11 +928,10 @@ class EventSelectionModule
       return; // don't do anything in case configuration reported not ok
 
     int run = bcs.iteratorAt(0).runNumber();
-    // create maps from globalBC to bc index for TVX-fired bcs
+    // fill timeline of globalBC to bc index for FT0 and TVX-fired bcs
     // to be used for closest TVX searches
-    std::map<int64_t, int32_t> mapGlobalBcWithTVX;
-    std::map<int64_t, int32_t> mapGlobalBcWithOrInFT0;
-    std::map<int64_t, float> mapGlobalBcVtxZ;
+    namespace bctl = o2::common::core;
+    bcTimeline.clear();
     for (const auto& bc : bcs) {
       int64_t globalBC = bc.globalBC();
       // skip non-colliding bcs for data and anchored runs
@@ -903,18 +940,24 @@ class EventSelectionModule
       }
 
       if (bc.has_ft0()) {
-        mapGlobalBcWithOrInFT0[globalBC] = bc.globalIndex();
+        bcTimeline.add(bctl::kBcChannelFT0, globalBC, bc.globalIndex());
       }
 
       auto selection = bcselbuffer[bc.globalIndex()].selection;
       if (bitcheck64(selection, aod::evsel::kIsTriggerTVX)) {
-        mapGlobalBcWithTVX[globalBC] = bc.globalIndex();
-        mapGlobalBcVtxZ[globalBC] = bc.has_ft0() ? bc.ft0().posZ() : 0;
+        bcTimeline.add(bctl::kBcChannelTVX, globalBC, bc.globalIndex());
       }
     }
+    bcTimeline.build();
+    vTvxVtxZ.resize(bcTimeline.size(bctl::kBcChannelTVX));
+    vIsTvxMatched.assign(bcTimeline.size(bctl::kBcChannelTVX), false);
+    for (std::size_t i = 0; i < vTvxVtxZ.size(); i++) {
+      auto bc = bcs.iteratorAt(bcTimeline.row(bctl::kBcChannelTVX, i));
+      vTvxVtxZ[i] = bc.has_ft0() ? bc.ft0().posZ() : 0;
+    }
 
     // protection against empty FT0 maps
-    if (mapGlobalBcWithTVX.size() == 0) {
+    if (bcTimeline.empty(bctl::kBcChannelTVX)) {
       LOGP(error, "FT0 table is empty or corrupted. Filling evsel table with dummy values");
       for (const auto& col : cols) {
         auto bc = col.template bc_as<soa::Join<aod::BCs, aod::Run3MatchedToBCSparse>>();
@@ -1024,19 +1067,19 @@ class EventSelectionModule
 
         // matched with TOF --> precise time, match to TVX, but keep the nominal foundGlobalBC from pattern
         if (vIsVertexTOFmatched[colIndex]) {
-          std::map<int64_t, int32_t>::iterator it = mapGlobalBcWithTVX.find(foundGlobalBC);
-          if (it != mapGlobalBcWithTVX.end()) {
-            foundBCindex = it->second;                       // TVX at foundGlobalBC is found
-          } else {                                           // check if TVX is in nearby bcs
-            it = mapGlobalBcWithTVX.find(foundGlobalBC + 1); // next bc
-            if (it != mapGlobalBcWithTVX.end()) {
+          int32_t tvxIndex = bcTimeline.findRow(bctl::kBcChannelTVX, foundGlobalBC);
+          if (tvxIndex >= 0) {
+            foundBCindex = tvxIndex;                                               // TVX at foundGlobalBC is found
+          } else {                                                                 // check if TVX is in nearby bcs
+            tvxIndex = bcTimeline.findRow(bctl::kBcChannelTVX, foundGlobalBC + 1); // next bc
+            if (tvxIndex >= 0) {
               // foundGlobalBC += 1;
-              foundBCindex = it->second;
+              foundBCindex = tvxIndex;
             } else {
-              it = mapGlobalBcWithTVX.find(foundGlobalBC - 1); // previous bc
-              if (it != mapGlobalBcWithTVX.end()) {
+              tvxIndex = bcTimeline.findRow(bctl::kBcChannelTVX, foundGlobalBC - 1); // previous bc
+              if (tvxIndex >= 0) {
                 // foundGlobalBC -= 1;
-                foundBCindex = it->second;
+                foundBCindex = tvxIndex;
               } else {
                 foundBCindex = bc.globalIndex(); // keep original BC index
               }
@@ -1045,7 +1088,7 @@ class EventSelectionModule
         } // end of if TOF-matched vertex
         else { // for non-TOF and low-mult vertices, consider nearby nominal bcs
           int64_t meanBC = globalBC + TMath::Nint(sumHighPtTime / sumHighPtW / bcNS);
-          int64_t bestGlobalBC = findBestGlobalBC(meanBC, evselOpts.confSigmaBCforHighPtTracks, vNcontributors[colIndex], col.posZ(), mapGlobalBcVtxZ);
+          int64_t bestGlobalBC = findBestGlobalBC(meanBC, evselOpts.confSigmaBCforHighPtTracks, vNcontributors[colIndex], col.posZ());
           if (bestGlobalBC > 0) {
             foundGlobalBC = bestGlobalBC;
             // find closest nominal bc in pattern
@@ -1057,7 +1100,7 @@ class EventSelectionModule
                 break; // the bc in pattern is found
               }
             }
-            foundBCindex = mapGlobalBcWithTVX[bestGlobalBC];
+            foundBCindex = bcTimeline.findRow(bctl::kBcChannelTVX, bestGlobalBC);
           } else {                           // failed to find a proper TVX with small vZ difference
             foundBCindex = bc.globalIndex(); // keep original BC index
           }
@@ -1072,28 +1115,28 @@ class EventSelectionModule
         // for collisions with TOF tracks:
         // take bc corresponding to TOF track with median time
         int64_t tofGlobalBC = globalBC + TMath::Nint(getMedian(vTrackTimesTOF) / bcNS);
-        std::map<int64_t, int32_t>::iterator it = mapGlobalBcWithTVX.find(tofGlobalBC);
-        if (it != mapGlobalBcWithTVX.end()) {
-          foundGlobalBC = it->first;
-          foundBCindex = it->second;
+        int32_t tvxIndex = bcTimeline.findRow(bctl::kBcChannelTVX, tofGlobalBC);
+        if (tvxIndex >= 0) {
+          foundGlobalBC = tofGlobalBC;
+          foundBCindex = tvxIndex;
         }
       } else if (nPvTracksTPCnoTOFnoTRD == 0 && nPvTracksTRDnoTOF > 0) {
         // for collisions with TRD tracks but without TOF or ITSTPC-only tracks:
         // take bc corresponding to TRD track with median time
         int64_t trdGlobalBC = globalBC + TMath::Nint(getMedian(vTrackTimesTRDnoTOF) / bcNS);
-        std::map<int64_t, int32_t>::iterator it = mapGlobalBcWithTVX.find(trdGlobalBC);
-        if (it != mapGlobalBcWithTVX.end()) {
-          foundGlobalBC = it->first;
-          foundBCindex = it->second;
+        int32_t tvxIndex = bcTimeline.findRow(bctl::kBcChannelTVX, trdGlobalBC);
+        if (tvxIndex >= 0) {
+          foundGlobalBC = trdGlobalBC;
+          foundBCindex = tvxIndex;
         }
       } else if (nPvTracksHighPtTPCnoTOFnoTRD > 0) {
         // for collisions with high-pt ITSTPC-nonTOF-nonTRD tracks
         // search in 3*confSigmaBCforHighPtTracks range (3*4 bcs by default)
         int64_t meanBC = globalBC + TMath::Nint(sumHighPtTime / sumHighPtW / bcNS);
-        int64_t bestGlobalBC = findBestGlobalBC(meanBC, evselOpts.confSigmaBCforHighPtTracks, vNcontributors[colIndex], col.posZ(), mapGlobalBcVtxZ);
+        int64_t bestGlobalBC = findBestGlobalBC(meanBC, evselOpts.confSigmaBCforHighPtTracks, vNcontributors[colIndex], col.posZ());
         if (bestGlobalBC > 0) {
           foundGlobalBC = bestGlobalBC;
-          foundBCindex = mapGlobalBcWithTVX[bestGlobalBC];
+          foundBCindex = bcTimeline.findRow(bctl::kBcChannelTVX, bestGlobalBC);
         }
       }
 
@@ -1103,8 +1146,11 @@ class EventSelectionModule
       vFoundGlobalBC[colIndex] = foundGlobalBC > 0 ? foundGlobalBC : globalBC;
 
       // erase found global BC with TVX from the pool of bcs for the next loop over low-pt TPCnoTOFnoTRD collisions
-      if (foundBCindex >= 0)
-        mapGlobalBcVtxZ.erase(foundGlobalBC);
+      if (foundBCindex >= 0) {
+        int64_t tvxPos = bcTimeline.find(bctl::kBcChannelTVX, foundGlobalBC);
+        if (tvxPos >= 0)
+          vIsTvxMatched[tvxPos] = true;
+      }
     }
     // alternative matching: looking for collisions with the same nominal BC
     if (runLightIons >= 0) {
@@ -1127,9 +1173,9 @@ class EventSelectionModule
           int64_t globalBC = bc.globalBC();
           int64_t meanBC = globalBC + TMath::Nint(weightedTime / bcNS);
           int64_t sigmaBC = TMath::CeilNint(weightedSigma / bcNS);
-          int64_t bestGlobalBC = findBestGlobalBC(meanBC, sigmaBC, vNcontributors[colIndex], col.posZ(), mapGlobalBcVtxZ);
+          int64_t bestGlobalBC = findBestGlobalBC(meanBC, sigmaBC, vNcontributors[colIndex], col.posZ());
           vFoundGlobalBC[colIndex] = bestGlobalBC > 0 ? bestGlobalBC : globalBC;
-          vFoundBCindex[colIndex] = bestGlobalBC > 0 ? mapGlobalBcWithTVX[bestGlobalBC] : bc.globalIndex();
+          vFoundBCindex[colIndex] = bestGlobalBC > 0 ? bcTimeline.findRow(bctl::kBcChannelTVX, bestGlobalBC) : bc.globalIndex();
         }
         // fill pileup counter
         vCollisionsPerBc[vFoundBCindex[colIndex]]++;
@@ -1166,113 +1212,20 @@ class EventSelectionModule
       }
     }
 
-    // save indices of collisions for occupancy calculation (both in ROF and in time range)
-    std::vector<std::vector<int>> vCollsInSameITSROF;
-    std::vector<std::vector<int>> vCollsInPrevITSROF;
-    std::vector<std::vector<int>> vCollsInTimeWin;
-    std::vector<std::vector<float>> vTimeDeltaForColls; // delta time wrt a given collision
     for (const auto& col : cols) {
       int32_t colIndex = col.globalIndex();
-      int64_t foundGlobalBC = vFoundGlobalBC[colIndex];
       auto bcselEntr = bcselbuffer[vFoundBCindex[colIndex]];
       if (bcselEntr.foundFT0Id > -1) {
         // required: explicit ft0s table
         auto foundFT0 = ft0s.rawIteratorAt(bcselEntr.foundFT0Id);
         vAmpFT0CperColl[colIndex] = foundFT0.sumAmpC();
       }
-
-      int64_t tfId = (foundGlobalBC - bcSOR) / nBCsPerTF;
-      int64_t rofId = (foundGlobalBC + nBCsPerOrbit - rofOffset) / rofLength;
-
-      // ### for in-ROF occupancy
-      std::vector<int> vAssocCollInSameROF;
-      // find all collisions in the same ROF before a given collision
-      int32_t minColIndex = colIndex - 1;
-      while (minColIndex >= 0) {
-        int64_t thisBC = vFoundGlobalBC[minColIndex];
-        // check if this is still the same TF
-        int64_t thisTFid = (thisBC - bcSOR) / nBCsPerTF;
-        if (thisTFid != tfId)
-          break;
-        // int thisRofIdInTF = (thisBC - rofOffset) / rofLength;
-        int64_t thisRofId = (thisBC + nBCsPerOrbit - rofOffset) / rofLength;
-
-        // check if we are within the same ROF
-        if (thisRofId != rofId)
-          break;
-        vAssocCollInSameROF.push_back(minColIndex);
-        minColIndex--;
-      }
-      // find all collisions in the same ROF after the current one
-      int32_t maxColIndex = colIndex + 1;
-      while (maxColIndex < cols.size()) {
-        int64_t thisBC = vFoundGlobalBC[maxColIndex];
-        int64_t thisTFid = (thisBC - bcSOR) / nBCsPerTF;
-        if (thisTFid != tfId)
-          break;
-        int64_t thisRofId = (thisBC + nBCsPerOrbit - rofOffset) / rofLength;
-        if (thisRofId != rofId)
-          break;
-        vAssocCollInSameROF.push_back(maxColIndex);
-        maxColIndex++;
-      }
-      vCollsInSameITSROF.push_back(vAssocCollInSameROF);
-
-      // ### bookkeep collisions in previous ROF
-      std::vector<int> vAssocCollInPrevROF;
-      minColIndex = colIndex - 1;
-      while (minColIndex >= 0) {
-        int64_t thisBC = vFoundGlobalBC[minColIndex];
-        // check if this is still the same TF
-        int64_t thisTFid = (thisBC - bcSOR) / nBCsPerTF;
-        if (thisTFid != tfId)
-          break;
-        int64_t thisRofId = (thisBC + nBCsPerOrbit - rofOffset) / rofLength;
-        if (thisRofId == rofId - 1)
-          vAssocCollInPrevROF.push_back(minColIndex);
-        else if (thisRofId < rofId - 1)
-          break;
-        minColIndex--;
-      }
-      vCollsInPrevITSROF.push_back(vAssocCollInPrevROF);
-
-      // ### for occupancy in time windows
-      std::vector<int> vAssocToThisCol;
-      std::vector<float> vCollsTimeDeltaWrtGivenColl;
-      // find all collisions in time window before the current one
-      minColIndex = colIndex - 1;
-      while (minColIndex >= 0) {
-        int64_t thisBC = vFoundGlobalBC[minColIndex];
-        // check if this is still the same TF
-        int64_t thisTFid = (thisBC - bcSOR) / nBCsPerTF;
-        if (thisTFid != tfId)
-          break;
-        float dt = (thisBC - foundGlobalBC) * bcNS; // ns
-        // check if we are within the chosen time range
-        if (dt < timeWinOccupancyCalcMinNS)
-          break;
-        vAssocToThisCol.push_back(minColIndex);
-        vCollsTimeDeltaWrtGivenColl.push_back(dt);
-        minColIndex--;
-      }
-      // find all collisions in time window after the current one
-      maxColIndex = colIndex + 1;
-      while (maxColIndex < cols.size()) {
-        int64_t thisBC = vFoundGlobalBC[maxColIndex];
-        int64_t thisTFid = (thisBC - bcSOR) / nBCsPerTF;
-        if (thisTFid != tfId)
-          break;
-        float dt = (thisBC - foundGlobalBC) * bcNS; // ns
-        if (dt > timeWinOccupancyCalcMaxNS)
-          break;
-        vAssocToThisCol.push_back(maxColIndex);
-        vCollsTimeDeltaWrtGivenColl.push_back(dt);
-        maxColIndex++;
-      }
-      vCollsInTimeWin.push_back(vAssocToThisCol);
-      vTimeDeltaForColls.push_back(vCollsTimeDeltaWrtGivenColl);
     }
 
+    // find collisions in the same ROF, in the previous ROF and in the time window for occupancy calculation
+    collNeighbours.build(vFoundGlobalBC, bcSOR, nBCsPerTF, rofOffset, rofLength, timeWinOccupancyCalcMinNS, timeWinOccupancyCalcMaxNS);
+    CollisionNeighbourIndex::fillRunningSum(vTracksITS567perColl, vTracksITS567RunningSum);
+
     // perform the occupancy calculation per ITS ROF and also in the pre-defined time window
     std::vector<int> vNumTracksITS567inFullTimeWin(cols.size(), 0); // counter of tracks in full time window for occupancy studies (excluding given event)
     std::vector<float> vSumAmpFT0CinFullTimeWin(cols.size(), 0);    // sum of FT0C of tracks in full time window for occupancy studies (excluding given event)
@@ -1291,13 +1244,10 @@ class EventSelectionModule
       float vZ = col.posZ();
 
       // ### in-ROF occupancy
-      std::vector<int> vAssocCollInSameROF = vCollsInSameITSROF[colIndex];
-      int nITS567tracksForSameRofVetoStrict = 0;    // to veto events with other collisions in the same ITS ROF
-      int nCollsInRofWithFT0CAboveVetoStandard = 0; // to veto events with other collisions in the same ITS ROF, with per-collision multiplicity above threshold
-      int nITS567tracksForRofVetoOnCloseVz = 0;     // to veto events with nearby collisions with close vZ
-      for (uint32_t iCol = 0; iCol < vAssocCollInSameROF.size(); iCol++) {
-        int thisColIndex = vAssocCollInSameROF[iCol];
-        nITS567tracksForSameRofVetoStrict += vTracksITS567perColl[thisColIndex];
+      int nITS567tracksForSameRofVetoStrict = collNeighbours.sumInSameRof(colIndex, vTracksITS567RunningSum); // to veto events with other collisions in the same ITS ROF
+      int nCollsInRofWithFT0CAboveVetoStandard = 0;                                                           // to veto events with other collisions in the same ITS ROF, with per-collision multiplicity above threshold
+      int nITS567tracksForRofVetoOnCloseVz = 0;                                                               // to veto events with nearby collisions with close vZ
+      for (const int thisColIndex : collNeighbours.sameRof(colIndex)) {
         if (vAmpFT0CperColl[thisColIndex] > evselOpts.confFT0CamplCutVetoOnCollInROF)
           nCollsInRofWithFT0CAboveVetoStandard++;
         if (std::fabs(vCollVz[thisColIndex] - vZ) < evselOpts.confEpsilonVzDiffVetoInROF)
@@ -1309,18 +1259,16 @@ class EventSelectionModule
       vNoCollInSameRofWithCloseVz[colIndex] = (nITS567tracksForRofVetoOnCloseVz == 0);
 
       // ### occupancy in previous ROF
-      std::vector<int> vAssocCollInPrevROF = vCollsInPrevITSROF[colIndex];
       float totalFT0amplInPrevROF = 0;
-      for (uint32_t iCol = 0; iCol < vAssocCollInPrevROF.size(); iCol++) {
-        int thisColIndex = vAssocCollInPrevROF[iCol];
+      for (const int thisColIndex : collNeighbours.prevRof(colIndex)) {
         totalFT0amplInPrevROF += vAmpFT0CperColl[thisColIndex];
       }
       // veto events if FT0C amplitude in previous ITS ROF is above threshold
       vNoHighMultCollInPrevRof[colIndex] = (totalFT0amplInPrevROF < evselOpts.confFT0CamplCutVetoOnCollInROF);
 
       // ### occupancy in time windows
-      std::vector<int> vAssocToThisCol = vCollsInTimeWin[colIndex];
-      std::vector<float> vCollsTimeDeltaWrtGivenColl = vTimeDeltaForColls[colIndex];
+      auto vAssocToThisCol = collNeighbours.timeWindow(colIndex);
+      auto vCollsTimeDeltaWrtGivenColl = collNeighbours.timeWindowDeltaNS(colIndex);
       int nITS567tracksInFullTimeWindow = 0;
       float sumAmpFT0CInFullTimeWindow = 0;
       int nITS567tracksForVetoNarrow = 0;      // to veto events with nearby collisions (narrow range) with per-collision multiplicity above threshold
@@ -1368,10 +1316,10 @@ class EventSelectionModule
       if (vIsFullInfoForOccupancy[colIndex] && vCanHaveAssocCollsWithinLastDriftTime[colIndex] && colIndexFirstRejectedByTFborderCut >= 0) {
         int64_t foundGlobalBC = vFoundGlobalBC[colIndex];
         int64_t tfId = (foundGlobalBC - bcSOR) / nBCsPerTF;
-        std::map<int64_t, int32_t>::iterator it = mapGlobalBcWithTVX.find(vFoundGlobalBC[colIndexFirstRejectedByTFborderCut]);
-        while (it != mapGlobalBcWithTVX.end()) {
-          int64_t thisFoundGlobalBC = it->first;
-          int32_t thisFoundBCindex = it->second;
+        int64_t tvxPos = bcTimeline.find(bctl::kBcChannelTVX, vFoundGlobalBC[colIndexFirstRejectedByTFborderCut]);
+        for (int64_t iTvx = tvxPos; iTvx >= 0 && iTvx < static_cast<int64_t>(bcTimeline.size(bctl::kBcChannelTVX)); iTvx++) {
+          int64_t thisFoundGlobalBC = bcTimeline.globalBC(bctl::kBcChannelTVX, iTvx);
+          int32_t thisFoundBCindex = bcTimeline.row(bctl::kBcChannelTVX, iTvx);
           auto bc = bcs.iteratorAt(thisFoundBCindex);
           int64_t thisTFid = (bc.globalBC() - bcSOR) / nBCsPerTF;
           if (thisTFid != tfId)
@@ -1394,7 +1342,6 @@ class EventSelectionModule
               sumAmpFT0CInFullTimeWindow += wOccup * multT0C;
             }
           }
-          it++;
         }
       }
 
@@ -1615,7 +1562,11 @@ class LumiModule
       int64_t ts = timestamps[0];
 
       // getting GRP LHCIF object to extract colliding system, energy and colliding bc pattern
-      auto grplhcif = ccdb->template getForTimeStamp<parameters::GRPLHCIFData>("GLO/Config/GRPLHCIF", ts);
+      const auto ccdbSource = o2::common::CcdbObjectCache::sourceOf(ccdb);
+      auto grplhcif = o2::common::CcdbObjectCache::instance().get<parameters::GRPLHCIFData>(ccdbSource, "GLO/Config/GRPLHCIF", ts);
+      if (!grplhcif) {
+        LOGP(fatal, "GRPLHCIFData not in database, timestamp: {}", ts);
+      }
       int beamZ1 = grplhcif->getBeamZ(constants::lhc::BeamA);
       int beamZ2 = grplhcif->getBeamZ(constants::lhc::BeamC);
       float sqrts = grplhcif->getSqrtS();
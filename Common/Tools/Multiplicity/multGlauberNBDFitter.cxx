@@ -40,10 +40,21 @@
 #include <TStopwatch.h>
 #include <TVirtualFitter.h>
 
+#include <Math/Factory.h>
+#include <Math/Functor.h>
+#include <Math/Minimizer.h>
+#include <Math/MinimizerOptions.h>
+
 #include <Rtypes.h>
 #include <RtypesCore.h>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <iostream> // FIXME
+#include <memory>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -68,7 +79,16 @@ multGlauberNBDFitter::multGlauberNBDFitter() : TNamed(),
                                                ff(0.8),
                                                fnorm(100),
                                                fFitOptions("R0"),
-                                               fFitNpx(5000)
+                                               fFitNpx(5000),
+                                               fNThreads(1),
+                                               fUseAnalyticGradient(kFALSE),
+                                               fMaxTableSize(20000000),
+                                               fFastFitChi2(-1),
+                                               fFastNCalls(0),
+                                               fFastAncf(-1),
+                                               fFastTablek(-1),
+                                               fFastShapeValid(kFALSE),
+                                               fFastShapeHasGrad(kFALSE)
 {
   // Constructor
   fNpart = new Double_t[fMaxNpNcPairs];
@@ -95,6 +115,9 @@ multGlauberNBDFitter::multGlauberNBDFitter() : TNamed(),
   fGlauberNBD->SetParName(2, "f");
   fGlauberNBD->SetParName(3, "norm");
   fGlauberNBD->SetParName(4, "dMu/dNanc");
+
+  fFastShapePar.fill(0.0);
+  fFastFixed.fill(kFALSE);
 }
 
 multGlauberNBDFitter::multGlauberNBDFitter(const char* name, const char* title) : TNamed(name, title),
@@ -116,7 +139,16 @@ multGlauberNBDFitter::multGlauberNBDFitter(const char* name, const char* title)
                                                                                   ff(0.8),
                                                                                   fnorm(100),
                                                                                   fFitOptions("R0"),
-                                                                                  fFitNpx(5000)
+                                                                                  fFitNpx(5000),
+                                                                                  fNThreads(1),
+                                                                                  fUseAnalyticGradient(kFALSE),
+                                                                                  fMaxTableSize(20000000),
+                                                                                  fFastFitChi2(-1),
+                                                                                  fFastNCalls(0),
+                                                                                  fFastAncf(-1),
+                                                                                  fFastTablek(-1),
+                                                                                  fFastShapeValid(kFALSE),
+                                                                                  fFastShapeHasGrad(kFALSE)
 {
   // Named constructor
   fNpart = new Double_t[fMaxNpNcPairs];
@@ -143,6 +175,9 @@ multGlauberNBDFitter::multGlauberNBDFitter(const char* name, const char* title)
   fGlauberNBD->SetParName(2, "f");
   fGlauberNBD->SetParName(3, "norm");
   fGlauberNBD->SetParName(4, "dMu/dNanc");
+
+  fFastShapePar.fill(0.0);
+  fFastFixed.fill(kFALSE);
 }
 //________________________________________________________________
 multGlauberNBDFitter::~multGlauberNBDFitter()
@@ -184,25 +219,8 @@ Double_t multGlauberNBDFitter::ProbDistrib(Double_t* x, Double_t* par)
   // Recalculate the ancestor distribution in case f changed
   if (ffChanged) {
     fCurrentf = par[2];
-    fhNanc->Reset();
-
-    for (int ibin = 0; ibin < fNNpNcPairs; ibin++) {
-      Double_t lOption0 = (Int_t)(fNpart[ibin] * par[2] + fNcoll[ibin] * (1.0 - par[2]));
-      Double_t lOption1 = TMath::Floor(fNpart[ibin] * par[2] + fNcoll[ibin] * (1.0 - par[2]) + 0.5);
-      Double_t lOption2 = (fNpart[ibin] * par[2] + fNcoll[ibin] * (1.0 - par[2]));
-      if (fAncestorMode == 0)
-        fhNanc->Fill(lOption0, fContent[ibin]);
-      if (fAncestorMode == 1)
-        fhNanc->Fill(lOption1, fContent[ibin]);
-      if (fAncestorMode == 2)
-        fhNanc->Fill(lOption2, fContent[ibin]);
-    }
-    if (fhNanc->Integral() < 1) {
-      cout << "ERROR: ANCESTOR HISTOGRAM EMPTY" << endl;
-      cout << "Will not do anything. Call InitializeNpNc if you want to plot without fitting" << endl;
+    if (!FillAncestorHistogram(par[2]))
       return 0;
-    }
-    fhNanc->Scale(1. / fhNanc->Integral());
   }
   //______________________________________________________
   // Actually evaluate function
@@ -227,6 +245,32 @@ Double_t multGlauberNBDFitter::ProbDistrib(Double_t* x, Double_t* par)
   return par[3] * lProbability;
 }
 
+//______________________________________________________
+Bool_t multGlauberNBDFitter::FillAncestorHistogram(Double_t lf)
+// Ancestor distribution for a given f, normalized to unity
+{
+  fhNanc->Reset();
+
+  for (int ibin = 0; ibin < fNNpNcPairs; ibin++) {
+    Double_t lOption0 = (Int_t)(fNpart[ibin] * lf + fNcoll[ibin] * (1.0 - lf));
+    Double_t lOption1 = TMath::Floor(fNpart[ibin] * lf + fNcoll[ibin] * (1.0 - lf) + 0.5);
+    Double_t lOption2 = (fNpart[ibin] * lf + fNcoll[ibin] * (1.0 - lf));
+    if (fAncestorMode == 0)
+      fhNanc->Fill(lOption0, fContent[ibin]);
+    if (fAncestorMode == 1)
+      fhNanc->Fill(lOption1, fContent[ibin]);
+    if (fAncestorMode == 2)
+      fhNanc->Fill(lOption2, fContent[ibin]);
+  }
+  if (fhNanc->Integral() < 1) {
+    cout << "ERROR: ANCESTOR HISTOGRAM EMPTY" << endl;
+    cout << "Will not do anything. Call InitializeNpNc if you want to plot without fitting" << endl;
+    return kFALSE;
+  }
+  fhNanc->Scale(1. / fhNanc->Integral());
+  return kTRUE;
+}
+
 //________________________________________________________________
 Bool_t multGlauberNBDFitter::SetNpartNcollCorrelation(TH2* hNpNc)
 {
@@ -447,3 +491,407 @@ void multGlauberNBDFitter::CalculateAvNpNc(TProfile* lNPartProf, TProfile* lNCol
     }
   }
 }
+
+//________________________________________________________________
+// Fast fit engine
+//
+// The fit function is the same as ProbDistrib, evaluated at the centres of the
+// fit bins, but with the ancestor distribution stored as plain arrays and the
+// NBD written in log form:
+//   log NBD(n; mu_a, k_a) = C(n, k_a) + n log(mu_a/k_a) - (n+k_a) log(1+mu_a/k_a)
+//   C(n, k_a) = lgamma(n+k_a) - lgamma(n+1) - lgamma(k_a)
+// with mu_a = Nanc (mu + dMu/dNanc Nanc) and k_a = Nanc k. C depends on k only
+// and is cached as a (fit bin x ancestor) table, so that steps in mu and
+// dMu/dNanc only need exponentials. The sum over ancestors does not depend on
+// norm, which is applied to the cached sum. The fit bins are split among
+// up to fNThreads threads when there is enough work per thread.
+//________________________________________________________________
+Bool_t multGlauberNBDFitter::InitializeFastFit()
+{
+  if (!fhV0M) {
+    cout << "Failed to initialize! Please provide the input histogram with SetInputV0M!" << endl;
+    return kFALSE;
+  }
+  InitAncestor();
+  if (!InitializeNpNc())
+    return kFALSE;
+
+  Double_t lMin, lMax;
+  fGlauberNBD->GetRange(lMin, lMax);
+  fFastN.clear();
+  fFastY.clear();
+  fFastInvErr2.clear();
+  fFastLgN1.clear();
+  for (Int_t ibin = 1; ibin < fhV0M->GetNbinsX() + 1; ibin++) {
+    Double_t lMultValue = fhV0M->GetBinCenter(ibin);
+    Double_t lError = fhV0M->GetBinError(ibin);
+    // same bins as the chi2 fit of DoFit: in range, empty bins skipped
+    if (lMultValue < lMin || lMultValue > lMax || lError <= 0)
+      continue;
+    // negative_binomial_pdf takes an unsigned int: truncated for ancestor modes 0 and 1
+    Double_t lN = fAncestorMode != 2 ? TMath::Floor(lMultValue) : lMultValue;
+    if (lMultValue <= 1e-6)
+      lN = -1; // ProbDistrib is zero here
+    fFastN.push_back(lN);
+    fFastY.push_back(fhV0M->GetBinContent(ibin));
+    fFastInvErr2.push_back(1.0 / (lError * lError));
+    fFastLgN1.push_back(lN >= 0 ? LogGamma(lN + 1.0) : 0.0);
+  }
+  fFastAncN.clear();
+  fFastAncW.clear();
+  fFastAncf = -1;
+  fFastTable.clear();
+  fFastTablek = -1;
+  fFastShapeValid = kFALSE;
+  fFastShapeHasGrad = kFALSE;
+  if (fFastN.empty()) {
+    cout << "Failed to initialize! No bin of the input histogram with entries in the fit range!" << endl;
+    return kFALSE;
+  }
+  return kTRUE;
+}
+
+//________________________________________________________________
+Bool_t multGlauberNBDFitter::UpdateFastAncestors(Double_t lf)
+{
+  if (!fFastAncN.empty() && fFastAncf == lf)
+    return kTRUE;
+  fFastAncN.clear();
+  fFastAncW.clear();
+  fFastAncf = -1;
+  fFastTablek = -1;
+  fFastShapeValid = kFALSE;
+  if (!FillAncestorHistogram(lf))
+    return kFALSE;
+  // fhNanc now holds the distribution for lf, also for ProbDistrib
+  fCurrentf = lf;
+
+  Int_t lStartBin = fhNanc->FindBin(0.0) + 1;
+  for (Long_t iNanc = lStartBin; iNanc < fhNanc->GetNbinsX() + 1; iNanc++) {
+    Double_t lNancestorCount = fhNanc->GetBinContent(iNanc);
+    if (lNancestorCount <= 0)
+      continue;
+    fFastAncN.push_back(fhNanc->GetBinCenter(iNanc));
+    fFastAncW.push_back(lNancestorCount);
+  }
+  fFastAncf = lf;
+  return kTRUE;
+}
+
+//________________________________________________________________
+void multGlauberNBDFitter::UpdateFastTable(Double_t lk)
+{
+  const Long_t lNBins = fFastN.size();
+  const Long_t lNAnc = fFastAncN.size();
+  if (lNBins * lNAnc > fMaxTableSize) {
+    // too large: lgamma terms are evaluated on the fly
+    fFastTable.clear();
+    fFastTablek = -1;
+    return;
+  }
+  if (fFastTablek == lk && static_cast<Long_t>(fFastTable.size()) == lNBins * lNAnc)
+    return;
+  fFastTable.resize(lNBins * lNAnc);
+  std::vector<Double_t> lLgk(lNAnc);
+  for (Long_t ia = 0; ia < lNAnc; ia++)
+    lLgk[ia] = LogGamma(fFastAncN[ia] * lk);
+  ForEachBinChunk([&](Long_t lFirstBin, Long_t lLastBin) {
+    for (Long_t ibin = lFirstBin; ibin < lLastBin; ibin++) {
+      Double_t* lRow = &fFastTable[ibin * lNAnc];
+      const Double_t lN = fFastN[ibin];
+      if (lN < 0) {
+        std::fill(lRow, lRow + lNAnc, 0.0);
+        continue;
+      }
+      for (Long_t ia = 0; ia < lNAnc; ia++)
+        lRow[ia] = LogGamma(lN + fFastAncN[ia] * lk) - fFastLgN1[ibin] - lLgk[ia];
+    }
+  });
+  fFastTablek = lk;
+}
+
+//________________________________________________________________
+void multGlauberNBDFitter::UpdateFastShape(const Double_t* par, Bool_t lWithGradient)
+{
+  if (fFastShapeValid && (!lWithGradient || fFastShapeHasGrad) &&
+      fFastShapePar[0] == par[0] && fFastShapePar[1] == par[1] && fFastShapePar[2] == par[2] && fFastShapePar[4] == par[4])
+    return;
+
+  const Long_t lNBins = fFastN.size();
+  fFastShape.assign(lNBins, 0.0);
+  fFastShapeGrad.assign(lWithGradient ? 3 * lNBins : 0, 0.0);
+  if (UpdateFastAncestors(par[2])) {
+    UpdateFastTable(par[1]);
+    ForEachBinChunk([&](Long_t lFirstBin, Long_t lLastBin) { EvaluateFastShape(lFirstBin, lLastBin, par, lWithGradient); });
+  }
+  for (Int_t ipar = 0; ipar < 5; ipar++)
+    fFastShapePar[ipar] = par[ipar];
+  fFastShapeValid = kTRUE;
+  fFastShapeHasGrad = lWithGradient;
+}
+
+//________________________________________________________________
+void multGlauberNBDFitter::EvaluateFastShape(Long_t lFirstBin, Long_t lLastBin, const Double_t* par, Bool_t lWithGradient)
+{
+  const Long_t lNAnc = fFastAncN.size();
+  const Bool_t lHasTable = fFastTablek == par[1] && !fFastTable.empty();
+  const Bool_t lWithGradk = lWithGradient && !fFastFixed[1];
+
+  // per-ancestor terms
+  std::vector<Double_t> lW(lNAnc), lKa(lNAnc), lLogRatio(lNAnc), lLog1p(lNAnc), lLgKa(lNAnc);
+  std::vector<Double_t> lMua, lInvMu, lInvMuK, lDiGammaKa;
+  if (lWithGradient) {
+    lMua.resize(lNAnc);
+    lInvMu.resize(lNAnc);
+    lInvMuK.resize(lNAnc);
+    lDiGammaKa.resize(lNAnc);
+  }
+  for (Long_t ia = 0; ia < lNAnc; ia++) {
+    const Double_t lNancestors = fFastAncN[ia];
+    const Double_t lThisMu = lNancestors * (par[0] + par[4] * lNancestors);
+    const Double_t lThisk = lNancestors * par[1];
+    // no contribution for a non-positive mean, as negative_binomial_pdf for p > 1
+    lW[ia] = lThisMu > 0 ? fFastAncW[ia] : 0.0;
+    lKa[ia] = lThisk;
+    lLogRatio[ia] = lThisMu > 0 ? std::log(lThisMu / lThisk) : 0.0;
+    lLog1p[ia] = lThisMu > 0 ? std::log(1.0 + lThisMu / lThisk) : 0.0;
+    lLgKa[ia] = lHasTable ? 0.0 : LogGamma(lThisk);
+    if (lWithGradient) {
+      lMua[ia] = lThisMu;
+      lInvMu[ia] = lThisMu > 0 ? 1.0 / lThisMu : 0.0;
+      lInvMuK[ia] = 1.0 / (lThisMu + lThisk);
+      lDiGammaKa[ia] = lWithGradk ? DiGamma(lThisk) : 0.0;
+    }
+  }
+
+  for (Long_t ibin = lFirstBin; ibin < lLastBin; ibin++) {
+    const Double_t lN = fFastN[ibin];
+    if (lN < 0)
+      continue;
+    const Double_t* lRow = lHasTable ? &fFastTable[ibin * lNAnc] : nullptr;
+    Double_t lShape = 0.0;
+    if (!lWithGradient) {
+      if (lRow) {
+        for (Long_t ia = 0; ia < lNAnc; ia++)
+          lShape += lW[ia] > 0 ? lW[ia] * std::exp(lRow[ia] + lN * lLogRatio[ia] - (lN + lKa[ia]) * lLog1p[ia]) : 0.0;
+      } else {
+        for (Long_t ia = 0; ia < lNAnc; ia++)
+          lShape += lW[ia] > 0 ? lW[ia] * std::exp(LogGamma(lN + lKa[ia]) - fFastLgN1[ibin] - lLgKa[ia] + lN * lLogRatio[ia] - (lN + lKa[ia]) * lLog1p[ia]) : 0.0;
+      }
+      fFastShape[ibin] = lShape;
+      continue;
+    }
+    // derivatives of log NBD in mu_a and k_a, chain rule to mu, k and dMu/dNanc
+    Double_t lGradMu = 0.0, lGradk = 0.0, lGraddMu = 0.0;
+    for (Long_t ia = 0; ia < lNAnc; ia++) {
+      if (lW[ia] <= 0)
+        continue;
+      const Double_t lC = lRow ? lRow[ia] : LogGamma(lN + lKa[ia]) - fFastLgN1[ibin] - lLgKa[ia];
+      const Double_t lValue = lW[ia] * std::exp(lC + lN * lLogRatio[ia] - (lN + lKa[ia]) * lLog1p[ia]);
+      const Double_t lNancestors = fFastAncN[ia];
+      const Double_t lDLogDMua = lN * lInvMu[ia] - (lN + lKa[ia]) * lInvMuK[ia];
+      lShape += lValue;
+      lGradMu += lValue * lNancestors * lDLogDMua;
+      lGraddMu += lValue * lNancestors * lNancestors * lDLogDMua;
+      if (lWithGradk)
+        lGradk += lValue * lNancestors * (DiGamma(lN + lKa[ia]) - lDiGammaKa[ia] - lLog1p[ia] + (lMua[ia] - lN) * lInvMuK[ia]);
+    }
+    fFastShape[ibin] = lShape;
+    fFastShapeGrad[3 * ibin] = lGradMu;
+    fFastShapeGrad[3 * ibin + 1] = lGradk;
+    fFastShapeGrad[3 * ibin + 2] = lGraddMu;
+  }
+}
+
+//________________________________________________________________
+void multGlauberNBDFitter::ForEachBinChunk(const std::function<void(Long_t, Long_t)>& lFunction)
+{
+  // threads are started for each call: only worth it if each one has at least
+  // this number of (bin, ancestor) terms, otherwise the evaluation is serial
+  const Long_t lMinTermsPerThread = 1 << 16;
+  const Long_t lNBins = fFastN.size();
+  const Long_t lNTerms = lNBins * std::max<Long_t>(1, fFastAncN.size());
+  const Long_t lNThreads = std::max<Long_t>(1, std::min<Long_t>({static_cast<Long_t>(fNThreads), lNBins, lNTerms / lMinTermsPerThread}));
+  if (lNThreads == 1) {
+    lFunction(0, lNBins);
+    return;
+  }
+  std::vector<std::thread> lThreads;
+  lThreads.reserve(lNThreads);
+  for (Long_t iThread = 0; iThread < lNThreads; iThread++) {
+    Long_t lFirstBin = lNBins * iThread / lNThreads;
+    Long_t lLastBin = lNBins * (iThread + 1) / lNThreads;
+    lThreads.emplace_back(lFunction, lFirstBin, lLastBin);
+  }
+  for (auto& lThread : lThreads)
+    lThread.join();
+}
+
+//________________________________________________________________
+Double_t multGlauberNBDFitter::FastChi2(const Double_t* par, Double_t* grad)
+{
+  fFastNCalls++;
+  UpdateFastShape(par, grad != nullptr);
+  // sums in bin order, independent of the number of threads
+  Double_t lChi2 = 0.0;
+  Double_t lGrad[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+  for (size_t ibin = 0; ibin < fFastN.size(); ibin++) {
+    const Double_t lResidual = fFastY[ibin] - par[3] * fFastShape[ibin];
+    lChi2 += lResidual * lResidual * fFastInvErr2[ibin];
+    if (grad) {
+      const Double_t lFactor = -2.0 * lResidual * fFastInvErr2[ibin];
+      lGrad[0] += lFactor * par[3] * fFastShapeGrad[3 * ibin];
+      lGrad[1] += lFactor * par[3] * fFastShapeGrad[3 * ibin + 1];
+      lGrad[3] += lFactor * fFastShape[ibin];
+      lGrad[4] += lFactor * par[3] * fFastShapeGrad[3 * ibin + 2];
+    }
+  }
+  if (grad) {
+    // f only enters through the binned ancestor distribution: not differentiable, kept fixed
+    for (Int_t ipar = 0; ipar < 5; ipar++)
+      grad[ipar] = lGrad[ipar];
+  }
+  return lChi2;
+}
+
+//________________________________________________________________
+Double_t multGlauberNBDFitter::LogGamma(Double_t x)
+{
+  // reentrant version: std::lgamma sets the global signgam, called from several threads
+  int lSign;
+  return lgamma_r(x, &lSign);
+}
+
+//________________________________________________________________
+Double_t multGlauberNBDFitter::DiGamma(Double_t x)
+{
+  // recurrence to x >= 6, then asymptotic expansion
+  Double_t lResult = 0.0;
+  while (x < 6.0) {
+    lResult -= 1.0 / x;
+    x += 1.0;
+  }
+  const Double_t lInvX2 = 1.0 / (x * x);
+  lResult += std::log(x) - 0.5 / x - lInvX2 * (1.0 / 12 - lInvX2 * (1.0 / 120 - lInvX2 * (1.0 / 252 - lInvX2 * (1.0 / 240 - lInvX2 / 132))));
+  return lResult;
+}
+
+//________________________________________________________________
+Double_t multGlauberNBDFitter::EvaluateFast(Double_t lMultValue, const Double_t* par)
+{
+  if (fFastN.empty() && !InitializeFastFit())
+    return 0;
+  if (!UpdateFastAncestors(par[2]))
+    return 0;
+  if (lMultValue <= 1e-6)
+    return 0;
+  const Double_t lN = fAncestorMode != 2 ? TMath::Floor(lMultValue) : lMultValue;
+  const Double_t lLgN1 = LogGamma(lN + 1.0);
+  Double_t lProbability = 0.0;
+  for (size_t ia = 0; ia < fFastAncN.size(); ia++) {
+    const Double_t lNancestors = fFastAncN[ia];
+    const Double_t lThisMu = lNancestors * (par[0] + par[4] * lNancestors);
+    const Double_t lThisk = lNancestors * par[1];
+    if (lThisMu <= 0)
+      continue;
+    lProbability += fFastAncW[ia] * std::exp(LogGamma(lN + lThisk) - lLgN1 - LogGamma(lThisk) + lN * std::log(lThisMu / lThisk) - (lN + lThisk) * std::log(1.0 + lThisMu / lThisk));
+  }
+  return par[3] * lProbability;
+}
+
+//________________________________________________________________
+Double_t multGlauberNBDFitter::GetFastChi2(const Double_t* par)
+{
+  if (fFastN.empty() && !InitializeFastFit())
+    return -1;
+  return FastChi2(par, nullptr);
+}
+
+//________________________________________________________________
+Bool_t multGlauberNBDFitter::DoFastFit()
+{
+  if (!InitializeFastFit()) {
+    cout << "---> Initialization of the fast fit failed!" << endl;
+    return kFALSE;
+  }
+
+  TStopwatch* timer = new TStopwatch();
+  timer->Start(kTRUE);
+  if (fAncestorMode == 0)
+    cout << "---> Config: Nancestors will be truncated" << endl;
+  if (fAncestorMode == 1)
+    cout << "---> Config: Nancestors will be rounded" << endl;
+  if (fAncestorMode == 2)
+    cout << "---> Config: Nancestors will be taken as float" << endl;
+  cout << "---> Config: " << fFastN.size() << " fit bins, " << std::max(fNThreads, 1) << " thread(s)" << endl;
+
+  const Int_t lNPar = 5;
+  std::unique_ptr<ROOT::Math::Minimizer> lMinimizer(ROOT::Math::Factory::CreateMinimizer(ROOT::Math::MinimizerOptions::DefaultMinimizerType(),
+                                                                                         ROOT::Math::MinimizerOptions::DefaultMinimizerAlgo()));
+  if (!lMinimizer) {
+    cout << "---> Could not create the minimizer " << ROOT::Math::MinimizerOptions::DefaultMinimizerType() << endl;
+    delete timer;
+    return kFALSE;
+  }
+  // Try very hard, please
+  lMinimizer->SetMaxFunctionCalls(5000000);
+  lMinimizer->SetMaxIterations(5000000);
+  lMinimizer->SetErrorDef(1.0);
+  lMinimizer->SetPrintLevel(0);
+
+  // parameters as set in fGlauberNBD, with the same conventions as TF1::Fit
+  for (Int_t ipar = 0; ipar < lNPar; ipar++) {
+    Double_t lValue = fGlauberNBD->GetParameter(ipar);
+    Double_t lStep = fGlauberNBD->GetParError(ipar) > 0 ? fGlauberNBD->GetParError(ipar) : (lValue != 0 ? 0.3 * TMath::Abs(lValue) : 0.1);
+    Double_t lLow, lHigh;
+    fGlauberNBD->GetParLimits(ipar, lLow, lHigh);
+    const char* lName = fGlauberNBD->GetParName(ipar);
+    fFastFixed[ipar] = kFALSE;
+    if (lLow * lHigh != 0 && lLow >= lHigh) {
+      lMinimizer->SetFixedVariable(ipar, lName, lValue);
+      fFastFixed[ipar] = kTRUE;
+    } else if (lLow < lHigh) {
+      lMinimizer->SetLimitedVariable(ipar, lName, lValue, lStep, lLow, lHigh);
+    } else {
+      lMinimizer->SetVariable(ipar, lName, lValue, lStep);
+    }
+  }
+
+  Bool_t lUseGradient = fUseAnalyticGradient && fFastFixed[2];
+  if (fUseAnalyticGradient && !lUseGradient)
+    cout << "---> f is free: analytic gradient not available, Minuit will differentiate numerically" << endl;
+  ROOT::Math::Functor lChi2([this](const Double_t* par) { return FastChi2(par, nullptr); }, lNPar);
+  ROOT::Math::GradFunctor lChi2WithGradient([this](const Double_t* par) { return FastChi2(par, nullptr); },
+                                            [this](const Double_t* par, Double_t* grad) { FastChi2(par, grad); }, lNPar);
+  if (lUseGradient)
+    lMinimizer->SetFunction(lChi2WithGradient);
+  else
+    lMinimizer->SetFunction(lChi2);
+
+  cout << "---> Now fitting, please wait..." << endl;
+  fFastNCalls = 0;
+  Bool_t lValid = lMinimizer->Minimize();
+  lMinimizer->Hesse();
+
+  const Double_t* lValues = lMinimizer->X();
+  const Double_t* lErrors = lMinimizer->Errors();
+  for (Int_t ipar = 0; ipar < lNPar; ipar++) {
+    fGlauberNBD->SetParameter(ipar, lValues[ipar]);
+    fGlauberNBD->SetParError(ipar, lErrors ? lErrors[ipar] : 0.0);
+  }
+  fFastFitChi2 = lMinimizer->MinValue();
+
+  timer->Stop();
+  Double_t lTotalTime = timer->RealTime();
+  cout << "---> Fitting took " << lTotalTime << " seconds, " << fFastNCalls << " chi2 evaluations" << endl;
+  cout << "---> chi2/ndf = " << fFastFitChi2 << "/" << static_cast<Long_t>(fFastN.size()) - static_cast<Long_t>(lMinimizer->NFree()) << endl;
+  delete timer;
+
+  fMu = fGlauberNBD->GetParameter(0);
+  fk = fGlauberNBD->GetParameter(1);
+  ff = fGlauberNBD->GetParameter(2);
+  fnorm = fGlauberNBD->GetParameter(3);
+  fdMu = fGlauberNBD->GetParameter(4);
+
+  return lValid;
+}
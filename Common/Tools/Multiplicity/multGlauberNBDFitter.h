@@ -22,6 +22,10 @@
 #include <Rtypes.h>
 #include <RtypesCore.h>
 
+#include <array>
+#include <functional>
+#include <vector>
+
 class multGlauberNBDFitter : public TNamed
 {
 
@@ -39,6 +43,16 @@ class multGlauberNBDFitter : public TNamed
   // Do Fit: where everything happens
   Bool_t DoFit();
 
+  // Same chi2 fit as DoFit with a dedicated engine: cached NBD tables,
+  // threads over the fit bins and optionally analytic gradients
+  Bool_t DoFastFit();
+
+  // Glauber+NBD function of the fast engine, same value as ProbDistrib
+  Double_t EvaluateFast(Double_t lMultValue, const Double_t* par);
+
+  // chi2 of the fit bins of the input histogram with the fast engine
+  Double_t GetFastChi2(const Double_t* par);
+
   // Set input characteristics: the 2D plot with Npart, Nanc
   Bool_t SetNpartNcollCorrelation(TH2* hNpNc);
 
@@ -73,6 +87,13 @@ class multGlauberNBDFitter : public TNamed
   void SetFitOptions(TString lOpt);
   void SetFitNpx(Long_t lNpx);
 
+  // Fast fit engine settings
+  void SetNThreads(Int_t lNThreads) { fNThreads = lNThreads; }
+  void SetUseAnalyticGradient(Bool_t lUse = kTRUE) { fUseAnalyticGradient = lUse; }
+  void SetMaxTableSize(Long_t lSize) { fMaxTableSize = lSize; }
+  Double_t GetFastFitChi2() { return fFastFitChi2; }
+  Long_t GetFastNCalls() { return fFastNCalls; }
+
   // For ancestor mode 2
   Double_t ContinuousNBD(Double_t n, Double_t mu, Double_t k);
 
@@ -82,6 +103,20 @@ class multGlauberNBDFitter : public TNamed
   // void    Print(Option_t *option="") const;
 
  private:
+  // Ancestor distribution for a given f, in fhNanc
+  Bool_t FillAncestorHistogram(Double_t lf);
+
+  // Fast engine helpers
+  Bool_t InitializeFastFit();
+  Bool_t UpdateFastAncestors(Double_t lf);
+  void UpdateFastTable(Double_t lk);
+  void UpdateFastShape(const Double_t* par, Bool_t lWithGradient);
+  void EvaluateFastShape(Long_t lFirstBin, Long_t lLastBin, const Double_t* par, Bool_t lWithGradient);
+  Double_t FastChi2(const Double_t* par, Double_t* grad);
+  void ForEachBinChunk(const std::function<void(Long_t, Long_t)>& lFunction);
+  static Double_t LogGamma(Double_t x);
+  static Double_t DiGamma(Double_t x);
+
   // This function serves as the (analytical) NBD
   TF1* fNBD;
 
@@ -117,6 +152,29 @@ class multGlauberNBDFitter : public TNamed
   TString fFitOptions;
   Long_t fFitNpx;
 
-  ClassDef(multGlauberNBDFitter, 1);
+  // Fast fit engine
+  Int_t fNThreads;             // threads for the evaluation over the fit bins
+  Bool_t fUseAnalyticGradient; // analytic gradient in mu, k, norm and dMu/dNanc (f is not differentiable)
+  Long_t fMaxTableSize;        // maximum number of (bin, ancestor) entries of the cached lgamma table
+  Double_t fFastFitChi2;       // chi2 at the minimum of the last DoFastFit
+  Long_t fFastNCalls;          // chi2 evaluations in the last DoFastFit
+
+  std::vector<Double_t> fFastN;          //! multiplicity of each fit bin, truncated for ancestor modes 0 and 1
+  std::vector<Double_t> fFastY;          //! content of each fit bin
+  std::vector<Double_t> fFastInvErr2;    //! 1/error^2 of each fit bin
+  std::vector<Double_t> fFastLgN1;       //! lgamma(n+1) of each fit bin
+  std::vector<Double_t> fFastAncN;       //! ancestor values with non-zero probability
+  std::vector<Double_t> fFastAncW;       //! their probabilities
+  Double_t fFastAncf;                    //! f of the ancestor arrays
+  std::vector<Double_t> fFastTable;      //! lgamma(n+k*Nanc) - lgamma(n+1) - lgamma(k*Nanc), bins x ancestors
+  Double_t fFastTablek;                  //! k of the table, -1 if not filled
+  std::vector<Double_t> fFastShape;      //! sum over ancestors of P(Nanc) NBD(n; mu(Nanc), k(Nanc)) per fit bin
+  std::vector<Double_t> fFastShapeGrad;  //! its derivatives in mu, k and dMu/dNanc, 3 per fit bin
+  std::array<Double_t, 5> fFastShapePar; //! parameters of fFastShape
+  Bool_t fFastShapeValid;                //! fFastShape (and fFastShapeGrad if fFastShapeHasGrad) filled for fFastShapePar
+  Bool_t fFastShapeHasGrad;              //!
+  std::array<Bool_t, 5> fFastFixed;      //! fixed parameters of the fast fit, no derivative needed
+
+  ClassDef(multGlauberNBDFitter, 2);
 };
 #endif // COMMON_TOOLS_MULTIPLICITY_MULTGLAUBERNBDFITTER_H_
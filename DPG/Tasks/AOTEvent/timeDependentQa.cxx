@@ -17,6 +17,7 @@
 #include "Common/CCDB/EventSelectionParams.h"
 #include "Common/CCDB/RCTSelectionFlags.h"
 #include "Common/CCDB/ctpRateFetcher.h"
+#include "Common/Core/TimeSeriesAccumulator.h"
 #include "Common/DataModel/EventSelection.h"
 #include "Common/DataModel/Multiplicity.h"
 #include "Common/DataModel/TrackSelectionTables.h"
@@ -44,6 +45,7 @@
 
 #include <sys/types.h>
 
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <string>
@@ -144,6 +146,14 @@ struct TimeDependentQaTask {
 
   TAxis* axRctFlags;
 
+  // ITS cluster pattern vs phi vs time: accumulated in the track loop, flushed into the registry histograms once per DF
+  static constexpr int NLayersITS = 7;
+  std::array<o2::common::core::TimeSeriesAccumulator<>, NLayersITS> hSecondsITSlayerVsPhi;
+  o2::common::core::TimeSeriesAccumulator<> hSecondsITS7clsVsPhi;
+  o2::common::core::TimeSeriesAccumulator<> hSecondsITSglobalVsPhi;
+  o2::common::core::TimeSeriesAccumulator<> hSecondsITSTRDVsPhi;
+  o2::common::core::TimeSeriesAccumulator<> hSecondsITSTOFVsPhi;
+
   void init(InitContext&)
   {
     ccdb->setURL("http://alice-ccdb.cern.ch");
@@ -459,12 +469,23 @@ struct TimeDependentQaTask {
         histos.add("hSecondsITSlayer4vsPhi", "", kTH2F, {axisSeconds, axisPhi});
         histos.add("hSecondsITSlayer5vsPhi", "", kTH2F, {axisSeconds, axisPhi});
         histos.add("hSecondsITSlayer6vsPhi", "", kTH2F, {axisSeconds, axisPhi});
+        hSecondsITSlayerVsPhi[0].bind(histos.get<TH2>(HIST("hSecondsITSlayer0vsPhi")));
+        hSecondsITSlayerVsPhi[1].bind(histos.get<TH2>(HIST("hSecondsITSlayer1vsPhi")));
+        hSecondsITSlayerVsPhi[2].bind(histos.get<TH2>(HIST("hSecondsITSlayer2vsPhi")));
+        hSecondsITSlayerVsPhi[3].bind(histos.get<TH2>(HIST("hSecondsITSlayer3vsPhi")));
+        hSecondsITSlayerVsPhi[4].bind(histos.get<TH2>(HIST("hSecondsITSlayer4vsPhi")));
+        hSecondsITSlayerVsPhi[5].bind(histos.get<TH2>(HIST("hSecondsITSlayer5vsPhi")));
+        hSecondsITSlayerVsPhi[6].bind(histos.get<TH2>(HIST("hSecondsITSlayer6vsPhi")));
       }
       if (confFlagFillPhiVsTimeHist > 0) {
         histos.add("hSecondsITS7clsVsPhi", "", kTH2F, {axisSeconds, axisPhi});
         histos.add("hSecondsITSglobalVsPhi", "", kTH2F, {axisSeconds, axisPhi});
         histos.add("hSecondsITSTRDVsPhi", "", kTH2F, {axisSeconds, axisPhi});
         histos.add("hSecondsITSTOFVsPhi", "", kTH2F, {axisSeconds, axisPhi});
+        hSecondsITS7clsVsPhi.bind(histos.get<TH2>(HIST("hSecondsITS7clsVsPhi")));
+        hSecondsITSglobalVsPhi.bind(histos.get<TH2>(HIST("hSecondsITSglobalVsPhi")));
+        hSecondsITSTRDVsPhi.bind(histos.get<TH2>(HIST("hSecondsITSTRDVsPhi")));
+        hSecondsITSTOFVsPhi.bind(histos.get<TH2>(HIST("hSecondsITSTOFVsPhi")));
       }
       if (confFlagFillEtaPhiVsTimeHist)
         histos.add("hSecondsITSglobalVsEtaPhi", "", kTH3F, {axisSeconds, axisEta, axisPhi});
@@ -777,31 +798,22 @@ struct TimeDependentQaTask {
         if (track.isPVContributor() && track.pt() > 1) {
           // layer-by-layer check
           if (confFlagFillPhiVsTimeHist == 2) {
-            if (track.itsClusterMap() & (1 << 0))
-              histos.fill(HIST("hSecondsITSlayer0vsPhi"), secFromSOR, track.phi());
-            if (track.itsClusterMap() & (1 << 1))
-              histos.fill(HIST("hSecondsITSlayer1vsPhi"), secFromSOR, track.phi());
-            if (track.itsClusterMap() & (1 << 2))
-              histos.fill(HIST("hSecondsITSlayer2vsPhi"), secFromSOR, track.phi());
-            if (track.itsClusterMap() & (1 << 3))
-              histos.fill(HIST("hSecondsITSlayer3vsPhi"), secFromSOR, track.phi());
-            if (track.itsClusterMap() & (1 << 4))
-              histos.fill(HIST("hSecondsITSlayer4vsPhi"), secFromSOR, track.phi());
-            if (track.itsClusterMap() & (1 << 5))
-              histos.fill(HIST("hSecondsITSlayer5vsPhi"), secFromSOR, track.phi());
-            if (track.itsClusterMap() & (1 << 6))
-              histos.fill(HIST("hSecondsITSlayer6vsPhi"), secFromSOR, track.phi());
+            const int phiBin = hSecondsITSlayerVsPhi[0].findBinY(track.phi()); // same phi binning for all layers
+            for (int layer = 0; layer < NLayersITS; layer++) {
+              if (track.itsClusterMap() & (1 << layer))
+                hSecondsITSlayerVsPhi[layer].fillBin(secFromSOR, phiBin);
+            }
           }
           // tracks with conditions
           if (confFlagFillPhiVsTimeHist > 0) {
             if (track.itsNCls() == 7)
-              histos.fill(HIST("hSecondsITS7clsVsPhi"), secFromSOR, track.phi());
+              hSecondsITS7clsVsPhi.fill(secFromSOR, track.phi());
             if (track.isGlobalTrack())
-              histos.fill(HIST("hSecondsITSglobalVsPhi"), secFromSOR, track.phi());
+              hSecondsITSglobalVsPhi.fill(secFromSOR, track.phi());
             if (track.hasTRD())
-              histos.fill(HIST("hSecondsITSTRDVsPhi"), secFromSOR, track.phi());
+              hSecondsITSTRDVsPhi.fill(secFromSOR, track.phi());
             if (track.hasTOF())
-              histos.fill(HIST("hSecondsITSTOFVsPhi"), secFromSOR, track.phi());
+              hSecondsITSTOFVsPhi.fill(secFromSOR, track.phi());
           }
           // eta-phi histogram for global tracks
           if (confFlagFillEtaPhiVsTimeHist && track.isGlobalTrack()) {
@@ -866,6 +878,19 @@ struct TimeDependentQaTask {
         }
       }
     }
+
+    // move the phi-vs-time maps of this DF to the registry histograms
+    if (confFlagFillPhiVsTimeHist == 2) {
+      for (auto& hLayer : hSecondsITSlayerVsPhi) {
+        hLayer.flush();
+      }
+    }
+    if (confFlagFillPhiVsTimeHist > 0) {
+      hSecondsITS7clsVsPhi.flush();
+      hSecondsITSglobalVsPhi.flush();
+      hSecondsITSTRDVsPhi.flush();
+      hSecondsITSTOFVsPhi.flush();
+    }
   } // end of collision loop
   PROCESS_SWITCH(TimeDependentQaTask, processRun3, "Process Run3 QA vs time", true);
 };
@@ -18,6 +18,7 @@
 
 #include "tofSkimsTableCreator.h"
 
+#include "Common/Core/StratifiedReservoirSampler.h"
 #include "Common/DataModel/EventSelection.h"
 #include "Common/DataModel/FT0Corrected.h"
 #include "Common/DataModel/Multiplicity.h"
@@ -46,9 +47,18 @@ struct tofSkimsTableCreator {
   Configurable<int> applyEvSel{"applyEvSel", 2, "Flag to apply rapidity cut: 0 -> no event selection, 1 -> Run 2 event selection, 2 -> Run 3 event selection"};
   Configurable<int> trackSelection{"trackSelection", 1, "Track selection: 0 -> No Cut, 1 -> kGlobalTrack, 2 -> kGlobalTrackWoPtEta, 3 -> kGlobalTrackWoDCA, 4 -> kQualityTracks, 5 -> kInAcceptanceTracks"};
   Configurable<bool> keepTpcOnly{"keepTpcOnly", false, "Flag to keep the TPC only tracks as well"};
-  Configurable<float> fractionOfEvents{"fractionOfEvents", 0.1, "Fractions of events to keep"};
+  Configurable<float> fractionOfEvents{"fractionOfEvents", 0.1, "Fractions of events to keep, not used with stratifiedSampling"};
+  // Stratified reservoir sampling of the tracks per (species, p, eta, occupancy) and run, replaces the random event downsampling
+  Configurable<bool> stratifiedSampling{"stratifiedSampling", false, "Flag to keep per stratum only the tracks entering its reservoir"};
+  Configurable<int> stratifiedTargetPerStratum{"stratifiedTargetPerStratum", 1000, "Reservoir size per stratum, run and job"};
+  Configurable<int64_t> stratifiedMaxTracksPerRun{"stratifiedMaxTracksPerRun", -1, "Maximum number of skimmed tracks per run and job, < 0: no limit"};
+  Configurable<int> stratifiedSeed{"stratifiedSeed", 0, "Seed of the random numbers, which are reproducible for a given seed and run"};
+  ConfigurableAxis stratifiedBinsP{"stratifiedBinsP", {VARIABLE_WIDTH, 0.2, 0.4, 0.6, 0.8, 1., 1.5, 2., 3., 5., 10.}, "Momentum bins of the strata (GeV/c)"};
+  ConfigurableAxis stratifiedBinsEta{"stratifiedBinsEta", {8, -0.8, 0.8}, "Pseudorapidity bins of the strata"};
+  ConfigurableAxis stratifiedBinsOccupancy{"stratifiedBinsOccupancy", {VARIABLE_WIDTH, 0., 500., 1000., 2000., 4000., 8000., 15000.}, "Track occupancy bins of the strata"};
 
   unsigned int randomSeed = 0;
+  o2::common::core::StratifiedReservoirSampler sampler;
   void init(o2::framework::InitContext&)
   {
     randomSeed = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
@@ -73,6 +83,17 @@ struct tofSkimsTableCreator {
         LOG(fatal) << "Invalid track selection flag: " << trackSelection.value;
         break;
     }
+    if (stratifiedSampling) {
+      using o2::common::core::StratifiedReservoirSampler;
+      sampler.setNSpecies(PID::NIDs);
+      sampler.setTargetPerStratum(stratifiedTargetPerStratum);
+      sampler.setMaxAcceptedPerRun(stratifiedMaxTracksPerRun);
+      sampler.setSeed(stratifiedSeed);
+      sampler.setBinning(StratifiedReservoirSampler::kMomentum, stratifiedBinsP.value);
+      sampler.setBinning(StratifiedReservoirSampler::kEta, stratifiedBinsEta.value);
+      sampler.setBinning(StratifiedReservoirSampler::kOccupancy, stratifiedBinsOccupancy.value);
+      sampler.init();
+    }
   }
 
   Filter eventFilter = (applyEvSel.node() == 0) ||
@@ -86,9 +107,10 @@ struct tofSkimsTableCreator {
                        ((trackSelection.node() == 5) && requireInAcceptanceTracksInFilter());
 
   void process(soa::Filtered<Coll>::iterator const& collision,
-               soa::Filtered<Trks> const& tracks)
+               soa::Filtered<Trks> const& tracks,
+               aod::BCs const&)
   {
-    if (fractionOfEvents < 1.f && (static_cast<float>(rand_r(&randomSeed)) / static_cast<float>(RAND_MAX)) > fractionOfEvents) { // Skip events that are not sampled
+    if (!stratifiedSampling && fractionOfEvents < 1.f && (static_cast<float>(rand_r(&randomSeed)) / static_cast<float>(RAND_MAX)) > fractionOfEvents) { // Skip events that are not sampled
       return;
     }
     tableRow.reserve(tracks.size());
@@ -132,11 +154,17 @@ struct tofSkimsTableCreator {
                 collision.collisionTimeRes(),
                 tofFlags);
 
+    if (stratifiedSampling) {
+      sampler.startRun(collision.bc_as<aod::BCs>().runNumber());
+    }
     int8_t lastTRDLayer = -1;
     for (auto const& trk : tracks) {
       if (!keepTpcOnly.value && !trk.hasTOF()) {
         continue;
       }
+      if (stratifiedSampling && !sampler.accept(trk.pidForTracking(), trk.p(), trk.eta(), collision.trackOccupancyInTimeRange())) {
+        continue;
+      }
 
       lastTRDLayer = -1;
       if (trk.hasTRD()) {
@@ -168,7 +196,9 @@ struct tofSkimsTableCreator {
                trk.tpcNClsFindableMinusFound(),
                trk.tpcNClsFindableMinusCrossedRows(),
                trk.tpcNClsShared(),
-               lastTRDLayer);
+               lastTRDLayer,
+               stratifiedSampling ? sampler.getLastKey() : -1.f,
+               stratifiedSampling ? sampler.getLastAcceptanceProbability() : 1.f);
     }
   }
 };
@@ -48,6 +48,8 @@ DECLARE_SOA_COLUMN(PIDForTracking, pidForTracking, uint8_t); //! Index for mass
 DECLARE_SOA_COLUMN(EvTimeT0AC, evTimeT0AC, float);           //! Event time of the track computed with the T0AC
 DECLARE_SOA_COLUMN(EvTimeT0ACErr, evTimeT0ACErr, float);     //! Resolution of the event time of the track computed with the T0AC
 DECLARE_SOA_COLUMN(LastTRDCluster, lastTRDCluster, int8_t);  //! Index of the last cluster in the TRD, -1 if no TRD information
+DECLARE_SOA_COLUMN(SamplingKey, samplingKey, float);         //! Reservoir key of the stratified sampling, -1 if disabled
+DECLARE_SOA_COLUMN(SamplingProb, samplingProb, float);       //! Probability of the track to be kept by the stratified sampling
 DECLARE_SOA_DYNAMIC_COLUMN(HasTOF, hasTOF,                   //! Flag to check if track has a TOF measurement
                            [](float tofSignal) -> bool { return tofSignal > 0; });
 // Calibration information
@@ -91,6 +93,8 @@ DECLARE_SOA_TABLE(SkimmedTOF, "AOD", "SKIMMEDTOF", //! Table of the skimmed TOF
                   track::TPCNClsFindableMinusCrossedRows,
                   track::TPCNClsShared,
                   tofskims::LastTRDCluster,
+                  tofskims::SamplingKey,
+                  tofskims::SamplingProb,
                   tofskims::HasTOF<pidtofsignal::TOFSignal>,
                   pidflags::IsEvTimeDefined<pidflags::TOFFlags>,
                   pidflags::IsEvTimeTOF<pidflags::TOFFlags>,
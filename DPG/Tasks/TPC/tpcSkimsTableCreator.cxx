@@ -112,6 +112,7 @@ struct TreeWriterTpcV0 {
   Configurable<float> maxPt4dwnsmplTsalisProtons{"maxPt4dwnsmplTsalisProtons", 100., "Maximum Pt for applying downsampling factor of protons"};
   Configurable<float> maxPt4dwnsmplTsalisElectrons{"maxPt4dwnsmplTsalisElectrons", 100., "Maximum Pt for applying  downsampling factor of electrons"};
   Configurable<float> maxPt4dwnsmplTsalisKaons{"maxPt4dwnsmplTsalisKaons", 100., "Maximum Pt for applying  downsampling factor of kaons"};
+  StratifiedSamplingOpts stratifiedSamplingOpts;
 
   enum { // Reconstructed V0 and cascade
     MotherUndef = -1,
@@ -243,7 +244,7 @@ struct TreeWriterTpcV0 {
     const float gammapsipair = v0casc.psipair();
 
     const double pseudoRndm = track.pt() * 1000. - static_cast<int64_t>(track.pt() * 1000);
-    if (pseudoRndm < dwnSmplFactor) {
+    if (pseudoRndm < dwnSmplFactor && passStratifiedSampling(stratifiedSampler, stratifiedSamplingOpts.enable, runnumber, id, p, track.eta(), trackOcc)) {
       float usedDedx;
       if constexpr (DoUseCorrectedDeDx) {
         usedDedx = track.tpcSignalCorrected();
@@ -270,6 +271,8 @@ struct TreeWriterTpcV0 {
                  trackOcc,
                  ft0Occ,
                  hadronicRate,
+                 getSamplingKey(stratifiedSampler, stratifiedSamplingOpts.enable),
+                 getSamplingProb(stratifiedSampler, stratifiedSamplingOpts.enable),
                  alpha,
                  qt,
                  cosPA,
@@ -299,7 +302,7 @@ struct TreeWriterTpcV0 {
     const float gammapsipair = v0casc.psipair();
 
     const double pseudoRndm = track.pt() * 1000. - static_cast<int64_t>(track.pt() * 1000);
-    if (pseudoRndm < dwnSmplFactor) {
+    if (pseudoRndm < dwnSmplFactor && passStratifiedSampling(stratifiedSampler, stratifiedSamplingOpts.enable, runnumber, id, p, track.eta(), trackOcc)) {
       float usedDedx;
       if constexpr (DoUseCorrectedDeDx) {
         usedDedx = track.tpcSignalCorrected();
@@ -327,6 +330,8 @@ struct TreeWriterTpcV0 {
                                 trackOcc,
                                 ft0Occ,
                                 hadronicRate,
+                                getSamplingKey(stratifiedSampler, stratifiedSamplingOpts.enable),
+                                getSamplingProb(stratifiedSampler, stratifiedSamplingOpts.enable),
                                 alpha,
                                 qt,
                                 cosPA,
@@ -355,6 +360,8 @@ struct TreeWriterTpcV0 {
                             trackOcc,
                             ft0Occ,
                             hadronicRate,
+                            getSamplingKey(stratifiedSampler, stratifiedSamplingOpts.enable),
+                            getSamplingProb(stratifiedSampler, stratifiedSamplingOpts.enable),
                             alpha,
                             qt,
                             cosPA,
@@ -379,6 +386,7 @@ struct TreeWriterTpcV0 {
   }
 
   TRandom3* fRndm = new TRandom3(0);
+  o2::common::core::StratifiedReservoirSampler stratifiedSampler;
 
   void init(o2::framework::InitContext&)
   {
@@ -390,6 +398,10 @@ struct TreeWriterTpcV0 {
     ccdb->setURL("http://alice-ccdb.cern.ch");
     ccdb->setCaching(true);
     ccdb->setFatalWhenNull(false);
+
+    if (stratifiedSamplingOpts.enable) {
+      initStratifiedSampler(stratifiedSampler, stratifiedSamplingOpts);
+    }
   }
 
   /// Evaluate cosPA of the v0
@@ -444,7 +456,7 @@ struct TreeWriterTpcV0 {
 
     auto fillDaughterTrack = [&](const auto& mother, const TrksType::iterator& dauTrack, const V0Daughter& daughter) {
       const bool passTrackSelection = isTrackSelected(dauTrack, trackSelection);
-      const bool passDownsamplig = downsampleTsalisCharged(fRndm, dauTrack.pt(), daughter.downsamplingTsalis, daughter.mass, sqrtSNN, daughter.maxPt4dwnsmplTsalis);
+      const bool passDownsamplig = stratifiedSamplingOpts.enable || downsampleTsalisCharged(fRndm, dauTrack.pt(), daughter.downsamplingTsalis, daughter.mass, sqrtSNN, daughter.maxPt4dwnsmplTsalis);
       const bool passNSigmaTofCut = std::fabs(daughter.tofNSigma) < daughter.nSigmaTofDauTrack || std::fabs(daughter.tofNSigma - NSigmaTofUnmatched) < NSigmaTofUnmatchedEqualityTolerance;
       const bool passMatchTofRequirement = !daughter.rejectNoTofDauTrack || std::fabs(daughter.tofNSigma - NSigmaTofUnmatched) > NSigmaTofUnmatchedEqualityTolerance;
       if (passTrackSelection && passDownsamplig && passNSigmaTofCut && passMatchTofRequirement) {
@@ -533,7 +545,7 @@ struct TreeWriterTpcV0 {
 
       auto fillDaughterTrack = [&](const auto& mother, const TrksType::iterator& dauTrack, const V0Daughter& daughter, const aod::TracksQA& trackQAInstance, const bool existTrkQA) {
         const bool passTrackSelection = isTrackSelected(dauTrack, trackSelection);
-        const bool passDownsamplig = downsampleTsalisCharged(fRndm, dauTrack.pt(), daughter.downsamplingTsalis, daughter.mass, sqrtSNN, daughter.maxPt4dwnsmplTsalis);
+        const bool passDownsamplig = stratifiedSamplingOpts.enable || downsampleTsalisCharged(fRndm, dauTrack.pt(), daughter.downsamplingTsalis, daughter.mass, sqrtSNN, daughter.maxPt4dwnsmplTsalis);
         const bool passNSigmaTofCut = std::fabs(daughter.tofNSigma) < daughter.nSigmaTofDauTrack || std::fabs(daughter.tofNSigma - NSigmaTofUnmatched) < NSigmaTofUnmatchedEqualityTolerance;
         const bool passMatchTofRequirement = !daughter.rejectNoTofDauTrack || std::fabs(daughter.tofNSigma - NSigmaTofUnmatched) > NSigmaTofUnmatchedEqualityTolerance;
         if (passTrackSelection && passDownsamplig && passNSigmaTofCut && passMatchTofRequirement) {
@@ -690,6 +702,7 @@ struct TreeWriterTpcTof {
   Configurable<float> downsamplingTsalisProtons{"downsamplingTsalisProtons", -1., "Downsampling factor to reduce the number of protons"};
   Configurable<float> downsamplingTsalisKaons{"downsamplingTsalisKaons", -1., "Downsampling factor to reduce the number of kaons"};
   Configurable<float> downsamplingTsalisPions{"downsamplingTsalisPions", -1., "Downsampling factor to reduce the number of pions"};
+  StratifiedSamplingOpts stratifiedSamplingOpts;
 
   Filter trackFilter = (trackSelection.node() == static_cast<int>(TrackSelectionNoCut)) ||
                        ((trackSelection.node() == static_cast<int>(TrackSelectionGlobalTrack)) && requireGlobalTrackInFilter()) ||
@@ -718,6 +731,7 @@ struct TreeWriterTpcTof {
   };
 
   TRandom3* fRndm = new TRandom3(0);
+  o2::common::core::StratifiedReservoirSampler stratifiedSampler;
 
   /// Function to fill trees
   template <bool DoCorrectDeDx = false, typename T, typename C>
@@ -734,7 +748,7 @@ struct TreeWriterTpcTof {
     const auto ft0Occ = collision.ft0cOccupancyInTimeRange();
 
     const double pseudoRndm = track.pt() * 1000. - static_cast<int64_t>(track.pt() * 1000);
-    if (pseudoRndm < dwnSmplFactor) {
+    if (pseudoRndm < dwnSmplFactor && passStratifiedSampling(stratifiedSampler, stratifiedSamplingOpts.enable, runnumber, id, p, track.eta(), trackOcc)) {
       float usedEdx;
       if constexpr (DoCorrectDeDx) {
         usedEdx = track.tpcSignalCorrected();
@@ -761,6 +775,8 @@ struct TreeWriterTpcTof {
                     trackOcc,
                     ft0Occ,
                     hadronicRate,
+                    getSamplingKey(stratifiedSampler, stratifiedSamplingOpts.enable),
+                    getSamplingProb(stratifiedSampler, stratifiedSamplingOpts.enable),
                     nSigmaITS);
     }
   };
@@ -778,7 +794,7 @@ struct TreeWriterTpcTof {
     const auto ft0Occ = collision.ft0cOccupancyInTimeRange();
 
     const double pseudoRndm = track.pt() * 1000. - static_cast<int64_t>(track.pt() * 1000);
-    if (pseudoRndm < dwnSmplFactor) {
+    if (pseudoRndm < dwnSmplFactor && passStratifiedSampling(stratifiedSampler, stratifiedSamplingOpts.enable, runnumber, id, p, track.eta(), trackOcc)) {
       float usedEdx;
       if constexpr (DoCorrectDeDx) {
         usedEdx = track.tpcSignalCorrected();
@@ -806,6 +822,8 @@ struct TreeWriterTpcTof {
                                    trackOcc,
                                    ft0Occ,
                                    hadronicRate,
+                                   getSamplingKey(stratifiedSampler, stratifiedSamplingOpts.enable),
+                                   getSamplingProb(stratifiedSampler, stratifiedSamplingOpts.enable),
                                    nSigmaITS,
                                    existTrkQA ? trackQA.tpcdEdxNorm() : -999);
       } else {
@@ -829,6 +847,8 @@ struct TreeWriterTpcTof {
                                trackOcc,
                                ft0Occ,
                                hadronicRate,
+                               getSamplingKey(stratifiedSampler, stratifiedSamplingOpts.enable),
+                               getSamplingProb(stratifiedSampler, stratifiedSamplingOpts.enable),
                                nSigmaITS,
                                bcGlobalIndex,
                                bcTimeFrameId,
@@ -857,6 +877,10 @@ struct TreeWriterTpcTof {
     ccdb->setURL("http://alice-ccdb.cern.ch");
     ccdb->setCaching(true);
     ccdb->setFatalWhenNull(false);
+
+    if (stratifiedSamplingOpts.enable) {
+      initStratifiedSampler(stratifiedSampler, stratifiedSamplingOpts);
+    }
   }
 
   /// Evaluate tpcSignal with or without correction
@@ -898,7 +922,7 @@ struct TreeWriterTpcTof {
         if ((!tofTrack->isApplyHardCutOnly || trk.tpcInnerParam() < tofTrack->maxMomHardCutOnly) &&
             ((trk.tpcInnerParam() <= tofTrack->maxMomTPCOnly && std::fabs(tofTrack->tpcNSigma) < tofTrack->nSigmaTPCOnly) ||
              (trk.tpcInnerParam() > tofTrack->maxMomTPCOnly && std::fabs(tofTrack->tofNSigma) < tofTrack->nSigmaTofTpctof && std::fabs(tofTrack->tpcNSigma) < tofTrack->nSigmaTpcTpctof)) &&
-            downsampleTsalisCharged(fRndm, trk.pt(), tofTrack->downsamplingTsalis, tofTrack->mass, sqrtSNN)) {
+            (stratifiedSamplingOpts.enable || downsampleTsalisCharged(fRndm, trk.pt(), tofTrack->downsamplingTsalis, tofTrack->mass, sqrtSNN))) {
           fillSkimmedTPCTOFTable<IsCorrectedDeDx>(trk, collision, tofTrack->tpcNSigma, tofTrack->tofNSigma, tofTrack->itsNSigma, tofTrack->tpcExpSignal, tofTrack->pid, runnumber, tofTrack->dwnSmplFactor, hadronicRate);
         }
       }
@@ -977,7 +1001,7 @@ struct TreeWriterTpcTof {
           if ((!tofTrack->isApplyHardCutOnly || trk.tpcInnerParam() < tofTrack->maxMomHardCutOnly) &&
               ((trk.tpcInnerParam() <= tofTrack->maxMomTPCOnly && std::fabs(tofTrack->tpcNSigma) < tofTrack->nSigmaTPCOnly) ||
                (trk.tpcInnerParam() > tofTrack->maxMomTPCOnly && std::fabs(tofTrack->tofNSigma) < tofTrack->nSigmaTofTpctof && std::fabs(tofTrack->tpcNSigma) < tofTrack->nSigmaTpcTpctof)) &&
-              downsampleTsalisCharged(fRndm, trk.pt(), tofTrack->downsamplingTsalis, tofTrack->mass, sqrtSNN)) {
+              (stratifiedSamplingOpts.enable || downsampleTsalisCharged(fRndm, trk.pt(), tofTrack->downsamplingTsalis, tofTrack->mass, sqrtSNN))) {
             fillSkimmedTPCTOFTableWithTrkQAGeneric<IsCorrectedDeDx, IsWithdEdx>(trk, trackQA, existTrkQA, collision, tofTrack->tpcNSigma, tofTrack->tofNSigma, tofTrack->itsNSigma, tofTrack->tpcExpSignal, tofTrack->pid, runnumber, tofTrack->dwnSmplFactor, hadronicRate, bcGlobalIndex, bcTimeFrameId, bcBcInTimeFrame);
           }
         }
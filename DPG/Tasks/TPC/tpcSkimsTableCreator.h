@@ -53,6 +53,8 @@ DECLARE_SOA_COLUMN(HadronicRate, hadronicRate, float);
 DECLARE_SOA_COLUMN(BcGlobalIndex, bcGlobalIndex, int);
 DECLARE_SOA_COLUMN(BcTimeFrameId, bcTimeFrameId, int);
 DECLARE_SOA_COLUMN(BcBcInTimeFrame, bcBcInTimeFrame, int);
+DECLARE_SOA_COLUMN(SamplingKey, samplingKey, float);
+DECLARE_SOA_COLUMN(SamplingProb, samplingProb, float);
 } // namespace tpcskims
 
 #define TPCSKIMS_COLUMNS_BASE      \
@@ -75,7 +77,9 @@ DECLARE_SOA_COLUMN(BcBcInTimeFrame, bcBcInTimeFrame, int);
     tpcskims::RunNumber,           \
     tpcskims::TrackOcc,            \
     tpcskims::Ft0Occ,              \
-    tpcskims::HadronicRate
+    tpcskims::HadronicRate,        \
+    tpcskims::SamplingKey,         \
+    tpcskims::SamplingProb
 
 #define TPCSKIMS_COLUMNS_V0 \
   TPCSKIMS_COLUMNS_BASE,    \
@@ -20,8 +20,16 @@
 #ifndef DPG_TASKS_TPC_UTILSTPCSKIMSTABLECREATOR_H_
 #define DPG_TASKS_TPC_UTILSTPCSKIMSTABLECREATOR_H_
 
+#include "Common/Core/StratifiedReservoirSampler.h"
+
+#include <Framework/Configurable.h>
+#include <ReconstructionDataFormats/PID.h>
+
 #include <TRandom3.h>
 
+#include <cstdint>
+#include <string>
+
 namespace o2::dpg_tpcskimstablecreator
 {
 enum {
@@ -83,6 +91,55 @@ inline bool downsampleTsalisCharged(TRandom3* fRndm, const double pt, const doub
   }
 };
 
+/// Stratified reservoir sampling of the skimmed tracks per (species, p, eta, occupancy) and run.
+/// When enabled, the Tsallis downsampling (TRandom3 seeded from the clock) is bypassed, so that the skim is
+/// reproducible; the deterministic dwnSmplFactor selection still applies before the sampler
+struct StratifiedSamplingOpts : o2::framework::ConfigurableGroup {
+  std::string prefix = "stratifiedSampling";
+  o2::framework::Configurable<bool> enable{"enable", false, "Flag to keep per stratum only the tracks entering its reservoir, instead of the random Tsallis downsampling"};
+  o2::framework::Configurable<int> targetPerStratum{"targetPerStratum", 1000, "Reservoir size per stratum, run and job"};
+  o2::framework::Configurable<int64_t> maxTracksPerRun{"maxTracksPerRun", -1, "Maximum number of skimmed tracks per run and job, < 0: no limit"};
+  o2::framework::Configurable<int> seed{"seed", 0, "Seed of the random numbers, which are reproducible for a given seed and run"};
+  o2::framework::ConfigurableAxis binsP{"binsP", {o2::framework::VARIABLE_WIDTH, 0.1, 0.2, 0.3, 0.4, 0.5, 0.7, 1., 1.5, 2., 3., 5., 10.}, "TPC inner momentum bins of the strata (GeV/c)"};
+  o2::framework::ConfigurableAxis binsEta{"binsEta", {8, -0.8, 0.8}, "Pseudorapidity bins of the strata"};
+  o2::framework::ConfigurableAxis binsOccupancy{"binsOccupancy", {o2::framework::VARIABLE_WIDTH, 0., 500., 1000., 2000., 4000., 8000., 15000.}, "Track occupancy bins of the strata"};
+};
+
+inline void initStratifiedSampler(o2::common::core::StratifiedReservoirSampler& sampler, const StratifiedSamplingOpts& opts)
+{
+  using o2::common::core::StratifiedReservoirSampler;
+  sampler.setNSpecies(o2::track::PID::NIDs);
+  sampler.setTargetPerStratum(opts.targetPerStratum);
+  sampler.setMaxAcceptedPerRun(opts.maxTracksPerRun);
+  sampler.setSeed(opts.seed);
+  sampler.setBinning(StratifiedReservoirSampler::kMomentum, opts.binsP.value);
+  sampler.setBinning(StratifiedReservoirSampler::kEta, opts.binsEta.value);
+  sampler.setBinning(StratifiedReservoirSampler::kOccupancy, opts.binsOccupancy.value);
+  sampler.init();
+}
+
+/// Stratified sampling decision, always true if disabled
+inline bool passStratifiedSampling(o2::common::core::StratifiedReservoirSampler& sampler, const bool enabled, const int runnumber, const int species, const double p, const double eta, const double occupancy)
+{
+  if (!enabled) {
+    return true;
+  }
+  sampler.startRun(runnumber);
+  return sampler.accept(species, p, eta, occupancy);
+}
+
+/// Reservoir key of the row just accepted, -1 without stratified sampling
+inline float getSamplingKey(const o2::common::core::StratifiedReservoirSampler& sampler, const bool enabled)
+{
+  return enabled ? sampler.getLastKey() : -1.f;
+}
+
+/// Probability with which the row just accepted was kept by the stratified sampling, 1 if disabled
+inline float getSamplingProb(const o2::common::core::StratifiedReservoirSampler& sampler, const bool enabled)
+{
+  return enabled ? sampler.getLastAcceptanceProbability() : 1.f;
+}
+
 // Track selection
 template <typename TrackType>
 inline bool isTrackSelected(const TrackType& track, const int trackSelection)
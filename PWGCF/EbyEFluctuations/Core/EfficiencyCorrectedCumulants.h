@@ -0,0 +1,272 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file EfficiencyCorrectedCumulants.h
+/// \brief Efficiency-corrected cumulants of (net-)particle numbers up to a compile-time order
+///
+/// The correction follows the binomial-efficiency formalism of Nonaka, Kitazawa and Esumi (PRC 95, 064912):
+/// with the power sums q(a,b) = sum_i c_i^a / eps_i^b over the particles of an event (charge c_i, efficiency
+/// eps_i), the combinations r_a = sum_b (-1)^(b-1) (b-1)! S(a,b) q(a,b) (S: Stirling numbers of the second
+/// kind) are such that the complete Bell polynomials Y_m = B_m(r_1, ..., r_m) are unbiased estimators of the
+/// moments <X^m> of the true X = sum_i c_i. All the products of q(a,b) terms of the usual formulas are thus
+/// contained in MaxOrder per-event values, generated from the coefficient tables built at compile time.
+///
+/// Per (centrality bin, sample) only the sum of event weights and the sums of Y_1 ... Y_MaxOrder are kept,
+/// directly in the bin array of a TH3D booked by the task (x: term, y: sample, z: centrality), so that the
+/// output merges by adding histograms and no flush is needed. Sample 0 holds all the events, samples 1..n
+/// either random subsamples or Poisson bootstrap replicas. The cumulants and their statistical errors are
+/// computed from the merged histogram with fillCumulants().
+///
+/// Usage:
+///   registry.add("hSums", "", kTH3D, {{NTerms, -0.5, NTerms - 0.5}, {nSamples + 1, -0.5, nSamples + 0.5}, centAxis});
+///   cumulants.bind(registry.get<TH3>(HIST("hSums")), ErrorMode::kBootstrap);
+///   per event: cumulants.startEvent(); cumulants.addParticle(sign, efficiency) per particle; cumulants.fillEvent(cent);
+///
+
+#ifndef PWGCF_EBYEFLUCTUATIONS_CORE_EFFICIENCYCORRECTEDCUMULANTS_H_
+#define PWGCF_EBYEFLUCTUATIONS_CORE_EFFICIENCYCORRECTEDCUMULANTS_H_
+
+#include <Framework/Logger.h>
+
+#include <TArrayD.h>
+#include <TAxis.h>
+#include <TH1.h>
+#include <TH3.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+namespace o2::analysis::ebyefluctuations
+{
+
+enum class ErrorMode : int {
+  kSubsamples = 0, // each event in one random subsample, error = RMS / sqrt(n)
+  kBootstrap       // each event in every replica with a Poisson(1) weight, error = RMS
+};
+
+/// \tparam MaxOrder highest cumulant order
+template <int MaxOrder>
+class EfficiencyCorrectedCumulants
+{
+  static_assert(MaxOrder >= 1 && MaxOrder <= 12, "EfficiencyCorrectedCumulants: order out of range");
+
+ public:
+  static constexpr int NTerms = MaxOrder + 1; // sum of weights, sums of Y_1 ... Y_MaxOrder
+
+  using Table = std::array<std::array<double, MaxOrder + 1>, MaxOrder + 1>;
+
+  /// binomial coefficients C(n, k)
+  static constexpr Table binomials()
+  {
+    Table c{};
+    for (int n = 0; n <= MaxOrder; n++) {
+      c[n][0] = 1.;
+      for (int k = 1; k <= n; k++) {
+        c[n][k] = c[n - 1][k - 1] + (k <= n - 1 ? c[n - 1][k] : 0.);
+      }
+    }
+    return c;
+  }
+
+  /// coefficient of q(a,b) in r_a: (-1)^(b-1) (b-1)! S(a,b)
+  static constexpr Table correctionCoefficients()
+  {
+    Table stirling{};
+    stirling[0][0] = 1.;
+    for (int a = 1; a <= MaxOrder; a++) {
+      for (int b = 1; b <= a; b++) {
+        stirling[a][b] = b * stirling[a - 1][b] + stirling[a - 1][b - 1];
+      }
+    }
+    Table coefficients{};
+    double factorial = 1.; // (b-1)!
+    for (int b = 1; b <= MaxOrder; b++) {
+      for (int a = b; a <= MaxOrder; a++) {
+        coefficients[a][b] = (b % 2 == 1 ? 1. : -1.) * factorial * stirling[a][b];
+      }
+      factorial *= b;
+    }
+    return coefficients;
+  }
+
+  static constexpr Table Binomials = binomials();
+  static constexpr Table Coefficients = correctionCoefficients();
+
+  /// takes the storage, the number of samples and the centrality binning from the histogram. The contents are kept,
+  /// e.g. to continue filling a merged histogram
+  template <typename HistPtr>
+  void bind(HistPtr const& hist, ErrorMode errorMode = ErrorMode::kSubsamples, uint64_t seed = 0)
+  {
+    TH3* hist3 = &*hist;
+    auto* array = dynamic_cast<TArrayD*>(hist3);
+    if (!array) {
+      LOGF(fatal, "EfficiencyCorrectedCumulants: %s is not a TH3D", hist3->GetName());
+    }
+    if (hist3->GetNbinsX() != NTerms) {
+      LOGF(fatal, "EfficiencyCorrectedCumulants: %s has %d bins on the term axis, %d expected for order %d", hist3->GetName(), hist3->GetNbinsX(), NTerms, MaxOrder);
+    }
+    mHist = hist3;
+    mSums = array->GetArray();
+    mNSamples = hist3->GetNbinsY() - 1;
+    mAxisCent = hist3->GetZaxis();
+    mErrorMode = errorMode;
+    mRandom.seed(seed);
+  }
+
+  /// resets the power sums of the event
+  void startEvent() { mPowerSums = {}; }
+
+  /// adds a particle with charge (e.g. +1 or -1 for the net number, 1 for the number of one species) and efficiency
+  void addParticle(double charge, double efficiency)
+  {
+    if (!(efficiency > 0.)) {
+      return;
+    }
+    const double weight = 1. / efficiency;
+    double chargePower = 1.;
+    for (int a = 1; a <= MaxOrder; a++) {
+      chargePower *= charge;
+      double weightPower = chargePower;
+      for (int b = 1; b <= a; b++) {
+        weightPower *= weight;
+        mPowerSums[a][b] += weightPower;
+      }
+    }
+  }
+
+  /// moment estimators Y_1 ... Y_MaxOrder of the event from the power sums, Y_0 = 1
+  std::array<double, MaxOrder + 1> getEventMoments() const
+  {
+    std::array<double, MaxOrder + 1> r{};
+    for (int a = 1; a <= MaxOrder; a++) {
+      for (int b = 1; b <= a; b++) {
+        r[a] += Coefficients[a][b] * mPowerSums[a][b];
+      }
+    }
+    // complete Bell polynomials: Y_(m+1) = sum_i C(m, i) Y_(m-i) r_(i+1)
+    std::array<double, MaxOrder + 1> moments{};
+    moments[0] = 1.;
+    for (int m = 0; m < MaxOrder; m++) {
+      for (int i = 0; i <= m; i++) {
+        moments[m + 1] += Binomials[m][i] * moments[m - i] * r[i + 1];
+      }
+    }
+    return moments;
+  }
+
+  /// adds the event to sample 0 and to its subsample or to the bootstrap replicas
+  void fillEvent(double centrality, double eventWeight = 1.)
+  {
+    const auto moments = getEventMoments();
+    const int centBin = mAxisCent->FindFixBin(centrality);
+    addToCell(centBin, 0, moments, eventWeight);
+    if (mNSamples > 0) {
+      if (mErrorMode == ErrorMode::kSubsamples) {
+        std::uniform_int_distribution<int> subsample(1, mNSamples);
+        addToCell(centBin, subsample(mRandom), moments, eventWeight);
+      } else {
+        std::poisson_distribution<int> replicaWeight(1.);
+        for (int sample = 1; sample <= mNSamples; sample++) {
+          if (const int k = replicaWeight(mRandom)) {
+            addToCell(centBin, sample, moments, k * eventWeight);
+          }
+        }
+      }
+    }
+    mHist->SetEntries(mHist->GetEntries() + 1);
+  }
+
+  /// cumulants kappa_1 ... kappa_MaxOrder from the sums of one cell (sums[0]: sum of weights); kappa_0 = 0
+  static std::array<double, MaxOrder + 1> cumulantsFromSums(const double* sums)
+  {
+    std::array<double, MaxOrder + 1> cumulants{};
+    if (!(sums[0] > 0.)) {
+      return cumulants;
+    }
+    std::array<double, MaxOrder + 1> moments{};
+    for (int m = 1; m <= MaxOrder; m++) {
+      moments[m] = sums[m] / sums[0];
+    }
+    // kappa_m = mu_m - sum_(i=1)^(m-1) C(m-1, i-1) kappa_i mu_(m-i)
+    for (int m = 1; m <= MaxOrder; m++) {
+      cumulants[m] = moments[m];
+      for (int i = 1; i < m; i++) {
+        cumulants[m] -= Binomials[m - 1][i - 1] * cumulants[i] * moments[m - i];
+      }
+    }
+    return cumulants;
+  }
+
+  /// kappa_order (or kappa_order / kappa_denominatorOrder) vs centrality, with the binning of the z axis of hSums.
+  /// The errors are the spread of the samples, as for errorMode when filling
+  static void fillCumulants(const TH3* hSums, TH1* hCumulant, int order, int denominatorOrder = 0, ErrorMode errorMode = ErrorMode::kSubsamples)
+  {
+    const int nSamples = hSums->GetNbinsY() - 1;
+    for (int centBin = 1; centBin <= hSums->GetNbinsZ(); centBin++) {
+      auto valueOf = [&](int sample) {
+        std::array<double, NTerms> sums;
+        for (int term = 0; term < NTerms; term++) {
+          sums[term] = hSums->GetBinContent(term + 1, sample + 1, centBin);
+        }
+        const auto cumulants = cumulantsFromSums(sums.data());
+        return denominatorOrder > 0 ? (cumulants[denominatorOrder] != 0. ? cumulants[order] / cumulants[denominatorOrder] : 0.) : cumulants[order];
+      };
+      const double value = valueOf(0);
+      double sum = 0., sum2 = 0.;
+      int nValid = 0;
+      for (int sample = 1; sample <= nSamples; sample++) {
+        if (!(hSums->GetBinContent(1, sample + 1, centBin) > 0.)) {
+          continue;
+        }
+        const double sampleValue = valueOf(sample);
+        sum += sampleValue;
+        sum2 += sampleValue * sampleValue;
+        nValid++;
+      }
+      double error = 0.;
+      if (nValid > 1) {
+        const double rms = std::sqrt(std::max(0., (sum2 - sum * sum / nValid) / (nValid - 1)));
+        error = errorMode == ErrorMode::kSubsamples ? rms / std::sqrt(nValid) : rms;
+      }
+      const int bin = hCumulant->FindBin(hSums->GetZaxis()->GetBinCenter(centBin));
+      hCumulant->SetBinContent(bin, value);
+      hCumulant->SetBinError(bin, error);
+    }
+  }
+
+ private:
+  void addToCell(int centBin, int sample, std::array<double, MaxOrder + 1> const& moments, double weight)
+  {
+    // TH3 global bin of (term 0, sample, centBin): the terms of a cell are contiguous
+    const std::size_t cell = 1 + static_cast<std::size_t>(NTerms + 2) * ((sample + 1) + static_cast<std::size_t>(mNSamples + 3) * centBin);
+    double* sums = mSums + cell;
+    sums[0] += weight;
+    for (int m = 1; m <= MaxOrder; m++) {
+      sums[m] += weight * moments[m];
+    }
+  }
+
+  TH3* mHist = nullptr;
+  double* mSums = nullptr; // bin contents of mHist
+  const TAxis* mAxisCent = nullptr;
+  int mNSamples = 0;
+  ErrorMode mErrorMode = ErrorMode::kSubsamples;
+  std::mt19937_64 mRandom;
+  Table mPowerSums{}; // q(a,b) of the current event, b <= a
+};
+
+} // namespace o2::analysis::ebyefluctuations
+
+#endif // PWGCF_EBYEFLUCTUATIONS_CORE_EFFICIENCYCORRECTEDCUMULANTS_H_
@@ -0,0 +1,189 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FactorialMomentsGrid.h
+/// \brief Integer M x M count grids of one event in (eta, phi) and the sums of their factorial moments
+///
+/// The grids of all the binnings M are organised as a hierarchy: a binning with a multiple in the set
+/// (e.g. M = 4 with 8 or 12) is derived by summing the cells of its smallest multiple, the others (the
+/// roots) are filled from the tracks. Since floor(u * k M) / k = floor(u * M), the derived counts are
+/// exactly the ones of a direct filling. A single common finest grid would need lcm(M) cells, so each
+/// track is binned once per root instead.
+/// The sums over the cells of n and of the falling factorials n (n - 1) ... (n - q + 1), q = 2 ... maxOrder,
+/// are computed for all the orders in one pass over the cells, with integer counts and without overflow of
+/// the factorials for large n.
+///
+/// Usage, per event:
+///   grid.reset(); grid.fill(eta, phi) per track; grid.compute();
+///   grid.getSumCounts(iM), grid.getSumFq(iM, q)
+///
+
+#ifndef PWGCF_EBYEFLUCTUATIONS_CORE_FACTORIALMOMENTSGRID_H_
+#define PWGCF_EBYEFLUCTUATIONS_CORE_FACTORIALMOMENTSGRID_H_
+
+#include <Framework/Logger.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace o2::analysis::ebyefluctuations
+{
+
+class FactorialMomentsGrid
+{
+ public:
+  /// \param binnings number of bins M per axis of each grid
+  /// \param maxOrder highest order q of the factorial moments, from 2
+  void init(std::vector<int> const& binnings, int maxOrder, double etaMin, double etaMax, double phiMin, double phiMax)
+  {
+    if (maxOrder < 2) {
+      LOGF(fatal, "FactorialMomentsGrid: maximum order %d, at least 2 expected", maxOrder);
+    }
+    for (const auto nBins : binnings) {
+      if (nBins < 1) {
+        LOGF(fatal, "FactorialMomentsGrid: invalid number of bins %d", nBins);
+      }
+    }
+    mBinnings = binnings;
+    mMaxOrder = maxOrder;
+    mEtaMin = etaMin;
+    mEtaScale = 1. / (etaMax - etaMin);
+    mPhiMin = phiMin;
+    mPhiScale = 1. / (phiMax - phiMin);
+
+    const int nGrids = mBinnings.size();
+    mCounts.resize(nGrids);
+    mParents.assign(nGrids, -1);
+    mRoots.clear();
+    for (int iM = 0; iM < nGrids; iM++) {
+      const int nBins = mBinnings[iM];
+      mCounts[iM].assign(static_cast<std::size_t>(nBins) * nBins, 0);
+      for (int iParent = 0; iParent < nGrids; iParent++) {
+        const int nParentBins = mBinnings[iParent];
+        if (nParentBins > nBins && nParentBins % nBins == 0 && (mParents[iM] < 0 || nParentBins < mBinnings[mParents[iM]])) {
+          mParents[iM] = iParent;
+        }
+      }
+      if (mParents[iM] < 0) {
+        mRoots.push_back(iM);
+      }
+    }
+    // the parents are derived before their children
+    mOrder.resize(nGrids);
+    std::iota(mOrder.begin(), mOrder.end(), 0);
+    std::stable_sort(mOrder.begin(), mOrder.end(), [this](int a, int b) { return mBinnings[a] > mBinnings[b]; });
+
+    mSumCounts.assign(nGrids, 0.);
+    mSumFq.assign(static_cast<std::size_t>(nGrids) * (mMaxOrder - 1), 0.);
+  }
+
+  /// clears the grids of the roots, the other grids are overwritten by compute()
+  void reset()
+  {
+    for (const auto iM : mRoots) {
+      std::fill(mCounts[iM].begin(), mCounts[iM].end(), 0);
+    }
+  }
+
+  /// adds a track; tracks outside [etaMin, etaMax) x [phiMin, phiMax) are ignored, as the under- and
+  /// overflows of a TH2 with the same axes
+  void fill(double eta, double phi)
+  {
+    const double u = (eta - mEtaMin) * mEtaScale;
+    const double v = (phi - mPhiMin) * mPhiScale;
+    if (!(u >= 0. && u < 1. && v >= 0. && v < 1.)) {
+      return;
+    }
+    for (const auto iM : mRoots) {
+      const int nBins = mBinnings[iM];
+      const int iEta = std::min(static_cast<int>(u * nBins), nBins - 1);
+      const int iPhi = std::min(static_cast<int>(v * nBins), nBins - 1);
+      mCounts[iM][iEta * nBins + iPhi]++;
+    }
+  }
+
+  /// derives the grids of the non-root binnings and computes the sums of the counts and of the factorial moments
+  void compute()
+  {
+    for (const auto iM : mOrder) {
+      if (mParents[iM] >= 0) {
+        derive(iM);
+      }
+    }
+    const int nOrders = mMaxOrder - 1;
+    for (std::size_t iM = 0; iM < mBinnings.size(); iM++) {
+      int64_t sumCounts = 0;
+      double* sumFq = &mSumFq[iM * nOrders];
+      std::fill(sumFq, sumFq + nOrders, 0.);
+      for (const auto count : mCounts[iM]) {
+        sumCounts += count;
+        if (count < 2) {
+          continue;
+        }
+        // n (n - 1) ... (n - q + 1), the product grows with q
+        double fq = count;
+        for (int q = 2; q <= mMaxOrder && count >= q; q++) {
+          fq *= count - q + 1;
+          sumFq[q - 2] += fq;
+        }
+      }
+      mSumCounts[iM] = sumCounts;
+    }
+  }
+
+  int getNBinnings() const { return mBinnings.size(); }
+  int getBinning(int iM) const { return mBinnings[iM]; }
+  /// sum of the counts of grid iM, i.e. tracks in the acceptance
+  double getSumCounts(int iM) const { return mSumCounts[iM]; }
+  /// sum over the cells of grid iM of n! / (n - q)!
+  double getSumFq(int iM, int q) const { return mSumFq[iM * (mMaxOrder - 1) + q - 2]; }
+  /// count of cell (iEta, iPhi) of grid iM, after compute() for the non-root binnings
+  int32_t getCount(int iM, int iEta, int iPhi) const { return mCounts[iM][iEta * mBinnings[iM] + iPhi]; }
+
+ private:
+  /// sums the cells of the parent grid, nParentBins = ratio * nBins
+  void derive(int iM)
+  {
+    const int nBins = mBinnings[iM];
+    const int nParentBins = mBinnings[mParents[iM]];
+    const int ratio = nParentBins / nBins;
+    auto& counts = mCounts[iM];
+    const auto& parentCounts = mCounts[mParents[iM]];
+    std::fill(counts.begin(), counts.end(), 0);
+    for (int iEta = 0; iEta < nParentBins; iEta++) {
+      int32_t* row = &counts[(iEta / ratio) * nBins];
+      const int32_t* parentRow = &parentCounts[iEta * nParentBins];
+      for (int iPhi = 0; iPhi < nParentBins; iPhi++) {
+        row[iPhi / ratio] += parentRow[iPhi];
+      }
+    }
+  }
+
+  std::vector<int> mBinnings;
+  std::vector<int> mParents; // smallest multiple of each binning in the set, -1 for the roots
+  std::vector<int> mRoots;   // binnings filled from the tracks
+  std::vector<int> mOrder;   // binnings by decreasing M
+  std::vector<std::vector<int32_t>> mCounts;
+  std::vector<double> mSumCounts;
+  std::vector<double> mSumFq; // per binning, orders 2 ... mMaxOrder
+  int mMaxOrder = 2;
+  double mEtaMin = 0.;
+  double mEtaScale = 1.;
+  double mPhiMin = 0.;
+  double mPhiScale = 1.;
+};
+
+} // namespace o2::analysis::ebyefluctuations
+
+#endif // PWGCF_EBYEFLUCTUATIONS_CORE_FACTORIALMOMENTSGRID_H_
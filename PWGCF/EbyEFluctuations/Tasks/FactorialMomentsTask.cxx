@@ -18,6 +18,7 @@
 #include <TH1F.h>
 #include "TRandom.h"
 // O2 includes
+#include "PWGCF/EbyEFluctuations/Core/FactorialMomentsGrid.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
@@ -33,6 +34,7 @@ using std::array;
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
+using o2::analysis::ebyefluctuations::FactorialMomentsGrid;
 struct FactorialMoments {
   Configurable<Float_t> confEta{"centralEta", 0.9, "eta limit for tracks"};
   Configurable<Int_t> confNumPt{"numPt", 1, "number of pT bins"};
@@ -53,6 +55,7 @@ struct FactorialMoments {
   Configurable<bool> includeGlobalTracks{"includeGlobalTracks", false, "Enable Global Tracks"};
   Configurable<bool> includeTPCTracks{"includeTPCTracks", false, "TPC Tracks"};
   Configurable<bool> includeITSTracks{"includeITSTracks", false, "ITS Tracks"};
+  Configurable<bool> useCountGrid{"useCountGrid", true, "Count the tracks in integer eta-phi grids instead of per-event TH2 histograms"};
   Filter filterTracks = (nabs(aod::track::eta) < confEta) && (aod::track::pt >= confPtMin) && (nabs(aod::track::dcaXY) < confDCAxy) && (nabs(aod::track::dcaZ) < confDCAz);
   Filter filterCollisions = (nabs(aod::collision::posZ) < confVertex.value[2]) && (nabs(aod::collision::posX) < confVertex.value[0]) && (nabs(aod::collision::posY) < confVertex.value[1]);
 
@@ -102,6 +105,7 @@ struct FactorialMoments {
   std::vector<std::shared_ptr<TH1>> mHistArrQA;
   std::vector<std::shared_ptr<TH1>> mFqBinFinal;
   std::vector<std::shared_ptr<TH1>> mBinConFinal;
+  std::vector<FactorialMomentsGrid> mCountGrids; // per pT bin, all M
   // max number of bins restricted to 5
   static constexpr array<std::string_view, 5> mbinNames{"bin1/", "bin2/", "bin3/", "bin4/", "bin5/"};
   void init(o2::framework::InitContext&)
@@ -123,7 +127,10 @@ struct FactorialMoments {
       mHistArrQA.push_back(std::get<std::shared_ptr<TH1>>(histos.add(Form("bin%i/mPt", iPt + 1), Form("pT for bin %.2f-%.2f;pT", confPtBins.value[2 * iPt], confPtBins.value[2 * iPt + 1]), HistType::kTH1F, {axisPt[iPt]})));
       mHistArrQA.push_back(std::get<std::shared_ptr<TH1>>(histos.add(Form("bin%i/mPhi", iPt + 1), Form("#phi for bin %.2f-%.2f;#phi", confPtBins.value[2 * iPt], confPtBins.value[2 * iPt + 1]), HistType::kTH1F, {{1000, 0, 2 * TMath::Pi()}})));
       mHistArrQA.push_back(std::get<std::shared_ptr<TH1>>(histos.add(Form("bin%i/mMultiplicity", iPt + 1), Form("Multiplicity for bin %.2f-%.2f;Multiplicity", confPtBins.value[2 * iPt], confPtBins.value[2 * iPt + 1]), HistType::kTH1F, {{1000, 0, 8000}})));
-      for (auto iM = 0; iM < nBins; ++iM) {
+      if (useCountGrid) {
+        mCountGrids.emplace_back().init(std::vector<int>(binningM.begin(), binningM.end()), 7, -0.8, 0.8, 0, 2 * TMath::Pi());
+      }
+      for (auto iM = 0; iM < nBins && !useCountGrid; ++iM) {
         auto mHistsR = std::get<std::shared_ptr<TH2>>(histos.add(Form("bin%i/Reset/mEtaPhi%i", iPt + 1, iM), Form("#eta#phi_%i for bin %.2f-%.2f;#eta;#phi", iM, confPtBins.value[2 * iPt], confPtBins.value[2 * iPt + 1]), HistType::kTH2F, {{binningM[iM], -0.8, 0.8}, {binningM[iM], 0, 2 * TMath::Pi()}}));
         mHistArrReset.push_back(mHistsR);
       }
@@ -151,14 +158,57 @@ struct FactorialMoments {
         mHistArrQA[iPt * 4 + 1]->Fill(track.pt());
         mHistArrQA[iPt * 4 + 2]->Fill(iphi);
         countTracks[iPt]++;
+        if (useCountGrid) {
+          mCountGrids[iPt].fill(track.eta(), track.phi());
+          continue;
+        }
         for (auto iM = 0; iM < nBins; ++iM) {
           mHistArrReset[iPt * nBins + iM]->Fill(track.eta(), track.phi());
         }
       }
     }
   }
-  void calculateMoments(std::vector<std::shared_ptr<TH2>> hist)
+  void resetCounts()
+  {
+    for (auto& grid : mCountGrids) {
+      grid.reset();
+    }
+    for (auto const& h : mHistArrReset) {
+      h->Reset();
+    }
+  }
+  void fillMoments(int iPt, int iM, Double_t binContent, const Double_t* sumfqBin)
   {
+    binConEvent[iPt][iM] = binContent / (TMath::Power(binningM[iM], 2));
+    for (auto iOrder = 0; iOrder < 6; ++iOrder) {
+      if (sumfqBin[iOrder] > 0) {
+        fqEvent[iOrder][iPt][iM] = sumfqBin[iOrder] / (TMath::Power(binningM[iM], 2));
+      }
+      mFqBinFinal[iPt * 6 + iOrder]->Fill(iM, fqEvent[iOrder][iPt][iM]);
+      mBinConFinal[iPt * 6 + iOrder]->Fill(iM, binConEvent[iPt][iM]);
+    }
+  }
+  // same moments as calculateMoments from the integer count grids
+  void calculateMomentsGrid()
+  {
+    for (auto iPt = 0; iPt < confNumPt; ++iPt) {
+      auto& grid = mCountGrids[iPt];
+      grid.compute();
+      for (auto iM = 0; iM < nBins; ++iM) {
+        Double_t sumfqBin[6] = {0};
+        for (auto iOrder = 0; iOrder < 6; ++iOrder) {
+          sumfqBin[iOrder] = grid.getSumFq(iM, iOrder + 2);
+        }
+        fillMoments(iPt, iM, grid.getSumCounts(iM), sumfqBin);
+      }
+    }
+  }
+  void calculateMoments(std::vector<std::shared_ptr<TH2>> const& hist)
+  {
+    if (useCountGrid) {
+      calculateMomentsGrid();
+      return;
+    }
     Double_t binContent = 0;
     // Calculate the normalized factorial moments
     for (auto iPt = 0; iPt < confNumPt; ++iPt) {
@@ -183,14 +233,7 @@ struct FactorialMoments {
             }
           }
         }
-        binConEvent[iPt][iM] = binContent / (TMath::Power(binningM[iM], 2));
-        for (auto iOrder = 0; iOrder < 6; ++iOrder) {
-          if (sumfqBin[iOrder] > 0) {
-            fqEvent[iOrder][iPt][iM] = sumfqBin[iOrder] / (TMath::Power(binningM[iM], 2));
-          }
-          mFqBinFinal[iPt * 6 + iOrder]->Fill(iM, fqEvent[iOrder][iPt][iM]);
-          mBinConFinal[iPt * 6 + iOrder]->Fill(iM, binConEvent[iPt][iM]);
-        }
+        fillMoments(iPt, iM, binContent, sumfqBin);
       } // end of loop over M bins
     } // end of loop over pT bins
   }
@@ -221,9 +264,7 @@ struct FactorialMoments {
     histos.fill(HIST("mCentFV0A"), coll.centFV0A());
     histos.fill(HIST("mCentFT0A"), coll.centFT0A());
     histos.fill(HIST("mCentFT0C"), coll.centFT0C());
-    for (auto const& h : mHistArrReset) {
-      h->Reset();
-    }
+    resetCounts();
     countTracks = {0, 0, 0, 0, 0};
     fqEvent = {{{{{0, 0, 0, 0, 0, 0}}}}};
     binConEvent = {{{0, 0, 0, 0, 0}}};
@@ -276,9 +317,7 @@ struct FactorialMoments {
     histos.fill(HIST("mVertexZ"), coll.posZ());
     histos.fill(HIST("mCentFT0M"), coll.centRun2V0M());
 
-    for (auto const& h : mHistArrReset) {
-      h->Reset();
-    }
+    resetCounts();
 
     countTracks = {0, 0, 0, 0, 0};
     fqEvent = {{{{{0, 0, 0, 0, 0, 0}}}}};
@@ -13,6 +13,8 @@
 /// \brief Task for analyzing efficiency of proton, and net-proton distributions in MC reconstructed and generated, and calculating net-proton cumulants
 /// \author Swati Saha
 
+#include "PWGCF/EbyEFluctuations/Core/EfficiencyCorrectedCumulants.h"
+
 #include "Common/Core/TrackSelection.h"
 #include "Common/Core/trackUtilities.h"
 #include "Common/DataModel/Centrality.h"
@@ -61,6 +63,7 @@
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
+using namespace o2::analysis::ebyefluctuations;
 
 struct NetprotonCumulantsMc {
   // events
@@ -89,6 +92,8 @@ struct NetprotonCumulantsMc {
   Configurable<int> cfgNSubsample{"cfgNSubsample", 10, "Number of subsamples for ERR"};
   Configurable<bool> cfgIsCalculateCentral{"cfgIsCalculateCentral", true, "Calculate Central value"};
   Configurable<bool> cfgIsCalculateError{"cfgIsCalculateError", false, "Calculate Error"};
+  Configurable<bool> cfgFillCumulantSums{"cfgFillCumulantSums", false, "Fill the sums of the efficiency-corrected cumulant engine (net-proton, proton, antiproton)"};
+  Configurable<bool> cfgCumulantBootstrap{"cfgCumulantBootstrap", false, "Errors of the cumulant sums from cfgNSubsample bootstrap replicas instead of subsamples"};
 
   // Efficiencies
   Configurable<std::vector<float>> cfgPtBins{"cfgPtBins", {0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0, 1.1, 1.2, 1.3, 1.4, 1.5, 1.6, 1.7, 1.8, 1.9, 2.0}, "Pt Bins for Efficiency of protons"};
@@ -113,6 +118,13 @@ struct NetprotonCumulantsMc {
 
   TRandom3* fRndm = new TRandom3(0);
 
+  // efficiency-corrected cumulants up to 6th order, in one TH3D each
+  static constexpr int CumulantOrder = 6;
+  using CumulantSums = EfficiencyCorrectedCumulants<CumulantOrder>;
+  CumulantSums netprotonCumulants;
+  CumulantSums protonCumulants;
+  CumulantSums antiprotonCumulants;
+
   // Eff histograms 2d: eff(pT, eta)
   TH2F* hRatio2DEtaVsPtProton = nullptr;
   TH2F* hRatio2DEtaVsPtAntiproton = nullptr;
@@ -213,6 +225,15 @@ struct NetprotonCumulantsMc {
     histos.add("h2DnsigmaTofVsPt", "2D hist of nSigmaTOF vs. pT", kTH2F, {ptAxis, nSigmaAxis});
     histos.add("h2DnsigmaItsVsPt", "2D hist of nSigmaITS vs. pT", kTH2F, {ptAxis, nSigmaAxis});
 
+    if (cfgFillCumulantSums) {
+      AxisSpec termAxis = {CumulantSums::NTerms, -0.5, CumulantSums::NTerms - 0.5, "term"};
+      AxisSpec sampleAxis = {noSubsample + 1, -0.5, noSubsample + 0.5, "sample"};
+      const ErrorMode errorMode = cfgCumulantBootstrap ? ErrorMode::kBootstrap : ErrorMode::kSubsamples;
+      netprotonCumulants.bind(histos.add<TH3>("CumulantSums/hNetproton", "", kTH3D, {termAxis, sampleAxis, centAxis}), errorMode, 1);
+      protonCumulants.bind(histos.add<TH3>("CumulantSums/hProton", "", kTH3D, {termAxis, sampleAxis, centAxis}), errorMode, 2);
+      antiprotonCumulants.bind(histos.add<TH3>("CumulantSums/hAntiproton", "", kTH3D, {termAxis, sampleAxis, centAxis}), errorMode, 3);
+    }
+
     if (cfgIsCalculateCentral) {
       // uncorrected
       histos.add("Prof_mu1_netproton", "", {HistType::kTProfile, {centAxis}});
@@ -937,6 +958,30 @@ struct NetprotonCumulantsMc {
     }
   }
 
+  void startCumulantEvent()
+  {
+    netprotonCumulants.startEvent();
+    protonCumulants.startEvent();
+    antiprotonCumulants.startEvent();
+  }
+
+  void addCumulantParticle(int sign, float eff)
+  {
+    netprotonCumulants.addParticle(sign, eff);
+    if (sign > 0) {
+      protonCumulants.addParticle(1., eff);
+    } else {
+      antiprotonCumulants.addParticle(1., eff);
+    }
+  }
+
+  void fillCumulantEvent(float cent)
+  {
+    netprotonCumulants.fillEvent(cent);
+    protonCumulants.fillEvent(cent);
+    antiprotonCumulants.fillEvent(cent);
+  }
+
   void processMCGen(aod::McCollision const& mcCollision, aod::McParticles const& mcParticles, const soa::SmallGroups<EventCandidatesMC>& collisions)
   {
     histos.fill(HIST("hMC"), 0.5);
@@ -1096,6 +1141,9 @@ struct NetprotonCumulantsMc {
     std::array<float, 7> powerEffAntiprot = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
     std::array<float, 7> fTCP0 = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
     std::array<float, 7> fTCP1 = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (cfgFillCumulantSums) {
+      startCumulantEvent();
+    }
 
     o2::aod::ITSResponse itsResponse;
 
@@ -1176,6 +1224,9 @@ struct NetprotonCumulantsMc {
                   powerEffProt[i] += std::pow(1.0 / pEff, i);
                 }
               }
+              if (cfgFillCumulantSums) {
+                addCumulantParticle(1, pEff);
+              }
             }
             if (particle.pdgCode() == PDG_t::kProton) {
               histos.fill(HIST("hrecTruePtProton"), particle.pt()); //! hist for p purity
@@ -1198,6 +1249,9 @@ struct NetprotonCumulantsMc {
                   powerEffAntiprot[i] += std::pow(1.0 / pEff, i);
                 }
               }
+              if (cfgFillCumulantSums) {
+                addCumulantParticle(-1, pEff);
+              }
             }
             if (particle.pdgCode() == PDG_t::kProtonBar) {
               histos.fill(HIST("hrecTruePtAntiproton"), particle.pt()); //! hist for anti-p purity
@@ -1208,6 +1262,9 @@ struct NetprotonCumulantsMc {
     } //! end track loop
 
     float netProt = nProt - nAntiprot;
+    if (cfgFillCumulantSums) {
+      fillCumulantEvent(cent);
+    }
     histos.fill(HIST("hrecNetProtonVsCentrality"), netProt, cent);
     histos.fill(HIST("hrecProtonVsCentrality"), nProt, cent);
     histos.fill(HIST("hrecAntiprotonVsCentrality"), nAntiprot, cent);
@@ -2043,6 +2100,9 @@ struct NetprotonCumulantsMc {
     std::array<float, 7> powerEffAntiprot = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
     std::array<float, 7> fTCP0 = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
     std::array<float, 7> fTCP1 = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (cfgFillCumulantSums) {
+      startCumulantEvent();
+    }
 
     o2::aod::ITSResponse itsResponse;
 
@@ -2113,6 +2173,9 @@ struct NetprotonCumulantsMc {
                 powerEffProt[i] += std::pow(1.0 / pEff, i);
               }
             }
+            if (cfgFillCumulantSums) {
+              addCumulantParticle(1, pEff);
+            }
           }
         }
         // for anti-protons
@@ -2131,6 +2194,9 @@ struct NetprotonCumulantsMc {
                 powerEffAntiprot[i] += std::pow(1.0 / pEff, i);
               }
             }
+            if (cfgFillCumulantSums) {
+              addCumulantParticle(-1, pEff);
+            }
           }
         }
 
@@ -2138,6 +2204,9 @@ struct NetprotonCumulantsMc {
     } //! end track loop
 
     float netProt = nProt - nAntiprot;
+    if (cfgFillCumulantSums) {
+      fillCumulantEvent(cent);
+    }
     histos.fill(HIST("hrecNetProtonVsCentrality"), netProt, cent);
     histos.fill(HIST("hrecProtonVsCentrality"), nProt, cent);
     histos.fill(HIST("hrecAntiprotonVsCentrality"), nAntiprot, cent);
@@ -555,6 +555,11 @@ class DielectronCut : public TNamed
 
   // Getters
   bool IsPhotonConversionSelected() const { return mSelectPC; }
+  float GetMinMee() const { return mMinMee; }
+  float GetMaxMee() const { return mMaxMee; }
+  float GetMinPairY() const { return mMinPairY; }
+  float GetMaxPairY() const { return mMaxPairY; }
+  bool IsDifferentSidesRequired() const { return mRequireDiffSides; }
 
  private:
   static const std::pair<int8_t, std::set<uint8_t>> its_ib_any_Requirement;
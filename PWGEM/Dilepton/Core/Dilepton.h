@@ -21,12 +21,14 @@
 #include "PWGEM/Dilepton/Core/DimuonCut.h"
 #include "PWGEM/Dilepton/Core/EMEventCut.h"
 #include "PWGEM/Dilepton/DataModel/dileptonTables.h"
+#include "PWGEM/Dilepton/Utils/DileptonPairKernel.h"
 #include "PWGEM/Dilepton/Utils/EMFwdTrack.h"
 #include "PWGEM/Dilepton/Utils/EMTrack.h"
 #include "PWGEM/Dilepton/Utils/EMTrackUtilities.h"
 #include "PWGEM/Dilepton/Utils/EventHistograms.h"
 #include "PWGEM/Dilepton/Utils/EventMixingHandler.h"
 #include "PWGEM/Dilepton/Utils/MlResponseDielectronSingleTrack.h"
+#include "PWGEM/Dilepton/Utils/PairMixingPool.h"
 #include "PWGEM/Dilepton/Utils/PairUtilities.h"
 
 #include "Common/CCDB/RCTSelectionFlags.h"
@@ -56,7 +58,6 @@
 #include <iterator>
 #include <map>
 #include <random>
-#include <ranges>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -89,7 +90,7 @@ using FilteredMyMuon = FilteredMyMuons::iterator;
 
 using MyEMH_electron = o2::aod::pwgem::dilepton::utils::EventMixingHandler<std::tuple<int, int, int, int>, std::pair<int, int>, EMTrack>;
 using MyEMH_muon = o2::aod::pwgem::dilepton::utils::EventMixingHandler<std::tuple<int, int, int, int>, std::pair<int, int>, EMFwdTrack>;
-using MyEMH_pair = o2::aod::pwgem::dilepton::utils::EventMixingHandler<std::tuple<int, int, int, int>, std::pair<int, int>, std::tuple<int, int, int, int, EMPair>>;
+using MyEMH_pair = o2::aod::pwgem::dilepton::utils::PairMixingPool<std::tuple<int, int, int, int>, std::pair<int, int>, EMPairRecord>;
 
 template <o2::aod::pwgem::dilepton::utils::pairutil::DileptonPairType pairtype, typename TEMH, typename... Types>
 struct Dilepton {
@@ -113,6 +114,7 @@ struct Dilepton {
   Configurable<float> cfgCentMax{"cfgCentMax", 999.f, "max. centrality"};
   Configurable<bool> cfgDoMix{"cfgDoMix", true, "flag for event mixing"};
   Configurable<int> ndepth{"ndepth", 100, "depth for event mixing"};
+  Configurable<bool> cfgUsePairKernel{"cfgUsePairKernel", false, "flag to evaluate track cuts once per track and pre-select same-event pairs in blocks"};
   Configurable<uint64_t> ndiff_bc_mix{"ndiff_bc_mix", 594, "difference in global BC required in mixed events"};
   ConfigurableAxis ConfVtxBins{"ConfVtxBins", {VARIABLE_WIDTH, -10.0f, -8.f, -6.f, -4.f, -2.f, 0.f, 2.f, 4.f, 6.f, 8.f, 10.f}, "Mixing bins - z-vertex"};
   ConfigurableAxis ConfCentBins{"ConfCentBins", {VARIABLE_WIDTH, 0.0f, 5.0f, 10.0f, 20.0f, 30.0f, 40.0f, 50.0f, 60.0f, 70.0f, 80.0f, 90.0f, 100.f, 999.f}, "Mixing bins - centrality"};
@@ -313,6 +315,7 @@ struct Dilepton {
   HistogramRegistry fRegistry{"output", {}, OutputObjHandlingPolicy::AnalysisObject, false, false};
   // static constexpr std::string_view event_cut_types[2] = {"before/", "after/"};
   static constexpr std::string_view event_pair_types[2] = {"same/", "mix/"};
+  static constexpr std::string_view pair_sign_types[3] = {"uls/", "lspp/", "lsmm/"};
 
   std::mt19937 engine;
   std::vector<float> cent_bin_edges;
@@ -973,10 +976,10 @@ struct Dilepton {
     }
   }
 
-  template <int ev_id, typename TCollision, typename TTrack1, typename TTrack2, typename TCut, typename TAllTracks>
+  template <int ev_id, bool isTrackSelected = false, typename TCollision, typename TTrack1, typename TTrack2, typename TCut, typename TAllTracks>
   bool fillPairInfo(TCollision const& collision, TTrack1 const& t1, TTrack2 const& t2, TCut const& cut, TAllTracks const& tracks)
   {
-    if constexpr (ev_id == 0) {
+    if constexpr (ev_id == 0 && !isTrackSelected) { // single-track cuts already applied by the pairing kernel otherwise
       if constexpr (pairtype == o2::aod::pwgem::dilepton::utils::pairutil::DileptonPairType::kDielectron) {
         if (dielectroncuts.cfg_pid_scheme == static_cast<int>(DielectronCut::PIDSchemes::kPIDML)) {
           if (!cut.template IsSelectedTrack<false>(t1) || !cut.template IsSelectedTrack<false>(t2)) {
@@ -1215,13 +1218,7 @@ struct Dilepton {
         }
 
         auto key_df_collision = std::make_pair(ndf, collision.globalIndex());
-        float phi12_tmp = v12.Phi();
-        o2::math_utils::bringTo02Pi(phi12_tmp);
-        EMPair empair = EMPair(v12.Pt(), v12.Eta(), phi12_tmp, v12.M(), t1.sign() + t2.sign());
-        empair.setPositiveLegPxPyPzM(arrD[0], arrD[1], arrD[2], leptonM1);
-        // empair.setNegativeLegPtEtaPhiM(t2.pt(), t2.eta(), t2.phi(), leptonM2);
-        empair.setPairDCA(pair_dca);
-        auto pair_tmp = std::make_tuple(mbin, ptbin, etabin, phibin, empair);
+        EMPairRecord pair_tmp{static_cast<float>(v12.Pt()), static_cast<float>(v12.Eta()), phi12, static_cast<float>(v12.M()), pair_dca, arrD[0], arrD[1], arrD[2], getPairMixingBin(mbin, ptbin, etabin, phibin)};
         if (t1.sign() * t2.sign() < 0) { // ULS
           emh_pair_uls->AddTrackToEventPool(key_df_collision, pair_tmp);
         } else if (t1.sign() > 0 && t2.sign() > 0) { // LS++
@@ -1356,6 +1353,97 @@ struct Dilepton {
   std::vector<int> used_trackIds_per_col;
   int ndf = 0;
 
+  o2::aod::pwgem::dilepton::utils::pairkernel::LeptonArrays posLeptons, negLeptons;
+  std::vector<uint8_t> preselected_pairs;
+
+  template <typename TLeptonsPerColl, typename TCut, typename TAllTracks>
+  void stageLeptons(TLeptonsPerColl const& tracks_per_coll, TCut const& cut, TAllTracks const& tracks, o2::aod::pwgem::dilepton::utils::pairkernel::LeptonArrays& leptons, std::vector<typename TLeptonsPerColl::iterator>& iterators)
+  {
+    leptons.clear();
+    iterators.clear();
+    for (const auto& track : tracks_per_coll) {
+      uint8_t bits = 0;
+      if (cut.template IsSelectedTrack<false>(track)) {
+        bits |= o2::aod::pwgem::dilepton::utils::pairkernel::kSelectedTrack;
+        if constexpr (pairtype == o2::aod::pwgem::dilepton::utils::pairutil::DileptonPairType::kDimuon) {
+          if (o2::aod::pwgem::dilepton::utils::emtrackutil::isBestMatch(track, cut, tracks)) {
+            bits |= o2::aod::pwgem::dilepton::utils::pairkernel::kBestMatch;
+          }
+        }
+      }
+      leptons.add(track.pt(), track.eta(), track.phi(), leptonM1, bits);
+      iterators.emplace_back(track);
+    }
+  }
+
+  // same-event pairing of a collision: the single-track cuts are evaluated once per track and the pairs are pre-selected with the cheap pair cuts before fillPairInfo
+  template <typename TCollision, typename TLeptonsPerColl, typename TCut, typename TAllTracks>
+  void runPairingKernel(TCollision const& collision, TLeptonsPerColl const& posTracks_per_coll, TLeptonsPerColl const& negTracks_per_coll, TCut const& cut, TAllTracks const& tracks, int& nuls, int& nlspp, int& nlsmm)
+  {
+    std::vector<typename TLeptonsPerColl::iterator> posIterators, negIterators;
+    stageLeptons(posTracks_per_coll, cut, tracks, posLeptons, posIterators);
+    stageLeptons(negTracks_per_coll, cut, tracks, negLeptons, negIterators);
+
+    o2::aod::pwgem::dilepton::utils::pairkernel::PairWindow window;
+    if constexpr (pairtype == o2::aod::pwgem::dilepton::utils::pairutil::DileptonPairType::kDielectron) {
+      window = o2::aod::pwgem::dilepton::utils::pairkernel::PairWindow::make(cut.GetMinMee(), cut.GetMaxMee(), cut.GetMinPairY(), cut.GetMaxPairY(), cut.IsDifferentSidesRequired());
+    } else if constexpr (pairtype == o2::aod::pwgem::dilepton::utils::pairutil::DileptonPairType::kDimuon) {
+      window = o2::aod::pwgem::dilepton::utils::pairkernel::PairWindow::make(cut.GetMinMass(), cut.GetMaxMass(), cut.GetMinPairY(), cut.GetMaxPairY(), false, o2::aod::pwgem::dilepton::utils::pairkernel::kSelectedTrack | o2::aod::pwgem::dilepton::utils::pairkernel::kBestMatch);
+    }
+
+    // same order of pairs as CombinationsFullIndexPolicy and CombinationsStrictlyUpperIndexPolicy
+    auto runBlocks = [&](o2::aod::pwgem::dilepton::utils::pairkernel::LeptonArrays const& leptons1, auto const& iterators1, o2::aod::pwgem::dilepton::utils::pairkernel::LeptonArrays const& leptons2, auto const& iterators2, bool isStrictlyUpper, int& npair) {
+      for (std::size_t i = 0; i < leptons1.size(); i++) {
+        if (!(leptons1.bits[i] & o2::aod::pwgem::dilepton::utils::pairkernel::kSelectedTrack)) {
+          continue;
+        }
+        const std::size_t first = isStrictlyUpper ? i + 1 : 0;
+        o2::aod::pwgem::dilepton::utils::pairkernel::preselectPairs(leptons1, i, leptons2, first, leptons2.size(), window, preselected_pairs);
+        for (std::size_t j = first; j < leptons2.size(); j++) {
+          if (preselected_pairs[j - first] && fillPairInfo<0, true>(collision, iterators1[i], iterators2[j], cut, tracks)) {
+            npair++;
+          }
+        }
+      }
+    };
+    runBlocks(posLeptons, posIterators, negLeptons, negIterators, false, nuls); // ULS
+    runBlocks(posLeptons, posIterators, posLeptons, posIterators, true, nlspp); // LS++
+    runBlocks(negLeptons, negIterators, negLeptons, negIterators, true, nlsmm); // LS--
+  }
+
+  uint32_t getPairMixingBin(int mbin, int ptbin, int etabin, int phibin) const
+  {
+    const uint32_t nptbin = ptll_bin_edges.size() - 1, netabin = etall_bin_edges.size() - 1, nphibin = phill_bin_edges.size() - 1;
+    return ((mbin * nptbin + ptbin) * netabin + etabin) * nphibin + phibin;
+  }
+
+  // pair-level mixing for polarization: pairs of the current event with pairs in the same (mass, pT, eta, phi) bin from the event pool
+  template <int sign_id>
+  void mixPairs(MyEMH_pair* emh, std::tuple<int, int, int, int> const& key_bin, std::pair<int, int> const& key_df_collision)
+  {
+    float weight = 1.f;
+    const auto& events_in_mixing_pool = emh->GetEventsFromEventPool(key_bin);
+    for (const auto& pair1 : emh->GetTracksPerCollision(key_df_collision)) {
+      auto arrD = std::array<float, 4>{pair1.pxLeg(), pair1.pyLeg(), pair1.pzLeg(), leptonM1};
+      const float rapidity1 = pair1.rapidity();
+      for (const auto& event : events_in_mixing_pool) {
+        for (const auto& pair2 : emh->GetTracksPerCollision(key_bin, event, pair1.bin())) {
+          auto arrM = std::array<float, 4>{pair2.px(), pair2.py(), pair2.pz(), pair2.mass()};
+
+          float cos_thetaPol = 999, phiPol = 999.f;
+          if (cfgPolarizationFrame == 0) {
+            o2::aod::pwgem::dilepton::utils::pairutil::getAngleCS(arrM, arrD, beamE1, beamE2, beamP1, beamP2, cos_thetaPol, phiPol);
+          } else if (cfgPolarizationFrame == 1) {
+            o2::aod::pwgem::dilepton::utils::pairutil::getAngleHX(arrM, arrD, beamE1, beamE2, beamP1, beamP2, cos_thetaPol, phiPol);
+          }
+          o2::math_utils::bringToPMPi(phiPol);
+          float quadmom = (3.f * std::pow(cos_thetaPol, 2) - 1.f) / 2.f;
+          fRegistry.fill(HIST("Pair/mix/") + HIST(pair_sign_types[sign_id]) + HIST("hsAcc"), pair1.mass(), pair1.pt(), pair1.getPairDCA(), rapidity1, cos_thetaPol, phiPol, quadmom, weight);
+        }
+      }
+    }
+  }
+
   template <bool isTriggerAnalysis, typename TCollisions, typename TLeptons, typename TPresilce, typename TCut, typename TAllTracks>
   void runPairing(TCollisions const& collisions, TLeptons const& posTracks, TLeptons const& negTracks, TPresilce const& perCollision, TCut const& cut, TAllTracks const& tracks)
   {
@@ -1437,22 +1525,26 @@ struct Dilepton {
 
       used_trackIds_per_col.reserve(posTracks_per_coll.size() + negTracks_per_coll.size());
       int nuls = 0, nlspp = 0, nlsmm = 0;
-      for (const auto& [pos, neg] : combinations(CombinationsFullIndexPolicy(posTracks_per_coll, negTracks_per_coll))) { // ULS
-        bool is_pair_ok = fillPairInfo<0>(collision, pos, neg, cut, tracks);
-        if (is_pair_ok) {
-          nuls++;
+      if (cfgUsePairKernel) {
+        runPairingKernel(collision, posTracks_per_coll, negTracks_per_coll, cut, tracks, nuls, nlspp, nlsmm);
+      } else {
+        for (const auto& [pos, neg] : combinations(CombinationsFullIndexPolicy(posTracks_per_coll, negTracks_per_coll))) { // ULS
+          bool is_pair_ok = fillPairInfo<0>(collision, pos, neg, cut, tracks);
+          if (is_pair_ok) {
+            nuls++;
+          }
         }
-      }
-      for (const auto& [pos1, pos2] : combinations(CombinationsStrictlyUpperIndexPolicy(posTracks_per_coll, posTracks_per_coll))) { // LS++
-        bool is_pair_ok = fillPairInfo<0>(collision, pos1, pos2, cut, tracks);
-        if (is_pair_ok) {
-          nlspp++;
+        for (const auto& [pos1, pos2] : combinations(CombinationsStrictlyUpperIndexPolicy(posTracks_per_coll, posTracks_per_coll))) { // LS++
+          bool is_pair_ok = fillPairInfo<0>(collision, pos1, pos2, cut, tracks);
+          if (is_pair_ok) {
+            nlspp++;
+          }
         }
-      }
-      for (const auto& [neg1, neg2] : combinations(CombinationsStrictlyUpperIndexPolicy(negTracks_per_coll, negTracks_per_coll))) { // LS--
-        bool is_pair_ok = fillPairInfo<0>(collision, neg1, neg2, cut, tracks);
-        if (is_pair_ok) {
-          nlsmm++;
+        for (const auto& [neg1, neg2] : combinations(CombinationsStrictlyUpperIndexPolicy(negTracks_per_coll, negTracks_per_coll))) { // LS--
+          bool is_pair_ok = fillPairInfo<0>(collision, neg1, neg2, cut, tracks);
+          if (is_pair_ok) {
+            nlsmm++;
+          }
         }
       }
       used_trackIds_per_col.clear();
@@ -1556,171 +1648,9 @@ struct Dilepton {
       } // end of loop over mixed event pool
 
       if (cfgAnalysisType == static_cast<int>(o2::aod::pwgem::dilepton::utils::pairutil::DileptonAnalysisType::kPolarization)) { // only for polarization
-        auto selected_pairs_uls_in_this_event = emh_pair_uls->GetTracksPerCollision(key_df_collision);
-        auto selected_pairs_lspp_in_this_event = emh_pair_lspp->GetTracksPerCollision(key_df_collision);
-        auto selected_pairs_lsmm_in_this_event = emh_pair_lsmm->GetTracksPerCollision(key_df_collision);
-        auto collisionIds_in_mixing_pool = emh_pair_uls->GetCollisionIdsFromEventPool(key_bin);
-        float weight = 1.f;
-
-        for (const auto& mix_dfId_collisionId : collisionIds_in_mixing_pool) {
-          auto pairs_uls_from_event_pool = emh_pair_uls->GetTracksPerCollision(mix_dfId_collisionId);
-          auto pairs_lspp_from_event_pool = emh_pair_lspp->GetTracksPerCollision(mix_dfId_collisionId);
-          auto pairs_lsmm_from_event_pool = emh_pair_lsmm->GetTracksPerCollision(mix_dfId_collisionId);
-
-          for (const auto& pair1 : selected_pairs_uls_in_this_event) { // ULS mix
-            auto empair1 = std::get<4>(pair1);
-            auto v_pos = empair1.getPositiveLeg(); // pt, eta, phi, M
-            // auto v_neg = empair1.getNegativeLeg(); // pt, eta, phi, M
-            auto arrD = std::array<float, 4>{static_cast<float>(v_pos.Px()), static_cast<float>(v_pos.Py()), static_cast<float>(v_pos.Pz()), leptonM1};
-
-            int mbin = lower_bound(mll_bin_edges.begin(), mll_bin_edges.end(), empair1.mass()) - mll_bin_edges.begin() - 1;
-            if (mbin < 0) {
-              mbin = 0;
-            } else if (static_cast<int>(mll_bin_edges.size()) - 2 < mbin) {
-              mbin = static_cast<int>(mll_bin_edges.size()) - 2;
-            }
-
-            int ptbin = lower_bound(ptll_bin_edges.begin(), ptll_bin_edges.end(), empair1.pt()) - ptll_bin_edges.begin() - 1;
-            if (ptbin < 0) {
-              ptbin = 0;
-            } else if (static_cast<int>(ptll_bin_edges.size()) - 2 < ptbin) {
-              ptbin = static_cast<int>(ptll_bin_edges.size()) - 2;
-            }
-
-            int etabin = lower_bound(etall_bin_edges.begin(), etall_bin_edges.end(), empair1.eta()) - etall_bin_edges.begin() - 1;
-            if (etabin < 0) {
-              etabin = 0;
-            } else if (static_cast<int>(etall_bin_edges.size()) - 2 < etabin) {
-              etabin = static_cast<int>(etall_bin_edges.size()) - 2;
-            }
-
-            int phibin = lower_bound(phill_bin_edges.begin(), phill_bin_edges.end(), empair1.phi()) - phill_bin_edges.begin() - 1;
-            if (phibin < 0) {
-              phibin = 0;
-            } else if (static_cast<int>(phill_bin_edges.size()) - 2 < phibin) {
-              phibin = static_cast<int>(phill_bin_edges.size()) - 2;
-            }
-
-            for (const auto& pair2 : std::views::filter(pairs_uls_from_event_pool, [&mbin, &ptbin, &etabin, &phibin](std::tuple<int, int, int, int, EMPair> t) { return std::get<0>(t) == mbin && std::get<1>(t) == ptbin && std::get<2>(t) == etabin && std::get<3>(t) == phibin; })) {
-              auto empair2 = std::get<4>(pair2);
-              auto arrM = std::array<float, 4>{static_cast<float>(empair2.px()), static_cast<float>(empair2.py()), static_cast<float>(empair2.pz()), static_cast<float>(empair2.mass())};
-
-              float cos_thetaPol = 999, phiPol = 999.f;
-              if (cfgPolarizationFrame == 0) {
-                o2::aod::pwgem::dilepton::utils::pairutil::getAngleCS(arrM, arrD, beamE1, beamE2, beamP1, beamP2, cos_thetaPol, phiPol);
-              } else if (cfgPolarizationFrame == 1) {
-                o2::aod::pwgem::dilepton::utils::pairutil::getAngleHX(arrM, arrD, beamE1, beamE2, beamP1, beamP2, cos_thetaPol, phiPol);
-              }
-              o2::math_utils::bringToPMPi(phiPol);
-              float quadmom = (3.f * std::pow(cos_thetaPol, 2) - 1.f) / 2.f;
-              fRegistry.fill(HIST("Pair/mix/uls/hsAcc"), empair1.mass(), empair1.pt(), empair1.getPairDCA(), empair1.rapidity(), cos_thetaPol, phiPol, quadmom, weight);
-            }
-          } // end of ULS
-
-          for (const auto& pair1 : selected_pairs_lspp_in_this_event) { // LS++
-            auto empair1 = std::get<4>(pair1);
-            auto v_pos = empair1.getPositiveLeg(); // pt, eta, phi, M
-            // auto v_neg = empair1.getNegativeLeg(); // pt, eta, phi, M
-            // auto arrD = +1 * v_pos.Pt() > +1 * v_neg.Pt() ? std::array<float, 4>{static_cast<float>(v_pos.Px()), static_cast<float>(v_pos.Py()), static_cast<float>(v_pos.Pz()), leptonM1} : std::array<float, 4>{static_cast<float>(v_neg.Px()), static_cast<float>(v_neg.Py()), static_cast<float>(v_neg.Pz()), leptonM2};
-            auto arrD = std::array<float, 4>{static_cast<float>(v_pos.Px()), static_cast<float>(v_pos.Py()), static_cast<float>(v_pos.Pz()), leptonM1};
-
-            int mbin = lower_bound(mll_bin_edges.begin(), mll_bin_edges.end(), empair1.mass()) - mll_bin_edges.begin() - 1;
-            if (mbin < 0) {
-              mbin = 0;
-            } else if (static_cast<int>(mll_bin_edges.size()) - 2 < mbin) {
-              mbin = static_cast<int>(mll_bin_edges.size()) - 2;
-            }
-
-            int ptbin = lower_bound(ptll_bin_edges.begin(), ptll_bin_edges.end(), empair1.pt()) - ptll_bin_edges.begin() - 1;
-            if (ptbin < 0) {
-              ptbin = 0;
-            } else if (static_cast<int>(ptll_bin_edges.size()) - 2 < ptbin) {
-              ptbin = static_cast<int>(ptll_bin_edges.size()) - 2;
-            }
-
-            int etabin = lower_bound(etall_bin_edges.begin(), etall_bin_edges.end(), empair1.eta()) - etall_bin_edges.begin() - 1;
-            if (etabin < 0) {
-              etabin = 0;
-            } else if (static_cast<int>(etall_bin_edges.size()) - 2 < etabin) {
-              etabin = static_cast<int>(etall_bin_edges.size()) - 2;
-            }
-
-            int phibin = lower_bound(phill_bin_edges.begin(), phill_bin_edges.end(), empair1.phi()) - phill_bin_edges.begin() - 1;
-            if (phibin < 0) {
-              phibin = 0;
-            } else if (static_cast<int>(phill_bin_edges.size()) - 2 < phibin) {
-              phibin = static_cast<int>(phill_bin_edges.size()) - 2;
-            }
-
-            for (const auto& pair2 : std::views::filter(pairs_lspp_from_event_pool, [&mbin, &ptbin, &etabin, &phibin](std::tuple<int, int, int, int, EMPair> t) { return std::get<0>(t) == mbin && std::get<1>(t) == ptbin && std::get<2>(t) == etabin && std::get<3>(t) == phibin; })) {
-              auto empair2 = std::get<4>(pair2);
-              auto arrM = std::array<float, 4>{static_cast<float>(empair2.px()), static_cast<float>(empair2.py()), static_cast<float>(empair2.pz()), static_cast<float>(empair2.mass())};
-
-              float cos_thetaPol = 999, phiPol = 999.f;
-              if (cfgPolarizationFrame == 0) {
-                o2::aod::pwgem::dilepton::utils::pairutil::getAngleCS(arrM, arrD, beamE1, beamE2, beamP1, beamP2, cos_thetaPol, phiPol);
-              } else if (cfgPolarizationFrame == 1) {
-                o2::aod::pwgem::dilepton::utils::pairutil::getAngleHX(arrM, arrD, beamE1, beamE2, beamP1, beamP2, cos_thetaPol, phiPol);
-              }
-              o2::math_utils::bringToPMPi(phiPol);
-              float quadmom = (3.f * std::pow(cos_thetaPol, 2) - 1.f) / 2.f;
-              fRegistry.fill(HIST("Pair/mix/lspp/hsAcc"), empair1.mass(), empair1.pt(), empair1.getPairDCA(), empair1.rapidity(), cos_thetaPol, phiPol, quadmom, weight);
-            }
-          } // end of LS++
-
-          for (const auto& pair1 : selected_pairs_lsmm_in_this_event) { // LS++
-            auto empair1 = std::get<4>(pair1);
-            auto v_pos = empair1.getPositiveLeg(); // pt, eta, phi, M
-            // auto v_neg = empair1.getNegativeLeg(); // pt, eta, phi, M
-            // auto arrD = -1 * v_pos.Pt() > -1 * v_neg.Pt() ? std::array<float, 4>{static_cast<float>(v_pos.Px()), static_cast<float>(v_pos.Py()), static_cast<float>(v_pos.Pz()), leptonM1} : std::array<float, 4>{static_cast<float>(v_neg.Px()), static_cast<float>(v_neg.Py()), static_cast<float>(v_neg.Pz()), leptonM2};
-            auto arrD = std::array<float, 4>{static_cast<float>(v_pos.Px()), static_cast<float>(v_pos.Py()), static_cast<float>(v_pos.Pz()), leptonM1};
-
-            int mbin = lower_bound(mll_bin_edges.begin(), mll_bin_edges.end(), empair1.mass()) - mll_bin_edges.begin() - 1;
-            if (mbin < 0) {
-              mbin = 0;
-            } else if (static_cast<int>(mll_bin_edges.size()) - 2 < mbin) {
-              mbin = static_cast<int>(mll_bin_edges.size()) - 2;
-            }
-
-            int ptbin = lower_bound(ptll_bin_edges.begin(), ptll_bin_edges.end(), empair1.pt()) - ptll_bin_edges.begin() - 1;
-            if (ptbin < 0) {
-              ptbin = 0;
-            } else if (static_cast<int>(ptll_bin_edges.size()) - 2 < ptbin) {
-              ptbin = static_cast<int>(ptll_bin_edges.size()) - 2;
-            }
-
-            int etabin = lower_bound(etall_bin_edges.begin(), etall_bin_edges.end(), empair1.eta()) - etall_bin_edges.begin() - 1;
-            if (etabin < 0) {
-              etabin = 0;
-            } else if (static_cast<int>(etall_bin_edges.size()) - 2 < etabin) {
-              etabin = static_cast<int>(etall_bin_edges.size()) - 2;
-            }
-
-            int phibin = lower_bound(phill_bin_edges.begin(), phill_bin_edges.end(), empair1.phi()) - phill_bin_edges.begin() - 1;
-            if (phibin < 0) {
-              phibin = 0;
-            } else if (static_cast<int>(phill_bin_edges.size()) - 2 < phibin) {
-              phibin = static_cast<int>(phill_bin_edges.size()) - 2;
-            }
-
-            for (const auto& pair2 : std::views::filter(pairs_lsmm_from_event_pool, [&mbin, &ptbin, &etabin, &phibin](std::tuple<int, int, int, int, EMPair> t) { return std::get<0>(t) == mbin && std::get<1>(t) == ptbin && std::get<2>(t) == etabin && std::get<3>(t) == phibin; })) {
-              auto empair2 = std::get<4>(pair2);
-              auto arrM = std::array<float, 4>{static_cast<float>(empair2.px()), static_cast<float>(empair2.py()), static_cast<float>(empair2.pz()), static_cast<float>(empair2.mass())};
-
-              float cos_thetaPol = 999, phiPol = 999.f;
-              if (cfgPolarizationFrame == 0) {
-                o2::aod::pwgem::dilepton::utils::pairutil::getAngleCS(arrM, arrD, beamE1, beamE2, beamP1, beamP2, cos_thetaPol, phiPol);
-              } else if (cfgPolarizationFrame == 1) {
-                o2::aod::pwgem::dilepton::utils::pairutil::getAngleHX(arrM, arrD, beamE1, beamE2, beamP1, beamP2, cos_thetaPol, phiPol);
-              }
-              o2::math_utils::bringToPMPi(phiPol);
-              float quadmom = (3.f * std::pow(cos_thetaPol, 2) - 1.f) / 2.f;
-              fRegistry.fill(HIST("Pair/mix/lsmm/hsAcc"), empair1.mass(), empair1.pt(), empair1.getPairDCA(), empair1.rapidity(), cos_thetaPol, phiPol, quadmom, weight);
-            }
-          } // end of LS++
-
-        } // end of loop over mixed event pool
-
+        mixPairs<0>(emh_pair_uls, key_bin, key_df_collision);  // ULS
+        mixPairs<1>(emh_pair_lspp, key_bin, key_df_collision); // LS++
+        mixPairs<2>(emh_pair_lsmm, key_bin, key_df_collision); // LS--
       } // end of if polarization
 
       if (nuls > 0 || nlspp > 0 || nlsmm > 0) {
@@ -256,6 +256,12 @@ class DimuonCut : public TNamed
   void SetMFTHitMap(bool flag, std::vector<int> hitMap);
   void SetMaxdPtdEtadPhiwrtMCHMID(float reldPtMax, float dEtaMax, float dPhiMax); // this is relevant for global muons
 
+  // Getters
+  float GetMinMass() const { return mMinMass; }
+  float GetMaxMass() const { return mMaxMass; }
+  float GetMinPairY() const { return mMinPairY; }
+  float GetMaxPairY() const { return mMaxPairY; }
+
  private:
   // pair cuts
   float mMinMass{0.f}, mMaxMass{1e10f};
@@ -28,6 +28,7 @@
 #include <array>
 #include <chrono>
 #include <string>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -58,6 +59,7 @@ struct ApplySmearing {
   Configurable<int64_t> fTimestamp{"cfgCcdbTimestamp", 10, "valid timestamp of CCDB object"};
   Configurable<float> fCentralityForCocktail{"cfgCentralityForCocktail", 5, "average centrality for cocktail"};
   Configurable<int> cfgCentEstimator{"cfgCentEstimator", 2, "FT0M:0, FT0A:1, FT0C:2"};
+  Configurable<bool> fUseAliasSampling{"cfgUseAliasSampling", false, "sample the resolution maps from alias tables built at init, and smear the leptons of a DataFrame at once"};
 
   struct : ConfigurableGroup {
     std::string prefix = "electron_filename_group";
@@ -121,9 +123,43 @@ struct ApplySmearing {
   MomentumSmearer smearer_GlobalMuon;
   Service<ccdb::BasicCCDBManager> ccdb;
 
+  // generated leptons of a DataFrame, smeared at once with cfgUseAliasSampling
+  struct LeptonBatch {
+    std::vector<float> centrality, pt, eta, phi;
+    std::vector<int> ch;
+    std::vector<float> ptsmeared, etasmeared, phismeared;
+
+    void clear()
+    {
+      for (auto* v : {&centrality, &pt, &eta, &phi, &ptsmeared, &etasmeared, &phismeared}) {
+        v->clear();
+      }
+      ch.clear();
+    }
+
+    void add(float centralityIn, int chIn, float ptIn, float etaIn, float phiIn)
+    {
+      centrality.push_back(centralityIn);
+      ch.push_back(chIn);
+      pt.push_back(ptIn);
+      eta.push_back(etaIn);
+      phi.push_back(phiIn);
+    }
+
+    void smear(MomentumSmearer& smearer)
+    {
+      ptsmeared.resize(pt.size());
+      etasmeared.resize(pt.size());
+      phismeared.resize(pt.size());
+      smearer.applySmearing(centrality, ch, pt, eta, phi, ptsmeared, etasmeared, phismeared);
+    }
+  };
+  LeptonBatch electrons, standaloneMuons, globalMuons;
+
   void init(InitContext&)
   {
     smearer_Electron.setNDSmearing(electron_filenames.fConfigNDSmearing.value);
+    smearer_Electron.setAliasSampling(fUseAliasSampling.value);
     smearer_Electron.setResFileName(TString(electron_filenames.fConfigResFileName));
     smearer_Electron.setResNDHistName(TString(electron_filenames.fConfigResNDHistName));
     smearer_Electron.setResPtHistName(TString(electron_filenames.fConfigResPtHistName));
@@ -137,6 +173,7 @@ struct ApplySmearing {
     smearer_Electron.setMinPt(electron_filenames.fConfigMinPt);
 
     smearer_StandaloneMuon.setNDSmearing(sa_muon_filenames.fConfigNDSmearing.value);
+    smearer_StandaloneMuon.setAliasSampling(fUseAliasSampling.value);
     smearer_StandaloneMuon.setResFileName(TString(sa_muon_filenames.fConfigResFileName));
     smearer_StandaloneMuon.setResNDHistName(TString(sa_muon_filenames.fConfigResNDHistName));
     smearer_StandaloneMuon.setResPtHistName(TString(sa_muon_filenames.fConfigResPtHistName));
@@ -150,6 +187,7 @@ struct ApplySmearing {
     smearer_StandaloneMuon.setMinPt(sa_muon_filenames.fConfigMinPt);
 
     smearer_GlobalMuon.setNDSmearing(gl_muon_filenames.fConfigNDSmearing.value);
+    smearer_GlobalMuon.setAliasSampling(fUseAliasSampling.value);
     smearer_GlobalMuon.setResFileName(TString(gl_muon_filenames.fConfigResFileName));
     smearer_GlobalMuon.setResNDHistName(TString(gl_muon_filenames.fConfigResNDHistName));
     smearer_GlobalMuon.setResPtHistName(TString(gl_muon_filenames.fConfigResPtHistName));
@@ -191,9 +229,45 @@ struct ApplySmearing {
     smearer_GlobalMuon.init();
   }
 
+  template <o2::aod::pwgem::dilepton::smearing::EMAnaType type, typename TMCCollisions, typename TTrackMC, typename TCollisions>
+  float getCentrality(TTrackMC const& mctrack, TCollisions const& collisions)
+  {
+    if constexpr (type == o2::aod::pwgem::dilepton::smearing::EMAnaType::kEfficiency) {
+      auto mccollision = mctrack.template emmcevent_as<TMCCollisions>();
+      if (mccollision.mpemeventId() > 0) { // if mc collisions are not reconstructed, such mc collisions should not enter efficiency calculation.
+        auto collision = collisions.rawIteratorAt(mccollision.mpemeventId());
+        return std::array{collision.centFT0M(), collision.centFT0A(), collision.centFT0C()}[cfgCentEstimator];
+      }
+      return -1.f;
+    } else {
+      return fCentralityForCocktail;
+    }
+  }
+
   template <o2::aod::pwgem::dilepton::smearing::EMAnaType type, typename TTracksMC, typename TCollisions, typename TMCCollisions>
   void applySmearing(TTracksMC const& tracksMC, TCollisions const& collisions, TMCCollisions const&)
   {
+    if (fUseAliasSampling) {
+      // smear all the leptons first, their smeared kinematics are taken in order in the loop below
+      electrons.clear();
+      standaloneMuons.clear();
+      globalMuons.clear();
+      for (const auto& mctrack : tracksMC) {
+        int pdgCode = mctrack.pdgCode();
+        int ch = pdgCode < 0 ? 1 : -1;
+        if (std::abs(pdgCode) == 11) {
+          electrons.add(getCentrality<type, TMCCollisions>(mctrack, collisions), ch, mctrack.pt(), mctrack.eta(), mctrack.phi());
+        } else if (std::abs(pdgCode) == 13) {
+          standaloneMuons.add(getCentrality<type, TMCCollisions>(mctrack, collisions), ch, mctrack.pt(), mctrack.eta(), mctrack.phi());
+        }
+      }
+      globalMuons = standaloneMuons;
+      electrons.smear(smearer_Electron);
+      standaloneMuons.smear(smearer_StandaloneMuon);
+      globalMuons.smear(smearer_GlobalMuon);
+    }
+    std::size_t iElectron = 0, iMuon = 0;
+
     for (auto& mctrack : tracksMC) {
       float ptgen = mctrack.pt();
       float etagen = mctrack.eta();
@@ -202,20 +276,7 @@ struct ApplySmearing {
       float dca = 0.;
 
       float ptsmeared = 0, etasmeared = 0, phismeared = 0;
-      float centrality = -1.f;
-      if constexpr (type == o2::aod::pwgem::dilepton::smearing::EMAnaType::kEfficiency) {
-        auto mccollision = mctrack.template emmcevent_as<TMCCollisions>();
-        if (mccollision.mpemeventId() > 0) { // if mc collisions are not reconstructed, such mc collisions should not enter efficiency calculation.
-          auto collision = collisions.rawIteratorAt(mccollision.mpemeventId());
-          centrality = std::array{collision.centFT0M(), collision.centFT0A(), collision.centFT0C()}[cfgCentEstimator];
-        } else {
-          ptsmeared = ptgen;
-          etasmeared = etagen;
-          phismeared = phigen;
-        }
-      } else {
-        centrality = fCentralityForCocktail;
-      }
+      float centrality = getCentrality<type, TMCCollisions>(mctrack, collisions);
 
       int pdgCode = mctrack.pdgCode();
       if (std::abs(pdgCode) == 11) {
@@ -224,7 +285,14 @@ struct ApplySmearing {
           ch = 1;
         }
         // apply smearing for electrons or muons.
-        smearer_Electron.applySmearing(centrality, ch, ptgen, etagen, phigen, ptsmeared, etasmeared, phismeared);
+        if (fUseAliasSampling) {
+          ptsmeared = electrons.ptsmeared[iElectron];
+          etasmeared = electrons.etasmeared[iElectron];
+          phismeared = electrons.phismeared[iElectron];
+          iElectron++;
+        } else {
+          smearer_Electron.applySmearing(centrality, ch, ptgen, etagen, phigen, ptsmeared, etasmeared, phismeared);
+        }
         // get the efficiency
         efficiency = smearer_Electron.getEfficiency(ptgen, etagen, phigen);
         // get DCA
@@ -239,13 +307,26 @@ struct ApplySmearing {
         }
         // apply smearing for muons based on resolution map of standalone muons
         float ptsmeared_sa = 0.f, etasmeared_sa = 0.f, phismeared_sa = 0.f, efficiency_sa = 1.f, dca_sa = 0.f;
-        smearer_StandaloneMuon.applySmearing(centrality, ch, ptgen, etagen, phigen, ptsmeared_sa, etasmeared_sa, phismeared_sa);
+        if (fUseAliasSampling) {
+          ptsmeared_sa = standaloneMuons.ptsmeared[iMuon];
+          etasmeared_sa = standaloneMuons.etasmeared[iMuon];
+          phismeared_sa = standaloneMuons.phismeared[iMuon];
+        } else {
+          smearer_StandaloneMuon.applySmearing(centrality, ch, ptgen, etagen, phigen, ptsmeared_sa, etasmeared_sa, phismeared_sa);
+        }
         efficiency_sa = smearer_StandaloneMuon.getEfficiency(ptgen, etagen, phigen);
         dca_sa = smearer_StandaloneMuon.getDCA(ptsmeared_sa);
 
         float ptsmeared_gl = 0.f, etasmeared_gl = 0.f, phismeared_gl = 0.f, efficiency_gl = 1.f, dca_gl = 0.f;
         // apply smearing for muons based on resolution map of global muons
-        smearer_GlobalMuon.applySmearing(centrality, ch, ptgen, etagen, phigen, ptsmeared_gl, etasmeared_gl, phismeared_gl);
+        if (fUseAliasSampling) {
+          ptsmeared_gl = globalMuons.ptsmeared[iMuon];
+          etasmeared_gl = globalMuons.etasmeared[iMuon];
+          phismeared_gl = globalMuons.phismeared[iMuon];
+          iMuon++;
+        } else {
+          smearer_GlobalMuon.applySmearing(centrality, ch, ptgen, etagen, phigen, ptsmeared_gl, etasmeared_gl, phismeared_gl);
+        }
         efficiency_gl = smearer_GlobalMuon.getEfficiency(ptgen, etagen, phigen);
         dca_gl = smearer_GlobalMuon.getDCA(ptsmeared_gl);
         smearedmuon(ptsmeared_sa, etasmeared_sa, phismeared_sa, efficiency_sa, dca_sa, ptsmeared_gl, etasmeared_gl, phismeared_gl, efficiency_gl, dca_gl);
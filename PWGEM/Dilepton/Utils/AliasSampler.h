@@ -0,0 +1,102 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file AliasSampler.h
+/// \brief Alias table (Walker, with the construction of Vose) to sample the cells of a histogram in constant time
+/// \author agent <agent@local>
+///
+/// The table has one column per cell with a non-zero weight. A column holds its own cell with probability
+/// fProbability and the cell of its alias otherwise, so that a cell is drawn from a single uniform random
+/// number: its integer part selects the column, its fractional part decides between the cell and the alias.
+/// This replaces the binary search in the cumulative integral of TH1::GetRandom() and TH3::GetRandom3(),
+/// the position inside the cell is to be drawn uniformly as they do.
+
+#ifndef PWGEM_DILEPTON_UTILS_ALIASSAMPLER_H_
+#define PWGEM_DILEPTON_UTILS_ALIASSAMPLER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace o2::aod::pwgem::dilepton::utils
+{
+class AliasSampler
+{
+ public:
+  /// builds the table from the weights of nCells cells. Cells with a zero or negative weight are never drawn
+  void build(const double* weights, std::size_t nCells)
+  {
+    fProbability.clear();
+    fCells.clear();
+    fAliasCells.clear();
+    double sum = 0.;
+    for (std::size_t cell = 0; cell < nCells; cell++) {
+      if (weights[cell] > 0.) {
+        fCells.push_back(static_cast<uint32_t>(cell));
+        sum += weights[cell];
+      }
+    }
+    const std::size_t nColumns = fCells.size();
+    if (nColumns == 0) {
+      return;
+    }
+
+    // probabilities scaled to an average of 1, columns below 1 are completed with the excess of a column above 1
+    fProbability.resize(nColumns);
+    fAliasCells.resize(nColumns);
+    std::vector<uint32_t> small, large;
+    for (std::size_t column = 0; column < nColumns; column++) {
+      fProbability[column] = weights[fCells[column]] * nColumns / sum;
+      fAliasCells[column] = fCells[column];
+      (fProbability[column] < 1. ? small : large).push_back(static_cast<uint32_t>(column));
+    }
+    while (!small.empty() && !large.empty()) {
+      const uint32_t s = small.back();
+      const uint32_t l = large.back();
+      small.pop_back();
+      fAliasCells[s] = fCells[l];
+      fProbability[l] -= 1. - fProbability[s];
+      if (fProbability[l] < 1.) {
+        large.pop_back();
+        small.push_back(l);
+      }
+    }
+    // left-overs of the rounding are full columns
+    for (const auto column : small) {
+      fProbability[column] = 1.;
+    }
+    for (const auto column : large) {
+      fProbability[column] = 1.;
+    }
+  }
+
+  /// true if no cell has a positive weight
+  bool empty() const { return fCells.empty(); }
+
+  /// number of cells with a positive weight
+  std::size_t size() const { return fCells.size(); }
+
+  /// cell for a uniform random number u in [0, 1)
+  uint32_t sample(double u) const
+  {
+    const double x = u * fProbability.size();
+    const std::size_t column = std::min(static_cast<std::size_t>(x), fProbability.size() - 1);
+    return x - column < fProbability[column] ? fCells[column] : fAliasCells[column];
+  }
+
+ private:
+  std::vector<double> fProbability;  // probability of the own cell of each column
+  std::vector<uint32_t> fCells;      // own cell of each column
+  std::vector<uint32_t> fAliasCells; // alias cell of each column
+};
+} // namespace o2::aod::pwgem::dilepton::utils
+#endif // PWGEM_DILEPTON_UTILS_ALIASSAMPLER_H_
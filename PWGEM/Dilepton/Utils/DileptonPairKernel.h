@@ -0,0 +1,138 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file DileptonPairKernel.h
+/// \brief Per-collision pairing kernel for dileptons
+/// \author agent <agent@local>
+///
+/// The single-track cuts of Dilepton are evaluated once per lepton, not once per pair: each staged lepton
+/// carries a bitmask of the cuts it passes next to its (E, px, py, pz, eta). Before a pair reaches the full pair
+/// selection, its track bits, mass window, rapidity window and A-C sides are checked from these staged values,
+/// which rejects most of the combinatorics without building the pair four-vector objects. The windows are
+/// widened by a small tolerance, so that every pair accepted by the full selection passes the pre-selection.
+
+#ifndef PWGEM_DILEPTON_UTILS_DILEPTONPAIRKERNEL_H_
+#define PWGEM_DILEPTON_UTILS_DILEPTONPAIRKERNEL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace o2::aod::pwgem::dilepton::utils::pairkernel
+{
+enum TrackBit : uint8_t {
+  kSelectedTrack = 1 << 0, // single-track cut
+  kBestMatch = 1 << 1,     // best MFT-MCH match, only for global muons
+};
+
+/// leptons of one collision
+struct LeptonArrays {
+  std::vector<double> e, px, py, pz;
+  std::vector<float> eta;
+  std::vector<uint8_t> bits;
+
+  std::size_t size() const { return e.size(); }
+
+  void clear()
+  {
+    for (auto* v : {&e, &px, &py, &pz}) {
+      v->clear();
+    }
+    eta.clear();
+    bits.clear();
+  }
+
+  void add(float pt, float etaIn, float phi, float mass, uint8_t trackBits)
+  {
+    // same arithmetic as ROOT::Math::PtEtaPhiMVector
+    const double x = pt * std::cos(static_cast<double>(phi));
+    const double y = pt * std::sin(static_cast<double>(phi));
+    const double z = pt * std::sinh(static_cast<double>(etaIn));
+    px.push_back(x);
+    py.push_back(y);
+    pz.push_back(z);
+    e.push_back(std::sqrt(x * x + y * y + z * z + static_cast<double>(mass) * mass));
+    eta.push_back(etaIn);
+    bits.push_back(trackBits);
+  }
+};
+
+/// cheap pair cuts of the pre-selection
+struct PairWindow {
+  uint8_t requiredBits = kSelectedTrack;
+  double minMass = 0., maxMass = 1e+10;
+  double minY = -1e+10, maxY = 1e+10;
+  bool requireDiffSides = false;
+
+  static constexpr double Tolerance = 1e-5;
+
+  /// window for the mass and rapidity ranges of a pair cut
+  static PairWindow make(double minMass, double maxMass, double minY, double maxY, bool requireDiffSides, uint8_t requiredBits = kSelectedTrack)
+  {
+    PairWindow window;
+    window.requiredBits = requiredBits;
+    window.minMass = minMass * (1. - Tolerance) - Tolerance;
+    window.maxMass = maxMass * (1. + Tolerance) + Tolerance;
+    window.minY = minY - Tolerance;
+    window.maxY = maxY + Tolerance;
+    window.requireDiffSides = requireDiffSides;
+    return window;
+  }
+};
+
+/// pre-selects the pairs of lepton i of a with the leptons [first, last) of b: accepted[j - first]
+inline void preselectPairs(LeptonArrays const& a, std::size_t i, LeptonArrays const& b, std::size_t first, std::size_t last, PairWindow const& window, std::vector<uint8_t>& accepted)
+{
+  const std::size_t n = last - first;
+  accepted.resize(n);
+  if (n == 0) {
+    return;
+  }
+  const uint8_t required = window.requiredBits;
+  if ((a.bits[i] & required) != required) {
+    std::fill(accepted.begin(), accepted.end(), 0);
+    return;
+  }
+  const double e1 = a.e[i], px1 = a.px[i], py1 = a.py[i], pz1 = a.pz[i];
+  const float eta1 = a.eta[i];
+  const double minMass2 = window.minMass > 0. ? window.minMass * window.minMass : -1.;
+  const double maxMass2 = window.maxMass * window.maxMass;
+  // y in [minY, maxY] <=> pz / E in [tanh(minY), tanh(maxY)]
+  const double minBeta = std::tanh(std::max(window.minY, -50.));
+  const double maxBeta = std::tanh(std::min(window.maxY, 50.));
+  const bool requireDiffSides = window.requireDiffSides;
+  const double* e2 = b.e.data() + first;
+  const double* px2 = b.px.data() + first;
+  const double* py2 = b.py.data() + first;
+  const double* pz2 = b.pz.data() + first;
+  const float* eta2 = b.eta.data() + first;
+  const uint8_t* bits2 = b.bits.data() + first;
+  uint8_t* out = accepted.data();
+  // kinematics and track bits in separate loops, the loads of bytes and doubles do not vectorise together
+  for (std::size_t j = 0; j < n; j++) {
+    const double e = e1 + e2[j];
+    const double px = px1 + px2[j];
+    const double py = py1 + py2[j];
+    const double pz = pz1 + pz2[j];
+    const double m2 = e * e - (px * px + py * py + pz * pz);
+    const bool massOk = (m2 >= minMass2) & (m2 <= maxMass2);
+    const bool rapidityOk = (pz >= e * minBeta) & (pz <= e * maxBeta);
+    const bool sidesOk = !requireDiffSides | (eta1 * eta2[j] <= 0.f);
+    out[j] = massOk & rapidityOk & sidesOk;
+  }
+  for (std::size_t j = 0; j < n; j++) {
+    out[j] &= (bits2[j] & required) == required;
+  }
+}
+} // namespace o2::aod::pwgem::dilepton::utils::pairkernel
+#endif // PWGEM_DILEPTON_UTILS_DILEPTONPAIRKERNEL_H_
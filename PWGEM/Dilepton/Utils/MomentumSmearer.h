@@ -15,6 +15,8 @@
 #ifndef PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
 #define PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
 
+#include "PWGEM/Dilepton/Utils/AliasSampler.h"
+
 #include "CCDB/BasicCCDBManager.h"
 #include "Framework/ASoAHelpers.h"
 #include "Framework/AnalysisTask.h"
@@ -28,14 +30,19 @@
 #include <TH3.h>
 #include <THnSparse.h>
 #include <TKey.h>
+#include <TRandom.h>
 #include <TString.h>
 
+#include <array>
+#include <cstddef>
+#include <span>
 #include <vector>
 
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
 using namespace o2::soa;
+using o2::aod::pwgem::dilepton::utils::AliasSampler;
 
 class MomentumSmearer
 {
@@ -186,6 +193,54 @@ class MomentumSmearer
     } // end of centrality loop
   }
 
+  void fillAliasReso(std::vector<TH1F*> const& fVecReso, std::vector<AliasSampler>& fAliasReso)
+  {
+    fAliasReso.resize(fVecReso.size());
+    std::vector<double> weights;
+    for (std::size_t i = 0; i < fVecReso.size(); i++) {
+      const int nBins = fVecReso[i]->GetNbinsX();
+      weights.resize(nBins);
+      for (int bin = 0; bin < nBins; bin++) {
+        weights[bin] = fVecReso[i]->GetBinContent(bin + 1);
+      }
+      fAliasReso[i].build(weights.data(), nBins);
+    }
+  }
+
+  void fillAliasResoND()
+  {
+    LOGP(info, "prepare alias tables");
+    fAliasResoND.clear();
+    fAliasResoND.resize(fNCenBins * fNPtBins * fNEtaBins * fNPhiBins * fNChBins);
+    std::vector<double> weights;
+    for (int icen = 0; icen < fNCenBins; icen++) {
+      for (int ipt = 0; ipt < fNPtBins; ipt++) {
+        for (int ieta = 0; ieta < fNEtaBins; ieta++) {
+          for (int iphi = 0; iphi < fNPhiBins; iphi++) {
+            for (int ich = 0; ich < fNChBins; ich++) {
+              TH3D* h3 = fVecResoND[icen][ipt][ieta][iphi][ich];
+              if (!h3) {
+                continue;
+              }
+              // same cell numbering as TH3::GetRandom3(), x running fastest
+              const int nx = h3->GetNbinsX(), ny = h3->GetNbinsY(), nz = h3->GetNbinsZ();
+              weights.resize(static_cast<std::size_t>(nx) * ny * nz);
+              for (int iz = 0; iz < nz; iz++) {
+                for (int iy = 0; iy < ny; iy++) {
+                  for (int ix = 0; ix < nx; ix++) {
+                    weights[ix + static_cast<std::size_t>(nx) * (iy + static_cast<std::size_t>(ny) * iz)] = h3->GetBinContent(ix + 1, iy + 1, iz + 1);
+                  }
+                }
+              }
+              fAliasResoND[getResoNDIndex({icen, ipt, ieta, iphi, ich})].build(weights.data(), weights.size());
+              fAxesResoND = {h3->GetXaxis(), h3->GetYaxis(), h3->GetZaxis()};
+            } // end of charge loop
+          } // end of phi loop
+        } // end of eta loop
+      } // end of pt loop
+    } // end of centrality loop
+  }
+
   void init()
   {
     if (fInitialized) {
@@ -238,6 +293,9 @@ class MomentumSmearer
           LOGP(fatal, "Could not open {} from file {}", fResNDHistName.Data(), fResFileName.Data());
         }
         fillVecResoND(fResoND);
+        if (fUseAliasSampling) {
+          fillAliasResoND();
+        }
       }
     } else {
       if (fResType != 0) {
@@ -264,6 +322,12 @@ class MomentumSmearer
         fillVecReso(fResoEta, fVecResoEta, "_deta");
         fillVecReso(fResoPhi_Pos, fVecResoPhi_Pos, "_dphi_pos");
         fillVecReso(fResoPhi_Neg, fVecResoPhi_Neg, "_dphi_neg");
+        if (fUseAliasSampling) {
+          fillAliasReso(fVecResoPt, fAliasResoPt);
+          fillAliasReso(fVecResoEta, fAliasResoEta);
+          fillAliasReso(fVecResoPhi_Pos, fAliasResoPhi_Pos);
+          fillAliasReso(fVecResoPhi_Neg, fAliasResoPhi_Neg);
+        }
       }
     }
 
@@ -365,6 +429,9 @@ class MomentumSmearer
         LOGP(fatal, "Could not open {} from file {}", fDCAHistName.Data(), fDCAFileName.Data());
       }
       fillVecReso(fDCA, fVecDCA, "_dca");
+      if (fUseAliasSampling) {
+        fillAliasReso(fVecDCA, fAliasDCA);
+      }
     }
 
     if (!fFromCcdb) {
@@ -374,7 +441,7 @@ class MomentumSmearer
     fInitialized = true;
   }
 
-  void applySmearing(const float ptgen, const float vargen, const float multiply, float& varsmeared, TH2F* fReso, std::vector<TH1F*>& fVecReso)
+  int findPtBin(TH2F* fReso, const float ptgen)
   {
     float ptgen_tmp = ptgen > fMinPtGen ? ptgen : fMinPtGen;
     TAxis* axisPt = fReso->GetXaxis();
@@ -386,6 +453,12 @@ class MomentumSmearer
     if (ptbin > nBinsPt) {
       ptbin = nBinsPt;
     }
+    return ptbin;
+  }
+
+  void applySmearing(const float ptgen, const float vargen, const float multiply, float& varsmeared, TH2F* fReso, std::vector<TH1F*>& fVecReso)
+  {
+    int ptbin = findPtBin(fReso, ptgen);
     float smearing = 0.;
     if (fVecReso[ptbin - 1]->GetEntries() > 0) {
       smearing = fVecReso[ptbin - 1]->GetRandom() * multiply;
@@ -393,6 +466,13 @@ class MomentumSmearer
     varsmeared = vargen - smearing;
   }
 
+  /// same as above with the alias table of the pt bin, from 2 uniform random numbers u
+  void applySmearing(const float ptgen, const float vargen, const float multiply, float& varsmeared, TH2F* fReso, std::vector<AliasSampler> const& fAliasReso, const double* u)
+  {
+    int ptbin = findPtBin(fReso, ptgen);
+    varsmeared = vargen - sampleAlias(fAliasReso[ptbin - 1], fReso->GetYaxis(), u) * multiply;
+  }
+
   void applySmearing(const float centrality, const int ch, const float ptgen, const float etagen, const float phigen, float& ptsmeared, float& etasmeared, float& phismeared)
   {
     if (fResType == 0) {
@@ -402,6 +482,13 @@ class MomentumSmearer
       return;
     }
 
+    if (fUseAliasSampling) {
+      std::array<double, NRandomPerLepton> u;
+      gRandom->RndmArray(u.size(), u.data());
+      applySmearing(centrality, ch, ptgen, etagen, phigen, ptsmeared, etasmeared, phismeared, u.data());
+      return;
+    }
+
     if (fDoNDSmearing) {
       if (centrality < 0) {
         ptsmeared = ptgen;
@@ -421,7 +508,25 @@ class MomentumSmearer
     }
   }
 
-  void applySmearingND(const float centrality, const int ch, const float ptgen, const float etagen, const float phigen, float& ptsmeared, float& etasmeared, float& phismeared)
+  /// smears whole spans of leptons, e.g. all the generated leptons of a DataFrame. With the alias sampling, the
+  /// random numbers of the whole span are drawn at once
+  void applySmearing(std::span<const float> centrality, std::span<const int> ch, std::span<const float> ptgen, std::span<const float> etagen, std::span<const float> phigen, std::span<float> ptsmeared, std::span<float> etasmeared, std::span<float> phismeared)
+  {
+    const std::size_t nLeptons = ptgen.size();
+    if (!fUseAliasSampling || fResType == 0) {
+      for (std::size_t i = 0; i < nLeptons; i++) {
+        applySmearing(centrality[i], ch[i], ptgen[i], etagen[i], phigen[i], ptsmeared[i], etasmeared[i], phismeared[i]);
+      }
+      return;
+    }
+    fRandom.resize(nLeptons * NRandomPerLepton);
+    gRandom->RndmArray(static_cast<int>(fRandom.size()), fRandom.data());
+    for (std::size_t i = 0; i < nLeptons; i++) {
+      applySmearing(centrality[i], ch[i], ptgen[i], etagen[i], phigen[i], ptsmeared[i], etasmeared[i], phismeared[i], &fRandom[i * NRandomPerLepton]);
+    }
+  }
+
+  std::array<int, 5> findResoNDBins(const float centrality, const int ch, const float ptgen, const float etagen, const float phigen)
   {
     float ptgen_tmp = ptgen > fMinPtGen ? ptgen : fMinPtGen;
     int cenbin = fResoND->GetAxis(0)->FindBin(centrality);
@@ -464,10 +569,15 @@ class MomentumSmearer
     } else if (chbin > fNChBins) {
       chbin = fNChBins;
     }
+    return {cenbin - 1, ptbin - 1, etabin - 1, phibin - 1, chbin - 1};
+  }
 
+  void applySmearingND(const float centrality, const int ch, const float ptgen, const float etagen, const float phigen, float& ptsmeared, float& etasmeared, float& phismeared)
+  {
+    const auto [icen, ipt, ieta, iphi, ich] = findResoNDBins(centrality, ch, ptgen, etagen, phigen);
     double dpt_rel = 0, deta = 0, dphi = 0;
-    if (fVecResoND[cenbin - 1][ptbin - 1][etabin - 1][phibin - 1][chbin - 1]->GetEntries() > 0) {
-      fVecResoND[cenbin - 1][ptbin - 1][etabin - 1][phibin - 1][chbin - 1]->GetRandom3(dpt_rel, deta, dphi);
+    if (fVecResoND[icen][ipt][ieta][iphi][ich]->GetEntries() > 0) {
+      fVecResoND[icen][ipt][ieta][iphi][ich]->GetRandom3(dpt_rel, deta, dphi);
     }
     ptsmeared = ptgen - dpt_rel * ptgen;
     etasmeared = etagen - deta;
@@ -475,6 +585,25 @@ class MomentumSmearer
     // LOGF(info, "ptgen = %f (GeV/c), etagen = %f, phigen = %f (rad.), ptsmeared = %f (GeV/c), etasmeared = %f, phismeared = %f (rad.)", ptgen, etagen, phigen, ptsmeared, etasmeared, phismeared);
   }
 
+  /// same as above with the alias table of the resolution slice, from 4 uniform random numbers u
+  void applySmearingND(const float centrality, const int ch, const float ptgen, const float etagen, const float phigen, float& ptsmeared, float& etasmeared, float& phismeared, const double* u)
+  {
+    const AliasSampler& sampler = fAliasResoND[getResoNDIndex(findResoNDBins(centrality, ch, ptgen, etagen, phigen))];
+    double dpt_rel = 0, deta = 0, dphi = 0;
+    if (!sampler.empty()) {
+      // as TH3::GetRandom3(): uniform inside the drawn cell
+      const uint32_t cell = sampler.sample(u[0]);
+      const uint32_t nx = fAxesResoND[0]->GetNbins(), ny = fAxesResoND[1]->GetNbins();
+      const int ix = cell % nx + 1, iy = (cell / nx) % ny + 1, iz = cell / (nx * ny) + 1;
+      dpt_rel = fAxesResoND[0]->GetBinLowEdge(ix) + fAxesResoND[0]->GetBinWidth(ix) * u[1];
+      deta = fAxesResoND[1]->GetBinLowEdge(iy) + fAxesResoND[1]->GetBinWidth(iy) * u[2];
+      dphi = fAxesResoND[2]->GetBinLowEdge(iz) + fAxesResoND[2]->GetBinWidth(iz) * u[3];
+    }
+    ptsmeared = ptgen - dpt_rel * ptgen;
+    etasmeared = etagen - deta;
+    phismeared = phigen - dphi;
+  }
+
   float getEfficiency(float pt, float eta, float phi)
   {
 
@@ -555,7 +684,11 @@ class MomentumSmearer
       ptbin = nBinsPt;
     }
     float dca = 0.;
-    if (fVecDCA[ptbin - 1]->GetEntries() > 0) {
+    if (fUseAliasSampling) {
+      std::array<double, 2> u;
+      gRandom->RndmArray(u.size(), u.data());
+      dca = sampleAlias(fAliasDCA[ptbin - 1], fDCA->GetYaxis(), u.data());
+    } else if (fVecDCA[ptbin - 1]->GetEntries() > 0) {
       dca = fVecDCA[ptbin - 1]->GetRandom();
     }
     return dca;
@@ -563,6 +696,7 @@ class MomentumSmearer
 
   // setters
   void setNDSmearing(bool flag) { fDoNDSmearing = flag; }
+  void setAliasSampling(bool flag) { fUseAliasSampling = flag; }
   void setResFileName(TString resFileName) { fResFileName = resFileName; }
   void setResNDHistName(TString resNDHistName) { fResNDHistName = resNDHistName; }
   void setResPtHistName(TString resPtHistName) { fResPtHistName = resPtHistName; }
@@ -586,6 +720,7 @@ class MomentumSmearer
 
   // getters
   bool getNDSmearing() { return fDoNDSmearing; }
+  bool getAliasSampling() { return fUseAliasSampling; }
   TString getResFileName() { return fResFileName; }
   TString getResNDHistName() { return fResNDHistName; }
   TString getResPtHistName() { return fResPtHistName; }
@@ -607,8 +742,48 @@ class MomentumSmearer
   float getMinPt() { return fMinPtGen; }
 
  private:
+  static constexpr int NRandomPerLepton = 6; // pt, eta, phi: cell and position in the cell
+
+  /// as TH1::GetRandom(): uniform inside the bin drawn from the alias table, 0 for an empty histogram
+  static double sampleAlias(AliasSampler const& sampler, const TAxis* axis, const double* u)
+  {
+    if (sampler.empty()) {
+      return 0.;
+    }
+    const int bin = sampler.sample(u[0]) + 1;
+    return axis->GetBinLowEdge(bin) + axis->GetBinWidth(bin) * u[1];
+  }
+
+  /// smearing with the alias tables from NRandomPerLepton uniform random numbers u
+  void applySmearing(const float centrality, const int ch, const float ptgen, const float etagen, const float phigen, float& ptsmeared, float& etasmeared, float& phismeared, const double* u)
+  {
+    if (fDoNDSmearing) {
+      if (centrality < 0) {
+        ptsmeared = ptgen;
+        etasmeared = etagen;
+        phismeared = phigen;
+        return;
+      }
+      applySmearingND(centrality, ch, ptgen, etagen, phigen, ptsmeared, etasmeared, phismeared, u);
+    } else {
+      applySmearing(ptgen, ptgen, ptgen, ptsmeared, fResoPt, fAliasResoPt, u);
+      applySmearing(ptgen, etagen, 1., etasmeared, fResoEta, fAliasResoEta, u + 2);
+      if (ch > 0) {
+        applySmearing(ptgen, phigen, 1., phismeared, fResoPhi_Pos, fAliasResoPhi_Pos, u + 4);
+      } else {
+        applySmearing(ptgen, phigen, 1., phismeared, fResoPhi_Neg, fAliasResoPhi_Neg, u + 4);
+      }
+    }
+  }
+
+  int getResoNDIndex(std::array<int, 5> const& bins) const
+  {
+    return (((bins[0] * fNPtBins + bins[1]) * fNEtaBins + bins[2]) * fNPhiBins + bins[3]) * fNChBins + bins[4];
+  }
+
   bool fInitialized = false;
   bool fDoNDSmearing = false;
+  bool fUseAliasSampling = false;
   TString fResFileName;
   TString fResNDHistName;
   TString fResPtHistName;
@@ -643,6 +818,14 @@ class MomentumSmearer
   TObject* fEff;
   TH2F* fDCA;
   std::vector<TH1F*> fVecDCA;
+  std::vector<AliasSampler> fAliasResoPt; // alias tables of the resolution histograms above, with fUseAliasSampling
+  std::vector<AliasSampler> fAliasResoEta;
+  std::vector<AliasSampler> fAliasResoPhi_Pos;
+  std::vector<AliasSampler> fAliasResoPhi_Neg;
+  std::vector<AliasSampler> fAliasResoND;    // flattened (cen, pt, eta, phi, ch)
+  std::array<const TAxis*, 3> fAxesResoND{}; // (dpt/pt, deta, dphi) axes of fVecResoND
+  std::vector<AliasSampler> fAliasDCA;
+  std::vector<double> fRandom; // uniform random numbers of a span of leptons
   int64_t fTimestamp;
   bool fFromCcdb = false;
   Service<ccdb::BasicCCDBManager> fCcdb;
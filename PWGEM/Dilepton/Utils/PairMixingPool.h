@@ -0,0 +1,163 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file PairMixingPool.h
+/// \brief Event mixing pool of compact pair records for pair-level mixing
+/// \author agent <agent@local>
+///
+/// The records of all the events of a mixing bin are kept in one contiguous arena, in the order the events
+/// entered the pool. When an event enters the pool, its records are sorted by pair bin, so that the pairs
+/// of a pool event in a given (mass, pT, eta, phi) bin are a contiguous range found by binary search instead
+/// of a scan over all the pairs. Evicted events are always at the front of the arena, which is compacted
+/// when they make up half of it.
+/// The records of the current event are kept apart until AddCollisionIdAtLast() and are dropped when the
+/// records of another event arrive before, i.e. when the current event is not added to the pool.
+
+#ifndef PWGEM_DILEPTON_UTILS_PAIRMIXINGPOOL_H_
+#define PWGEM_DILEPTON_UTILS_PAIRMIXINGPOOL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace o2::aod::pwgem::dilepton::utils
+{
+/// dilepton for pair-level mixing, 36 bytes instead of the EMPair in a tuple with its bins
+struct EMPairRecord {
+  float fPt;
+  float fEta;
+  float fPhi;
+  float fMass;
+  float fPairDCA;
+  float fPxLeg; // reference leg for the polarization angles
+  float fPyLeg;
+  float fPzLeg;
+  uint32_t fBin; // (mass, pT, eta, phi) bin of the pair, pairs are mixed within the same bin
+
+  uint32_t bin() const { return fBin; }
+  float pt() const { return fPt; }
+  float eta() const { return fEta; }
+  float phi() const { return fPhi; }
+  float mass() const { return fMass; }
+  float getPairDCA() const { return fPairDCA; }
+  float rapidity() const { return std::log((std::sqrt(std::pow(fMass, 2) + std::pow(fPt * std::cosh(fEta), 2)) + fPt * std::sinh(fEta)) / std::sqrt(std::pow(fMass, 2) + std::pow(fPt, 2))); }
+  float px() const { return fPt * std::cos(fPhi); }
+  float py() const { return fPt * std::sin(fPhi); }
+  float pz() const { return fPt * std::sinh(fEta); }
+  float pxLeg() const { return fPxLeg; }
+  float pyLeg() const { return fPyLeg; }
+  float pzLeg() const { return fPzLeg; }
+};
+static_assert(std::is_trivially_copyable_v<EMPairRecord>);
+
+/// \tparam T key of the mixing bin, e.g. <zbin, centbin, epbin, occbin>
+/// \tparam U key of the collision, e.g. <df index, global collision index>
+/// \tparam V trivially copyable record with bin()
+template <typename T, typename U, typename V>
+class PairMixingPool
+{
+  static_assert(std::is_trivially_copyable_v<V>, "PairMixingPool: records must be trivially copyable");
+
+ public:
+  struct Event {
+    U key;
+    std::size_t offset; // first record in the arena of the bin
+    uint32_t nRecords;
+  };
+
+  explicit PairMixingPool(int ndepth = 0) : fNdepth(ndepth) {}
+
+  void SetNdepth(int ndepth) { fNdepth = ndepth; }
+
+  void AddTrackToEventPool(U key_df_collision, V const& record)
+  {
+    if (!fCurrentRecords.empty() && !(fCurrentKey == key_df_collision)) {
+      fCurrentRecords.clear();
+    }
+    fCurrentKey = key_df_collision;
+    fCurrentRecords.emplace_back(record);
+  }
+
+  /// records of the current event
+  std::span<const V> GetTracksPerCollision(U key_df_collision) const
+  {
+    if (fCurrentRecords.empty() || !(fCurrentKey == key_df_collision)) {
+      return {};
+    }
+    return {fCurrentRecords.data(), fCurrentRecords.size()};
+  }
+
+  /// events of the pool in bin key_bin, from the oldest
+  std::deque<Event> const& GetEventsFromEventPool(T key_bin) { return fBins[key_bin].events; }
+
+  /// records of a pool event in pair bin pairBin
+  std::span<const V> GetTracksPerCollision(T key_bin, Event const& event, uint32_t pairBin)
+  {
+    const V* first = fBins[key_bin].arena.data() + event.offset;
+    auto [lower, upper] = std::equal_range(first, first + event.nRecords, pairBin, CompareBin{});
+    return {lower, static_cast<std::size_t>(upper - lower)};
+  }
+
+  /// adds the current event to the pool, to be called at the end of collision loop
+  void AddCollisionIdAtLast(T key_bin, U key_df_collision)
+  {
+    Bin& bin = fBins[key_bin];
+    if (static_cast<int>(bin.events.size()) >= fNdepth && !bin.events.empty()) {
+      bin.nDeadRecords += bin.events.front().nRecords;
+      bin.events.pop_front();
+      if (2 * bin.nDeadRecords >= bin.arena.size()) {
+        compact(bin);
+      }
+    }
+    std::size_t nRecords = 0;
+    if (!fCurrentRecords.empty() && fCurrentKey == key_df_collision) {
+      std::stable_sort(fCurrentRecords.begin(), fCurrentRecords.end(), [](V const& a, V const& b) { return a.bin() < b.bin(); });
+      bin.arena.insert(bin.arena.end(), fCurrentRecords.begin(), fCurrentRecords.end());
+      nRecords = fCurrentRecords.size();
+      fCurrentRecords.clear();
+    }
+    bin.events.push_back({key_df_collision, bin.arena.size() - nRecords, static_cast<uint32_t>(nRecords)});
+  }
+
+ private:
+  struct Bin {
+    std::vector<V> arena;
+    std::deque<Event> events;
+    std::size_t nDeadRecords = 0; // records of evicted events, at the front of the arena
+  };
+
+  struct CompareBin {
+    bool operator()(V const& record, uint32_t pairBin) const { return record.bin() < pairBin; }
+    bool operator()(uint32_t pairBin, V const& record) const { return pairBin < record.bin(); }
+  };
+
+  static void compact(Bin& bin)
+  {
+    bin.arena.erase(bin.arena.begin(), bin.arena.begin() + bin.nDeadRecords);
+    for (auto& event : bin.events) {
+      event.offset -= bin.nDeadRecords;
+    }
+    bin.nDeadRecords = 0;
+  }
+
+  int fNdepth;                      // depth of event mixing
+  std::map<T, Bin> fBins;           // map : e.g. <zbin, centbin, epbin, occbin> -> records and events
+  U fCurrentKey{};                  // current event, not yet in the pool
+  std::vector<V> fCurrentRecords{}; // records of the current event
+};
+} // namespace o2::aod::pwgem::dilepton::utils
+#endif // PWGEM_DILEPTON_UTILS_PAIRMIXINGPOOL_H_
@@ -22,6 +22,7 @@
 #include "PWGEM/PhotonMeson/Core/PHOSPhotonCut.h"
 #include "PWGEM/PhotonMeson/Core/V0PhotonCut.h"
 #include "PWGEM/PhotonMeson/DataModel/gammaTables.h"
+#include "PWGEM/PhotonMeson/Utils/DiphotonPairKernel.h"
 #include "PWGEM/PhotonMeson/Utils/EventHistograms.h"
 #include "PWGEM/PhotonMeson/Utils/NMHistograms.h"
 #include "PWGEM/PhotonMeson/Utils/PairUtilities.h"
@@ -30,6 +31,7 @@
 #include "PWGEM/Dilepton/Utils/EventMixingHandler.h"
 
 #include "Common/CCDB/TriggerAliases.h"
+#include "Common/Core/SparseHistAccumulator.h"
 #include "Common/DataModel/Centrality.h"
 #include "Common/DataModel/EventSelection.h"
 
@@ -56,6 +58,7 @@
 #include <Math/GenVector/Rotation3D.h>
 #include <Math/Vector4D.h> // IWYU pragma: keep
 #include <Math/Vector4Dfwd.h>
+#include <THnSparse.h>
 
 #include <algorithm>
 #include <cmath>
@@ -87,6 +90,7 @@ struct Pi0EtaToGammaGamma {
   o2::framework::Configurable<float> maxY{"maxY", 0.8, "maximum rapidity for reconstructed particles"};
   o2::framework::Configurable<bool> cfgDoMix{"cfgDoMix", true, "flag for event mixing"};
   o2::framework::Configurable<int> ndepth{"ndepth", 10, "depth for event mixing"};
+  o2::framework::Configurable<bool> cfgUsePairKernel{"cfgUsePairKernel", false, "flag to stage photons per event in arrays and compute same- and mixed-event pairs in blocks"};
   o2::framework::ConfigurableAxis ConfVtxBins{"ConfVtxBins", {o2::framework::VARIABLE_WIDTH, -10.0f, -8.f, -6.f, -4.f, -2.f, 0.f, 2.f, 4.f, 6.f, 8.f, 10.f}, "Mixing bins - z-vertex"};
   o2::framework::ConfigurableAxis ConfCentBins{"ConfCentBins", {o2::framework::VARIABLE_WIDTH, 0.0f, 5.0f, 10.0f, 20.0f, 30.0f, 40.0f, 50.0f, 60.0f, 70.0f, 80.0f, 90.0f, 100.f, 999.f}, "Mixing bins - centrality"};
   o2::framework::ConfigurableAxis ConfEPBins{"ConfEPBins", {o2::framework::VARIABLE_WIDTH, -o2::constants::math::PIHalf, -o2::constants::math::PIQuarter, 0.0f, +o2::constants::math::PIQuarter, +o2::constants::math::PIHalf}, "Mixing bins - event plane angle"};
@@ -253,6 +257,10 @@ struct Pi0EtaToGammaGamma {
       emcalGeom = o2::emcal::Geometry::GetInstanceFromRunNumber(300000);
     }
     fRegistry.add("Pair/mix/hDiffBC", "diff. global BC in mixed event;|BC_{current} - BC_{mixed}|", o2::framework::kTH1D, {{10001, -0.5, 10000.5}}, true);
+    if (cfgUsePairKernel) {
+      fHistSameFiller.bind(fRegistry.get<THnSparse>(HIST("Pair/same/hs")));
+      fHistMixFiller.bind(fRegistry.get<THnSparse>(HIST("Pair/mix/hs")));
+    }
 
     mRunNumber = 0;
     d_bz = 0;
@@ -540,6 +548,102 @@ struct Pi0EtaToGammaGamma {
   std::vector<std::pair<int, int>> used_dileptonIds_per_col; // <ndf, trackId>
   std::map<std::pair<int, int>, uint64_t> map_mixed_eventId_to_globalBC;
 
+  o2::aod::pwgem::photonmeson::utils::pairkernel::PhotonArrays fPhotons1;    // photons of the current event, same-event pairing
+  o2::aod::pwgem::photonmeson::utils::pairkernel::PhotonArrays fPhotons2;    // second kind of the current event, same-event pairing
+  o2::aod::pwgem::photonmeson::utils::pairkernel::PhotonArrays fPoolTracks1; // pooled tracks of the current event, emh1
+  o2::aod::pwgem::photonmeson::utils::pairkernel::PhotonArrays fPoolTracks2; // pooled tracks of the current event, emh2
+  o2::aod::pwgem::photonmeson::utils::pairkernel::PhotonArrays fMixedTracks; // pooled tracks of an event from the mixing pool
+  o2::aod::pwgem::photonmeson::utils::pairkernel::PairBlock fPairBlock;
+  o2::common::core::SparseHistFiller<double> fHistSameFiller; // Pair/same/hs with the pair kernel
+  o2::common::core::SparseHistFiller<double> fHistMixFiller;  // Pair/mix/hs with the pair kernel
+  std::vector<uint8_t> fIsUsed1;
+  std::vector<uint8_t> fIsUsed2;
+
+  template <typename TSubInfos1, typename TSubInfos2, typename TPhotons, typename TCut1, typename TCut2>
+  void stagePhotons(TPhotons const& photons, TCut1 const& cut1, TCut2 const& cut2, o2::aod::pwgem::photonmeson::utils::pairkernel::PhotonArrays& arrays)
+  {
+    arrays.clear();
+    for (const auto& g : photons) {
+      const bool isSelected1 = cut1.template IsSelected<TSubInfos1>(g);
+      bool isSelected2 = isSelected1;
+      if constexpr (std::is_same_v<TCut1, TCut2>) {
+        if (&cut1 != &cut2) {
+          isSelected2 = cut2.template IsSelected<TSubInfos2>(g);
+        }
+      } else {
+        isSelected2 = cut2.template IsSelected<TSubInfos2>(g);
+      }
+      if (isSelected1 || isSelected2) {
+        arrays.add(g.pt(), g.eta(), g.phi(), 0.f, g.globalIndex(), isSelected1, isSelected2);
+      }
+    }
+  }
+
+  /// same-event pairs of the staged photons, as the pairing loops over o2::soa::combinations. Returns the number of pairs
+  template <typename TPhotons2>
+  int runSameEventKernel(TPhotons2 const& photons2_per_collision, std::pair<int, int64_t> const& key_df_collision, float weight)
+  {
+    o2::aod::pwgem::photonmeson::utils::pairkernel::PairCuts cuts;
+    cuts.maxY = maxY;
+    if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kEMCEMC) {
+      cuts.minOpeningAngle = emccuts.minOpenAngle;
+    }
+    constexpr bool isSameKind = pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPCMPCM || pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPHOSPHOS || pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kEMCEMC;
+    auto& photons2 = isSameKind ? fPhotons1 : fPhotons2;
+    const std::size_t n1 = fPhotons1.size();
+    const std::size_t n2 = photons2.size();
+    fIsUsed1.assign(n1, 0);
+    fIsUsed2.assign(n2, 0);
+    auto& isUsed2 = isSameKind ? fIsUsed1 : fIsUsed2;
+    auto* emh_for_photons2 = isSameKind ? emh1 : emh2;
+
+    int ndiphoton = 0;
+    for (std::size_t i = 0; i < n1; i++) {
+      if (!fPhotons1.selected1[i]) {
+        continue;
+      }
+      const std::size_t first = isSameKind ? i + 1 : 0; // strictly upper or full index policy
+      o2::aod::pwgem::photonmeson::utils::pairkernel::pairBlock(fPhotons1, i, photons2, first, n2, cuts, fPairBlock);
+      for (std::size_t j = first; j < n2; j++) {
+        if (!fPairBlock.accepted[j - first] || !photons2.selected2[j]) {
+          continue;
+        }
+        fHistSameFiller.fill(fPairBlock.mass(j - first), fPairBlock.pt(j - first), weight);
+
+        if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kEMCEMC) {
+          ROOT::Math::PtEtaPhiMVector v1(fPhotons1.pt[i], fPhotons1.eta[i], fPhotons1.phi[i], 0.);
+          ROOT::Math::PtEtaPhiMVector v2(photons2.pt[j], photons2.eta[j], photons2.phi[j], 0.);
+          RotationBackground<o2::soa::Join<o2::aod::SkimEMCClusters, o2::aod::EMCEMEventIds>>(v1 + v2, v1, v2, photons2_per_collision, fPhotons1.ids[i], photons2.ids[j], weight);
+        }
+
+        if (!fIsUsed1[i]) {
+          emh1->AddTrackToEventPool(key_df_collision, o2::aod::pwgem::dilepton::utils::EMTrack(fPhotons1.pt[i], fPhotons1.eta[i], fPhotons1.phi[i], 0));
+          fIsUsed1[i] = 1;
+        }
+        if (!isUsed2[j]) {
+          emh_for_photons2->AddTrackToEventPool(key_df_collision, o2::aod::pwgem::dilepton::utils::EMTrack(photons2.pt[j], photons2.eta[j], photons2.phi[j], 0));
+          isUsed2[j] = 1;
+        }
+        ndiphoton++;
+      }
+    }
+    return ndiphoton;
+  }
+
+  /// mixed-event pairs of the staged pooled tracks of the current event with the pooled tracks of an event from the pool
+  void runMixedEventKernel(o2::aod::pwgem::photonmeson::utils::pairkernel::PhotonArrays const& tracks, std::vector<o2::aod::pwgem::dilepton::utils::EMTrack> const& tracks_from_event_pool, float weight)
+  {
+    fMixedTracks.clear();
+    fMixedTracks.addTracks(tracks_from_event_pool);
+    o2::aod::pwgem::photonmeson::utils::pairkernel::PairCuts cuts;
+    cuts.maxY = maxY;
+    const std::size_t nMixed = fMixedTracks.size();
+    for (std::size_t i = 0; i < tracks.size(); i++) {
+      o2::aod::pwgem::photonmeson::utils::pairkernel::pairBlock(tracks, i, fMixedTracks, 0, nMixed, cuts, fPairBlock);
+      o2::aod::pwgem::photonmeson::utils::pairkernel::fillAccepted(fPairBlock, nMixed, weight, fHistMixFiller);
+    }
+  }
+
   template <typename TCollisions, typename TPhotons1, typename TPhotons2, typename TSubInfos1, typename TSubInfos2, typename TPreslice1, typename TPreslice2, typename TCut1, typename TCut2>
   void runPairing(TCollisions const& collisions,
                   TPhotons1 const& photons1, TPhotons2 const& photons2,
@@ -623,41 +727,46 @@ struct Pi0EtaToGammaGamma {
         auto photons1_per_collision = photons1.sliceBy(perCollision1, collision.globalIndex());
         auto photons2_per_collision = photons2.sliceBy(perCollision2, collision.globalIndex());
 
-        for (const auto& [g1, g2] : o2::soa::combinations(o2::soa::CombinationsStrictlyUpperIndexPolicy(photons1_per_collision, photons2_per_collision))) {
-          if (!cut1.template IsSelected<TSubInfos1>(g1) || !cut2.template IsSelected<TSubInfos2>(g2)) {
-            continue;
-          }
-
-          ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-          ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-          ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-          if (std::fabs(v12.Rapidity()) > maxY) {
-            continue;
-          }
+        if (cfgUsePairKernel) {
+          stagePhotons<TSubInfos1, TSubInfos2>(photons1_per_collision, cut1, cut2, fPhotons1);
+          ndiphoton = runSameEventKernel(photons2_per_collision, key_df_collision, weight);
+        } else {
+          for (const auto& [g1, g2] : o2::soa::combinations(o2::soa::CombinationsStrictlyUpperIndexPolicy(photons1_per_collision, photons2_per_collision))) {
+            if (!cut1.template IsSelected<TSubInfos1>(g1) || !cut2.template IsSelected<TSubInfos2>(g2)) {
+              continue;
+            }
 
-          if (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kEMCEMC) {
-            float openingAngle = std::acos(v1.Vect().Dot(v2.Vect()) / (v1.P() * v2.P()));
-            if (openingAngle < emccuts.minOpenAngle) {
+            ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
+            ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
+            ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
+            if (std::fabs(v12.Rapidity()) > maxY) {
               continue;
             }
-          }
 
-          fRegistry.fill(HIST("Pair/same/hs"), v12.M(), v12.Pt(), weight);
+            if (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kEMCEMC) {
+              float openingAngle = std::acos(v1.Vect().Dot(v2.Vect()) / (v1.P() * v2.P()));
+              if (openingAngle < emccuts.minOpenAngle) {
+                continue;
+              }
+            }
 
-          if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kEMCEMC) {
-            RotationBackground<o2::soa::Join<o2::aod::SkimEMCClusters, o2::aod::EMCEMEventIds>>(v12, v1, v2, photons2_per_collision, g1.globalIndex(), g2.globalIndex(), weight);
-          }
+            fRegistry.fill(HIST("Pair/same/hs"), v12.M(), v12.Pt(), weight);
 
-          if (std::find(used_photonIds_per_col.begin(), used_photonIds_per_col.end(), g1.globalIndex()) == used_photonIds_per_col.end()) {
-            emh1->AddTrackToEventPool(key_df_collision, o2::aod::pwgem::dilepton::utils::EMTrack(g1.pt(), g1.eta(), g1.phi(), 0));
-            used_photonIds_per_col.emplace_back(g1.globalIndex());
-          }
-          if (std::find(used_photonIds_per_col.begin(), used_photonIds_per_col.end(), g2.globalIndex()) == used_photonIds_per_col.end()) {
-            emh1->AddTrackToEventPool(key_df_collision, o2::aod::pwgem::dilepton::utils::EMTrack(g2.pt(), g2.eta(), g2.phi(), 0));
-            used_photonIds_per_col.emplace_back(g2.globalIndex());
-          }
-          ndiphoton++;
-        } // end of pairing loop
+            if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kEMCEMC) {
+              RotationBackground<o2::soa::Join<o2::aod::SkimEMCClusters, o2::aod::EMCEMEventIds>>(v12, v1, v2, photons2_per_collision, g1.globalIndex(), g2.globalIndex(), weight);
+            }
+
+            if (std::find(used_photonIds_per_col.begin(), used_photonIds_per_col.end(), g1.globalIndex()) == used_photonIds_per_col.end()) {
+              emh1->AddTrackToEventPool(key_df_collision, o2::aod::pwgem::dilepton::utils::EMTrack(g1.pt(), g1.eta(), g1.phi(), 0));
+              used_photonIds_per_col.emplace_back(g1.globalIndex());
+            }
+            if (std::find(used_photonIds_per_col.begin(), used_photonIds_per_col.end(), g2.globalIndex()) == used_photonIds_per_col.end()) {
+              emh1->AddTrackToEventPool(key_df_collision, o2::aod::pwgem::dilepton::utils::EMTrack(g2.pt(), g2.eta(), g2.phi(), 0));
+              used_photonIds_per_col.emplace_back(g2.globalIndex());
+            }
+            ndiphoton++;
+          } // end of pairing loop
+        }
       } else if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPCMDalitzEE) {
         auto photons1_per_collision = photons1.sliceBy(perCollision1, collision.globalIndex());
         auto positrons_per_collision = positrons->sliceByCached(o2::aod::emprimaryelectron::emeventId, collision.globalIndex(), cache);
@@ -714,29 +823,35 @@ struct Pi0EtaToGammaGamma {
         auto photons1_per_collision = photons1.sliceBy(perCollision1, collision.globalIndex());
         auto photons2_per_collision = photons2.sliceBy(perCollision2, collision.globalIndex());
 
-        for (const auto& [g1, g2] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(photons1_per_collision, photons2_per_collision))) {
-          if (!cut1.template IsSelected<TSubInfos1>(g1) || !cut2.template IsSelected<TSubInfos2>(g2)) {
-            continue;
-          }
-          ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-          ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-          ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-          if (std::fabs(v12.Rapidity()) > maxY) {
-            continue;
-          }
+        if (cfgUsePairKernel) {
+          stagePhotons<TSubInfos1, TSubInfos1>(photons1_per_collision, cut1, cut1, fPhotons1);
+          stagePhotons<TSubInfos2, TSubInfos2>(photons2_per_collision, cut2, cut2, fPhotons2);
+          ndiphoton = runSameEventKernel(photons2_per_collision, key_df_collision, weight);
+        } else {
+          for (const auto& [g1, g2] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(photons1_per_collision, photons2_per_collision))) {
+            if (!cut1.template IsSelected<TSubInfos1>(g1) || !cut2.template IsSelected<TSubInfos2>(g2)) {
+              continue;
+            }
+            ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
+            ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
+            ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
+            if (std::fabs(v12.Rapidity()) > maxY) {
+              continue;
+            }
 
-          fRegistry.fill(HIST("Pair/same/hs"), v12.M(), v12.Pt(), weight);
+            fRegistry.fill(HIST("Pair/same/hs"), v12.M(), v12.Pt(), weight);
 
-          if (std::find(used_photonIds_per_col.begin(), used_photonIds_per_col.end(), g1.globalIndex()) == used_photonIds_per_col.end()) {
-            emh1->AddTrackToEventPool(key_df_collision, o2::aod::pwgem::dilepton::utils::EMTrack(g1.pt(), g1.eta(), g1.phi(), 0));
-            used_photonIds_per_col.emplace_back(g1.globalIndex());
-          }
-          if (std::find(used_photonIds_per_col.begin(), used_photonIds_per_col.end(), g2.globalIndex()) == used_photonIds_per_col.end()) {
-            emh2->AddTrackToEventPool(key_df_collision, o2::aod::pwgem::dilepton::utils::EMTrack(g2.pt(), g2.eta(), g2.phi(), 0));
-            used_photonIds_per_col.emplace_back(g2.globalIndex());
-          }
-          ndiphoton++;
-        } // end of pairing loop
+            if (std::find(used_photonIds_per_col.begin(), used_photonIds_per_col.end(), g1.globalIndex()) == used_photonIds_per_col.end()) {
+              emh1->AddTrackToEventPool(key_df_collision, o2::aod::pwgem::dilepton::utils::EMTrack(g1.pt(), g1.eta(), g1.phi(), 0));
+              used_photonIds_per_col.emplace_back(g1.globalIndex());
+            }
+            if (std::find(used_photonIds_per_col.begin(), used_photonIds_per_col.end(), g2.globalIndex()) == used_photonIds_per_col.end()) {
+              emh2->AddTrackToEventPool(key_df_collision, o2::aod::pwgem::dilepton::utils::EMTrack(g2.pt(), g2.eta(), g2.phi(), 0));
+              used_photonIds_per_col.emplace_back(g2.globalIndex());
+            }
+            ndiphoton++;
+          } // end of pairing loop
+        }
       } // end of pairing in same event
 
       used_photonIds_per_col.clear();
@@ -752,6 +867,12 @@ struct Pi0EtaToGammaGamma {
       // make a vector of selected photons in this collision.
       auto selected_photons1_in_this_event = emh1->GetTracksPerCollision(key_df_collision);
       auto selected_photons2_in_this_event = emh2->GetTracksPerCollision(key_df_collision);
+      if (cfgUsePairKernel) {
+        fPoolTracks1.clear();
+        fPoolTracks1.addTracks(selected_photons1_in_this_event);
+        fPoolTracks2.clear();
+        fPoolTracks2.addTracks(selected_photons2_in_this_event);
+      }
 
       auto collisionIds1_in_mixing_pool = emh1->GetCollisionIdsFromEventPool(key_bin);
       auto collisionIds2_in_mixing_pool = emh2->GetCollisionIdsFromEventPool(key_bin);
@@ -774,6 +895,10 @@ struct Pi0EtaToGammaGamma {
 
           auto photons1_from_event_pool = emh1->GetTracksPerCollision(mix_dfId_collisionId);
           // LOGF(info, "Do event mixing: current event (%d, %d), ngamma = %d | event pool (%d, %d), ngamma = %d", ndf, collision.globalIndex(), selected_photons1_in_this_event.size(), mix_dfId, mix_collisionId, photons1_from_event_pool.size());
+          if (cfgUsePairKernel) {
+            runMixedEventKernel(fPoolTracks1, photons1_from_event_pool, weight);
+            continue;
+          }
 
           for (const auto& g1 : selected_photons1_in_this_event) {
             for (const auto& g2 : photons1_from_event_pool) {
@@ -807,6 +932,10 @@ struct Pi0EtaToGammaGamma {
 
           auto photons2_from_event_pool = emh2->GetTracksPerCollision(mix_dfId_collisionId);
           // LOGF(info, "Do event mixing: current event (%d, %d), ngamma = %d | event pool (%d, %d), nll = %d", ndf, collision.globalIndex(), selected_photons1_in_this_event.size(), mix_dfId, mix_collisionId, photons2_from_event_pool.size());
+          if (cfgUsePairKernel) {
+            runMixedEventKernel(fPoolTracks1, photons2_from_event_pool, weight);
+            continue;
+          }
 
           for (const auto& g1 : selected_photons1_in_this_event) {
             for (const auto& g2 : photons2_from_event_pool) {
@@ -840,6 +969,10 @@ struct Pi0EtaToGammaGamma {
 
           auto photons1_from_event_pool = emh1->GetTracksPerCollision(mix_dfId_collisionId);
           // LOGF(info, "Do event mixing: current event (%d, %d), nll = %d | event pool (%d, %d), ngamma = %d", ndf, collision.globalIndex(), selected_photons2_in_this_event.size(), mix_dfId, mix_collisionId, photons1_from_event_pool.size());
+          if (cfgUsePairKernel) {
+            runMixedEventKernel(fPoolTracks2, photons1_from_event_pool, weight);
+            continue;
+          }
 
           for (const auto& g1 : selected_photons2_in_this_event) {
             for (const auto& g2 : photons1_from_event_pool) {
@@ -865,6 +998,11 @@ struct Pi0EtaToGammaGamma {
       }
 
     } // end of collision loop
+
+    if (cfgUsePairKernel) {
+      fHistSameFiller.flush();
+      fHistMixFiller.flush();
+    }
   }
 
   o2::framework::expressions::Filter collisionFilter_occupancy_track = eventcuts.cfgTrackOccupancyMin <= o2::aod::evsel::trackOccupancyInTimeRange && o2::aod::evsel::trackOccupancyInTimeRange < eventcuts.cfgTrackOccupancyMax;
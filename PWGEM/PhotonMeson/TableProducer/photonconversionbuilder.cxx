@@ -51,6 +51,7 @@
 #include <KFPTrack.h>
 #include <KFPVertex.h>
 #include <KFParticle.h>
+#include <KFParticleSIMD.h>
 
 #include <algorithm>
 #include <array>
@@ -144,6 +145,7 @@ struct PhotonConversionBuilder {
   Configurable<float> max_pt_v0_itsonly{"max_pt_v0_itsonly", 0.3, "max pT for v0 photons wth 2 ITSonly tracks at PV"};
   Configurable<float> max_eta_v0{"max_eta_v0", 0.9, "max eta for v0 photons at PV"};
   Configurable<float> kfMassConstrain{"kfMassConstrain", -1.f, "mass constrain for the KFParticle mother particle"};
+  Configurable<bool> useBatchKF{"useBatchKF", false, "fit the V0s of a collision in SIMD batches with KFParticleSIMD and keep the fits for the table filling"};
   Configurable<float> max_r_req_its{"max_r_req_its", 16.0, "max Rxy for V0 with ITS hits"};
   Configurable<float> min_r_tpconly{"min_r_tpconly", 32.0, "min Rxy for V0 with TPConly tracks"};
   Configurable<float> max_r_itsmft_ss{"max_r_itsmft_ss", 66.0, "max Rxy for ITS/MFT SS"};
@@ -273,6 +275,7 @@ struct PhotonConversionBuilder {
     /// Set magnetic field for KF vertexing
     const float magneticField = o2::base::Propagator::Instance()->getNominalBz();
     KFParticle::SetField(magneticField);
+    KFParticleSIMD::SetField(magneticField);
 
     mVDriftMgr.init(&ccdb->instance());
   }
@@ -402,8 +405,33 @@ struct PhotonConversionBuilder {
     }
   }
 
+  // legs, DCAs and KF inputs of a V0 which passed the cuts before the KF fit
+  struct V0Candidate {
+    int64_t v0Id = -1;
+    o2::track::TrackParCov pTrack; // at the IU, after the correction of TPC-only tracks
+    o2::track::TrackParCov nTrack;
+    float posdcaXY = 0.f;
+    float posdcaZ = 0.f;
+    float eledcaXY = 0.f;
+    float eledcaZ = 0.f;
+    KFTwoProngCandidate kf; // legs, PV and conversion point from the recalculated vertex
+  };
+
   template <bool isMC, class TBCs, class TCollisions, class TTracks, typename TV0>
   void fillV0Table(TV0 const& v0, const bool filltable)
+  {
+    V0Candidate candidate;
+    if (!prepareV0<isMC, TBCs, TCollisions, TTracks>(v0, candidate)) {
+      return;
+    }
+    KFTwoProngFit fit;
+    kfConstructTwoProng(candidate.kf, fit, 2, kfMassConstrain);
+    selectV0<isMC, TCollisions, TTracks>(v0, candidate, fit, false, filltable);
+  }
+
+  // cuts before the KF fit; fills candidate
+  template <bool isMC, class TBCs, class TCollisions, class TTracks, typename TV0>
+  bool prepareV0(TV0 const& v0, V0Candidate& candidate)
   {
     // Get tracks
     const auto& pos = v0.template posTrack_as<TTracks>();
@@ -412,27 +440,27 @@ struct PhotonConversionBuilder {
     // LOGF(info, "v0.collisionId() = %d, pos.collisionId() = %d, ele.collisionId() = %d", v0.collisionId(), pos.collisionId(), ele.collisionId());
 
     if (pos.sign() * ele.sign() > 0) { // reject same sign pair
-      return;
+      return false;
     }
 
     if (pos.pt() < min_pt_trackiu || ele.pt() < min_pt_trackiu) {
-      return;
+      return false;
     }
 
     if (pos.globalIndex() == ele.globalIndex()) {
-      return;
+      return false;
     }
 
     if (isITSonlyTrack(pos) && !ele.hasITS()) {
-      return;
+      return false;
     }
 
     if (isITSonlyTrack(ele) && !pos.hasITS()) {
-      return;
+      return false;
     }
 
     if (!checkV0leg<isMC>(pos) || !checkV0leg<isMC>(ele)) {
-      return;
+      return false;
     }
 
     // LOGF(info, "v0.collisionId() = %d , v0.posTrackId() = %d , v0.negTrackId() = %d", v0.collisionId(), v0.posTrackId(), v0.negTrackId());
@@ -448,7 +476,7 @@ struct PhotonConversionBuilder {
     auto pTrack = getTrackParCov(pos);
     if (moveTPCTracks && isTPConlyTrack(pos) && !mVDriftMgr.moveTPCTrack<TBCs, TCollisions>(collision, pos, pTrack)) {
       LOGP(error, "failed correction for positive tpc track");
-      return;
+      return false;
     }
     auto pTrackC = pTrack;
     pTrackC.setPID(o2::track::PID::Electron);
@@ -459,7 +487,7 @@ struct PhotonConversionBuilder {
     auto nTrack = getTrackParCov(ele);
     if (moveTPCTracks && isTPConlyTrack(ele) && !mVDriftMgr.moveTPCTrack<TBCs, TCollisions>(collision, ele, nTrack)) {
       LOGP(error, "failed correction for negative tpc track");
-      return;
+      return false;
     }
     auto nTrackC = nTrack;
     nTrackC.setPID(o2::track::PID::Electron);
@@ -468,37 +496,50 @@ struct PhotonConversionBuilder {
     auto eledcaZ = dcaInfo[1];
 
     if (std::fabs(posdcaXY) < dcapostopv || std::fabs(eledcaXY) < dcanegtopv) {
-      return;
+      return false;
     }
 
     float xyz[3] = {0.f, 0.f, 0.f};
     Vtx_recalculationParCov(o2::base::Propagator::Instance(), pTrack, nTrack, xyz, matCorr);
     float rxy_tmp = RecoDecay::sqrtSumOfSquares(xyz[0], xyz[1]);
     if (rxy_tmp > maxX + margin_r_tpc) {
-      return;
+      return false;
     }
     if (rxy_tmp < std::fabs(xyz[2]) * std::tan(2 * std::atan(std::exp(-max_eta_v0))) - margin_z) {
-      return; // RZ line cut
+      return false; // RZ line cut
     }
 
     KFPTrack kfp_track_pos = createKFPTrackFromTrackParCov(pTrack, pos.sign(), pos.tpcNClsFound(), pos.tpcChi2NCl());
     KFPTrack kfp_track_ele = createKFPTrackFromTrackParCov(nTrack, ele.sign(), ele.tpcNClsFound(), ele.tpcChi2NCl());
-    KFParticle kfp_pos(kfp_track_pos, kPositron);
-    KFParticle kfp_ele(kfp_track_ele, kElectron);
-    const KFParticle* GammaDaughters[2] = {&kfp_pos, &kfp_ele};
-
-    KFParticle gammaKF;
-    gammaKF.SetConstructMethod(2);
-    gammaKF.Construct(GammaDaughters, 2);
-    if (kfMassConstrain > -0.1) {
-      gammaKF.SetNonlinearMassConstraint(kfMassConstrain);
-    }
+    candidate.kf.daughters[0] = KFParticle(kfp_track_pos, kPositron);
+    candidate.kf.daughters[1] = KFParticle(kfp_track_ele, kElectron);
     KFPVertex kfpVertex = createKFPVertexFromCollision(collision);
-    KFParticle KFPV(kfpVertex);
+    candidate.kf.vertex = KFParticle(kfpVertex);
+    std::copy(xyz, xyz + 3, candidate.kf.point); // the gamma is transported to the recalculated decay vertex
+
+    candidate.v0Id = v0.globalIndex();
+    candidate.pTrack = pTrack;
+    candidate.nTrack = nTrack;
+    candidate.posdcaXY = posdcaXY;
+    candidate.posdcaZ = posdcaZ;
+    candidate.eledcaXY = eledcaXY;
+    candidate.eledcaZ = eledcaZ;
+    return true;
+  }
 
-    // Transport the gamma to the recalculated decay vertex
-    KFParticle gammaKF_DecayVtx = gammaKF; // with respect to (0,0,0)
-    gammaKF_DecayVtx.TransportToPoint(xyz);
+  // cuts after the KF fit and filling of the tables. fit holds mother and motherAtPoint, or the complete fit
+  template <bool isMC, class TCollisions, class TTracks, typename TV0>
+  void selectV0(TV0 const& v0, V0Candidate const& candidate, KFTwoProngFit& fit, const bool fitComplete, const bool filltable)
+  {
+    const auto& pos = v0.template posTrack_as<TTracks>();
+    const auto& ele = v0.template negTrack_as<TTracks>();
+    const auto& collision = v0.template collision_as<TCollisions>();
+    const auto& pTrack = candidate.pTrack;
+    const auto& nTrack = candidate.nTrack;
+    const float posdcaXY = candidate.posdcaXY, posdcaZ = candidate.posdcaZ;
+    const float eledcaXY = candidate.eledcaXY, eledcaZ = candidate.eledcaZ;
+    const KFParticle& KFPV = candidate.kf.vertex;
+    const KFParticle& gammaKF_DecayVtx = fit.motherAtPoint; // gamma at the recalculated decay vertex
 
     float cospa_kf = cpaFromKF(gammaKF_DecayVtx, KFPV);
     if (!ele.hasITS() && !pos.hasITS()) {
@@ -565,8 +606,11 @@ struct PhotonConversionBuilder {
     }
 
     // Apply a topological constraint of the gamma to the PV. Parameters will be given at the primary vertex.
-    KFParticle gammaKF_PV = gammaKF;
-    gammaKF_PV.SetProductionVertex(KFPV);
+    // The legs are transported to the decay vertex in the same step, without PV.
+    if (!fitComplete) {
+      kfConstrainTwoProng(candidate.kf, fit);
+    }
+    const KFParticle& gammaKF_PV = fit.motherWithVertex;
     float v0pt = RecoDecay::sqrtSumOfSquares(gammaKF_PV.GetPx(), gammaKF_PV.GetPy());
     float v0eta = RecoDecay::eta(std::array{gammaKF_PV.GetPx(), gammaKF_PV.GetPy(), gammaKF_PV.GetPz()});
     float v0phi = RecoDecay::constrainAngle(RecoDecay::phi(gammaKF_PV.GetPx(), gammaKF_PV.GetPy()));
@@ -586,10 +630,8 @@ struct PhotonConversionBuilder {
       return;
     }
 
-    KFParticle kfp_pos_DecayVtx = kfp_pos;  // Don't set Primary Vertex
-    KFParticle kfp_ele_DecayVtx = kfp_ele;  // Don't set Primary Vertex
-    kfp_pos_DecayVtx.TransportToPoint(xyz); // Don't set Primary Vertex
-    kfp_ele_DecayVtx.TransportToPoint(xyz); // Don't set Primary Vertex
+    const KFParticle& kfp_pos_DecayVtx = fit.daughtersAtPoint[0]; // Don't set Primary Vertex
+    const KFParticle& kfp_ele_DecayVtx = fit.daughtersAtPoint[1]; // Don't set Primary Vertex
 
     float pca_kf = kfp_pos_DecayVtx.GetDistanceFromParticle(kfp_ele_DecayVtx);
     if (!ele.hasITS() && !pos.hasITS()) { // V0s with TPConly-TPConly
@@ -711,12 +753,42 @@ struct PhotonConversionBuilder {
     } // end of fill table
   }
 
+  // same as fillV0Table(v0, false) for all the V0s of a collision, with the KF fits done in SIMD batches.
+  // The candidates and their fits are kept until the end of the DF for the filling of the tables
+  template <bool isMC, class TBCs, class TCollisions, class TTracks, typename TV0s>
+  void fillV0TableBatch(TV0s const& v0s_per_coll)
+  {
+    const int first = batch_candidates.size();
+    V0Candidate candidate;
+    for (const auto& v0 : v0s_per_coll) {
+      if (prepareV0<isMC, TBCs, TCollisions, TTracks>(v0, candidate)) {
+        batch_index_map[candidate.v0Id] = batch_candidates.size();
+        batch_candidates.push_back(candidate);
+        batch_kfCandidates.push_back(candidate.kf);
+      }
+    }
+    const int nCandidates = batch_candidates.size() - first;
+    batch_fits.resize(batch_candidates.size());
+    kfFitTwoProngs(batch_kfCandidates.data() + first, nCandidates, batch_fits.data() + first, 2, kfMassConstrain);
+    int index = first;
+    for (const auto& v0 : v0s_per_coll) {
+      if (index < first + nCandidates && batch_candidates[index].v0Id == v0.globalIndex()) {
+        selectV0<isMC, TCollisions, TTracks>(v0, batch_candidates[index], batch_fits[index], true, false);
+        index++;
+      }
+    }
+  }
+
   Preslice<aod::V0s> perCollision = o2::aod::v0::collisionId;
   std::map<std::tuple<int64_t, int64_t, int64_t, int64_t>, float> pca_map;      // (v0.globalIndex(), collision.globalIndex(), pos.globalIndex(), ele.globalIndex()) -> pca
   std::map<std::tuple<int64_t, int64_t, int64_t, int64_t>, float> cospa_map;    // (v0.globalIndex(), collision.globalIndex(), pos.globalIndex(), ele.globalIndex()) -> cospa
   std::vector<std::pair<int64_t, int64_t>> stored_v0Ids;                        // (pos.globalIndex(), ele.globalIndex())
   std::vector<std::tuple<int64_t, int64_t, int64_t, int64_t>> stored_fullv0Ids; // (v0.globalIndex(), collision.globalIndex(), pos.globalIndex(), ele.globalIndex())
   std::unordered_map<int64_t, int> nv0_map;                                     // map collisionId -> nv0
+  std::vector<V0Candidate> batch_candidates;                                    // V0s which passed the cuts before the KF fit, with useBatchKF
+  std::vector<KFTwoProngCandidate> batch_kfCandidates;                          // KF inputs of batch_candidates
+  std::vector<KFTwoProngFit> batch_fits;                                        // KF fits of batch_candidates
+  std::unordered_map<int64_t, int> batch_index_map;                             // map v0.globalIndex() -> index in batch_candidates
 
   template <bool isMC, bool isTriggerAnalysis, bool enableFilter, typename TCollisions, typename TV0s, typename TTracks, typename TBCs>
   void build(TCollisions const& collisions, TV0s const& v0s, TTracks const&, TBCs const&)
@@ -748,6 +820,10 @@ struct PhotonConversionBuilder {
 
       const auto& v0s_per_coll = v0s.sliceBy(perCollision, collision.globalIndex());
       // LOGF(info, "n v0 = %d", v0s_per_coll.size());
+      if (useBatchKF) {
+        fillV0TableBatch<isMC, TBCs, TCollisions, TTracks>(v0s_per_coll);
+        continue;
+      }
       for (const auto& v0 : v0s_per_coll) {
         // LOGF(info, "collision.globalIndex() = %d, v0.globalIndex() = %d, v0.posTrackId() = %d, v0.negTrackId() = %d", collision.globalIndex(), v0.globalIndex(), v0.posTrackId() , v0.negTrackId());
         fillV0Table<isMC, TBCs, TCollisions, TTracks>(v0, false);
@@ -825,6 +901,11 @@ struct PhotonConversionBuilder {
         // LOGF(info, "collision_tmp.globalIndex() = %d, collision_tmp.neeuls() = %d, nv0_map = %d", collision_tmp.globalIndex(), collision_tmp.neeuls(), nv0_map[collision_tmp.globalIndex()]);
       }
 
+      if (useBatchKF) {
+        const int index = batch_index_map[v0Id];
+        selectV0<isMC, TCollisions, TTracks>(v0, batch_candidates[index], batch_fits[index], true, true);
+        continue;
+      }
       fillV0Table<isMC, TBCs, TCollisions, TTracks>(v0, true);
     } // end of fullv0Id loop
 
@@ -844,6 +925,10 @@ struct PhotonConversionBuilder {
     stored_v0Ids.shrink_to_fit();
     stored_fullv0Ids.clear();
     stored_fullv0Ids.shrink_to_fit();
+    batch_candidates.clear();
+    batch_kfCandidates.clear();
+    batch_fits.clear();
+    batch_index_map.clear();
   } // end of build
 
   //! type of V0. 0: built solely for cascades (does not pass standard V0 cuts), 1: standard 2, 3: photon-like with TPC-only use. Regular analysis should always use type 1 or 3.
@@ -0,0 +1,153 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file DiphotonPairKernel.h
+/// \brief pair kinematics of whole blocks of photon pairs from per-event arrays, for same and mixed events
+/// \author agent <agent@local>
+///
+/// The four-momenta of the photons of an event (or of an event of the mixing pool) are computed once, when the
+/// photons are staged, instead of once per pair with ROOT::Math::PtEtaPhiMVector. For one photon and a block of
+/// partners, pairBlock() stores the squared mass and pT of each pair together with its rapidity and opening-angle
+/// decision: the rapidity cut is tested as |pz| <= E tanh(maxY) and the opening-angle cut on the cosine, so that
+/// neither the rapidity nor the angle of a pair is computed. Square roots are taken only for the pairs which are
+/// filled. fillAccepted() hands the accepted pairs to a filler such as o2::common::core::SparseHistFiller.
+
+#ifndef PWGEM_PHOTONMESON_UTILS_DIPHOTONPAIRKERNEL_H_
+#define PWGEM_PHOTONMESON_UTILS_DIPHOTONPAIRKERNEL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace o2::aod::pwgem::photonmeson::utils::pairkernel
+{
+/// kinematics of the photons (or dileptons) of one event
+struct PhotonArrays {
+  std::vector<double> e, px, py, pz, p;
+  std::vector<float> pt, eta, phi, mass; // as staged, for the mixing pools and the rotation background
+  std::vector<int64_t> ids;              // e.g. globalIndex()
+  std::vector<uint8_t> selected1;        // passes the cut of the first photon of a pair
+  std::vector<uint8_t> selected2;        // passes the cut of the second photon of a pair
+
+  std::size_t size() const { return e.size(); }
+
+  void clear()
+  {
+    for (auto* v : {&e, &px, &py, &pz, &p}) {
+      v->clear();
+    }
+    for (auto* v : {&pt, &eta, &phi, &mass}) {
+      v->clear();
+    }
+    ids.clear();
+    selected1.clear();
+    selected2.clear();
+  }
+
+  void add(float ptIn, float etaIn, float phiIn, float massIn, int64_t id = -1, bool isSelected1 = true, bool isSelected2 = true)
+  {
+    // same arithmetic as ROOT::Math::PtEtaPhiMVector
+    const double x = ptIn * std::cos(static_cast<double>(phiIn));
+    const double y = ptIn * std::sin(static_cast<double>(phiIn));
+    const double z = ptIn * std::sinh(static_cast<double>(etaIn));
+    const double momentum = std::sqrt(x * x + y * y + z * z);
+    px.push_back(x);
+    py.push_back(y);
+    pz.push_back(z);
+    p.push_back(momentum);
+    e.push_back(std::sqrt(momentum * momentum + static_cast<double>(massIn) * massIn));
+    pt.push_back(ptIn);
+    eta.push_back(etaIn);
+    phi.push_back(phiIn);
+    mass.push_back(massIn);
+    ids.push_back(id);
+    selected1.push_back(isSelected1);
+    selected2.push_back(isSelected2);
+  }
+
+  /// stages the tracks of an EventMixingHandler pool (pt(), eta(), phi(), mass())
+  template <typename TTracks>
+  void addTracks(TTracks const& tracks)
+  {
+    for (const auto& track : tracks) {
+      add(track.pt(), track.eta(), track.phi(), track.mass());
+    }
+  }
+};
+
+/// pair cuts of the kernel
+struct PairCuts {
+  double maxY = 1e+10;         // |rapidity| <= maxY
+  double minOpeningAngle = -1; // opening angle >= minOpeningAngle, not applied if negative
+};
+
+/// per-pair results of one photon with a block of photons. The squares are stored, the square roots are only
+/// taken for the accepted pairs
+struct PairBlock {
+  std::vector<double> mass2, pt2;
+  std::vector<uint8_t> accepted;
+
+  void resize(std::size_t n)
+  {
+    mass2.resize(n);
+    pt2.resize(n);
+    accepted.resize(n);
+  }
+
+  double mass(std::size_t j) const { return std::sqrt(mass2[j]); }
+  double pt(std::size_t j) const { return std::sqrt(pt2[j]); }
+};
+
+/// pairs photon i of a with the photons [first, last) of b. block.accepted is set for the pairs passing the
+/// rapidity and opening-angle cuts, whether or not the photons pass their selections
+inline void pairBlock(PhotonArrays const& a, std::size_t i, PhotonArrays const& b, std::size_t first, std::size_t last, PairCuts const& cuts, PairBlock& block)
+{
+  block.resize(last - first);
+  const double e1 = a.e[i], px1 = a.px[i], py1 = a.py[i], pz1 = a.pz[i], p1 = a.p[i];
+  const double tanhMaxY = std::tanh(cuts.maxY);
+  const bool checkAngle = cuts.minOpeningAngle >= 0.;
+  const double maxCosAngle = checkAngle ? std::cos(cuts.minOpeningAngle) : 2.;
+  const double* e2 = b.e.data() + first;
+  const double* px2 = b.px.data() + first;
+  const double* py2 = b.py.data() + first;
+  const double* pz2 = b.pz.data() + first;
+  const double* p2 = b.p.data() + first;
+  double* mass2 = block.mass2.data();
+  double* pt2 = block.pt2.data();
+  uint8_t* accepted = block.accepted.data();
+  const std::size_t n = last - first;
+  for (std::size_t j = 0; j < n; j++) {
+    const double e = e1 + e2[j];
+    const double px = px1 + px2[j];
+    const double py = py1 + py2[j];
+    const double pz = pz1 + pz2[j];
+    pt2[j] = px * px + py * py;
+    mass2[j] = std::max(e * e - (pt2[j] + pz * pz), 0.);
+    const double cosAngle = (px1 * px2[j] + py1 * py2[j] + pz1 * pz2[j]) / (p1 * p2[j]);
+    accepted[j] = (std::fabs(pz) <= e * tanhMaxY) & (cosAngle <= maxCosAngle);
+  }
+}
+
+/// fills the first n pairs of the block which are accepted, with filler.fill(mass, pT, weight)
+template <typename TFiller>
+inline void fillAccepted(PairBlock const& block, std::size_t n, double weight, TFiller& filler)
+{
+  for (std::size_t j = 0; j < n; j++) {
+    if (block.accepted[j]) {
+      filler.fill(block.mass(j), block.pt(j), weight);
+    }
+  }
+}
+} // namespace o2::aod::pwgem::photonmeson::utils::pairkernel
+
+#endif // PWGEM_PHOTONMESON_UTILS_DIPHOTONPAIRKERNEL_H_
@@ -19,9 +19,80 @@
 
 #include "Tools/ML/MlResponse.h"
 
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
 namespace o2::analysis
 {
 
+/// \brief Extractor of the ML input features of candidates
+///
+/// The configured input features are resolved once into a table of accessors (one function pointer
+/// per feature, see getFeatureAccessor in the channel classes), instead of once per candidate as
+/// getInputFeatures does with the same accessors. The features of one candidate are written into a
+/// buffer which is reused for all candidates, so no vector is allocated per candidate; those of a range
+/// of candidates into a row-major nCandidates x nFeatures buffer.
+/// The inference itself is still run per candidate with isSelectedMl.
+/// \tparam TCandidate candidate row type
+/// \tparam TArgs additional arguments of the accessors (e.g. the mass hypothesis)
+template <typename TCandidate, typename... TArgs>
+class HfMlFeatureExtractor
+{
+ public:
+  using Accessor = float (*)(TCandidate const&, TArgs...);
+
+  /// Remove all accessors
+  void clearAccessors()
+  {
+    mAccessors.clear();
+    mFeatures.clear();
+  }
+
+  /// Append an accessor to the feature table
+  void addAccessor(Accessor accessor)
+  {
+    mAccessors.push_back(accessor);
+    mFeatures.resize(mAccessors.size());
+  }
+
+  /// Fill the buffer with the features of a candidate
+  /// \return buffer with the input features, in the configured order, valid until the next call
+  std::vector<float>& extract(TCandidate const& candidate, TArgs... args)
+  {
+    float* feature = mFeatures.data();
+    for (const auto& accessor : mAccessors) {
+      *feature++ = accessor(candidate, args...);
+    }
+    return mFeatures;
+  }
+
+  /// Fill the buffer with the features of a range of candidates, one row of getNFeatures() values per candidate
+  /// \param candidates range of candidates, e.g. a std::span or a table
+  /// \param buffer resized to nCandidates x nFeatures, row-major
+  /// \return number of candidates
+  template <typename TCandidates>
+  std::size_t extract(TCandidates const& candidates, std::vector<float>& buffer, TArgs... args) const
+  {
+    const std::size_t nFeatures = mAccessors.size();
+    const std::size_t nCandidates = std::size(candidates);
+    buffer.resize(nCandidates * nFeatures);
+    float* feature = buffer.data();
+    for (const auto& candidate : candidates) {
+      for (const auto& accessor : mAccessors) {
+        *feature++ = accessor(candidate, args...);
+      }
+    }
+    return nCandidates;
+  }
+
+  std::size_t getNFeatures() const { return mAccessors.size(); }
+
+ private:
+  std::vector<Accessor> mAccessors; // resolved input features, in the configured order
+  std::vector<float> mFeatures;     // input features of the last extracted candidate
+};
+
 template <typename TypeOutputScore = float>
 class HfMlResponse : public MlResponse<TypeOutputScore>
 {
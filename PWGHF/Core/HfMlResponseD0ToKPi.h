@@ -35,85 +35,69 @@
     #FEATURE, static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE) \
   }
 
-// Check if the index of mCachedIndices (index associated to a FEATURE)
-// matches the entry in EnumInputFeatures associated to this FEATURE
-// if so, the inputFeatures vector is filled with the FEATURE's value
-// by calling the corresponding GETTER from OBJECT
-#define CHECK_AND_FILL_VEC_D0_FULL(OBJECT, FEATURE, GETTER)   \
-  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): { \
-    inputFeatures.emplace_back(OBJECT.GETTER());              \
-    break;                                                    \
+// Accessors used by getFeatureAccessor: if idx matches the entry in EnumInputFeatures
+// associated to this FEATURE, the accessor calling the corresponding GETTER from OBJECT is returned
+#define CHECK_AND_GET_ACCESSOR_D0_FULL(OBJECT, FEATURE, GETTER)            \
+  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): {              \
+    return [](T1 const& OBJECT, int) -> float { return OBJECT.GETTER(); }; \
   }
 
-// Specific case of CHECK_AND_FILL_VEC_D0_FULL(OBJECT, FEATURE, GETTER)
+// Specific case of CHECK_AND_GET_ACCESSOR_D0_FULL(OBJECT, FEATURE, GETTER)
 // where OBJECT is named candidate and FEATURE = GETTER
-#define CHECK_AND_FILL_VEC_D0(GETTER)                        \
-  case static_cast<uint8_t>(InputFeaturesD0ToKPi::GETTER): { \
-    inputFeatures.emplace_back(candidate.GETTER());          \
-    break;                                                   \
+#define CHECK_AND_GET_ACCESSOR_D0(GETTER)                                        \
+  case static_cast<uint8_t>(InputFeaturesD0ToKPi::GETTER): {                     \
+    return [](T1 const& candidate, int) -> float { return candidate.GETTER(); }; \
   }
 
-// Variation of CHECK_AND_FILL_VEC_D0_FULL(OBJECT, FEATURE, GETTER)
+// Variation of CHECK_AND_GET_ACCESSOR_D0_FULL(OBJECT, FEATURE, GETTER)
 // where GETTER is a method of HfHelper
-#define CHECK_AND_FILL_VEC_D0_HFHELPER(OBJECT, FEATURE, GETTER) \
-  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): {   \
-    inputFeatures.emplace_back(HfHelper::GETTER(OBJECT));       \
-    break;                                                      \
+#define CHECK_AND_GET_ACCESSOR_D0_HFHELPER(OBJECT, FEATURE, GETTER)                 \
+  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): {                       \
+    return [](T1 const& OBJECT, int) -> float { return HfHelper::GETTER(OBJECT); }; \
   }
 
-// Variation of CHECK_AND_FILL_VEC_D0_HFHELPER(OBJECT, FEATURE, GETTER)
+// Variation of CHECK_AND_GET_ACCESSOR_D0_HFHELPER(OBJECT, FEATURE, GETTER)
 // where GETTER1 and GETTER2 are methods of HfHelper, and the variable
 // is filled depending on whether it is a D0 or a D0bar
-#define CHECK_AND_FILL_VEC_D0_HFHELPER_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2) \
-  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): {                    \
-    if (pdgCode == o2::constants::physics::kD0) {                                \
-      inputFeatures.emplace_back(HfHelper::GETTER1(OBJECT));                     \
-    } else {                                                                     \
-      inputFeatures.emplace_back(HfHelper::GETTER2(OBJECT));                     \
-    }                                                                            \
-    break;                                                                       \
+#define CHECK_AND_GET_ACCESSOR_D0_HFHELPER_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2) \
+  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): {                        \
+    return [](T1 const& OBJECT, int pdgCode) -> float {                              \
+      if (pdgCode == o2::constants::physics::kD0) {                                  \
+        return HfHelper::GETTER1(OBJECT);                                            \
+      }                                                                              \
+      return HfHelper::GETTER2(OBJECT);                                              \
+    };                                                                               \
   }
 
-// Variation of CHECK_AND_FILL_VEC_D0_HFHELPER(OBJECT, FEATURE, GETTER)
-// where GETTER1 and GETTER2 are methods of HfHelper, and the variable
-// is filled depending on whether it is a D0 or a D0bar
-#define CHECK_AND_FILL_VEC_D0_OBJECT_HFHELPER_SIGNED(OBJECT1, OBJECT2, FEATURE, GETTER) \
-  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): {                           \
-    if (pdgCode == o2::constants::physics::kD0) {                                       \
-      inputFeatures.emplace_back(OBJECT1.GETTER());                                     \
-    } else {                                                                            \
-      inputFeatures.emplace_back(OBJECT2.GETTER());                                     \
-    }                                                                                   \
-    break;                                                                              \
-  }
-
-// Variation of CHECK_AND_FILL_VEC_D0_HFHELPER_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2)
+// Variation of CHECK_AND_GET_ACCESSOR_D0_HFHELPER_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2)
 // where GETTER1 and GETTER2 are methods of the OBJECT, and the variable
 // is filled depending on whether it is a D0 or a D0bar
-#define CHECK_AND_FILL_VEC_D0_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2) \
-  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): {           \
-    if (pdgCode == o2::constants::physics::kD0) {                       \
-      inputFeatures.emplace_back(OBJECT.GETTER1());                     \
-    } else {                                                            \
-      inputFeatures.emplace_back(OBJECT.GETTER2());                     \
-    }                                                                   \
-    break;                                                              \
+#define CHECK_AND_GET_ACCESSOR_D0_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2) \
+  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): {               \
+    return [](T1 const& OBJECT, int pdgCode) -> float {                     \
+      if (pdgCode == o2::constants::physics::kD0) {                         \
+        return OBJECT.GETTER1();                                            \
+      }                                                                     \
+      return OBJECT.GETTER2();                                              \
+    };                                                                      \
   }
 
-// Variation of CHECK_AND_FILL_VEC_D0_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2)
+// Variation of CHECK_AND_GET_ACCESSOR_D0_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2)
 // where GETTER1 and GETTER2 are methods of the OBJECT, the variable
 // is filled depending on whether it is a D0 or a D0bar
 // and INDEX is the index of the vector
-#define CHECK_AND_FILL_VEC_D0_ML(OBJECT, FEATURE, GETTER1, GETTER2, INDEX) \
-  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): {              \
-    if constexpr (usingMl) {                                               \
-      if (pdgCode == o2::constants::physics::kD0) {                        \
-        inputFeatures.emplace_back(OBJECT.GETTER1()[INDEX]);               \
-      } else {                                                             \
-        inputFeatures.emplace_back(OBJECT.GETTER2()[INDEX]);               \
-      }                                                                    \
-    }                                                                      \
-    break;                                                                 \
+// The feature is only available if the candidate has ML scores (usingMl)
+#define CHECK_AND_GET_ACCESSOR_D0_ML(OBJECT, FEATURE, GETTER1, GETTER2, INDEX) \
+  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): {                  \
+    if constexpr (usingMl) {                                                   \
+      return [](T1 const& OBJECT, int pdgCode) -> float {                      \
+        if (pdgCode == o2::constants::physics::kD0) {                          \
+          return OBJECT.GETTER1()[INDEX];                                      \
+        }                                                                      \
+        return OBJECT.GETTER2()[INDEX];                                        \
+      };                                                                       \
+    }                                                                          \
+    break;                                                                     \
   }
 
 namespace o2::analysis
@@ -175,6 +159,66 @@ class HfMlResponseD0ToKPi : public HfMlResponse<TypeOutputScore>
   /// Default destructor
   virtual ~HfMlResponseD0ToKPi() = default;
 
+  /// Method to get the accessor of an input feature
+  /// \param idx is the index of the feature in InputFeaturesD0ToKPi
+  /// \return function returning the feature value of a candidate for a given mass hypothesis (PDG code), nullptr if the feature is not available
+  template <bool usingMl = false, typename T1>
+  static typename HfMlFeatureExtractor<T1, int>::Accessor getFeatureAccessor(uint8_t idx)
+  {
+    switch (idx) {
+      CHECK_AND_GET_ACCESSOR_D0(chi2PCA);
+      CHECK_AND_GET_ACCESSOR_D0(decayLength);
+      CHECK_AND_GET_ACCESSOR_D0(decayLengthXY);
+      CHECK_AND_GET_ACCESSOR_D0(decayLengthNormalised);
+      CHECK_AND_GET_ACCESSOR_D0(decayLengthXYNormalised);
+      CHECK_AND_GET_ACCESSOR_D0(ptProng0);
+      CHECK_AND_GET_ACCESSOR_D0(ptProng1);
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, impactParameterXY0, impactParameter0);
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, impactParameterXY1, impactParameter1);
+      CHECK_AND_GET_ACCESSOR_D0(impactParameterZ0);
+      CHECK_AND_GET_ACCESSOR_D0(impactParameterZ1);
+      // TPC PID variables
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, nSigTpcPi0, /*getter*/ nSigTpcPi0);
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, nSigTpcKa0, /*getter*/ nSigTpcKa0);
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, nSigTpcPi1, /*getter*/ nSigTpcPi1);
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, nSigTpcKa1, /*getter*/ nSigTpcKa1);
+      CHECK_AND_GET_ACCESSOR_D0_SIGNED(candidate, nSigTpcPiExpPi, nSigTpcPi0, nSigTpcPi1);
+      CHECK_AND_GET_ACCESSOR_D0_SIGNED(candidate, nSigTpcKaExpPi, nSigTpcKa0, nSigTpcKa1);
+      CHECK_AND_GET_ACCESSOR_D0_SIGNED(candidate, nSigTpcPiExpKa, nSigTpcPi1, nSigTpcPi0);
+      CHECK_AND_GET_ACCESSOR_D0_SIGNED(candidate, nSigTpcKaExpKa, nSigTpcKa1, nSigTpcKa0);
+      // TOF PID variables
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, nSigTofPi0, /*getter*/ nSigTofPi0);
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, nSigTofKa0, /*getter*/ nSigTofKa0);
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, nSigTofPi1, /*getter*/ nSigTofPi1);
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, nSigTofKa1, /*getter*/ nSigTofKa1);
+      CHECK_AND_GET_ACCESSOR_D0_SIGNED(candidate, nSigTofPiExpPi, nSigTofPi0, nSigTofPi1);
+      CHECK_AND_GET_ACCESSOR_D0_SIGNED(candidate, nSigTofKaExpPi, nSigTofKa0, nSigTofKa1);
+      CHECK_AND_GET_ACCESSOR_D0_SIGNED(candidate, nSigTofPiExpKa, nSigTofPi1, nSigTofPi0);
+      CHECK_AND_GET_ACCESSOR_D0_SIGNED(candidate, nSigTofKaExpKa, nSigTofKa1, nSigTofKa0);
+      // Combined PID variables
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, nSigTpcTofPi0, tpcTofNSigmaPi0);
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, nSigTpcTofKa0, tpcTofNSigmaKa0);
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, nSigTpcTofPi1, tpcTofNSigmaPi1);
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, nSigTpcTofKa1, tpcTofNSigmaKa1);
+      CHECK_AND_GET_ACCESSOR_D0_SIGNED(candidate, nSigTpcTofPiExpPi, tpcTofNSigmaPi0, tpcTofNSigmaPi1);
+      CHECK_AND_GET_ACCESSOR_D0_SIGNED(candidate, nSigTpcTofKaExpPi, tpcTofNSigmaKa0, tpcTofNSigmaKa1);
+      CHECK_AND_GET_ACCESSOR_D0_SIGNED(candidate, nSigTpcTofPiExpKa, tpcTofNSigmaPi1, tpcTofNSigmaPi0);
+      CHECK_AND_GET_ACCESSOR_D0_SIGNED(candidate, nSigTpcTofKaExpKa, tpcTofNSigmaKa1, tpcTofNSigmaKa0);
+
+      CHECK_AND_GET_ACCESSOR_D0_ML(candidate, bdtOutputBkg, mlProbD0, mlProbD0bar, 0);
+      CHECK_AND_GET_ACCESSOR_D0_ML(candidate, bdtOutputNonPrompt, mlProbD0, mlProbD0bar, 1);
+      CHECK_AND_GET_ACCESSOR_D0_ML(candidate, bdtOutputPrompt, mlProbD0, mlProbD0bar, 2);
+
+      CHECK_AND_GET_ACCESSOR_D0(maxNormalisedDeltaIP);
+      CHECK_AND_GET_ACCESSOR_D0_FULL(candidate, impactParameterProduct, impactParameterProduct);
+      CHECK_AND_GET_ACCESSOR_D0_HFHELPER_SIGNED(candidate, cosThetaStar, cosThetaStarD0, cosThetaStarD0bar);
+      CHECK_AND_GET_ACCESSOR_D0(cpa);
+      CHECK_AND_GET_ACCESSOR_D0(cpaXY);
+      CHECK_AND_GET_ACCESSOR_D0_HFHELPER(candidate, ct, ctD0);
+    }
+    return nullptr;
+  }
+
   /// Method to get the input features vector needed for ML inference
   /// \param candidate is the D0 candidate
   /// \return inputFeatures vector
@@ -184,62 +228,27 @@ class HfMlResponseD0ToKPi : public HfMlResponse<TypeOutputScore>
     std::vector<float> inputFeatures;
 
     for (const auto& idx : MlResponse<TypeOutputScore>::mCachedIndices) {
-      switch (idx) {
-        CHECK_AND_FILL_VEC_D0(chi2PCA);
-        CHECK_AND_FILL_VEC_D0(decayLength);
-        CHECK_AND_FILL_VEC_D0(decayLengthXY);
-        CHECK_AND_FILL_VEC_D0(decayLengthNormalised);
-        CHECK_AND_FILL_VEC_D0(decayLengthXYNormalised);
-        CHECK_AND_FILL_VEC_D0(ptProng0);
-        CHECK_AND_FILL_VEC_D0(ptProng1);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, impactParameterXY0, impactParameter0);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, impactParameterXY1, impactParameter1);
-        CHECK_AND_FILL_VEC_D0(impactParameterZ0);
-        CHECK_AND_FILL_VEC_D0(impactParameterZ1);
-        // TPC PID variables
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, nSigTpcPi0, /*getter*/ nSigTpcPi0);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, nSigTpcKa0, /*getter*/ nSigTpcKa0);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, nSigTpcPi1, /*getter*/ nSigTpcPi1);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, nSigTpcKa1, /*getter*/ nSigTpcKa1);
-        CHECK_AND_FILL_VEC_D0_SIGNED(candidate, nSigTpcPiExpPi, nSigTpcPi0, nSigTpcPi1);
-        CHECK_AND_FILL_VEC_D0_SIGNED(candidate, nSigTpcKaExpPi, nSigTpcKa0, nSigTpcKa1);
-        CHECK_AND_FILL_VEC_D0_SIGNED(candidate, nSigTpcPiExpKa, nSigTpcPi1, nSigTpcPi0);
-        CHECK_AND_FILL_VEC_D0_SIGNED(candidate, nSigTpcKaExpKa, nSigTpcKa1, nSigTpcKa0);
-        // TOF PID variables
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, nSigTofPi0, /*getter*/ nSigTofPi0);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, nSigTofKa0, /*getter*/ nSigTofKa0);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, nSigTofPi1, /*getter*/ nSigTofPi1);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, nSigTofKa1, /*getter*/ nSigTofKa1);
-        CHECK_AND_FILL_VEC_D0_SIGNED(candidate, nSigTofPiExpPi, nSigTofPi0, nSigTofPi1);
-        CHECK_AND_FILL_VEC_D0_SIGNED(candidate, nSigTofKaExpPi, nSigTofKa0, nSigTofKa1);
-        CHECK_AND_FILL_VEC_D0_SIGNED(candidate, nSigTofPiExpKa, nSigTofPi1, nSigTofPi0);
-        CHECK_AND_FILL_VEC_D0_SIGNED(candidate, nSigTofKaExpKa, nSigTofKa1, nSigTofKa0);
-        // Combined PID variables
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, nSigTpcTofPi0, tpcTofNSigmaPi0);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, nSigTpcTofKa0, tpcTofNSigmaKa0);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, nSigTpcTofPi1, tpcTofNSigmaPi1);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, nSigTpcTofKa1, tpcTofNSigmaKa1);
-        CHECK_AND_FILL_VEC_D0_SIGNED(candidate, nSigTpcTofPiExpPi, tpcTofNSigmaPi0, tpcTofNSigmaPi1);
-        CHECK_AND_FILL_VEC_D0_SIGNED(candidate, nSigTpcTofKaExpPi, tpcTofNSigmaKa0, tpcTofNSigmaKa1);
-        CHECK_AND_FILL_VEC_D0_SIGNED(candidate, nSigTpcTofPiExpKa, tpcTofNSigmaPi1, tpcTofNSigmaPi0);
-        CHECK_AND_FILL_VEC_D0_SIGNED(candidate, nSigTpcTofKaExpKa, tpcTofNSigmaKa1, tpcTofNSigmaKa0);
-
-        CHECK_AND_FILL_VEC_D0_ML(candidate, bdtOutputBkg, mlProbD0, mlProbD0bar, 0);
-        CHECK_AND_FILL_VEC_D0_ML(candidate, bdtOutputNonPrompt, mlProbD0, mlProbD0bar, 1);
-        CHECK_AND_FILL_VEC_D0_ML(candidate, bdtOutputPrompt, mlProbD0, mlProbD0bar, 2);
-
-        CHECK_AND_FILL_VEC_D0(maxNormalisedDeltaIP);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, impactParameterProduct, impactParameterProduct);
-        CHECK_AND_FILL_VEC_D0_HFHELPER_SIGNED(candidate, cosThetaStar, cosThetaStarD0, cosThetaStarD0bar);
-        CHECK_AND_FILL_VEC_D0(cpa);
-        CHECK_AND_FILL_VEC_D0(cpaXY);
-        CHECK_AND_FILL_VEC_D0_HFHELPER(candidate, ct, ctD0);
+      if (auto accessor = getFeatureAccessor<usingMl, T1>(idx)) {
+        inputFeatures.emplace_back(accessor(candidate, pdgCode));
       }
     }
 
     return inputFeatures;
   }
 
+  /// Method to resolve the configured input features into the accessor table of a feature extractor
+  /// \param extractor is the feature extractor, filled with the features of candidates of type T1
+  template <bool usingMl = false, typename T1>
+  void initFeatureExtractor(HfMlFeatureExtractor<T1, int>& extractor) const
+  {
+    extractor.clearAccessors();
+    for (const auto& idx : MlResponse<TypeOutputScore>::mCachedIndices) {
+      if (auto accessor = getFeatureAccessor<usingMl, T1>(idx)) {
+        extractor.addAccessor(accessor);
+      }
+    }
+  }
+
  protected:
   /// Method to fill the map of available input features
   void setAvailableInputFeatures()
@@ -300,11 +309,11 @@ class HfMlResponseD0ToKPi : public HfMlResponse<TypeOutputScore>
 } // namespace o2::analysis
 
 #undef FILL_MAP_D0
-#undef CHECK_AND_FILL_VEC_D0_FULL
-#undef CHECK_AND_FILL_VEC_D0
-#undef CHECK_AND_FILL_VEC_D0_HFHELPER
-#undef CHECK_AND_FILL_VEC_D0_HFHELPER_SIGNED
-#undef CHECK_AND_FILL_VEC_D0_OBJECT_HFHELPER_SIGNED
-#undef CHECK_AND_FILL_VEC_D0_ML
+#undef CHECK_AND_GET_ACCESSOR_D0_FULL
+#undef CHECK_AND_GET_ACCESSOR_D0
+#undef CHECK_AND_GET_ACCESSOR_D0_HFHELPER
+#undef CHECK_AND_GET_ACCESSOR_D0_HFHELPER_SIGNED
+#undef CHECK_AND_GET_ACCESSOR_D0_SIGNED
+#undef CHECK_AND_GET_ACCESSOR_D0_ML
 
 #endif // PWGHF_CORE_HFMLRESPONSED0TOKPI_H_
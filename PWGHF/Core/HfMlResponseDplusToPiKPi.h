@@ -31,22 +31,18 @@
     #FEATURE, static_cast<uint8_t>(InputFeaturesDplusToPiKPi::FEATURE) \
   }
 
-// Check if the index of mCachedIndices (index associated to a FEATURE)
-// matches the entry in EnumInputFeatures associated to this FEATURE
-// if so, the inputFeatures vector is filled with the FEATURE's value
-// by calling the corresponding GETTER from OBJECT
-#define CHECK_AND_FILL_VEC_DPLUS_FULL(OBJECT, FEATURE, GETTER)     \
-  case static_cast<uint8_t>(InputFeaturesDplusToPiKPi::FEATURE): { \
-    inputFeatures.emplace_back(OBJECT.GETTER());                   \
-    break;                                                         \
+// Accessors used by getFeatureAccessor: if idx matches the entry in EnumInputFeatures
+// associated to this FEATURE, the accessor calling the corresponding GETTER from OBJECT is returned
+#define CHECK_AND_GET_ACCESSOR_DPLUS_FULL(OBJECT, FEATURE, GETTER)    \
+  case static_cast<uint8_t>(InputFeaturesDplusToPiKPi::FEATURE): {    \
+    return [](T1 const& OBJECT) -> float { return OBJECT.GETTER(); }; \
   }
 
-// Specific case of CHECK_AND_FILL_VEC_DPLUS_FULL(OBJECT, FEATURE, GETTER)
+// Specific case of CHECK_AND_GET_ACCESSOR_DPLUS_FULL(OBJECT, FEATURE, GETTER)
 // where OBJECT is named candidate and FEATURE = GETTER
-#define CHECK_AND_FILL_VEC_DPLUS(GETTER)                          \
-  case static_cast<uint8_t>(InputFeaturesDplusToPiKPi::GETTER): { \
-    inputFeatures.emplace_back(candidate.GETTER());               \
-    break;                                                        \
+#define CHECK_AND_GET_ACCESSOR_DPLUS(GETTER)                                \
+  case static_cast<uint8_t>(InputFeaturesDplusToPiKPi::GETTER): {           \
+    return [](T1 const& candidate) -> float { return candidate.GETTER(); }; \
   }
 
 namespace o2::analysis
@@ -99,6 +95,55 @@ class HfMlResponseDplusToPiKPi : public HfMlResponse<TypeOutputScore>
   /// Default destructor
   virtual ~HfMlResponseDplusToPiKPi() = default;
 
+  /// Method to get the accessor of an input feature
+  /// \param idx is the index of the feature in InputFeaturesDplusToPiKPi
+  /// \return function returning the feature value of a candidate, nullptr if the feature is not available
+  template <typename T1>
+  static typename HfMlFeatureExtractor<T1>::Accessor getFeatureAccessor(uint8_t idx)
+  {
+    switch (idx) {
+      CHECK_AND_GET_ACCESSOR_DPLUS(ptProng0);
+      CHECK_AND_GET_ACCESSOR_DPLUS(ptProng1);
+      CHECK_AND_GET_ACCESSOR_DPLUS(ptProng2);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, impactParameterXY0, impactParameter0);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, impactParameterXY1, impactParameter1);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, impactParameterXY2, impactParameter2);
+      CHECK_AND_GET_ACCESSOR_DPLUS(impactParameterZ0);
+      CHECK_AND_GET_ACCESSOR_DPLUS(impactParameterZ1);
+      CHECK_AND_GET_ACCESSOR_DPLUS(impactParameterZ2);
+      CHECK_AND_GET_ACCESSOR_DPLUS(decayLength);
+      CHECK_AND_GET_ACCESSOR_DPLUS(decayLengthXY);
+      CHECK_AND_GET_ACCESSOR_DPLUS(decayLengthNormalised);
+      CHECK_AND_GET_ACCESSOR_DPLUS(decayLengthXYNormalised);
+      CHECK_AND_GET_ACCESSOR_DPLUS(cpa);
+      CHECK_AND_GET_ACCESSOR_DPLUS(cpaXY);
+      CHECK_AND_GET_ACCESSOR_DPLUS(maxNormalisedDeltaIP);
+      CHECK_AND_GET_ACCESSOR_DPLUS(chi2PCA);
+      // TPC PID variables
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tpcNSigmaPi0, nSigTpcPi0);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tpcNSigmaKa0, nSigTpcKa0);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tpcNSigmaPi1, nSigTpcPi1);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tpcNSigmaKa1, nSigTpcKa1);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tpcNSigmaPi2, nSigTpcPi2);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tpcNSigmaKa2, nSigTpcKa2);
+      // TOF PID variables
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tofNSigmaPi0, nSigTofPi0);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tofNSigmaKa0, nSigTofKa0);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tofNSigmaPi1, nSigTofPi1);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tofNSigmaKa1, nSigTofKa1);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tofNSigmaPi2, nSigTofPi2);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tofNSigmaKa2, nSigTofKa2);
+      // Combined PID variables
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tpcTofNSigmaPi0, tpcTofNSigmaPi0);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tpcTofNSigmaPi1, tpcTofNSigmaPi1);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tpcTofNSigmaPi2, tpcTofNSigmaPi2);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tpcTofNSigmaKa0, tpcTofNSigmaKa0);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tpcTofNSigmaKa1, tpcTofNSigmaKa1);
+      CHECK_AND_GET_ACCESSOR_DPLUS_FULL(candidate, tpcTofNSigmaKa2, tpcTofNSigmaKa2);
+    }
+    return nullptr;
+  }
+
   /// Method to get the input features vector needed for ML inference
   /// \param candidate is the Dplus candidate
   /// \param prong0 is the candidate's prong0
@@ -111,51 +156,27 @@ class HfMlResponseDplusToPiKPi : public HfMlResponse<TypeOutputScore>
     std::vector<float> inputFeatures;
 
     for (const auto& idx : MlResponse<TypeOutputScore>::mCachedIndices) {
-      switch (idx) {
-        CHECK_AND_FILL_VEC_DPLUS(ptProng0);
-        CHECK_AND_FILL_VEC_DPLUS(ptProng1);
-        CHECK_AND_FILL_VEC_DPLUS(ptProng2);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, impactParameterXY0, impactParameter0);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, impactParameterXY1, impactParameter1);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, impactParameterXY2, impactParameter2);
-        CHECK_AND_FILL_VEC_DPLUS(impactParameterZ0);
-        CHECK_AND_FILL_VEC_DPLUS(impactParameterZ1);
-        CHECK_AND_FILL_VEC_DPLUS(impactParameterZ2);
-        CHECK_AND_FILL_VEC_DPLUS(decayLength);
-        CHECK_AND_FILL_VEC_DPLUS(decayLengthXY);
-        CHECK_AND_FILL_VEC_DPLUS(decayLengthNormalised);
-        CHECK_AND_FILL_VEC_DPLUS(decayLengthXYNormalised);
-        CHECK_AND_FILL_VEC_DPLUS(cpa);
-        CHECK_AND_FILL_VEC_DPLUS(cpaXY);
-        CHECK_AND_FILL_VEC_DPLUS(maxNormalisedDeltaIP);
-        CHECK_AND_FILL_VEC_DPLUS(chi2PCA);
-        // TPC PID variables
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tpcNSigmaPi0, nSigTpcPi0);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tpcNSigmaKa0, nSigTpcKa0);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tpcNSigmaPi1, nSigTpcPi1);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tpcNSigmaKa1, nSigTpcKa1);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tpcNSigmaPi2, nSigTpcPi2);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tpcNSigmaKa2, nSigTpcKa2);
-        // TOF PID variables
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tofNSigmaPi0, nSigTofPi0);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tofNSigmaKa0, nSigTofKa0);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tofNSigmaPi1, nSigTofPi1);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tofNSigmaKa1, nSigTofKa1);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tofNSigmaPi2, nSigTofPi2);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tofNSigmaKa2, nSigTofKa2);
-        // Combined PID variables
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tpcTofNSigmaPi0, tpcTofNSigmaPi0);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tpcTofNSigmaPi1, tpcTofNSigmaPi1);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tpcTofNSigmaPi2, tpcTofNSigmaPi2);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tpcTofNSigmaKa0, tpcTofNSigmaKa0);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tpcTofNSigmaKa1, tpcTofNSigmaKa1);
-        CHECK_AND_FILL_VEC_DPLUS_FULL(candidate, tpcTofNSigmaKa2, tpcTofNSigmaKa2);
+      if (auto accessor = getFeatureAccessor<T1>(idx)) {
+        inputFeatures.emplace_back(accessor(candidate));
       }
     }
 
     return inputFeatures;
   }
 
+  /// Method to resolve the configured input features into the accessor table of a feature extractor
+  /// \param extractor is the feature extractor, filled with the features of candidates of type T1
+  template <typename T1>
+  void initFeatureExtractor(HfMlFeatureExtractor<T1>& extractor) const
+  {
+    extractor.clearAccessors();
+    for (const auto& idx : MlResponse<TypeOutputScore>::mCachedIndices) {
+      if (auto accessor = getFeatureAccessor<T1>(idx)) {
+        extractor.addAccessor(accessor);
+      }
+    }
+  }
+
  protected:
   /// Method to fill the map of available input features
   void setAvailableInputFeatures()
@@ -205,7 +226,7 @@ class HfMlResponseDplusToPiKPi : public HfMlResponse<TypeOutputScore>
 } // namespace o2::analysis
 
 #undef FILL_MAP_DPLUS
-#undef CHECK_AND_FILL_VEC_DPLUS_FULL
-#undef CHECK_AND_FILL_VEC_DPLUS
+#undef CHECK_AND_GET_ACCESSOR_DPLUS_FULL
+#undef CHECK_AND_GET_ACCESSOR_DPLUS
 
 #endif // PWGHF_CORE_HFMLRESPONSEDPLUSTOPIKPI_H_
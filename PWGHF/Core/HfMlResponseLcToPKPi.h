@@ -34,55 +34,38 @@
     #FEATURE, static_cast<uint8_t>(InputFeaturesLcToPKPi::FEATURE) \
   }
 
-// Check if the index of mCachedIndices (index associated to a FEATURE)
-// matches the entry in EnumInputFeatures associated to this FEATURE
-// if so, the inputFeatures vector is filled with the FEATURE's value
-// by calling the corresponding GETTER from OBJECT
-#define CHECK_AND_FILL_VEC_LCTOPKPI_FULL(OBJECT, FEATURE, GETTER) \
-  case static_cast<uint8_t>(InputFeaturesLcToPKPi::FEATURE): {    \
-    inputFeatures.emplace_back(OBJECT.GETTER());                  \
-    break;                                                        \
+// Accessors used by getFeatureAccessor: if idx matches the entry in EnumInputFeatures
+// associated to this FEATURE, the accessor calling the corresponding GETTER from OBJECT is returned
+#define CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(OBJECT, FEATURE, GETTER)       \
+  case static_cast<uint8_t>(InputFeaturesLcToPKPi::FEATURE): {              \
+    return [](T1 const& OBJECT, bool) -> float { return OBJECT.GETTER(); }; \
   }
 
-// Specific case of CHECK_AND_FILL_VEC_LCTOPKPI_FULL(OBJECT, FEATURE, GETTER)
+// Specific case of CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(OBJECT, FEATURE, GETTER)
 // where OBJECT is named candidate and FEATURE = GETTER
-#define CHECK_AND_FILL_VEC_LCTOPKPI(GETTER)                   \
-  case static_cast<uint8_t>(InputFeaturesLcToPKPi::GETTER): { \
-    inputFeatures.emplace_back(candidate.GETTER());           \
-    break;                                                    \
+#define CHECK_AND_GET_ACCESSOR_LCTOPKPI(GETTER)                                   \
+  case static_cast<uint8_t>(InputFeaturesLcToPKPi::GETTER): {                     \
+    return [](T1 const& candidate, bool) -> float { return candidate.GETTER(); }; \
   }
 
-// Variation of CHECK_AND_FILL_VEC_LCTOPKPI_FULL(OBJECT, FEATURE, GETTER)
+// Variation of CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(OBJECT, FEATURE, GETTER)
 // where GETTER is a method of HfHelper
-#define CHECK_AND_FILL_VEC_LCTOPKPI_HFHELPER(OBJECT, FEATURE, GETTER) \
-  case static_cast<uint8_t>(InputFeaturesLcToPKPi::FEATURE): {        \
-    inputFeatures.emplace_back(HfHelper::GETTER(OBJECT));             \
-    break;                                                            \
-  }
-
-// Variation of CHECK_AND_FILL_VEC_LCTOPKPI_OBJECT_SIGNED(OBJECT1, OBJECT2, FEATURE, GETTER)
-// where OBJECT1 and OBJECT2 are the objects from which we call the GETTER method, and the variable
-// is filled depending on whether it is a LcToPKPi or a LcToPiKP
-#define CHECK_AND_FILL_VEC_LCTOPKPI_OBJECT_SIGNED(OBJECT1, OBJECT2, FEATURE, GETTER) \
+#define CHECK_AND_GET_ACCESSOR_LCTOPKPI_HFHELPER(OBJECT, FEATURE, GETTER)            \
   case static_cast<uint8_t>(InputFeaturesLcToPKPi::FEATURE): {                       \
-    if (caseLcToPKPi) {                                                              \
-      inputFeatures.emplace_back(OBJECT1.GETTER());                                  \
-    } else {                                                                         \
-      inputFeatures.emplace_back(OBJECT2.GETTER());                                  \
-    }                                                                                \
-    break;                                                                           \
+    return [](T1 const& OBJECT, bool) -> float { return HfHelper::GETTER(OBJECT); }; \
   }
 
-// Variation of CHECK_AND_FILL_VEC_LCTOPKPI_HFHELPER_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2)
-// where GETTER1 and GETTER2 are methods of the OBJECT
-#define CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2) \
-  case static_cast<uint8_t>(InputFeaturesLcToPKPi::FEATURE): {                \
-    if (caseLcToPKPi) {                                                       \
-      inputFeatures.emplace_back(OBJECT.GETTER1());                           \
-    } else {                                                                  \
-      inputFeatures.emplace_back(OBJECT.GETTER2());                           \
-    }                                                                         \
-    break;                                                                    \
+// Variation of CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(OBJECT, FEATURE, GETTER)
+// where GETTER1 and GETTER2 are methods of the OBJECT, and the variable
+// is filled depending on whether it is a LcToPKPi or a LcToPiKP
+#define CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2) \
+  case static_cast<uint8_t>(InputFeaturesLcToPKPi::FEATURE): {                    \
+    return [](T1 const& OBJECT, bool caseLcToPKPi) -> float {                     \
+      if (caseLcToPKPi) {                                                         \
+        return OBJECT.GETTER1();                                                  \
+      }                                                                           \
+      return OBJECT.GETTER2();                                                    \
+    };                                                                            \
   }
 
 namespace o2::analysis
@@ -159,6 +142,86 @@ class HfMlResponseLcToPKPi : public HfMlResponse<TypeOutputScore>
   /// Default destructor
   virtual ~HfMlResponseLcToPKPi() = default;
 
+  /// Method to get the accessor of an input feature
+  /// \param idx is the index of the feature in InputFeaturesLcToPKPi
+  /// \return function returning the feature value of a candidate for a given mass hypothesis (LcToPKPi or LcToPiKP), nullptr if the feature is not available
+  template <typename T1>
+  static typename HfMlFeatureExtractor<T1, bool>::Accessor getFeatureAccessor(uint8_t idx)
+  {
+    switch (idx) {
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI(ptProng0);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI(ptProng1);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI(ptProng2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, impactParameterXY0, impactParameter0);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, impactParameterXY1, impactParameter1);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, impactParameterXY2, impactParameter2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI(impactParameterZ0);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI(impactParameterZ1);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI(impactParameterZ2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI(decayLength);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI(decayLengthXY);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI(decayLengthXYNormalised);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI(cpa);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI(cpaXY);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI(chi2PCA);
+      // TPC PID variables
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcNSigmaPr0, nSigTpcPr0);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcNSigmaKa0, nSigTpcKa0);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcNSigmaPi0, nSigTpcPi0);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcNSigmaPr1, nSigTpcPr1);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcNSigmaKa1, nSigTpcKa1);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcNSigmaPi1, nSigTpcPi1);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcNSigmaPr2, nSigTpcPr2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcNSigmaKa2, nSigTpcKa2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcNSigmaPi2, nSigTpcPi2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(candidate, tpcNSigmaPrExpPr0, nSigTpcPr0, nSigTpcPr2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(candidate, tpcNSigmaPiExpPi2, nSigTpcPi2, nSigTpcPi0);
+      // TOF PID variables
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tofNSigmaPr0, nSigTofPr0);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tofNSigmaKa0, nSigTofKa0);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tofNSigmaPi0, nSigTofPi0);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tofNSigmaPr1, nSigTofPr1);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tofNSigmaKa1, nSigTofKa1);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tofNSigmaPi1, nSigTofPi1);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tofNSigmaPr2, nSigTofPr2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tofNSigmaKa2, nSigTofKa2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tofNSigmaPi2, nSigTofPi2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(candidate, tofNSigmaPrExpPr0, nSigTofPr0, nSigTofPr2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(candidate, tofNSigmaPiExpPi2, nSigTofPi2, nSigTofPi0);
+      // Combined PID variables
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcTofNSigmaPi0, tpcTofNSigmaPi0);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcTofNSigmaPi1, tpcTofNSigmaPi1);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcTofNSigmaPi2, tpcTofNSigmaPi2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcTofNSigmaKa0, tpcTofNSigmaKa0);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcTofNSigmaKa1, tpcTofNSigmaKa1);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcTofNSigmaKa2, tpcTofNSigmaKa2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcTofNSigmaPr0, tpcTofNSigmaPr0);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcTofNSigmaPr1, tpcTofNSigmaPr1);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, tpcTofNSigmaPr2, tpcTofNSigmaPr2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(candidate, tpcTofNSigmaPrExpPr0, tpcTofNSigmaPr0, tpcTofNSigmaPr2);
+      CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(candidate, tpcTofNSigmaPiExpPi2, tpcTofNSigmaPi2, tpcTofNSigmaPi0);
+    }
+    if constexpr (reconstructionType == aod::hf_cand::VertexerType::KfParticle) {
+      switch (idx) {
+        CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(candidate, kfChi2PrimProton, kfChi2PrimProng0, kfChi2PrimProng2);
+        CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, kfChi2PrimKaon, kfChi2PrimProng1);
+        CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(candidate, kfChi2PrimPion, kfChi2PrimProng2, kfChi2PrimProng0);
+        CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(candidate, kfChi2GeoKaonPion, kfChi2GeoProng1Prong2, kfChi2GeoProng0Prong1);
+        CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, kfChi2GeoProtonPion, kfChi2GeoProng0Prong2);
+        CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(candidate, kfChi2GeoProtonKaon, kfChi2GeoProng0Prong1, kfChi2GeoProng1Prong2);
+        CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(candidate, kfDcaKaonPion, kfDcaProng1Prong2, kfDcaProng0Prong1);
+        CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL(candidate, kfDcaProtonPion, kfDcaProng0Prong2);
+        CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED(candidate, kfDcaProtonKaon, kfDcaProng0Prong1, kfDcaProng1Prong2);
+        CHECK_AND_GET_ACCESSOR_LCTOPKPI(kfChi2Geo);
+        CHECK_AND_GET_ACCESSOR_LCTOPKPI(kfChi2Topo);
+        case static_cast<uint8_t>(InputFeaturesLcToPKPi::kfDecayLengthNormalised): {
+          return [](T1 const& candidate, bool) -> float { return candidate.kfDecayLength() / candidate.kfDecayLengthError(); };
+        }
+      }
+    }
+    return nullptr;
+  }
+
   /// Method to get the input features vector needed for ML inference
   /// \param candidate is the Lc candidate
   /// \param prong0 is the candidate's prong0
@@ -171,82 +234,27 @@ class HfMlResponseLcToPKPi : public HfMlResponse<TypeOutputScore>
     std::vector<float> inputFeatures;
 
     for (const auto& idx : MlResponse<TypeOutputScore>::mCachedIndices) {
-      switch (idx) {
-        CHECK_AND_FILL_VEC_LCTOPKPI(ptProng0);
-        CHECK_AND_FILL_VEC_LCTOPKPI(ptProng1);
-        CHECK_AND_FILL_VEC_LCTOPKPI(ptProng2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, impactParameterXY0, impactParameter0);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, impactParameterXY1, impactParameter1);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, impactParameterXY2, impactParameter2);
-        CHECK_AND_FILL_VEC_LCTOPKPI(impactParameterZ0);
-        CHECK_AND_FILL_VEC_LCTOPKPI(impactParameterZ1);
-        CHECK_AND_FILL_VEC_LCTOPKPI(impactParameterZ2);
-        CHECK_AND_FILL_VEC_LCTOPKPI(decayLength);
-        CHECK_AND_FILL_VEC_LCTOPKPI(decayLengthXY);
-        CHECK_AND_FILL_VEC_LCTOPKPI(decayLengthXYNormalised);
-        CHECK_AND_FILL_VEC_LCTOPKPI(cpa);
-        CHECK_AND_FILL_VEC_LCTOPKPI(cpaXY);
-        CHECK_AND_FILL_VEC_LCTOPKPI(chi2PCA);
-        // TPC PID variables
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcNSigmaPr0, nSigTpcPr0);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcNSigmaKa0, nSigTpcKa0);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcNSigmaPi0, nSigTpcPi0);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcNSigmaPr1, nSigTpcPr1);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcNSigmaKa1, nSigTpcKa1);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcNSigmaPi1, nSigTpcPi1);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcNSigmaPr2, nSigTpcPr2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcNSigmaKa2, nSigTpcKa2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcNSigmaPi2, nSigTpcPi2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(candidate, tpcNSigmaPrExpPr0, nSigTpcPr0, nSigTpcPr2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(candidate, tpcNSigmaPiExpPi2, nSigTpcPi2, nSigTpcPi0);
-        // TOF PID variables
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tofNSigmaPr0, nSigTofPr0);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tofNSigmaKa0, nSigTofKa0);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tofNSigmaPi0, nSigTofPi0);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tofNSigmaPr1, nSigTofPr1);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tofNSigmaKa1, nSigTofKa1);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tofNSigmaPi1, nSigTofPi1);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tofNSigmaPr2, nSigTofPr2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tofNSigmaKa2, nSigTofKa2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tofNSigmaPi2, nSigTofPi2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(candidate, tofNSigmaPrExpPr0, nSigTofPr0, nSigTofPr2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(candidate, tofNSigmaPiExpPi2, nSigTofPi2, nSigTofPi0);
-        // Combined PID variables
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcTofNSigmaPi0, tpcTofNSigmaPi0);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcTofNSigmaPi1, tpcTofNSigmaPi1);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcTofNSigmaPi2, tpcTofNSigmaPi2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcTofNSigmaKa0, tpcTofNSigmaKa0);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcTofNSigmaKa1, tpcTofNSigmaKa1);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcTofNSigmaKa2, tpcTofNSigmaKa2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcTofNSigmaPr0, tpcTofNSigmaPr0);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcTofNSigmaPr1, tpcTofNSigmaPr1);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, tpcTofNSigmaPr2, tpcTofNSigmaPr2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(candidate, tpcTofNSigmaPrExpPr0, tpcTofNSigmaPr0, tpcTofNSigmaPr2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(candidate, tpcTofNSigmaPiExpPi2, tpcTofNSigmaPi2, tpcTofNSigmaPi0);
-      }
-      if constexpr (reconstructionType == aod::hf_cand::VertexerType::KfParticle) {
-        switch (idx) {
-          CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(candidate, kfChi2PrimProton, kfChi2PrimProng0, kfChi2PrimProng2);
-          CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, kfChi2PrimKaon, kfChi2PrimProng1);
-          CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(candidate, kfChi2PrimPion, kfChi2PrimProng2, kfChi2PrimProng0);
-          CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(candidate, kfChi2GeoKaonPion, kfChi2GeoProng1Prong2, kfChi2GeoProng0Prong1);
-          CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, kfChi2GeoProtonPion, kfChi2GeoProng0Prong2);
-          CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(candidate, kfChi2GeoProtonKaon, kfChi2GeoProng0Prong1, kfChi2GeoProng1Prong2);
-          CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(candidate, kfDcaKaonPion, kfDcaProng1Prong2, kfDcaProng0Prong1);
-          CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, kfDcaProtonPion, kfDcaProng0Prong2);
-          CHECK_AND_FILL_VEC_LCTOPKPI_SIGNED(candidate, kfDcaProtonKaon, kfDcaProng0Prong1, kfDcaProng1Prong2);
-          CHECK_AND_FILL_VEC_LCTOPKPI(kfChi2Geo);
-          CHECK_AND_FILL_VEC_LCTOPKPI(kfChi2Topo);
-          case static_cast<uint8_t>(InputFeaturesLcToPKPi::kfDecayLengthNormalised): {
-            inputFeatures.emplace_back(candidate.kfDecayLength() / candidate.kfDecayLengthError());
-            break;
-          }
-        }
+      if (auto accessor = getFeatureAccessor<T1>(idx)) {
+        inputFeatures.emplace_back(accessor(candidate, caseLcToPKPi));
       }
     }
+
     return inputFeatures;
   }
 
+  /// Method to resolve the configured input features into the accessor table of a feature extractor
+  /// \param extractor is the feature extractor, filled with the features of candidates of type T1
+  template <typename T1>
+  void initFeatureExtractor(HfMlFeatureExtractor<T1, bool>& extractor) const
+  {
+    extractor.clearAccessors();
+    for (const auto& idx : MlResponse<TypeOutputScore>::mCachedIndices) {
+      if (auto accessor = getFeatureAccessor<T1>(idx)) {
+        extractor.addAccessor(accessor);
+      }
+    }
+  }
+
  protected:
   /// Method to fill the map of available input features
   void setAvailableInputFeatures()
@@ -326,9 +334,9 @@ class HfMlResponseLcToPKPi : public HfMlResponse<TypeOutputScore>
 } // namespace o2::analysis
 
 #undef FILL_MAP_LCTOPKPI
-#undef CHECK_AND_FILL_VEC_LCTOPKPI_FULL
-#undef CHECK_AND_FILL_VEC_LCTOPKPI
-#undef CHECK_AND_FILL_VEC_LCTOPKPI_HFHELPER
-#undef CHECK_AND_FILL_VEC_LCTOPKPI_OBJECT_SIGNED
+#undef CHECK_AND_GET_ACCESSOR_LCTOPKPI_FULL
+#undef CHECK_AND_GET_ACCESSOR_LCTOPKPI
+#undef CHECK_AND_GET_ACCESSOR_LCTOPKPI_HFHELPER
+#undef CHECK_AND_GET_ACCESSOR_LCTOPKPI_SIGNED
 
 #endif // PWGHF_CORE_HFMLRESPONSELCTOPKPI_H_
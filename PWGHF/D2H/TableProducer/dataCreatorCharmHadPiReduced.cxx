@@ -224,6 +224,39 @@ struct HfDataCreatorCharmHadPiReduced {
   static constexpr std::size_t NDaughtersDstar{2u};
   bool isHfCandBhadConfigFilled = false;
 
+  /// Bachelor pions of the current collision, selected and re-propagated once per collision and stored in
+  /// contiguous columns, so that the pairing with each charm-hadron candidate runs over plain arrays
+  struct PionColumns {
+    std::vector<int64_t> globalIndex;
+    std::vector<int8_t> sign;
+    std::vector<float> px;
+    std::vector<float> py;
+    std::vector<float> pz;
+    std::vector<float> pt;
+    std::vector<double> energy;                      // pion mass hypothesis
+    std::vector<o2::track::TrackParCov> trackParCov; // at the collision vertex, read only for the selected pairs
+    std::vector<uint8_t> pairSel;                    // pairing with the current charm-hadron candidate, see PairSel
+
+    std::size_t size() const { return globalIndex.size(); }
+    void clear()
+    {
+      globalIndex.clear();
+      sign.clear();
+      px.clear();
+      py.clear();
+      pz.clear();
+      pt.clear();
+      energy.clear();
+      trackParCov.clear();
+    }
+  } pionColumns;
+
+  enum PairSel : uint8_t {
+    Rejected = 0,
+    Preselected,  // opposite sign and not a charm-hadron daughter
+    InMassWindow, // preselected and in the invariant-mass window
+  };
+
   // Fitter to redo D-vertex to get extrapolated daughter tracks (2/3-prong vertex filter)
   o2::vertexing::DCAFitterN<3> df3;
   o2::vertexing::DCAFitterN<2> df2;
@@ -411,14 +444,13 @@ struct HfDataCreatorCharmHadPiReduced {
     }
   }
 
-  /// Pion selection (D Pi <-- B0)
+  /// Pion selection (D Pi <-- B0), the rejection of the charm-hadron daughters is done in the pairing
   /// \param trackPion is a track with the pion hypothesis
   /// \param trackParCovPion is the track parametrisation of the pion
   /// \param dcaPion is the 2-D array with track DCAs of the pion
-  /// \param charmDautracks charm-hadron daughter tracks
   /// \return true if trackPion passes all cuts
   template <typename T1, typename T2, typename T3>
-  bool isPionSelected(const T1& trackPion, const T2& trackParCovPion, const T3& dcaPion, const std::vector<T1>& charmDautracks)
+  bool isPionSelected(const T1& trackPion, const T2& trackParCovPion, const T3& dcaPion)
   {
     // check isGlobalTrackWoDCA status for pions if wanted
     if (trackPionConfigurations.usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
@@ -428,16 +460,71 @@ struct HfDataCreatorCharmHadPiReduced {
     if (trackParCovPion.getPt() < trackPionConfigurations.ptPionMin || std::abs(trackParCovPion.getEta()) > trackPionConfigurations.etaPionMax || !isSelectedTrackDCA(trackParCovPion, dcaPion, trackPionConfigurations.binsPtPion, trackPionConfigurations.cutsTrackPionDCA)) {
       return false;
     }
-    // reject pions that are charm-hadron daughters
-    for (const auto& track : charmDautracks) {
-      if (trackPion.globalIndex() == track.globalIndex()) {
-        return false;
-      }
-    }
 
     return true;
   }
 
+  /// Fills pionColumns with the selected pions of the collision, propagated to the collision vertex if they were
+  /// associated to another one
+  /// \param collision is the current collision
+  /// \param trackIndices are the indices of the tracks associated to the collision
+  template <typename TTracks, typename Coll>
+  void stagePions(Coll const& collision, aod::TrackAssoc const& trackIndices)
+  {
+    pionColumns.clear();
+    for (const auto& trackId : trackIndices) {
+      auto trackPion = trackId.template track_as<TTracks>();
+      auto trackParCovPion = getTrackParCov(trackPion);
+      std::array<float, 2> dcaPion{trackPion.dcaXY(), trackPion.dcaZ()};
+      std::array<float, 3> pVecPion = trackPion.pVector();
+      if (trackPion.collisionId() != collision.globalIndex()) {
+        o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParCovPion, 2.f, noMatCorr, &dcaPion);
+        getPxPyPz(trackParCovPion, pVecPion);
+      }
+      if (!isPionSelected(trackPion, trackParCovPion, dcaPion)) {
+        continue;
+      }
+      pionColumns.globalIndex.push_back(trackPion.globalIndex());
+      pionColumns.sign.push_back(trackPion.sign());
+      pionColumns.px.push_back(pVecPion[0]);
+      pionColumns.py.push_back(pVecPion[1]);
+      pionColumns.pz.push_back(pVecPion[2]);
+      pionColumns.pt.push_back(trackParCovPion.getPt());
+      pionColumns.energy.push_back(RecoDecay::e(pVecPion, MassPiPlus));
+      pionColumns.trackParCov.push_back(trackParCovPion);
+    }
+    pionColumns.pairSel.resize(pionColumns.size());
+  }
+
+  /// Pairs a charm-hadron candidate with the staged pions: charge, rejection of the daughters and
+  /// invariant-mass window, with the result in pionColumns.pairSel
+  /// \param pVecCharm is the momentum of the charm hadron
+  /// \param daughterIds are the global indices of the charm-hadron daughters, -1 if unused
+  /// \param allowPositive (allowNegative) enables the pairing with positive (negative) pions
+  void pairPions(std::array<float, 3> const& pVecCharm, std::array<int64_t, 3> const& daughterIds, bool allowPositive, bool allowNegative)
+  {
+    // same arithmetic as RecoDecay::m2, so that the selected pairs are the same
+    const double energyCharm = RecoDecay::e(pVecCharm, massC);
+    const double pxCharm = pVecCharm[0], pyCharm = pVecCharm[1], pzCharm = pVecCharm[2];
+    const std::size_t nPions = pionColumns.size();
+    const int64_t* globalIndex = pionColumns.globalIndex.data();
+    const int8_t* sign = pionColumns.sign.data();
+    const float* px = pionColumns.px.data();
+    const float* py = pionColumns.py.data();
+    const float* pz = pionColumns.pz.data();
+    const double* energy = pionColumns.energy.data();
+    uint8_t* pairSel = pionColumns.pairSel.data();
+    for (std::size_t iPion = 0; iPion < nPions; ++iPion) {
+      const bool chargeOk = (sign[iPion] > 0 && allowPositive) || (sign[iPion] < 0 && allowNegative);
+      const bool isDaughter = globalIndex[iPion] == daughterIds[0] || globalIndex[iPion] == daughterIds[1] || globalIndex[iPion] == daughterIds[2];
+      const double pxTot = pxCharm + px[iPion], pyTot = pyCharm + py[iPion], pzTot = pzCharm + pz[iPion];
+      const double energyTot = energyCharm + energy[iPion];
+      const double invMass2 = energyTot * energyTot - (pxTot * pxTot + pyTot * pyTot + pzTot * pzTot);
+      const bool inMassWindow = invMass2 >= invMass2ChHadPiMin && invMass2 <= invMass2ChHadPiMax;
+      pairSel[iPion] = (chargeOk && !isDaughter) ? (inMassWindow ? PairSel::InMassWindow : PairSel::Preselected) : PairSel::Rejected;
+    }
+  }
+
   /// Calculates the index of the collision with the maximum number of contributions.
   ///\param collisions are the collisions to search through.
   ///\return The index of the collision with the maximum number of contributions.
@@ -1018,7 +1105,7 @@ struct HfDataCreatorCharmHadPiReduced {
   void runDataCreation(Coll const& collision,
                        CCharmCands const& candsC,
                        aod::TrackAssoc const& trackIndices,
-                       TTracks const&,
+                       TTracks const& tracks,
                        PParticles const& particlesMc,
                        uint64_t const& indexCollisionMaxNumContrib,
                        BBCs const&)
@@ -1058,6 +1145,9 @@ struct HfDataCreatorCharmHadPiReduced {
     df3.setBz(bz);
 
     auto thisCollId = collision.globalIndex();
+    if (candsC.size() > 0) {
+      stagePions<TTracks>(collision, trackIndices);
+    }
     for (const auto& candC : candsC) {
       int indexHfCandCharm{-1};
       float invMassC0{-1.f}, invMassC1{-1.f};
@@ -1266,49 +1356,40 @@ struct HfDataCreatorCharmHadPiReduced {
         }
       }
 
-      for (const auto& trackId : trackIndices) {
-        auto trackPion = trackId.template track_as<TTracks>();
-
-        // apply selections on pion tracks
-        auto trackParCovPion = getTrackParCov(trackPion);
-        std::array<float, 2> dcaPion{trackPion.dcaXY(), trackPion.dcaZ()};
-        std::array<float, 3> pVecPion = trackPion.pVector();
-        if (trackPion.collisionId() != thisCollId) {
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParCovPion, 2.f, noMatCorr, &dcaPion);
-          getPxPyPz(trackParCovPion, pVecPion);
-        }
-
-        // reject pi D with same sign as D
-        if constexpr (DecChannel == DecayChannel::B0ToDminusPi || DecChannel == DecayChannel::BsToDsminusPi || DecChannel == DecayChannel::LbToLcplusPi) { // D∓ → π∓ K± π∓ and Ds∓ → K∓ K± π∓ and Lc∓ → p∓ K± π∓
-          if (trackPion.sign() * charmHadDauTracks[0].sign() > 0) {
-            continue;
-          }
-        } else if constexpr (DecChannel == DecayChannel::BplusToD0barPi) { // D0(bar) → K± π∓
-          if (!((candC.isSelD0() >= hfflagConfigurations.selectionFlagD0 && trackPion.sign() < 0) || (candC.isSelD0bar() >= hfflagConfigurations.selectionFlagD0bar && trackPion.sign() > 0))) {
-            continue;
-          }
-        } else if constexpr (DecChannel == DecayChannel::B0ToDstarPi) { // D*+ → D0 π+
-          if (trackPion.sign() * charmHadDauTracks.back().sign() > 0) {
-            continue;
-          }
-        }
+      // reject pi D with same sign as D
+      bool allowPositive{true}, allowNegative{true};
+      if constexpr (DecChannel == DecayChannel::B0ToDminusPi || DecChannel == DecayChannel::BsToDsminusPi || DecChannel == DecayChannel::LbToLcplusPi) { // D∓ → π∓ K± π∓ and Ds∓ → K∓ K± π∓ and Lc∓ → p∓ K± π∓
+        allowPositive = charmHadDauTracks[0].sign() <= 0;
+        allowNegative = charmHadDauTracks[0].sign() >= 0;
+      } else if constexpr (DecChannel == DecayChannel::BplusToD0barPi) { // D0(bar) → K± π∓
+        allowPositive = candC.isSelD0bar() >= hfflagConfigurations.selectionFlagD0bar;
+        allowNegative = candC.isSelD0() >= hfflagConfigurations.selectionFlagD0;
+      } else if constexpr (DecChannel == DecayChannel::B0ToDstarPi) { // D*+ → D0 π+
+        allowPositive = charmHadDauTracks.back().sign() <= 0;
+        allowNegative = charmHadDauTracks.back().sign() >= 0;
+      }
+      std::array<int64_t, 3> daughterIds{-1, -1, -1};
+      for (auto iDau = 0u; iDau < charmHadDauTracks.size(); ++iDau) {
+        daughterIds[iDau] = charmHadDauTracks[iDau].globalIndex();
+      }
+      pairPions(pVecCharm, daughterIds, allowPositive, allowNegative);
 
-        // apply selections on pion tracks
-        if (!isPionSelected(trackPion, trackParCovPion, dcaPion, charmHadDauTracks)) {
+      for (auto iPion = 0u; iPion < pionColumns.size(); ++iPion) {
+        if (pionColumns.pairSel[iPion] == PairSel::Rejected) {
           continue;
         }
-
-        registry.fill(HIST("hPtPion"), trackParCovPion.getPt());
-        // compute invariant mass square and apply selection
-        auto invMass2DPi = RecoDecay::m2(std::array{pVecCharm, pVecPion}, std::array{massC, MassPiPlus});
-        if ((invMass2DPi < invMass2ChHadPiMin) || (invMass2DPi > invMass2ChHadPiMax)) {
+        registry.fill(HIST("hPtPion"), pionColumns.pt[iPion]);
+        if (pionColumns.pairSel[iPion] != PairSel::InMassWindow) {
           continue;
         }
 
         // fill Pion tracks table
         // if information on track already stored, go to next track
-        if (!selectedTracksPion.count(trackPion.globalIndex())) {
-          tables.hfTrackPion(trackPion.globalIndex(), indexHfReducedCollision,
+        const int64_t indexPion = pionColumns.globalIndex[iPion];
+        auto trackPion = tracks.rawIteratorAt(indexPion);
+        if (!selectedTracksPion.count(indexPion)) {
+          const auto& trackParCovPion = pionColumns.trackParCov[iPion];
+          tables.hfTrackPion(indexPion, indexHfReducedCollision,
                              trackParCovPion.getX(), trackParCovPion.getAlpha(),
                              trackParCovPion.getY(), trackParCovPion.getZ(), trackParCovPion.getSnp(),
                              trackParCovPion.getTgl(), trackParCovPion.getQ2Pt(),
@@ -1321,16 +1402,16 @@ struct HfDataCreatorCharmHadPiReduced {
                                 trackParCovPion.getSigma1PtTgl(), trackParCovPion.getSigma1Pt2());
           tables.hfTrackPidPion(trackPion.hasTPC(), trackPion.hasTOF(),
                                 trackPion.tpcNSigmaPi(), trackPion.tofNSigmaPi());
-          tables.hfTrackMomPion(pVecPion[0], pVecPion[1], pVecPion[2], trackPion.sign());
+          tables.hfTrackMomPion(pionColumns.px[iPion], pionColumns.py[iPion], pionColumns.pz[iPion], trackPion.sign());
           // add trackPion.globalIndex() to a list
           // to keep memory of the pions filled in the table and avoid refilling them if they are paired to another D candidate
           // and keep track of their index in tables.hfTrackPion for McRec purposes
-          selectedTracksPion[trackPion.globalIndex()] = tables.hfTrackPion.lastIndex();
+          selectedTracksPion[indexPion] = tables.hfTrackPion.lastIndex();
         }
 
         if constexpr (DoMc) {
           std::vector<typename TTracks::iterator> beautyHadDauTracks{};
-          beautyHadDauTracks.reserve(charmHadDauTracks.size());
+          beautyHadDauTracks.reserve(charmHadDauTracks.size() + 1);
           for (const auto& track : charmHadDauTracks) {
             beautyHadDauTracks.push_back(track);
           }
@@ -63,6 +63,7 @@
 #include <array>
 #include <chrono>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <map>
 #include <string>
@@ -243,6 +244,81 @@ struct HfDataCreatorCharmResoReduced {
     std::array<float, 3> pVectorProng2;
   } varUtils{};
 
+  /// V0s of the current collision, built and selected once per collision, in columns indexed by the position of
+  /// the V0 in the collision. Rejected V0s have v0Type = 0
+  struct V0Columns {
+    std::vector<int64_t> posTrackId;
+    std::vector<int64_t> negTrackId;
+    std::vector<uint8_t> v0Type;
+    std::vector<float> px; // propagated to the primary vertex if propagateV0toPV
+    std::vector<float> py;
+    std::vector<float> pz;
+    std::vector<float> pt;
+    std::vector<float> mK0Short;
+    std::vector<float> mLambda;
+    // only read for the selected pairs
+    std::vector<std::array<float, 3>> pos;
+    std::vector<std::array<float, 3>> momPos;
+    std::vector<std::array<float, 3>> momNeg;
+    std::vector<float> cosPA;
+    std::vector<float> dcaV0ToPv;
+    std::vector<int> nItsClsDauMin;
+    std::vector<int> nTpcCrossRowsDauMin;
+    std::vector<float> chi2TpcDauMax;
+
+    std::size_t size() const { return v0Type.size(); }
+    void resize(std::size_t nV0s)
+    {
+      posTrackId.resize(nV0s);
+      negTrackId.resize(nV0s);
+      v0Type.assign(nV0s, 0);
+      px.resize(nV0s);
+      py.resize(nV0s);
+      pz.resize(nV0s);
+      pt.resize(nV0s);
+      mK0Short.resize(nV0s);
+      mLambda.resize(nV0s);
+      pos.resize(nV0s);
+      momPos.resize(nV0s);
+      momNeg.resize(nV0s);
+      cosPA.resize(nV0s);
+      dcaV0ToPv.resize(nV0s);
+      nItsClsDauMin.resize(nV0s);
+      nTpcCrossRowsDauMin.resize(nV0s);
+      chi2TpcDauMax.resize(nV0s);
+    }
+  } v0Columns;
+
+  /// Bachelor tracks of the current collision, selected and re-propagated once per collision, in contiguous columns
+  struct TrackColumns {
+    std::vector<int64_t> globalIndex;
+    std::vector<int8_t> sign;
+    std::vector<float> px; // at the collision vertex
+    std::vector<float> py;
+    std::vector<float> pz;
+    std::vector<float> p;
+    std::vector<float> tpcSignal;
+    std::vector<float> tpcNSigmaPi;
+    std::vector<float> tpcNSigmaKa;
+    std::vector<float> tpcNSigmaPr;
+    std::vector<uint8_t> commonDaughter; // shares a track with the current D candidate
+
+    std::size_t size() const { return globalIndex.size(); }
+    void clear()
+    {
+      globalIndex.clear();
+      sign.clear();
+      px.clear();
+      py.clear();
+      pz.clear();
+      p.clear();
+      tpcSignal.clear();
+      tpcNSigmaPi.clear();
+      tpcNSigmaKa.clear();
+      tpcNSigmaPr.clear();
+    }
+  } trackColumns;
+
   // Dplus
   using CandsDplusFiltered = soa::Filtered<soa::Join<aod::HfCand3Prong, aod::HfSelDplusToPiKPi>>;
   using CandsDplusFilteredWithMl = soa::Filtered<soa::Join<aod::HfCand3Prong, aod::HfSelDplusToPiKPi, aod::HfMlDplusToPiKPi>>;
@@ -393,11 +469,10 @@ struct HfDataCreatorCharmResoReduced {
     }
   }
 
-  /// Basic track quality selections for V0 daughters
+  /// Basic track quality selections for V0 daughters, the rejection of the D meson daughters is done in the pairing
   /// \param Tr is a track
-  /// \param dDaughtersIds are the IDs of the D meson daughter tracks
   template <typename Tr>
-  bool selectV0Daughter(Tr const& track, const std::array<int, 3>& dDaughtersIds)
+  bool selectV0Daughter(Tr const& track)
   {
     // acceptance selection
     if (std::abs(track.eta()) > cfgV0Cuts.etaMaxDau) {
@@ -415,10 +490,6 @@ struct HfDataCreatorCharmResoReduced {
         track.tpcNClsShared() > cfgV0Cuts.trackNsharedClusTpc) {
       return false;
     }
-    // rejection of tracks that share a daughter with the D meson
-    if (rejectPairsWithCommonDaughter && std::find(dDaughtersIds.begin(), dDaughtersIds.end(), track.globalIndex()) != dDaughtersIds.end()) {
-      return false;
-    }
     return true;
   }
 
@@ -438,15 +509,14 @@ struct HfDataCreatorCharmResoReduced {
   /// Basic selection of V0 candidates
   /// \param collision is the current collision
   /// \param dauTracks are the v0 daughter tracks
-  /// \param dDaughtersIds are the IDs of the D meson daughter tracks
   /// \return a bitmap with mass hypotesis if passes all cuts
   template <typename Coll, typename Tr>
-  bool buildAndSelectV0(const Coll& collision, const std::array<int, 3>& dDaughtersIds, const std::array<Tr, 2>& dauTracks)
+  bool buildAndSelectV0(const Coll& collision, const std::array<Tr, 2>& dauTracks)
   {
     const auto& trackPos = dauTracks[0];
     const auto& trackNeg = dauTracks[1];
     // single-tracks selection
-    if (!selectV0Daughter(trackPos, dDaughtersIds) || !selectV0Daughter(trackNeg, dDaughtersIds)) {
+    if (!selectV0Daughter(trackPos) || !selectV0Daughter(trackNeg)) {
       return false;
     }
     // daughters DCA to V0's collision primary vertex
@@ -561,16 +631,12 @@ struct HfDataCreatorCharmResoReduced {
     return true;
   }
 
-  /// Basic selection of tracks
+  /// Basic selection of tracks, the rejection of the D meson daughters is done in the pairing
   /// \param track is the track
-  /// \param dDaughtersIds are the IDs of the D meson daughter tracks
   /// \return true if passes all cuts
   template <typename Tr>
-  bool isTrackSelected(const Tr& track, const std::array<int, 3>& dDaughtersIds)
+  bool isTrackSelected(const Tr& track)
   {
-    if (rejectPairsWithCommonDaughter && std::find(dDaughtersIds.begin(), dDaughtersIds.end(), track.globalIndex()) != dDaughtersIds.end()) {
-      return false;
-    }
     switch (cfgSingleTrackCuts.setTrackSelections) {
       case 1:
         if (!track.isGlobalTrackWoDCA()) {
@@ -603,6 +669,117 @@ struct HfDataCreatorCharmResoReduced {
     return (isPion || isKaon || isProton); // we keep the track if is it compatible with at least one of the PID hypotheses selected
   }
 
+  /// Builds and selects the V0s of the collision and fills v0Columns
+  /// \param collision is the current collision
+  /// \param bachelorV0s are the V0s of the collision
+  /// \param tracksIU are the tracks at the innermost update
+  template <typename Coll, typename BBachV0s, typename TrIU>
+  void stageV0s(Coll const& collision, BBachV0s const& bachelorV0s, TrIU const& tracksIU)
+  {
+    v0Columns.resize(bachelorV0s.size());
+    std::size_t iV0Row = 0;
+    for (const auto& v0 : bachelorV0s) {
+      const std::size_t iV0 = iV0Row++;
+      auto trackPos = tracksIU.rawIteratorAt(v0.posTrackId());
+      auto trackNeg = tracksIU.rawIteratorAt(v0.negTrackId());
+      v0Columns.posTrackId[iV0] = v0.posTrackId();
+      v0Columns.negTrackId[iV0] = v0.negTrackId();
+      // Apply selsection
+      auto v0DauTracks = std::array{trackPos, trackNeg};
+      if (!buildAndSelectV0(collision, v0DauTracks)) {
+        continue;
+      }
+      // Get single track variables
+      float chi2TpcDauV0Max = -1.f;
+      int nItsClsDauV0Min = 8, nTpcCrossRowsDauV0Min = 200;
+      for (const auto& v0Track : v0DauTracks) {
+        if (v0Track.itsNCls() < nItsClsDauV0Min) {
+          nItsClsDauV0Min = v0Track.itsNCls();
+        }
+        if (v0Track.tpcNClsCrossedRows() < nTpcCrossRowsDauV0Min) {
+          nTpcCrossRowsDauV0Min = v0Track.tpcNClsCrossedRows();
+        }
+        if (v0Track.tpcChi2NCl() > chi2TpcDauV0Max) {
+          chi2TpcDauV0Max = v0Track.tpcChi2NCl();
+        }
+      }
+      // propagate V0 to primary vertex (if enabled)
+      if (propagateV0toPV) {
+        std::array<float, 3> const pVecV0Orig = {candidateV0.mom[0], candidateV0.mom[1], candidateV0.mom[2]};
+        std::array<float, 2> dcaInfo{};
+        auto trackParK0 = o2::track::TrackPar(candidateV0.pos, pVecV0Orig, 0, true);
+        trackParK0.setPID(o2::track::PID::K0);
+        trackParK0.setAbsCharge(0);
+        o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParK0, 2.f, matCorr, &dcaInfo);
+        getPxPyPz(trackParK0, candidateV0.mom);
+      }
+      v0Columns.v0Type[iV0] = candidateV0.v0Type;
+      v0Columns.px[iV0] = candidateV0.mom[0];
+      v0Columns.py[iV0] = candidateV0.mom[1];
+      v0Columns.pz[iV0] = candidateV0.mom[2];
+      v0Columns.pt[iV0] = candidateV0.pT;
+      v0Columns.mK0Short[iV0] = candidateV0.mK0Short;
+      v0Columns.mLambda[iV0] = candidateV0.mLambda;
+      v0Columns.pos[iV0] = candidateV0.pos;
+      v0Columns.momPos[iV0] = candidateV0.momPos;
+      v0Columns.momNeg[iV0] = candidateV0.momNeg;
+      v0Columns.cosPA[iV0] = candidateV0.cosPA;
+      v0Columns.dcaV0ToPv[iV0] = candidateV0.dcaV0ToPv;
+      v0Columns.nItsClsDauMin[iV0] = nItsClsDauV0Min;
+      v0Columns.nTpcCrossRowsDauMin[iV0] = nTpcCrossRowsDauV0Min;
+      v0Columns.chi2TpcDauMax[iV0] = chi2TpcDauV0Max;
+    }
+  }
+
+  /// Selects the bachelor tracks of the collision, propagated to the collision vertex if they were associated to
+  /// another one, and fills trackColumns
+  /// \param collision is the current collision
+  /// \param bachelorTrks are the indices of the tracks associated to the collision
+  /// \param tracks is the table with tracks
+  template <typename Coll, typename BBachTracks, typename Tr>
+  void stageTracks(Coll const& collision, BBachTracks const& bachelorTrks, Tr const& tracks)
+  {
+    trackColumns.clear();
+    for (const auto& trackIndex : bachelorTrks) {
+      auto track = tracks.rawIteratorAt(trackIndex.trackId());
+      if (!isTrackSelected(track)) {
+        continue;
+      }
+      // if the track has been reassociated, re-propagate it to PV (minor difference)
+      std::array<float, 3> pVecTrack = track.pVector();
+      if (track.collisionId() != collision.globalIndex()) {
+        auto trackParCovTrack = getTrackParCov(track);
+        std::array<float, 2> dcaTrack{track.dcaXY(), track.dcaZ()};
+        o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParCovTrack, 2.f, matCorr, &dcaTrack);
+        getPxPyPz(trackParCovTrack, pVecTrack);
+      }
+      trackColumns.globalIndex.push_back(track.globalIndex());
+      trackColumns.sign.push_back(track.sign());
+      trackColumns.px.push_back(pVecTrack[0]);
+      trackColumns.py.push_back(pVecTrack[1]);
+      trackColumns.pz.push_back(pVecTrack[2]);
+      trackColumns.p.push_back(track.p());
+      trackColumns.tpcSignal.push_back(track.tpcSignal());
+      trackColumns.tpcNSigmaPi.push_back(track.tpcNSigmaPi());
+      trackColumns.tpcNSigmaKa.push_back(track.tpcNSigmaKa());
+      trackColumns.tpcNSigmaPr.push_back(track.tpcNSigmaPr());
+    }
+    trackColumns.commonDaughter.resize(trackColumns.size());
+  }
+
+  /// Flags the staged tracks which are daughters of the D candidate, if rejectPairsWithCommonDaughter
+  /// \param prongIdsD are the IDs of the D meson daughter tracks
+  void flagCommonDaughterTracks(const std::array<int, 3>& prongIdsD)
+  {
+    const std::size_t nTracks = trackColumns.size();
+    const int64_t* globalIndex = trackColumns.globalIndex.data();
+    uint8_t* commonDaughter = trackColumns.commonDaughter.data();
+    const bool reject = rejectPairsWithCommonDaughter;
+    for (std::size_t iTrack = 0; iTrack < nTracks; ++iTrack) {
+      commonDaughter[iTrack] = reject && (globalIndex[iTrack] == prongIdsD[0] || globalIndex[iTrack] == prongIdsD[1] || globalIndex[iTrack] == prongIdsD[2]);
+    }
+  }
+
   template <typename PParticles, typename TrIU>
   int8_t getMatchingFlagV0(PParticles const& particlesMc, const std::array<TrIU, 2>& arrDaughtersV0)
   {
@@ -1060,6 +1237,15 @@ struct HfDataCreatorCharmResoReduced {
       LOG(info) << ">>>>>>>>>>>> Magnetic field: " << bz;
     }
     fitter.setBz(bz);
+    // the V0s and bachelor tracks do not depend on the D candidate: they are built and selected once per collision
+    if (candsD.size() > 0) {
+      if constexpr (DoV0s) {
+        stageV0s(collision, bachelorV0s, tracksIU);
+      }
+      if constexpr (DoTracks) {
+        stageTracks(collision, bachelorTrks, tracks);
+      }
+    }
     // loop on D candidates
     for (const auto& candD : candsD) {
       // initialize variables depending on D meson type
@@ -1164,65 +1350,50 @@ struct HfDataCreatorCharmResoReduced {
       }
       // Loop on the bachelor V0s
       if constexpr (DoV0s) {
+        std::size_t iV0 = 0;
         for (const auto& v0 : bachelorV0s) {
-          auto trackPos = tracksIU.rawIteratorAt(v0.posTrackId());
-          auto trackNeg = tracksIU.rawIteratorAt(v0.negTrackId());
-          // Apply selsection
-          auto v0DauTracks = std::array{trackPos, trackNeg};
-          if (!buildAndSelectV0(collision, prongIdsD, v0DauTracks)) {
+          const std::size_t iV0Col = iV0++;
+          if (v0Columns.v0Type[iV0Col] == 0) {
             continue;
           }
-          // Get single track variables
-          float chi2TpcDauV0Max = -1.f;
-          int nItsClsDauV0Min = 8, nTpcCrossRowsDauV0Min = 200;
-          for (const auto& v0Track : v0DauTracks) {
-            if (v0Track.itsNCls() < nItsClsDauV0Min) {
-              nItsClsDauV0Min = v0Track.itsNCls();
-            }
-            if (v0Track.tpcNClsCrossedRows() < nTpcCrossRowsDauV0Min) {
-              nTpcCrossRowsDauV0Min = v0Track.tpcNClsCrossedRows();
-            }
-            if (v0Track.tpcChi2NCl() > chi2TpcDauV0Max) {
-              chi2TpcDauV0Max = v0Track.tpcChi2NCl();
-            }
-          }
-          // propagate V0 to primary vertex (if enabled)
-          if (propagateV0toPV) {
-            std::array<float, 3> const pVecV0Orig = {candidateV0.mom[0], candidateV0.mom[1], candidateV0.mom[2]};
-            std::array<float, 2> dcaInfo{};
-            auto trackParK0 = o2::track::TrackPar(candidateV0.pos, pVecV0Orig, 0, true);
-            trackParK0.setPID(o2::track::PID::K0);
-            trackParK0.setAbsCharge(0);
-            o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParK0, 2.f, matCorr, &dcaInfo);
-            getPxPyPz(trackParK0, candidateV0.mom);
+          // rejection of V0s that share a daughter with the D meson
+          if (rejectPairsWithCommonDaughter &&
+              (std::find(prongIdsD.begin(), prongIdsD.end(), v0Columns.posTrackId[iV0Col]) != prongIdsD.end() ||
+               std::find(prongIdsD.begin(), prongIdsD.end(), v0Columns.negTrackId[iV0Col]) != prongIdsD.end())) {
+            continue;
           }
+          const std::array<float, 3> pVecV0{v0Columns.px[iV0Col], v0Columns.py[iV0Col], v0Columns.pz[iV0Col]};
+          const uint8_t v0Type = v0Columns.v0Type[iV0Col];
+          const float ptV0 = v0Columns.pt[iV0Col];
+          const float mK0Short = v0Columns.mK0Short[iV0Col];
+          const float mLambda = v0Columns.mLambda[iV0Col];
           // compute resonance invariant mass and filling of QA histograms
-          if (TESTBIT(candidateV0.v0Type, BachelorType::K0s)) {
-            registry.fill(HIST("hMassVsPtK0s"), candidateV0.pT, candidateV0.mK0Short);
+          if (TESTBIT(v0Type, BachelorType::K0s)) {
+            registry.fill(HIST("hMassVsPtK0s"), ptV0, mK0Short);
             switch (DType) {
               case DType::Dstar:
-                varUtils.ptReso = RecoDecay::pt(RecoDecay::sumOfVec(varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, candidateV0.mom));
+                varUtils.ptReso = RecoDecay::pt(RecoDecay::sumOfVec(varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecV0));
                 if (varUtils.signD > 0) {
-                  varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, candidateV0.mom}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassK0});
+                  varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecV0}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassK0});
                 } else {
-                  varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng1, varUtils.pVectorProng0, varUtils.pVectorProng2, candidateV0.mom}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassK0});
+                  varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng1, varUtils.pVectorProng0, varUtils.pVectorProng2, pVecV0}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassK0});
                 }
                 if (!cfgQaPlots.applyCutsForQaHistograms ||
                     (varUtils.invMassD - varUtils.invMassD0 > cfgQaPlots.cutMassDstarMin &&
                      varUtils.invMassD - varUtils.invMassD0 < cfgQaPlots.cutMassDstarMax &&
-                     candidateV0.mK0Short > cfgQaPlots.cutMassK0sMin &&
-                     candidateV0.mK0Short < cfgQaPlots.cutMassK0sMax)) {
+                     mK0Short > cfgQaPlots.cutMassK0sMin &&
+                     mK0Short < cfgQaPlots.cutMassK0sMax)) {
                   registry.fill(HIST("hMassDstarK0s"), varUtils.ptReso, varUtils.invMassReso - varUtils.invMassD);
                 }
                 break;
               case DType::Dplus:
-                varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, candidateV0.mom}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassK0});
-                varUtils.ptReso = RecoDecay::pt(RecoDecay::sumOfVec(varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, candidateV0.mom));
+                varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecV0}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassK0});
+                varUtils.ptReso = RecoDecay::pt(RecoDecay::sumOfVec(varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecV0));
                 if (!cfgQaPlots.applyCutsForQaHistograms ||
                     (varUtils.invMassD > cfgQaPlots.cutMassDMin &&
                      varUtils.invMassD < cfgQaPlots.cutMassDMax &&
-                     candidateV0.mK0Short > cfgQaPlots.cutMassK0sMin &&
-                     candidateV0.mK0Short < cfgQaPlots.cutMassK0sMax)) {
+                     mK0Short > cfgQaPlots.cutMassK0sMin &&
+                     mK0Short < cfgQaPlots.cutMassK0sMax)) {
                   registry.fill(HIST("hMassDplusK0s"), varUtils.ptReso, varUtils.invMassReso - varUtils.invMassD);
                 }
                 break;
@@ -1230,49 +1401,49 @@ struct HfDataCreatorCharmResoReduced {
                 break; // no other D meson types expected
             } // end of dType switch
           } // matched with K0s
-          bool const isLambda = TESTBIT(candidateV0.v0Type, BachelorType::Lambda);
-          bool const isAntiLambda = TESTBIT(candidateV0.v0Type, BachelorType::AntiLambda);
+          bool const isLambda = TESTBIT(v0Type, BachelorType::Lambda);
+          bool const isAntiLambda = TESTBIT(v0Type, BachelorType::AntiLambda);
           if (isLambda || isAntiLambda) {
-            registry.fill(HIST("hMassVsPtLambda"), candidateV0.pT, candidateV0.mLambda);
+            registry.fill(HIST("hMassVsPtLambda"), ptV0, mLambda);
             switch (DType) {
               case DType::Dstar:
-                varUtils.ptReso = RecoDecay::pt(RecoDecay::sumOfVec(varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, candidateV0.mom));
+                varUtils.ptReso = RecoDecay::pt(RecoDecay::sumOfVec(varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecV0));
                 if (varUtils.signD > 0) {
-                  varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, candidateV0.mom}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassLambda});
+                  varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecV0}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassLambda});
                 } else {
-                  varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng1, varUtils.pVectorProng0, varUtils.pVectorProng2, candidateV0.mom}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassLambda});
+                  varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng1, varUtils.pVectorProng0, varUtils.pVectorProng2, pVecV0}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassLambda});
                 }
                 if (!cfgQaPlots.applyCutsForQaHistograms ||
                     (varUtils.invMassD - varUtils.invMassD0 > cfgQaPlots.cutMassDstarMin &&
                      varUtils.invMassD - varUtils.invMassD0 < cfgQaPlots.cutMassDstarMax &&
-                     candidateV0.mLambda > cfgQaPlots.cutMassLambdaMin &&
-                     candidateV0.mLambda < cfgQaPlots.cutMassLambdaMax)) {
+                     mLambda > cfgQaPlots.cutMassLambdaMin &&
+                     mLambda < cfgQaPlots.cutMassLambdaMax)) {
                   registry.fill(HIST("hMassDstarLambda"), varUtils.ptReso, varUtils.invMassReso - varUtils.invMassD);
                 }
                 break;
               case DType::Dplus:
-                varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, candidateV0.mom}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassLambda});
-                varUtils.ptReso = RecoDecay::pt(RecoDecay::sumOfVec(varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, candidateV0.mom));
+                varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecV0}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassLambda});
+                varUtils.ptReso = RecoDecay::pt(RecoDecay::sumOfVec(varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecV0));
                 if (!cfgQaPlots.applyCutsForQaHistograms ||
                     (varUtils.invMassD > cfgQaPlots.cutMassDMin &&
                      varUtils.invMassD < cfgQaPlots.cutMassDMax &&
-                     candidateV0.mLambda > cfgQaPlots.cutMassLambdaMin &&
-                     candidateV0.mLambda < cfgQaPlots.cutMassLambdaMax)) {
+                     mLambda > cfgQaPlots.cutMassLambdaMin &&
+                     mLambda < cfgQaPlots.cutMassLambdaMax)) {
                   registry.fill(HIST("hMassDplusLambda"), varUtils.ptReso, varUtils.invMassReso - varUtils.invMassD);
                 }
                 break;
               case DType::D0:
                 if (isLambda) {
-                  varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, candidateV0.mom}, std::array{MassPiPlus, MassKPlus, MassLambda});
+                  varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, pVecV0}, std::array{MassPiPlus, MassKPlus, MassLambda});
                 } else {
-                  varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng1, varUtils.pVectorProng0, candidateV0.mom}, std::array{MassPiPlus, MassKPlus, MassLambda});
+                  varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng1, varUtils.pVectorProng0, pVecV0}, std::array{MassPiPlus, MassKPlus, MassLambda});
                 }
-                varUtils.ptReso = RecoDecay::pt(RecoDecay::sumOfVec(varUtils.pVectorProng0, varUtils.pVectorProng1, candidateV0.mom));
+                varUtils.ptReso = RecoDecay::pt(RecoDecay::sumOfVec(varUtils.pVectorProng0, varUtils.pVectorProng1, pVecV0));
                 if (!cfgQaPlots.applyCutsForQaHistograms ||
                     (((varUtils.invMassD0 > cfgQaPlots.cutMassDMin && varUtils.invMassD0 < cfgQaPlots.cutMassDMax) ||
                       (varUtils.invMassD0Bar > cfgQaPlots.cutMassDMin && varUtils.invMassD0Bar < cfgQaPlots.cutMassDMax)) &&
-                     candidateV0.mLambda > cfgQaPlots.cutMassLambdaMin &&
-                     candidateV0.mLambda < cfgQaPlots.cutMassLambdaMax)) {
+                     mLambda > cfgQaPlots.cutMassLambdaMin &&
+                     mLambda < cfgQaPlots.cutMassLambdaMax)) {
                   if (isLambda) {
                     registry.fill(HIST("hMassD0Lambda"), varUtils.ptReso, varUtils.invMassReso - varUtils.invMassD0);
                   } else {
@@ -1287,15 +1458,18 @@ struct HfDataCreatorCharmResoReduced {
           // fill V0 table
           // if information on V0 already stored, go to next V0
           if (!selectedV0s.count(v0.globalIndex())) {
-            hfCandV0(trackPos.globalIndex(), trackNeg.globalIndex(),
+            const auto& posV0 = v0Columns.pos[iV0Col];
+            const auto& momPos = v0Columns.momPos[iV0Col];
+            const auto& momNeg = v0Columns.momNeg[iV0Col];
+            hfCandV0(v0Columns.posTrackId[iV0Col], v0Columns.negTrackId[iV0Col],
                      indexHfReducedCollision,
-                     candidateV0.pos[0], candidateV0.pos[1], candidateV0.pos[2],
-                     candidateV0.momPos[0], candidateV0.momPos[1], candidateV0.momPos[2],
-                     candidateV0.momNeg[0], candidateV0.momNeg[1], candidateV0.momNeg[2],
-                     candidateV0.cosPA,
-                     candidateV0.dcaV0ToPv,
-                     nItsClsDauV0Min, nTpcCrossRowsDauV0Min, chi2TpcDauV0Max,
-                     candidateV0.v0Type);
+                     posV0[0], posV0[1], posV0[2],
+                     momPos[0], momPos[1], momPos[2],
+                     momNeg[0], momNeg[1], momNeg[2],
+                     v0Columns.cosPA[iV0Col],
+                     v0Columns.dcaV0ToPv[iV0Col],
+                     v0Columns.nItsClsDauMin[iV0Col], v0Columns.nTpcCrossRowsDauMin[iV0Col], v0Columns.chi2TpcDauMax[iV0Col],
+                     v0Type);
             selectedV0s[v0.globalIndex()] = hfCandV0.lastIndex();
           }
           fillHfCandD = true;
@@ -1315,28 +1489,25 @@ struct HfDataCreatorCharmResoReduced {
       } // end of do V0s
       // Loop on the bachelor tracks
       if constexpr (DoTracks) {
-        for (const auto& trackIndex : bachelorTrks) {
-          auto track = tracks.rawIteratorAt(trackIndex.trackId());
-          if (!isTrackSelected(track, prongIdsD)) {
+        flagCommonDaughterTracks(prongIdsD);
+        for (auto iTrack = 0u; iTrack < trackColumns.size(); ++iTrack) {
+          if (trackColumns.commonDaughter[iTrack]) {
             continue;
           }
-          // if the track has been reassociated, re-propagate it to PV (minor difference)
-          auto trackParCovTrack = getTrackParCov(track);
-          std::array<float, 2> dcaTrack{track.dcaXY(), track.dcaZ()};
-          std::array<float, 3> pVecTrack = track.pVector();
-          if (track.collisionId() != collision.globalIndex()) {
-            o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParCovTrack, 2.f, matCorr, &dcaTrack);
-            getPxPyPz(trackParCovTrack, pVecTrack);
-          }
-          registry.fill(HIST("hdEdxVsP"), track.p(), track.tpcSignal());
+          const std::array<float, 3> pVecTrack{trackColumns.px[iTrack], trackColumns.py[iTrack], trackColumns.pz[iTrack]};
+          const int8_t signTrack = trackColumns.sign[iTrack];
+          const float nSigmaTpcPi = trackColumns.tpcNSigmaPi[iTrack];
+          const float nSigmaTpcKa = trackColumns.tpcNSigmaKa[iTrack];
+          const float nSigmaTpcPr = trackColumns.tpcNSigmaPr[iTrack];
+          registry.fill(HIST("hdEdxVsP"), trackColumns.p[iTrack], trackColumns.tpcSignal[iTrack]);
           // compute invariant mass and filling of QA histograms
           switch (DType) {
             case DType::Dstar:
               // D* pi
-              if (std::abs(track.tpcNSigmaPi()) < cfgSingleTrackCuts.maxNsigmaTpcPi) {
-                if (varUtils.signD > 0 && track.sign() < 0) {
+              if (std::abs(nSigmaTpcPi) < cfgSingleTrackCuts.maxNsigmaTpcPi) {
+                if (varUtils.signD > 0 && signTrack < 0) {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassPiPlus});
-                } else if (varUtils.signD < 0 && track.sign() > 0) {
+                } else if (varUtils.signD < 0 && signTrack > 0) {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng1, varUtils.pVectorProng0, varUtils.pVectorProng2, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassPiPlus});
                 } else {
                   varUtils.invMassReso = -1.f; // invalid case
@@ -1348,10 +1519,10 @@ struct HfDataCreatorCharmResoReduced {
                   registry.fill(HIST("hMassDstarPi"), varUtils.ptReso, varUtils.invMassReso - varUtils.invMassD);
                 }
               }
-              if (std::abs(track.tpcNSigmaKa()) < cfgSingleTrackCuts.maxNsigmaTpcKa) {
-                if (varUtils.signD > 0 && track.sign() < 0) {
+              if (std::abs(nSigmaTpcKa) < cfgSingleTrackCuts.maxNsigmaTpcKa) {
+                if (varUtils.signD > 0 && signTrack < 0) {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassKPlus});
-                } else if (varUtils.signD < 0 && track.sign() > 0) {
+                } else if (varUtils.signD < 0 && signTrack > 0) {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng1, varUtils.pVectorProng0, varUtils.pVectorProng2, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassKPlus});
                 } else {
                   varUtils.invMassReso = -1.f; // invalid case
@@ -1364,10 +1535,10 @@ struct HfDataCreatorCharmResoReduced {
                 }
               }
               // D* p
-              if (std::abs(track.tpcNSigmaPr()) < cfgSingleTrackCuts.maxNsigmaTpcPr) {
-                if (varUtils.signD > 0 && track.sign() > 0) {
+              if (std::abs(nSigmaTpcPr) < cfgSingleTrackCuts.maxNsigmaTpcPr) {
+                if (varUtils.signD > 0 && signTrack > 0) {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassProton});
-                } else if (varUtils.signD < 0 && track.sign() < 0) {
+                } else if (varUtils.signD < 0 && signTrack < 0) {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng1, varUtils.pVectorProng0, varUtils.pVectorProng2, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassProton});
                 } else {
                   varUtils.invMassReso = -1.f; // invalid case
@@ -1382,8 +1553,8 @@ struct HfDataCreatorCharmResoReduced {
               break;
             case DType::Dplus:
               // D+ pi
-              if (std::abs(track.tpcNSigmaPi()) < cfgSingleTrackCuts.maxNsigmaTpcPi) {
-                if (varUtils.signD * track.sign() < 0) {
+              if (std::abs(nSigmaTpcPi) < cfgSingleTrackCuts.maxNsigmaTpcPi) {
+                if (varUtils.signD * signTrack < 0) {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassPiPlus});
                 } else {
                   varUtils.invMassReso = -1.f; // invalid case
@@ -1396,8 +1567,8 @@ struct HfDataCreatorCharmResoReduced {
                 }
               }
               // D+ K
-              if (std::abs(track.tpcNSigmaKa()) < cfgSingleTrackCuts.maxNsigmaTpcKa) {
-                if (varUtils.signD * track.sign() < 0) {
+              if (std::abs(nSigmaTpcKa) < cfgSingleTrackCuts.maxNsigmaTpcKa) {
+                if (varUtils.signD * signTrack < 0) {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassKPlus});
                 } else {
                   varUtils.invMassReso = -1.f; // invalid case
@@ -1410,8 +1581,8 @@ struct HfDataCreatorCharmResoReduced {
                 }
               }
               // D+ pr
-              if (std::abs(track.tpcNSigmaPr()) < cfgSingleTrackCuts.maxNsigmaTpcPr) {
-                if (varUtils.signD * track.sign() < 0) {
+              if (std::abs(nSigmaTpcPr) < cfgSingleTrackCuts.maxNsigmaTpcPr) {
+                if (varUtils.signD * signTrack < 0) {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, varUtils.pVectorProng2, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassPiPlus, MassProton});
                 } else {
                   varUtils.invMassReso = -1.f; // invalid case
@@ -1426,8 +1597,8 @@ struct HfDataCreatorCharmResoReduced {
               break;
             case DType::D0:
               // D0 pi
-              if (std::abs(track.tpcNSigmaPi()) < cfgSingleTrackCuts.maxNsigmaTpcPi) {
-                if (track.sign() > 0) {
+              if (std::abs(nSigmaTpcPi) < cfgSingleTrackCuts.maxNsigmaTpcPi) {
+                if (signTrack > 0) {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassPiPlus});
                 } else {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng1, varUtils.pVectorProng0, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassPiPlus});
@@ -1438,7 +1609,7 @@ struct HfDataCreatorCharmResoReduced {
                       varUtils.invMassD0 < cfgQaPlots.cutMassDMax) ||
                      (varUtils.invMassD0Bar > cfgQaPlots.cutMassDMin &&
                       varUtils.invMassD0Bar < cfgQaPlots.cutMassDMax))) {
-                  if (track.sign() > 0) {
+                  if (signTrack > 0) {
                     registry.fill(HIST("hMassD0Pi"), varUtils.ptReso, varUtils.invMassReso - varUtils.invMassD0);
                   } else {
                     registry.fill(HIST("hMassD0Pi"), varUtils.ptReso, varUtils.invMassReso - varUtils.invMassD0Bar);
@@ -1446,8 +1617,8 @@ struct HfDataCreatorCharmResoReduced {
                 }
               }
               // D0 K
-              if (std::abs(track.tpcNSigmaKa()) < cfgSingleTrackCuts.maxNsigmaTpcKa) {
-                if (track.sign() > 0) {
+              if (std::abs(nSigmaTpcKa) < cfgSingleTrackCuts.maxNsigmaTpcKa) {
+                if (signTrack > 0) {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassKPlus});
                 } else {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng1, varUtils.pVectorProng0, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassKPlus});
@@ -1458,7 +1629,7 @@ struct HfDataCreatorCharmResoReduced {
                       varUtils.invMassD0 < cfgQaPlots.cutMassDMax) ||
                      (varUtils.invMassD0Bar > cfgQaPlots.cutMassDMin &&
                       varUtils.invMassD0Bar < cfgQaPlots.cutMassDMax))) {
-                  if (track.sign() > 0) {
+                  if (signTrack > 0) {
                     registry.fill(HIST("hMassD0K"), varUtils.ptReso, varUtils.invMassReso - varUtils.invMassD0);
                   } else {
                     registry.fill(HIST("hMassD0K"), varUtils.ptReso, varUtils.invMassReso - varUtils.invMassD0Bar);
@@ -1466,8 +1637,8 @@ struct HfDataCreatorCharmResoReduced {
                 }
               }
               // D0 p
-              if (std::abs(track.tpcNSigmaPr()) < cfgSingleTrackCuts.maxNsigmaTpcPr) {
-                if (track.sign() > 0) {
+              if (std::abs(nSigmaTpcPr) < cfgSingleTrackCuts.maxNsigmaTpcPr) {
+                if (signTrack > 0) {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng0, varUtils.pVectorProng1, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassProton});
                 } else {
                   varUtils.invMassReso = RecoDecay::m(std::array{varUtils.pVectorProng1, varUtils.pVectorProng0, pVecTrack}, std::array{MassPiPlus, MassKPlus, MassProton});
@@ -1478,7 +1649,7 @@ struct HfDataCreatorCharmResoReduced {
                       varUtils.invMassD0 < cfgQaPlots.cutMassDMax) ||
                      (varUtils.invMassD0Bar > cfgQaPlots.cutMassDMin &&
                       varUtils.invMassD0Bar < cfgQaPlots.cutMassDMax))) {
-                  if (track.sign() > 0) {
+                  if (signTrack > 0) {
                     registry.fill(HIST("hMassD0Proton"), varUtils.ptReso, varUtils.invMassReso - varUtils.invMassD0);
                   } else {
                     registry.fill(HIST("hMassD0Proton"), varUtils.ptReso, varUtils.invMassReso - varUtils.invMassD0Bar);
@@ -1490,6 +1661,7 @@ struct HfDataCreatorCharmResoReduced {
               break; // no other D meson types expected
           } // end of DType switch
           // fill track table
+          auto track = tracks.rawIteratorAt(trackColumns.globalIndex[iTrack]);
           if (!selectedTracks.count(track.globalIndex())) {
             hfTrackNoParam(track.globalIndex(),
                            indexHfReducedCollision,
@@ -85,6 +85,68 @@ DECLARE_SOA_TABLE(HfPvRefitTrack, "AOD", "HFPVREFITTRACK", //!
                   hf_pv_refit_track::PvRefitDcaXY,
                   hf_pv_refit_track::PvRefitDcaZ);
 
+// track parametrisation propagated to the PV of the collision of the track, and its impact parameter
+// filled for every track, tracks without collision are kept at their reference point with a zero impact parameter
+namespace hf_track_at_pv
+{
+DECLARE_SOA_COLUMN(AtPvX, atPvX, float);                   //!
+DECLARE_SOA_COLUMN(AtPvAlpha, atPvAlpha, float);           //!
+DECLARE_SOA_COLUMN(AtPvY, atPvY, float);                   //!
+DECLARE_SOA_COLUMN(AtPvZ, atPvZ, float);                   //!
+DECLARE_SOA_COLUMN(AtPvSnp, atPvSnp, float);               //!
+DECLARE_SOA_COLUMN(AtPvTgl, atPvTgl, float);               //!
+DECLARE_SOA_COLUMN(AtPvSigned1Pt, atPvSigned1Pt, float);   //!
+DECLARE_SOA_COLUMN(AtPvCYY, atPvCYY, float);               //!
+DECLARE_SOA_COLUMN(AtPvCZY, atPvCZY, float);               //!
+DECLARE_SOA_COLUMN(AtPvCZZ, atPvCZZ, float);               //!
+DECLARE_SOA_COLUMN(AtPvCSnpY, atPvCSnpY, float);           //!
+DECLARE_SOA_COLUMN(AtPvCSnpZ, atPvCSnpZ, float);           //!
+DECLARE_SOA_COLUMN(AtPvCSnpSnp, atPvCSnpSnp, float);       //!
+DECLARE_SOA_COLUMN(AtPvCTglY, atPvCTglY, float);           //!
+DECLARE_SOA_COLUMN(AtPvCTglZ, atPvCTglZ, float);           //!
+DECLARE_SOA_COLUMN(AtPvCTglSnp, atPvCTglSnp, float);       //!
+DECLARE_SOA_COLUMN(AtPvCTglTgl, atPvCTglTgl, float);       //!
+DECLARE_SOA_COLUMN(AtPvC1PtY, atPvC1PtY, float);           //!
+DECLARE_SOA_COLUMN(AtPvC1PtZ, atPvC1PtZ, float);           //!
+DECLARE_SOA_COLUMN(AtPvC1PtSnp, atPvC1PtSnp, float);       //!
+DECLARE_SOA_COLUMN(AtPvC1PtTgl, atPvC1PtTgl, float);       //!
+DECLARE_SOA_COLUMN(AtPvC1Pt21Pt2, atPvC1Pt21Pt2, float);   //!
+DECLARE_SOA_COLUMN(AtPvDcaY, atPvDcaY, float);             //!
+DECLARE_SOA_COLUMN(AtPvDcaZ, atPvDcaZ, float);             //!
+DECLARE_SOA_COLUMN(AtPvSigmaDcaY2, atPvSigmaDcaY2, float); //!
+DECLARE_SOA_COLUMN(AtPvSigmaDcaYZ, atPvSigmaDcaYZ, float); //!
+DECLARE_SOA_COLUMN(AtPvSigmaDcaZ2, atPvSigmaDcaZ2, float); //!
+} // namespace hf_track_at_pv
+
+DECLARE_SOA_TABLE(HfTrackAtPv, "AOD", "HFTRACKATPV", //!
+                  hf_track_at_pv::AtPvX,
+                  hf_track_at_pv::AtPvAlpha,
+                  hf_track_at_pv::AtPvY,
+                  hf_track_at_pv::AtPvZ,
+                  hf_track_at_pv::AtPvSnp,
+                  hf_track_at_pv::AtPvTgl,
+                  hf_track_at_pv::AtPvSigned1Pt,
+                  hf_track_at_pv::AtPvCYY,
+                  hf_track_at_pv::AtPvCZY,
+                  hf_track_at_pv::AtPvCZZ,
+                  hf_track_at_pv::AtPvCSnpY,
+                  hf_track_at_pv::AtPvCSnpZ,
+                  hf_track_at_pv::AtPvCSnpSnp,
+                  hf_track_at_pv::AtPvCTglY,
+                  hf_track_at_pv::AtPvCTglZ,
+                  hf_track_at_pv::AtPvCTglSnp,
+                  hf_track_at_pv::AtPvCTglTgl,
+                  hf_track_at_pv::AtPvC1PtY,
+                  hf_track_at_pv::AtPvC1PtZ,
+                  hf_track_at_pv::AtPvC1PtSnp,
+                  hf_track_at_pv::AtPvC1PtTgl,
+                  hf_track_at_pv::AtPvC1Pt21Pt2,
+                  hf_track_at_pv::AtPvDcaY,
+                  hf_track_at_pv::AtPvDcaZ,
+                  hf_track_at_pv::AtPvSigmaDcaY2,
+                  hf_track_at_pv::AtPvSigmaDcaYZ,
+                  hf_track_at_pv::AtPvSigmaDcaZ2);
+
 // ================
 // Track index skim tables
 // ================
@@ -30,6 +30,7 @@
 #include "PWGHF/Utils/utilsMcGen.h"
 #include "PWGHF/Utils/utilsMcMatching.h"
 #include "PWGHF/Utils/utilsPid.h"
+#include "PWGHF/Utils/utilsTrackCacheHf.h"
 #include "PWGHF/Utils/utilsTrkCandHf.h"
 #include "PWGLF/DataModel/mcCentrality.h"
 
@@ -115,6 +116,7 @@ struct HfCandidateCreator2Prong {
 
   HfEventSelection hfEvSel;        // event selection and monitoring
   o2::vertexing::DCAFitterN<2> df; // 2-prong vertex fitter
+  HfDaughterTrackCache trackCache; // daughter tracks at the PV (HfTrackAtPv) reused across candidates of the same DataFrame
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
   int runNumber{0};
@@ -124,7 +126,7 @@ struct HfCandidateCreator2Prong {
 
   std::shared_ptr<TH1> hCandidates;
 
-  using TracksWCovExtraPidPiKa = soa::Join<aod::TracksWCovExtra, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa>;
+  using TracksWCovExtraPidPiKa = soa::Join<aod::TracksWCovExtra, aod::HfTrackAtPv, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa>;
 
   ConfigurableAxis axisMass{"axisMass", {500, 1.6, 2.1}, "axis for mass (GeV/c^2)"};
 
@@ -215,9 +217,10 @@ struct HfCandidateCreator2Prong {
   template <bool DoPvRefit, bool ApplyUpcSel, o2::hf_centrality::CentralityEstimator CentEstimator, typename Coll, typename CandType, typename TTracks, typename BCsType>
   void runCreator2ProngWithDCAFitterN(Coll const&,
                                       CandType const& rowsTrackIndexProng2,
-                                      TTracks const&,
+                                      TTracks const& tracks,
                                       BCsType const& bcs)
   {
+    trackCache.reset(tracks.size());
     // loop over pairs of track indices
     for (const auto& rowTrackIndexProng2 : rowsTrackIndexProng2) {
 
@@ -237,8 +240,6 @@ struct HfCandidateCreator2Prong {
 
       auto track0 = rowTrackIndexProng2.template prong0_as<TTracks>();
       auto track1 = rowTrackIndexProng2.template prong1_as<TTracks>();
-      auto trackParVarPos1 = getTrackParCov(track0);
-      auto trackParVarNeg1 = getTrackParCov(track1);
 
       /// Set the magnetic field from ccdb.
       /// The static instance of the propagator was already modified in the HFTrackIndexSkimCreator,
@@ -254,10 +255,14 @@ struct HfCandidateCreator2Prong {
       }
       df.setBz(bz);
 
+      // tracks at the PV of the collision, from the HfTrackAtPv table
+      const auto& trackAtPv0 = trackCache.getTrackAtPv(track0, collision);
+      const auto& trackAtPv1 = trackCache.getTrackAtPv(track1, collision);
+
       // reconstruct the 2-prong secondary vertex
       hCandidates->Fill(SVFitting::BeforeFit);
       try {
-        if (df.process(trackParVarPos1, trackParVarNeg1) == 0) {
+        if (df.process(trackAtPv0.trackParCov, trackAtPv1.trackParCov) == 0) {
           continue;
         }
       } catch (const std::runtime_error& error) {
@@ -307,10 +312,12 @@ struct HfCandidateCreator2Prong {
       registry.fill(HIST("hCovPVYY"), covMatrixPV[2]);
       registry.fill(HIST("hCovPVXZ"), covMatrixPV[3]);
       registry.fill(HIST("hCovPVZZ"), covMatrixPV[5]);
-      o2::dataformats::DCA impactParameter0;
-      o2::dataformats::DCA impactParameter1;
-      trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
-      trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
+      o2::dataformats::DCA impactParameter0 = trackAtPv0.impactParameter;
+      o2::dataformats::DCA impactParameter1 = trackAtPv1.impactParameter;
+      if constexpr (DoPvRefit) {
+        trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
+        trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
+      }
       registry.fill(HIST("hDcaXYProngs"), track0.pt(), impactParameter0.getY() * toMicrometers);
       registry.fill(HIST("hDcaXYProngs"), track1.pt(), impactParameter1.getY() * toMicrometers);
       registry.fill(HIST("hDcaZProngs"), track0.pt(), impactParameter0.getZ() * toMicrometers);
@@ -29,6 +29,7 @@
 #include "PWGHF/Utils/utilsMcGen.h"
 #include "PWGHF/Utils/utilsMcMatching.h"
 #include "PWGHF/Utils/utilsPid.h"
+#include "PWGHF/Utils/utilsTrackCacheHf.h"
 #include "PWGHF/Utils/utilsTrkCandHf.h"
 #include "PWGLF/DataModel/mcCentrality.h"
 
@@ -132,6 +133,7 @@ struct HfCandidateCreator3Prong {
 
   HfEventSelection hfEvSel;        // event selection and monitoring
   o2::vertexing::DCAFitterN<3> df; // 3-prong vertex fitter
+  HfDaughterTrackCache trackCache; // daughter tracks at the PV (HfTrackAtPv) reused across candidates of the same DataFrame
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
   int runNumber{0};
@@ -142,7 +144,7 @@ struct HfCandidateCreator3Prong {
 
   using FilteredHf3Prongs = soa::Filtered<aod::Hf3Prongs>;
   using FilteredPvRefitHf3Prongs = soa::Filtered<soa::Join<aod::Hf3Prongs, aod::HfPvRefit3Prong>>;
-  using TracksWCovExtraPidPiKaPrDe = soa::Join<aod::TracksWCovExtra, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa, aod::TracksPidPr, aod::PidTpcTofFullPr, aod::TracksPidDe, aod::PidTpcTofFullDe>;
+  using TracksWCovExtraPidPiKaPrDe = soa::Join<aod::TracksWCovExtra, aod::HfTrackAtPv, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa, aod::TracksPidPr, aod::PidTpcTofFullPr, aod::TracksPidDe, aod::PidTpcTofFullDe>;
 
   // filter candidates
   Filter filterSelected3Prongs = (createDplus && (o2::aod::hf_track_index::hfflag & static_cast<uint8_t>(BIT(DecayType::DplusToPiKPi))) != static_cast<uint8_t>(0)) || (createDs && (o2::aod::hf_track_index::hfflag & static_cast<uint8_t>(BIT(DecayType::DsToKKPi))) != static_cast<uint8_t>(0)) || (createLc && (o2::aod::hf_track_index::hfflag & static_cast<uint8_t>(BIT(DecayType::LcToPKPi))) != static_cast<uint8_t>(0)) || (createXic && (o2::aod::hf_track_index::hfflag & static_cast<uint8_t>(BIT(DecayType::XicToPKPi))) != static_cast<uint8_t>(0)) || (createCd && (o2::aod::hf_track_index::hfflag & static_cast<uint8_t>(BIT(DecayType::CdToDeKPi))) != static_cast<uint8_t>(0));
@@ -266,9 +268,10 @@ struct HfCandidateCreator3Prong {
   template <bool DoPvRefit, bool ApplyUpcSel, o2::hf_centrality::CentralityEstimator CentEstimator, typename Coll, typename Cand, typename BCsType>
   void runCreator3ProngWithDCAFitterN(Coll const&,
                                       Cand const& rowsTrackIndexProng3,
-                                      TracksWCovExtraPidPiKaPrDe const&,
+                                      TracksWCovExtraPidPiKaPrDe const& tracks,
                                       BCsType const& bcs)
   {
+    trackCache.reset(tracks.size());
     // loop over triplets of track indices
     for (const auto& rowTrackIndexProng3 : rowsTrackIndexProng3) {
 
@@ -289,9 +292,6 @@ struct HfCandidateCreator3Prong {
       auto track0 = rowTrackIndexProng3.template prong0_as<TracksWCovExtraPidPiKaPrDe>();
       auto track1 = rowTrackIndexProng3.template prong1_as<TracksWCovExtraPidPiKaPrDe>();
       auto track2 = rowTrackIndexProng3.template prong2_as<TracksWCovExtraPidPiKaPrDe>();
-      auto trackParVar0 = getTrackParCov(track0);
-      auto trackParVar1 = getTrackParCov(track1);
-      auto trackParVar2 = getTrackParCov(track2);
 
       /// Set the magnetic field from ccdb.
       /// The static instance of the propagator was already modified in the HFTrackIndexSkimCreator,
@@ -307,10 +307,15 @@ struct HfCandidateCreator3Prong {
       }
       df.setBz(bz);
 
+      // tracks at the PV of the collision, from the HfTrackAtPv table
+      const auto& trackAtPv0 = trackCache.getTrackAtPv(track0, collision);
+      const auto& trackAtPv1 = trackCache.getTrackAtPv(track1, collision);
+      const auto& trackAtPv2 = trackCache.getTrackAtPv(track2, collision);
+
       // reconstruct the 3-prong secondary vertex
       hCandidates->Fill(SVFitting::BeforeFit);
       try {
-        if (df.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
+        if (df.process(trackAtPv0.trackParCov, trackAtPv1.trackParCov, trackAtPv2.trackParCov) == 0) {
           continue;
         }
       } catch (const std::runtime_error& error) {
@@ -327,9 +332,9 @@ struct HfCandidateCreator3Prong {
       registry.fill(HIST("hCovSVYY"), covMatrixPCA[2]);
       registry.fill(HIST("hCovSVXZ"), covMatrixPCA[3]);
       registry.fill(HIST("hCovSVZZ"), covMatrixPCA[5]);
-      trackParVar0 = df.getTrack(0);
-      trackParVar1 = df.getTrack(1);
-      trackParVar2 = df.getTrack(2);
+      auto trackParVar0 = df.getTrack(0);
+      auto trackParVar1 = df.getTrack(1);
+      auto trackParVar2 = df.getTrack(2);
 
       // get track momenta
       std::array<float, 3> pvec0{};
@@ -363,12 +368,14 @@ struct HfCandidateCreator3Prong {
       registry.fill(HIST("hCovPVYY"), covMatrixPV[2]);
       registry.fill(HIST("hCovPVXZ"), covMatrixPV[3]);
       registry.fill(HIST("hCovPVZZ"), covMatrixPV[5]);
-      o2::dataformats::DCA impactParameter0;
-      o2::dataformats::DCA impactParameter1;
-      o2::dataformats::DCA impactParameter2;
-      trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
-      trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
-      trackParVar2.propagateToDCA(primaryVertex, bz, &impactParameter2);
+      o2::dataformats::DCA impactParameter0 = trackAtPv0.impactParameter;
+      o2::dataformats::DCA impactParameter1 = trackAtPv1.impactParameter;
+      o2::dataformats::DCA impactParameter2 = trackAtPv2.impactParameter;
+      if constexpr (DoPvRefit) {
+        trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
+        trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
+        trackParVar2.propagateToDCA(primaryVertex, bz, &impactParameter2);
+      }
       registry.fill(HIST("hDcaXYProngs"), track0.pt(), impactParameter0.getY() * toMicrometers);
       registry.fill(HIST("hDcaXYProngs"), track1.pt(), impactParameter1.getY() * toMicrometers);
       registry.fill(HIST("hDcaXYProngs"), track2.pt(), impactParameter2.getY() * toMicrometers);
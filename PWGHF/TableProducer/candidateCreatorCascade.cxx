@@ -21,6 +21,7 @@
 #include "PWGHF/DataModel/TrackIndexSkimmingTables.h"
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
 #include "PWGHF/Utils/utilsEvSelHf.h"
+#include "PWGHF/Utils/utilsTrackCacheHf.h"
 #include "PWGHF/Utils/utilsTrkCandHf.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "PWGLF/DataModel/mcCentrality.h"
@@ -91,6 +92,7 @@ struct HfCandidateCreatorCascade {
 
   HfEventSelection hfEvSel;        // event selection and monitoring
   o2::vertexing::DCAFitterN<2> df; // 2-prong vertex fitter
+  HfDaughterTrackCache trackCache; // bachelor tracks at the PV (HfTrackAtPv) reused across candidates of the same DataFrame
   Service<o2::ccdb::BasicCCDBManager> ccdb;
   o2::base::MatLayerCylSet* lut{};
   o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
@@ -104,6 +106,7 @@ struct HfCandidateCreatorCascade {
   double bz = 0.;
 
   using V0full = soa::Join<aod::V0Datas, aod::V0Covs>;
+  using TracksWCovAtPv = soa::Join<aod::TracksWCov, aod::HfTrackAtPv>;
 
   std::shared_ptr<TH1> hCandidates;
   HistogramRegistry registry{"registry"};
@@ -170,9 +173,10 @@ struct HfCandidateCreatorCascade {
                          aod::HfCascades const& rowsTrackIndexCasc,
                          aod::V0sLinked const&,
                          V0full const&,
-                         aod::TracksWCov const&,
+                         TracksWCovAtPv const& tracks,
                          aod::BCsWithTimestamps const& /*bcWithTimeStamps*/)
   {
+    trackCache.reset(tracks.size());
 
     // loop over pairs of track indices
     for (const auto& casc : rowsTrackIndexCasc) {
@@ -186,7 +190,7 @@ struct HfCandidateCreatorCascade {
         continue;
       }
 
-      const auto& bach = casc.prong0_as<aod::TracksWCov>();
+      const auto& bach = casc.prong0_as<TracksWCovAtPv>();
       LOGF(debug, "V0 %d in HF cascade %d.", casc.v0Id(), casc.globalIndex());
       if (!casc.has_v0()) {
         LOGF(error, "V0 not there for HF cascade %d. Skipping candidate.", casc.globalIndex());
@@ -203,8 +207,8 @@ struct HfCandidateCreatorCascade {
       if (v0index.has_v0Data()) {
         // this V0 passed both standard V0 and cascade V0 selections
         auto v0row = v0index.template v0Data_as<V0full>();
-        const auto& trackV0DaughPos = v0row.posTrack_as<aod::TracksWCov>();
-        const auto& trackV0DaughNeg = v0row.negTrack_as<aod::TracksWCov>();
+        const auto& trackV0DaughPos = v0row.posTrack_as<TracksWCovAtPv>();
+        const auto& trackV0DaughNeg = v0row.negTrack_as<TracksWCovAtPv>();
         posGlobalIndex = trackV0DaughPos.globalIndex();
         negGlobalIndex = trackV0DaughNeg.globalIndex();
         v0X = v0row.x();
@@ -246,7 +250,7 @@ struct HfCandidateCreatorCascade {
       }
       df.setBz(bz);
 
-      auto trackBach = getTrackParCov(bach);
+      const auto& trackAtPvBach = trackCache.getTrackAtPv(bach, collision); // bachelor at the PV of the collision, from the HfTrackAtPv table
       const std::array<float, 3> vertexV0 = {v0X, v0Y, v0Z};
       const std::array<float, 3> momentumV0 = {v0px, v0py, v0pz};
       // we build the neutral track to then build the cascade
@@ -257,7 +261,7 @@ struct HfCandidateCreatorCascade {
       // reconstruct the cascade secondary vertex
       hCandidates->Fill(SVFitting::BeforeFit);
       try {
-        if (df.process(trackV0, trackBach) == 0) {
+        if (df.process(trackV0, trackAtPvBach.trackParCov) == 0) {
           continue;
         }
         LOG(debug) << "Vertexing succeeded for Lc candidate";
@@ -289,9 +293,8 @@ struct HfCandidateCreatorCascade {
       auto covMatrixPV = primaryVertex.getCov();
       registry.fill(HIST("hCovPVXX"), covMatrixPV[0]);
       o2::dataformats::DCA impactParameterV0;
-      o2::dataformats::DCA impactParameterBach;
+      o2::dataformats::DCA impactParameterBach = trackAtPvBach.impactParameter;
       trackParVarV0.propagateToDCA(primaryVertex, bz, &impactParameterV0); // we do this wrt the primary vtx
-      trackParVarBach.propagateToDCA(primaryVertex, bz, &impactParameterBach);
 
       // get uncertainty of the decay length
       double phi, theta;
@@ -333,7 +336,7 @@ struct HfCandidateCreatorCascade {
                      aod::HfCascades const& rowsTrackIndexCasc,
                      aod::V0sLinked const& v0sLinked,
                      V0full const& v0Full,
-                     aod::TracksWCov const& tracks,
+                     TracksWCovAtPv const& tracks,
                      aod::BCsWithTimestamps const& bcs)
   {
     runCreatorCascade<CentralityEstimator::None>(collisions, rowsTrackIndexCasc, v0sLinked, v0Full, tracks, bcs);
@@ -345,7 +348,7 @@ struct HfCandidateCreatorCascade {
                        aod::HfCascades const& rowsTrackIndexCasc,
                        aod::V0sLinked const& v0sLinked,
                        V0full const& v0Full,
-                       aod::TracksWCov const& tracks,
+                       TracksWCovAtPv const& tracks,
                        aod::BCsWithTimestamps const& bcs)
   {
     runCreatorCascade<CentralityEstimator::FT0C>(collisions, rowsTrackIndexCasc, v0sLinked, v0Full, tracks, bcs);
@@ -357,7 +360,7 @@ struct HfCandidateCreatorCascade {
                        aod::HfCascades const& rowsTrackIndexCasc,
                        aod::V0sLinked const& v0sLinked,
                        V0full const& v0Full,
-                       aod::TracksWCov const& tracks,
+                       TracksWCovAtPv const& tracks,
                        aod::BCsWithTimestamps const& bcs)
   {
     runCreatorCascade<CentralityEstimator::FT0M>(collisions, rowsTrackIndexCasc, v0sLinked, v0Full, tracks, bcs);
@@ -23,6 +23,7 @@
 #include "PWGHF/DataModel/TrackIndexSkimmingTables.h"
 #include "PWGHF/Utils/utilsEvSelHf.h"
 #include "PWGHF/Utils/utilsPid.h"
+#include "PWGHF/Utils/utilsTrackCacheHf.h"
 #include "PWGHF/Utils/utilsTrkCandHf.h"
 #include "PWGLF/DataModel/mcCentrality.h"
 
@@ -109,12 +110,14 @@ struct HfCandidateCreatorDstar {
   o2::base::Propagator::MatCorrType noMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
   // D0-prong vertex fitter
   o2::vertexing::DCAFitterN<2> df;
+  // daughter tracks at the PV (HfTrackAtPv) reused across candidates of the same DataFrame
+  HfDaughterTrackCache trackCache;
   int runNumber{};
   double bz{};
   static constexpr float CmToMicrometers = 10000.; // from cm to µm
   double massPi{}, massK{}, massD0{};
 
-  using TracksWCovExtraPidPiKa = soa::Join<aod::TracksWCovExtra, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa>;
+  using TracksWCovExtraPidPiKa = soa::Join<aod::TracksWCovExtra, aod::HfTrackAtPv, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa>;
 
   AxisSpec ptAxis = {100, 0., 2.0, "#it{p}_{T} (GeV/#it{c}"};
   AxisSpec dcaAxis = {200, -500., 500., "#it{d}_{xy,z} (#mum)"};
@@ -210,9 +213,10 @@ struct HfCandidateCreatorDstar {
   void runCreatorDstar(Coll const&,
                        CandsDstar const& rowsTrackIndexDstar,
                        aod::Hf2Prongs const&,
-                       TracksWCovExtraPidPiKa const&,
+                       TracksWCovExtraPidPiKa const& tracks,
                        aod::BCsWithTimestamps const& /*bcWithTimeStamps*/)
   {
+    trackCache.reset(tracks.size());
     // LOG(info) << "runCreatorDstar function called";
     // LOG(info) << "candidate loop starts";
     // loop over suspected Dstar Candidate
@@ -236,12 +240,6 @@ struct HfCandidateCreatorDstar {
       auto primaryVertex = getPrimaryVertex(collision);
       auto covMatrixPV = primaryVertex.getCov();
 
-      // Extracts track parameters and covariance matrix from a track
-      auto trackPiParVar = getTrackParCov(trackPi);
-      // These will be used in DCA Fitter to reconstruct secondary vertex
-      auto trackD0Prong0ParVarPos1 = getTrackParCov(trackD0Prong0); // from trackUtilities.h
-      auto trackD0Prong1ParVarNeg1 = getTrackParCov(trackD0Prong1);
-
       // auto collisionPiId = trackPi.collisionId();
       // auto collisionD0Id = trackD0Prong0.collisionId();
       // LOGF(info, "Pi collision %ld, D0 collision %ld", collisionPiId, collisionD0Id);
@@ -262,10 +260,16 @@ struct HfCandidateCreatorDstar {
       }
       df.setBz(bz);
 
+      // Track parameters, covariance matrix and impact parameter at the PV of the collision, from the HfTrackAtPv table
+      const auto& trackAtPvPi = trackCache.getTrackAtPv(trackPi, collision);
+      // These will be used in DCA Fitter to reconstruct secondary vertex
+      const auto& trackAtPvD0Prong0 = trackCache.getTrackAtPv(trackD0Prong0, collision);
+      const auto& trackAtPvD0Prong1 = trackCache.getTrackAtPv(trackD0Prong1, collision);
+
       // reconstruct the 2-prong secondary vertex
       hCandidates->Fill(SVFitting::BeforeFit);
       try {
-        if (df.process(trackD0Prong0ParVarPos1, trackD0Prong1ParVarNeg1) == 0) {
+        if (df.process(trackAtPvD0Prong0.trackParCov, trackAtPvD0Prong1.trackParCov) == 0) {
           continue;
         }
       } catch (const std::runtime_error& error) {
@@ -317,15 +321,18 @@ struct HfCandidateCreatorDstar {
       registry.fill(HIST("Refit/hCovPVZZ"), covMatrixPV[5]);
 
       // get track impact parameters
-      o2::dataformats::DCA impactParameter0; // GPUROOTCartesianFwd.h
-      o2::dataformats::DCA impactParameter1;
-      // Propagating D0 prongs to DCA
-      trackD0ProngParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
-      trackD0ProngParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
-
-      // Propagating Soft Pi to DCA
-      o2::dataformats::DCA impactParameterPi;
-      trackPiParVar.propagateToDCA(primaryVertex, bz, &impactParameterPi);
+      o2::dataformats::DCA impactParameter0 = trackAtPvD0Prong0.impactParameter; // GPUROOTCartesianFwd.h
+      o2::dataformats::DCA impactParameter1 = trackAtPvD0Prong1.impactParameter;
+      o2::dataformats::DCA impactParameterPi = trackAtPvPi.impactParameter;
+      auto trackPiParVar = trackAtPvPi.trackParCov;
+      if constexpr (DoPvRefit) {
+        // Propagating D0 prongs to DCA
+        trackD0ProngParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
+        trackD0ProngParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
+
+        // Propagating Soft Pi to DCA
+        trackPiParVar.propagateToDCA(primaryVertex, bz, &impactParameterPi);
+      }
       registry.fill(HIST("QA/hDcaXYProngsD0"), trackD0Prong0.pt(), impactParameter0.getY() * CmToMicrometers);
       registry.fill(HIST("QA/hDcaXYProngsD0"), trackD0Prong1.pt(), impactParameter1.getY() * CmToMicrometers);
       registry.fill(HIST("QA/hDcaZProngsD0"), trackD0Prong0.pt(), impactParameter0.getZ() * CmToMicrometers);
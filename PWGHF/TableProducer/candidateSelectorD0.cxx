@@ -308,6 +308,12 @@ struct HfCandidateSelectorD0 {
   void processSel(CandType const& candidates,
                   TracksSel const&)
   {
+    // input features resolved once per DataFrame, feature buffer reused for all candidates
+    HfMlFeatureExtractor<typename CandType::iterator, int> mlFeatures;
+    if (applyMl) {
+      hfMlResponse.initFeatureExtractor(mlFeatures);
+    }
+
     // looping over 2-prong candidates
     for (const auto& candidate : candidates) {
 
@@ -458,12 +464,10 @@ struct HfCandidateSelectorD0 {
         bool isSelectedMlD0bar = false;
 
         if (statusD0 > 0) {
-          std::vector<float> inputFeaturesD0 = hfMlResponse.getInputFeatures(candidate, o2::constants::physics::kD0);
-          isSelectedMlD0 = hfMlResponse.isSelectedMl(inputFeaturesD0, ptCand, outputMlD0);
+          isSelectedMlD0 = hfMlResponse.isSelectedMl(mlFeatures.extract(candidate, o2::constants::physics::kD0), ptCand, outputMlD0);
         }
         if (statusD0bar > 0) {
-          std::vector<float> inputFeaturesD0bar = hfMlResponse.getInputFeatures(candidate, o2::constants::physics::kD0Bar);
-          isSelectedMlD0bar = hfMlResponse.isSelectedMl(inputFeaturesD0bar, ptCand, outputMlD0bar);
+          isSelectedMlD0bar = hfMlResponse.isSelectedMl(mlFeatures.extract(candidate, o2::constants::physics::kD0Bar), ptCand, outputMlD0bar);
         }
 
         if (!isSelectedMlD0) {
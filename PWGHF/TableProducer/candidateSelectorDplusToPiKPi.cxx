@@ -233,6 +233,12 @@ struct HfCandidateSelectorDplusToPiKPi {
   void process(aod::HfCand3ProngWPidPiKa const& candidates,
                TracksSel const&)
   {
+    // input features resolved once per DataFrame, feature buffer reused for all candidates
+    HfMlFeatureExtractor<aod::HfCand3ProngWPidPiKa::iterator> mlFeatures;
+    if (applyMl) {
+      hfMlResponse.initFeatureExtractor(mlFeatures);
+    }
+
     // looping over 3-prong candidates
     for (const auto& candidate : candidates) {
 
@@ -302,8 +308,7 @@ struct HfCandidateSelectorDplusToPiKPi {
 
       if (applyMl) {
         // ML selections
-        std::vector<float> inputFeatures = hfMlResponse.getInputFeatures(candidate);
-        bool const isSelectedMl = hfMlResponse.isSelectedMl(inputFeatures, ptCand, outputMl);
+        bool const isSelectedMl = hfMlResponse.isSelectedMl(mlFeatures.extract(candidate), ptCand, outputMl);
         hfMlDplusToPiKPiCandidate(outputMl);
 
         if (!isSelectedMl) {
@@ -442,6 +442,16 @@ struct HfCandidateSelectorLc {
   template <bool UseBayesPid = false, aod::hf_cand::VertexerType ReconstructionType, typename CandType, typename TTracks>
   void runSelectLc(CandType const& candidates, TTracks const&)
   {
+    // input features resolved once per DataFrame, feature buffer reused for all candidates
+    HfMlFeatureExtractor<typename CandType::iterator, bool> mlFeatures;
+    if (applyMl) {
+      if constexpr (ReconstructionType == aod::hf_cand::VertexerType::DCAFitter) {
+        hfMlResponseDCA.initFeatureExtractor(mlFeatures);
+      } else {
+        hfMlResponseKF.initFeatureExtractor(mlFeatures);
+      }
+    }
+
     // looping over 3-prong candidates
     for (const auto& candidate : candidates) {
 
@@ -582,21 +592,17 @@ struct HfCandidateSelectorLc {
 
         if constexpr (ReconstructionType == aod::hf_cand::VertexerType::DCAFitter) {
           if (pidLcToPKPi == 1 && pidBayesLcToPKPi == 1 && topolLcToPKPi) {
-            std::vector<float> inputFeaturesLcToPKPi = hfMlResponseDCA.getInputFeatures(candidate, true);
-            isSelectedMlLcToPKPi = hfMlResponseDCA.isSelectedMl(inputFeaturesLcToPKPi, candidate.pt(), outputMlLcToPKPi);
+            isSelectedMlLcToPKPi = hfMlResponseDCA.isSelectedMl(mlFeatures.extract(candidate, true), candidate.pt(), outputMlLcToPKPi);
           }
           if (pidLcToPiKP == 1 && pidBayesLcToPiKP == 1 && topolLcToPiKP) {
-            std::vector<float> inputFeaturesLcToPiKP = hfMlResponseDCA.getInputFeatures(candidate, false);
-            isSelectedMlLcToPiKP = hfMlResponseDCA.isSelectedMl(inputFeaturesLcToPiKP, candidate.pt(), outputMlLcToPiKP);
+            isSelectedMlLcToPiKP = hfMlResponseDCA.isSelectedMl(mlFeatures.extract(candidate, false), candidate.pt(), outputMlLcToPiKP);
           }
         } else {
           if (pidLcToPKPi == 1 && pidBayesLcToPKPi == 1 && topolLcToPKPi) {
-            std::vector<float> inputFeaturesLcToPKPi = hfMlResponseKF.getInputFeatures(candidate, true);
-            isSelectedMlLcToPKPi = hfMlResponseKF.isSelectedMl(inputFeaturesLcToPKPi, candidate.pt(), outputMlLcToPKPi);
+            isSelectedMlLcToPKPi = hfMlResponseKF.isSelectedMl(mlFeatures.extract(candidate, true), candidate.pt(), outputMlLcToPKPi);
           }
           if (pidLcToPiKP == 1 && pidBayesLcToPiKP == 1 && topolLcToPiKP) {
-            std::vector<float> inputFeaturesLcToPiKP = hfMlResponseKF.getInputFeatures(candidate, false);
-            isSelectedMlLcToPiKP = hfMlResponseKF.isSelectedMl(inputFeaturesLcToPiKP, candidate.pt(), outputMlLcToPiKP);
+            isSelectedMlLcToPiKP = hfMlResponseKF.isSelectedMl(mlFeatures.extract(candidate, false), candidate.pt(), outputMlLcToPiKP);
           }
         }
 
@@ -28,6 +28,7 @@
 #include "PWGHF/Utils/utilsAnalysis.h"
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
 #include "PWGHF/Utils/utilsEvSelHf.h"
+#include "PWGHF/Utils/utilsTrackCacheHf.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 
 #include "Common/CCDB/TriggerAliases.h"
@@ -262,6 +263,7 @@ struct HfTrackIndexSkimCreatorTagSelCollisions {
 struct HfTrackIndexSkimCreatorTagSelTracks {
   Produces<aod::HfSelTrack> rowSelectedTrack;
   Produces<aod::HfPvRefitTrack> tabPvRefitTrack;
+  Produces<aod::HfTrackAtPv> tabTrackAtPv;
 
   struct : ConfigurableGroup {
     double etaMinDefault{-99999.};
@@ -1022,6 +1024,24 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
     }
   }
 
+  /// Helper function to fill the table of tracks at the PV of their collision, read by the candidate creators
+  /// \param tracks is the track table
+  template <typename TTracks>
+  void fillTrackAtPvTable(TTracks const& tracks)
+  {
+    tabTrackAtPv.reserve(tracks.size());
+    for (const auto& track : tracks) {
+      auto trackParCov = getTrackParCov(track);
+      o2::dataformats::DCA impactParameter(0.f, 0.f);
+      if (track.has_collision()) {
+        const auto collision = track.template collision_as<aod::Collisions>();
+        initCCDB(collision.template bc_as<o2::aod::BCsWithTimestamps>(), runNumber, ccdb, config.isRun2 ? config.ccdbPathGrp : config.ccdbPathGrpMag, lut, config.isRun2);
+        o2::base::Propagator::Instance()->propagateToDCABxByBz(getPrimaryVertex(collision), trackParCov, 2.f, noMatCorr, &impactParameter);
+      }
+      o2::hf_trkcandsel::fillTrackAtPvRow(tabTrackAtPv, trackParCov, impactParameter);
+    }
+  }
+
   void processNoPid(aod::Collisions const& collisions,
                     TrackAssoc const& trackIndices,
                     TracksWithSelAndDca const& tracks,
@@ -1047,6 +1067,8 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
       runTagSelTracks<NoPid>(collision, tracks, groupedTrackIndices, pvContrCollision, bcWithTimeStamps, pvRefitDcaPerTrack, pvRefitPvCoordPerTrack, pvRefitPvCovMatrixPerTrack);
     }
 
+    fillTrackAtPvTable(tracks);
+
     if (config.doPvRefit) { /// fill table with PV refit info (it has to be filled per track and not track index)
       fillPvRefitTable(pvRefitDcaPerTrack, pvRefitPvCoordPerTrack, pvRefitPvCovMatrixPerTrack);
     }
@@ -1078,6 +1100,8 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
       runTagSelTracks<PidTpcOnly>(collision, tracks, groupedTrackIndices, pvContrCollision, bcWithTimeStamps, pvRefitDcaPerTrack, pvRefitPvCoordPerTrack, pvRefitPvCovMatrixPerTrack);
     }
 
+    fillTrackAtPvTable(tracks);
+
     if (config.doPvRefit) { /// fill table with PV refit info (it has to be filled per track and not track index)
       fillPvRefitTable(pvRefitDcaPerTrack, pvRefitPvCoordPerTrack, pvRefitPvCovMatrixPerTrack);
     }
@@ -1109,6 +1133,8 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
       runTagSelTracks<PidTofOnly>(collision, tracks, groupedTrackIndices, pvContrCollision, bcWithTimeStamps, pvRefitDcaPerTrack, pvRefitPvCoordPerTrack, pvRefitPvCovMatrixPerTrack);
     }
 
+    fillTrackAtPvTable(tracks);
+
     if (config.doPvRefit) { /// fill table with PV refit info (it has to be filled per track and not track index)
       fillPvRefitTable(pvRefitDcaPerTrack, pvRefitPvCoordPerTrack, pvRefitPvCovMatrixPerTrack);
     }
@@ -1140,6 +1166,8 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
       runTagSelTracks<PidTpcOrTof>(collision, tracks, groupedTrackIndices, pvContrCollision, bcWithTimeStamps, pvRefitDcaPerTrack, pvRefitPvCoordPerTrack, pvRefitPvCovMatrixPerTrack);
     }
 
+    fillTrackAtPvTable(tracks);
+
     if (config.doPvRefit) { /// fill table with PV refit info (it has to be filled per track and not track index)
       fillPvRefitTable(pvRefitDcaPerTrack, pvRefitPvCoordPerTrack, pvRefitPvCovMatrixPerTrack);
     }
@@ -1171,6 +1199,8 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
       runTagSelTracks<PidTpcAndTof>(collision, tracks, groupedTrackIndices, pvContrCollision, bcWithTimeStamps, pvRefitDcaPerTrack, pvRefitPvCoordPerTrack, pvRefitPvCovMatrixPerTrack);
     }
 
+    fillTrackAtPvTable(tracks);
+
     if (config.doPvRefit) { /// fill table with PV refit info (it has to be filled per track and not track index)
       fillPvRefitTable(pvRefitDcaPerTrack, pvRefitPvCoordPerTrack, pvRefitPvCovMatrixPerTrack);
     }
@@ -1273,12 +1303,12 @@ struct HfTrackIndexSkimCreator {
   } config;
 
   SliceCache cache;
-  o2::vertexing::DCAFitterN<2> df2; // 2-prong vertex fitter
-  o2::vertexing::DCAFitterN<3> df3; // 3-prong vertex fitter
+  o2::vertexing::DCAFitterN<2> df2;                   // 2-prong vertex fitter
+  o2::vertexing::DCAFitterN<3> df3;                   // 3-prong vertex fitter
+  o2::hf_trkcandsel::HfDaughterTrackCache trackCache; // tracks at the PV (HfTrackAtPv) reused across the pairs and triplets of the DataFrame
   // Needed for PV refitting
   Service<o2::ccdb::BasicCCDBManager> ccdb;
   o2::base::MatLayerCylSet* lut{};
-  o2::base::Propagator::MatCorrType noMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
   int runNumber{};
 
   // int nColls{0}; //can be added to run over limited collisions per file - for tesing purposes
@@ -1303,7 +1333,8 @@ struct HfTrackIndexSkimCreator {
   o2::ccdb::CcdbApi ccdbApi;
 
   using SelectedCollisions = soa::Filtered<soa::Join<aod::Collisions, aod::HfSelCollision>>;
-  using TracksWithPVRefitAndDCA = soa::Join<aod::TracksWCovDcaExtra, aod::HfPvRefitTrack>;
+  using TracksWithDcaAtPv = soa::Join<aod::TracksWCovDcaExtra, aod::HfTrackAtPv>;
+  using TracksWithPVRefitAndDCA = soa::Join<aod::TracksWCovDcaExtra, aod::HfPvRefitTrack, aod::HfTrackAtPv>;
   using FilteredTrackAssocSel = soa::Filtered<soa::Join<aod::TrackAssoc, aod::HfSelTrack>>;
 
   // filter collisions
@@ -2072,6 +2103,8 @@ struct HfTrackIndexSkimCreator {
                       FilteredTrackAssocSel const&,
                       TTracks const& tracks)
   {
+    // the tracks at the PV are read from the HfTrackAtPv table once per DataFrame, and re-propagated once to the other collisions they are associated to
+    trackCache.reset(tracks.size());
 
     // can be added to run over limited collisions per file - for tesing purposes
     /*
@@ -2168,11 +2201,11 @@ struct HfTrackIndexSkimCreator {
         const bool sel2ProngStatusPos = TESTBIT(isSelProngPos1, CandidateType::Cand2Prong);
         const bool sel3ProngStatusPos1 = TESTBIT(isSelProngPos1, CandidateType::Cand3Prong);
 
-        auto trackParVarPos1 = getTrackParCov(trackPos1);
+        const auto& trackAtPvPos1 = trackCache.getTrackAtPv(trackPos1, collision); // re-propagated once per DataFrame if this is not the "default" collision for this track
+        auto trackParVarPos1 = trackAtPvPos1.trackParCov;
         std::array pVecTrackPos1{trackPos1.pVector()};
-        std::array dcaInfoPos1{trackPos1.dcaXY(), trackPos1.dcaZ()};
-        if (thisCollId != trackPos1.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos1, 2.f, noMatCorr, &dcaInfoPos1);
+        std::array dcaInfoPos1{trackAtPvPos1.impactParameter.getY(), trackAtPvPos1.impactParameter.getZ()};
+        if (thisCollId != trackPos1.collisionId()) {
           getPxPyPz(trackParVarPos1, pVecTrackPos1);
         }
 
@@ -2186,11 +2219,11 @@ struct HfTrackIndexSkimCreator {
           const bool sel2ProngStatusNeg = TESTBIT(isSelProngNeg1, CandidateType::Cand2Prong);
           const bool sel3ProngStatusNeg1 = TESTBIT(isSelProngNeg1, CandidateType::Cand3Prong);
 
-          auto trackParVarNeg1 = getTrackParCov(trackNeg1);
+          const auto& trackAtPvNeg1 = trackCache.getTrackAtPv(trackNeg1, collision); // re-propagated once per DataFrame if this is not the "default" collision for this track
+          auto trackParVarNeg1 = trackAtPvNeg1.trackParCov;
           std::array pVecTrackNeg1{trackNeg1.pVector()};
-          std::array dcaInfoNeg1{trackNeg1.dcaXY(), trackNeg1.dcaZ()};
-          if (thisCollId != trackNeg1.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-            o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg1, 2.f, noMatCorr, &dcaInfoNeg1);
+          std::array dcaInfoNeg1{trackAtPvNeg1.impactParameter.getY(), trackAtPvNeg1.impactParameter.getZ()};
+          if (thisCollId != trackNeg1.collisionId()) {
             getPxPyPz(trackParVarNeg1, pVecTrackNeg1);
           }
 
@@ -2419,14 +2452,14 @@ struct HfTrackIndexSkimCreator {
               }
 
               const auto trackPos2 = trackIndexPos2.template track_as<TTracks>();
-              auto trackParVarPos2 = getTrackParCov(trackPos2);
-              std::array dcaInfoPos2{trackPos2.dcaXY(), trackPos2.dcaZ()};
+              const auto& trackAtPvPos2 = trackCache.getTrackAtPv(trackPos2, collision); // re-propagated once per DataFrame if this is not the "default" collision for this track
+              auto trackParVarPos2 = trackAtPvPos2.trackParCov;
+              std::array dcaInfoPos2{trackAtPvPos2.impactParameter.getY(), trackAtPvPos2.impactParameter.getZ()};
 
               // preselection of 3-prong candidates
               if (isSelected3ProngCand) {
                 std::array pVecTrackPos2{trackPos2.pVector()};
-                if (thisCollId != trackPos2.collisionId()) { // this is not the "default" collision for this track and we still did not re-propagate it, we have to re-propagate it
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos2, 2.f, noMatCorr, &dcaInfoPos2);
+                if (thisCollId != trackPos2.collisionId()) {
                   getPxPyPz(trackParVarPos2, pVecTrackPos2);
                 }
 
@@ -2675,14 +2708,14 @@ struct HfTrackIndexSkimCreator {
               }
 
               auto trackNeg2 = trackIndexNeg2.template track_as<TTracks>();
-              auto trackParVarNeg2 = getTrackParCov(trackNeg2);
-              std::array dcaInfoNeg2{trackNeg2.dcaXY(), trackNeg2.dcaZ()};
+              const auto& trackAtPvNeg2 = trackCache.getTrackAtPv(trackNeg2, collision); // re-propagated once per DataFrame if this is not the "default" collision for this track
+              auto trackParVarNeg2 = trackAtPvNeg2.trackParCov;
+              std::array dcaInfoNeg2{trackAtPvNeg2.impactParameter.getY(), trackAtPvNeg2.impactParameter.getZ()};
 
               // preselection of 3-prong candidates
               if (isSelected3ProngCand) {
                 std::array pVecTrackNeg2{trackNeg2.pVector()};
-                if (thisCollId != trackNeg2.collisionId()) { // this is not the "default" collision for this track and we still did not re-propagate it, we have to re-propagate it
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg2, 2.f, noMatCorr, &dcaInfoNeg2);
+                if (thisCollId != trackNeg2.collisionId()) {
                   getPxPyPz(trackParVarNeg2, pVecTrackNeg2);
                 }
 
@@ -2925,11 +2958,8 @@ struct HfTrackIndexSkimCreator {
                 }
                 auto trackPos2 = trackIndexPos2.template track_as<TTracks>();
                 std::array pVecTrackPos2{trackPos2.pVector()};
-                if (thisCollId != trackPos2.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-                  auto trackParVarPos2 = getTrackParCov(trackPos2);
-                  std::array dcaInfoPos2{trackPos2.dcaXY(), trackPos2.dcaZ()};
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos2, 2.f, noMatCorr, &dcaInfoPos2);
-                  getPxPyPz(trackParVarPos2, pVecTrackPos2);
+                if (thisCollId != trackPos2.collisionId()) { // this is not the "default" collision for this track, re-propagated once per DataFrame
+                  getPxPyPz(trackCache.getTrackAtPv(trackPos2, collision).trackParCov, pVecTrackPos2);
                 }
 
                 uint8_t isSelectedDstar{0};
@@ -2962,11 +2992,8 @@ struct HfTrackIndexSkimCreator {
                 }
                 auto trackNeg2 = trackIndexNeg2.template track_as<TTracks>();
                 std::array pVecTrackNeg2{trackNeg2.pVector()};
-                if (thisCollId != trackNeg2.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-                  auto trackParVarNeg2 = getTrackParCov(trackNeg2);
-                  std::array dcaInfoNeg2{trackNeg2.dcaXY(), trackNeg2.dcaZ()};
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg2, 2.f, noMatCorr, &dcaInfoNeg2);
-                  getPxPyPz(trackParVarNeg2, pVecTrackNeg2);
+                if (thisCollId != trackNeg2.collisionId()) { // this is not the "default" collision for this track, re-propagated once per DataFrame
+                  getPxPyPz(trackCache.getTrackAtPv(trackNeg2, collision).trackParCov, pVecTrackNeg2);
                 }
 
                 uint8_t isSelectedDstar{0};
@@ -3028,7 +3055,7 @@ struct HfTrackIndexSkimCreator {
     SelectedCollisions const& collisions,
     aod::BCsWithTimestamps const& bcWithTimeStamps,
     FilteredTrackAssocSel const& trackIndices,
-    aod::TracksWCovDcaExtra const& tracks)
+    TracksWithDcaAtPv const& tracks)
   {
     run2And3Prongs<false, false>(collisions, bcWithTimeStamps, trackIndices, tracks);
   }
@@ -3048,7 +3075,7 @@ struct HfTrackIndexSkimCreator {
     SelectedCollisions const& collisions,
     aod::BCsWithTimestamps const& bcWithTimeStamps,
     FilteredTrackAssocSel const& trackIndices,
-    soa::Join<aod::TracksWCovDcaExtra, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr> const& tracks)
+    soa::Join<TracksWithDcaAtPv, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr> const& tracks)
   {
     run2And3Prongs<false, true>(collisions, bcWithTimeStamps, trackIndices, tracks);
   }
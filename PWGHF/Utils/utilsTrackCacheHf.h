@@ -0,0 +1,158 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsTrackCacheHf.h
+/// \brief Access to the daughter tracks at the PV for the HF candidate creators
+///
+/// The track parametrisation at the PV of its collision and the impact parameter are produced once per
+/// DataFrame in the HfTrackAtPv table by the track selection of the skim creator. The candidate creators
+/// join this table to the tracks and read it through HfDaughterTrackCache, which builds the TrackParCov of
+/// a track once per DataFrame and propagates it once to the PV of another collision when asked for.
+
+#ifndef PWGHF_UTILS_UTILSTRACKCACHEHF_H_
+#define PWGHF_UTILS_UTILSTRACKCACHEHF_H_
+
+#include "Common/Core/trackUtilities.h"
+
+#include <DetectorsBase/Propagator.h>
+#include <ReconstructionDataFormats/DCA.h>
+#include <ReconstructionDataFormats/Track.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace o2::hf_trkcandsel
+{
+
+/// \brief track parametrisation at the PV from the HfTrackAtPv columns
+template <typename T>
+o2::track::TrackParCov getTrackParCovAtPv(const T& track)
+{
+  std::array<float, 5> par{track.atPvY(), track.atPvZ(), track.atPvSnp(), track.atPvTgl(), track.atPvSigned1Pt()};
+  std::array<float, 15> cov{track.atPvCYY(), track.atPvCZY(), track.atPvCZZ(),
+                            track.atPvCSnpY(), track.atPvCSnpZ(), track.atPvCSnpSnp(),
+                            track.atPvCTglY(), track.atPvCTglZ(), track.atPvCTglSnp(), track.atPvCTglTgl(),
+                            track.atPvC1PtY(), track.atPvC1PtZ(), track.atPvC1PtSnp(), track.atPvC1PtTgl(), track.atPvC1Pt21Pt2()};
+  return o2::track::TrackParCov(track.atPvX(), track.atPvAlpha(), par, cov);
+}
+
+/// \brief impact parameter to the PV from the HfTrackAtPv columns
+template <typename T>
+o2::dataformats::DCA getImpactParameterAtPv(const T& track)
+{
+  return o2::dataformats::DCA(track.atPvDcaY(), track.atPvDcaZ(), track.atPvSigmaDcaY2(), track.atPvSigmaDcaYZ(), track.atPvSigmaDcaZ2());
+}
+
+/// \brief fills a row of the HfTrackAtPv table
+template <typename TTable>
+void fillTrackAtPvRow(TTable& table, const o2::track::TrackParCov& trackParCov, const o2::dataformats::DCA& impactParameter)
+{
+  const auto& cov = trackParCov.getCov();
+  table(trackParCov.getX(), trackParCov.getAlpha(),
+        trackParCov.getY(), trackParCov.getZ(), trackParCov.getSnp(), trackParCov.getTgl(), trackParCov.getQ2Pt(),
+        cov[0], cov[1], cov[2], cov[3], cov[4], cov[5], cov[6], cov[7], cov[8], cov[9], cov[10], cov[11], cov[12], cov[13], cov[14],
+        impactParameter.getY(), impactParameter.getZ(), impactParameter.getSigmaY2(), impactParameter.getSigmaYZ(), impactParameter.getSigmaZ2());
+}
+
+/// \brief track parametrisation and impact parameter at the PV of a collision
+struct TrackAtPv {
+  o2::track::TrackParCov trackParCov;
+  o2::dataformats::DCA impactParameter;
+};
+
+/// \brief Cache of the HfTrackAtPv rows indexed by the track global index
+///
+/// The tracks have to be joined with aod::HfTrackAtPv. reset() has to be called at the beginning of each
+/// DataFrame with the size of the track table. Entries are invalidated by a generation counter, so that
+/// resetting does not touch the storage. An entry holds the track at the PV of the collision it was last
+/// asked for, only tracks asked for at a collision other than their own are propagated.
+class HfDaughterTrackCache
+{
+ public:
+  /// \brief invalidates all entries and makes room for nTracks tracks
+  void reset(std::size_t nTracks)
+  {
+    if (++mGeneration == 0) { // wrap-around, clear explicitly
+      mEntries.clear();
+      mGeneration = 1;
+    }
+    if (mEntries.size() < nTracks) {
+      mEntries.resize(nTracks);
+    }
+  }
+
+  /// \brief track parametrisation and impact parameter at the PV of the collision
+  /// \param collision collision with the PV, the track is propagated to it if it is not its own collision
+  template <typename T, typename C>
+  const TrackAtPv& getTrackAtPv(const T& track, const C& collision)
+  {
+    auto& entry = getEntry(track);
+    const int64_t collisionId = collision.globalIndex();
+    if (entry.collisionId != collisionId) {
+      if (entry.collisionId != track.collisionId()) {
+        fillFromTable(entry, track);
+      }
+      if (collisionId != track.collisionId()) { // not the collision of the track, propagate it from the PV of its own collision
+        o2::base::Propagator::Instance()->propagateToDCABxByBz(getPrimaryVertex(collision), entry.trackAtPv.trackParCov, 2.f, o2::base::Propagator::MatCorrType::USEMatCorrNONE, &entry.trackAtPv.impactParameter);
+        entry.collisionId = collisionId;
+        mNPropagations++;
+      }
+    }
+    return entry.trackAtPv;
+  }
+
+  /// \brief number of rows reused / read from the table and of propagations to other collisions since construction
+  uint64_t getNHits() const { return mNHits; }
+  uint64_t getNMisses() const { return mNMisses; }
+  uint64_t getNPropagations() const { return mNPropagations; }
+
+ private:
+  struct Entry {
+    TrackAtPv trackAtPv;
+    int64_t collisionId{-1}; // collision at whose PV the track is
+    uint32_t generation{0};
+  };
+
+  template <typename T>
+  void fillFromTable(Entry& entry, const T& track)
+  {
+    entry.trackAtPv.trackParCov = getTrackParCovAtPv(track);
+    entry.trackAtPv.impactParameter = getImpactParameterAtPv(track);
+    entry.collisionId = track.collisionId();
+  }
+
+  /// entry of the track, at the PV of its own collision when read for the first time in the DataFrame
+  template <typename T>
+  Entry& getEntry(const T& track)
+  {
+    auto& entry = mEntries[track.globalIndex()];
+    if (entry.generation != mGeneration) {
+      fillFromTable(entry, track);
+      entry.generation = mGeneration;
+      mNMisses++;
+    } else {
+      mNHits++;
+    }
+    return entry;
+  }
+
+  std::vector<Entry> mEntries;
+  uint32_t mGeneration{0};
+  uint64_t mNHits{0};
+  uint64_t mNMisses{0};
+  uint64_t mNPropagations{0};
+};
+
+} // namespace o2::hf_trkcandsel
+
+#endif // PWGHF_UTILS_UTILSTRACKCACHEHF_H_
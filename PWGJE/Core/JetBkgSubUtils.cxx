@@ -28,6 +28,9 @@
 #include <fastjet/contrib/ConstituentSubtractor.hh>
 #include <fastjet/tools/Subtractor.hh>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <tuple>
 #include <vector>
 
@@ -50,7 +53,11 @@ void JetBkgSubUtils::initialise()
 {
   // Note: recommended to use R=0.2
   jetDefBkg = fastjet::JetDefinition(algorithmBkg, jetBkgR, recombSchemeBkg, fastjet::Best);
-  areaDefBkg = fastjet::AreaDefinition(fastjet::active_area_explicit_ghosts, ghostAreaSpec);
+  if (rhoEstimator == BkgSubEstimator::medianRhoVoronoi) {
+    areaDefBkg = fastjet::AreaDefinition(fastjet::VoronoiAreaSpec());
+  } else {
+    areaDefBkg = fastjet::AreaDefinition(fastjet::active_area_explicit_ghosts, ghostAreaSpec);
+  }
   selRho = fastjet::SelectorRapRange(bkgEtaMin, bkgEtaMax) && fastjet::SelectorPhiRange(bkgPhiMin, bkgPhiMax) && !fastjet::SelectorNHardest(nHardReject); // here we have to put rap range, to be checked!
 }
 
@@ -69,29 +76,33 @@ std::tuple<double, double> JetBkgSubUtils::estimateRhoAreaMedian(const std::vect
   std::vector<fastjet::PseudoJet> alljets = selRho(clusterSeq.inclusive_jets());
 
   double totaljetAreaPhys(0), totalAreaCovered(0);
-  std::vector<double> rhovector;
-  std::vector<double> rhoMdvector;
+  rhoBuffer.clear();
+  rhoMBuffer.clear();
 
   // Fill a vector for pT/area to be used for the median
   for (auto& ijet : alljets) {
 
     // Physical area/ Physical jets (no ghost)
-    if (!clusterSeq.is_pure_ghost(ijet)) {
-      rhovector.push_back(ijet.perp() / ijet.area());
-      rhoMdvector.push_back(getMd(ijet) / ijet.area());
+    if (!clusterSeq.is_pure_ghost(ijet) && ijet.area() > 0) {
+      rhoBuffer.push_back(ijet.perp() / ijet.area());
+      rhoMBuffer.push_back(getMd(ijet) / ijet.area());
 
       totaljetAreaPhys += ijet.area();
     }
     // Full area
     totalAreaCovered += ijet.area();
   }
+  // Voronoi areas have no pure ghost jets, the empty area is the rest of the acceptance
+  if (rhoEstimator == BkgSubEstimator::medianRhoVoronoi) {
+    totalAreaCovered = (bkgEtaMax - bkgEtaMin) * std::min<double>(bkgPhiMax - bkgPhiMin, 2.0 * M_PI);
+  }
   // calculate Rho as the median of the jet pT / jet area
 
   double rho = 0.0;
   double rhoM = 0.0;
-  if (rhovector.size() != 0) {
-    rho = TMath::Median<double>(rhovector.size(), rhovector.data());
-    rhoM = TMath::Median<double>(rhoMdvector.size(), rhoMdvector.data());
+  if (rhoBuffer.size() != 0) {
+    rho = TMath::Median<double>(rhoBuffer.size(), rhoBuffer.data());
+    rhoM = TMath::Median<double>(rhoMBuffer.size(), rhoMBuffer.data());
   }
 
   if (doSparseSub) {
@@ -104,6 +115,146 @@ std::tuple<double, double> JetBkgSubUtils::estimateRhoAreaMedian(const std::vect
   return std::make_tuple(rho, rhoM);
 }
 
+void JetBkgSubUtils::setupGrid()
+{
+  // patch the acceptance in eta and phi, a phi range of 2pi or more is treated as full azimuth
+  gridFullPhi = (bkgPhiMax - bkgPhiMin) >= 2.0 * M_PI - 1e-3;
+  gridPhiMin = gridFullPhi ? 0.0 : bkgPhiMin;
+  gridPhiRange = gridFullPhi ? 2.0 * M_PI : bkgPhiMax - bkgPhiMin;
+  const double etaRange = bkgEtaMax - bkgEtaMin;
+  gridNEta = std::max(1, static_cast<int>(std::round(etaRange / gridSpacing)));
+  gridNPhi = std::max(1, static_cast<int>(std::round(gridPhiRange / gridSpacing)));
+  gridPatchEta = etaRange / gridNEta;
+  gridPatchPhi = gridPhiRange / gridNPhi;
+}
+
+int JetBkgSubUtils::getGridPatch(const fastjet::PseudoJet& particle) const
+{
+  const double rap = particle.rap();
+  if (rap < bkgEtaMin || rap >= bkgEtaMax) {
+    return -1;
+  }
+  // phi relative to the lower edge of the acceptance, in [0, 2pi) whatever the convention of bkgPhiMin
+  double phi = std::fmod(particle.phi() - gridPhiMin, 2.0 * M_PI);
+  if (phi < 0) {
+    phi += 2.0 * M_PI;
+  }
+  if (!gridFullPhi && phi >= gridPhiRange) {
+    return -1;
+  }
+  const int iEta = std::min(gridNEta - 1, static_cast<int>((rap - bkgEtaMin) / gridPatchEta));
+  const int iPhi = std::min(gridNPhi - 1, static_cast<int>(phi / gridPatchPhi));
+  return iEta * gridNPhi + iPhi;
+}
+
+void JetBkgSubUtils::fillGrid(const std::vector<fastjet::PseudoJet>& inputParticles, std::vector<double>& pt, std::vector<double>& md, std::vector<int>& n) const
+{
+  pt.assign(gridNEta * gridNPhi, 0.0);
+  md.assign(gridNEta * gridNPhi, 0.0);
+  n.assign(gridNEta * gridNPhi, 0);
+  for (const auto& particle : inputParticles) {
+    const int iPatch = getGridPatch(particle);
+    if (iPatch < 0) {
+      continue;
+    }
+    pt[iPatch] += particle.perp();
+    md[iPatch] += std::sqrt(particle.m2() + particle.perp2()) - particle.perp();
+    n[iPatch]++;
+  }
+}
+
+std::tuple<double, double> JetBkgSubUtils::medianOfGrid(bool doSparseSub)
+{
+  const auto median = [](std::vector<double>& values) {
+    const std::size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    if (values.size() % 2 == 1) {
+      return values[mid];
+    }
+    return 0.5 * (values[mid] + *std::max_element(values.begin(), values.begin() + mid));
+  };
+
+  double occupancyFactor = 1.0;
+  if (doSparseSub) {
+    // keep only the occupied patches and scale the median by their fraction of the acceptance
+    std::size_t nOccupied = 0;
+    for (std::size_t iPatch = 0; iPatch < gridPt.size(); iPatch++) {
+      if (gridN[iPatch] > 0) {
+        gridPt[nOccupied] = gridPt[iPatch];
+        gridMd[nOccupied] = gridMd[iPatch];
+        nOccupied++;
+      }
+    }
+    occupancyFactor = static_cast<double>(nOccupied) / gridPt.size();
+    gridPt.resize(nOccupied);
+    gridMd.resize(nOccupied);
+    if (nOccupied == 0) {
+      return std::make_tuple(0.0, 0.0);
+    }
+  }
+  // median over the patches, empty ones included unless sparse, as in fastjet::GridMedianBackgroundEstimator
+  const double patchArea = gridPatchEta * gridPatchPhi;
+  double rho = median(gridPt) / patchArea * occupancyFactor;
+  double rhoM = median(gridMd) / patchArea * occupancyFactor;
+
+  return std::make_tuple(rho, rhoM);
+}
+
+std::tuple<double, double> JetBkgSubUtils::estimateRhoGridMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub)
+{
+  if (inputParticles.size() == 0) {
+    return std::make_tuple(0.0, 0.0);
+  }
+  setupGrid();
+  fillGrid(inputParticles, gridPt, gridMd, gridN);
+  return medianOfGrid(doSparseSub);
+}
+
+void JetBkgSubUtils::fillEventGrid(const std::vector<fastjet::PseudoJet>& inputParticles)
+{
+  setupGrid();
+  fillGrid(inputParticles, gridEventPt, gridEventMd, gridEventN);
+  nEventGridParticles = inputParticles.size();
+}
+
+std::tuple<double, double> JetBkgSubUtils::estimateRhoGridMedianWithout(const std::vector<fastjet::PseudoJet>& excludedParticles, bool doSparseSub)
+{
+  if (nEventGridParticles <= excludedParticles.size()) {
+    return std::make_tuple(0.0, 0.0);
+  }
+  gridPt = gridEventPt;
+  gridMd = gridEventMd;
+  gridN = gridEventN;
+  for (const auto& particle : excludedParticles) {
+    const int iPatch = getGridPatch(particle);
+    if (iPatch < 0) {
+      continue;
+    }
+    gridPt[iPatch] -= particle.perp();
+    gridMd[iPatch] -= std::sqrt(particle.m2() + particle.perp2()) - particle.perp();
+    if (--gridN[iPatch] == 0) {
+      // no rounding left-over in the patches emptied by the exclusion
+      gridPt[iPatch] = 0.0;
+      gridMd[iPatch] = 0.0;
+    }
+  }
+  return medianOfGrid(doSparseSub);
+}
+
+std::tuple<double, double> JetBkgSubUtils::estimateRho(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub)
+{
+  switch (rhoEstimator) {
+    case BkgSubEstimator::none:
+      return std::make_tuple(0.0, 0.0);
+    case BkgSubEstimator::medianRhoSparse:
+      return estimateRhoAreaMedian(inputParticles, true);
+    case BkgSubEstimator::gridMedianRho:
+      return estimateRhoGridMedian(inputParticles, doSparseSub);
+    default: // medianRho and medianRhoVoronoi, the area definition is chosen in initialise()
+      return estimateRhoAreaMedian(inputParticles, doSparseSub);
+  }
+}
+
 fastjet::PseudoJet JetBkgSubUtils::doRhoAreaSub(const fastjet::PseudoJet& jet, double rhoParam, double rhoMParam)
 {
 
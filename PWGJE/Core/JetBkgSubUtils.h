@@ -23,6 +23,7 @@
 #include <fastjet/PseudoJet.hh>
 #include <fastjet/Selector.hh>
 
+#include <cstddef>
 #include <tuple>
 #include <vector>
 
@@ -30,7 +31,9 @@
 
 enum class BkgSubEstimator { none = 0,
                              medianRho = 1,
-                             medianRhoSparse = 2
+                             medianRhoSparse = 2,
+                             medianRhoVoronoi = 3, // kT jets with Voronoi areas, no ghosts
+                             gridMedianRho = 4     // median of fixed eta-phi patches, no clustering
                              // perpendicular cone method is in JetUtilities
 };
 
@@ -68,6 +71,31 @@ class JetBkgSubUtils
   /// @return Rho, RhoM the underlying event density
   std::tuple<double, double> estimateRhoAreaMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub);
 
+  /// @brief Method for estimating the jet background density as the median pT/area of fixed eta-phi patches
+  /// @param inputParticles (all particles in the event)
+  /// @param doSparseSub weather to scale rho by the fraction of occupied patches
+  /// @return Rho, RhoM the underlying event density
+  std::tuple<double, double> estimateRhoGridMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub);
+
+  /// @brief Fills the eta-phi patches of the grid median estimator with all the particles of an event, to be
+  ///        followed by estimateRhoGridMedianWithout for each set of particles to be left out (e.g. the
+  ///        daughters of each candidate), so that the event is patched once for all the candidates
+  /// @param inputParticles (all particles in the event)
+  void fillEventGrid(const std::vector<fastjet::PseudoJet>& inputParticles);
+
+  /// @brief Grid median estimate for the particles given to fillEventGrid without the excluded ones, equal to
+  ///        estimateRhoGridMedian of the remaining particles up to the rounding of the patch sums
+  /// @param excludedParticles particles of the event to be left out, each at most once
+  /// @param doSparseSub weather to scale rho by the fraction of occupied patches
+  /// @return Rho, RhoM the underlying event density
+  std::tuple<double, double> estimateRhoGridMedianWithout(const std::vector<fastjet::PseudoJet>& excludedParticles, bool doSparseSub);
+
+  /// @brief Method for estimating the jet background density with the estimator chosen with setRhoEstimator
+  /// @param inputParticles (all particles in the event)
+  /// @param doSparseSub weather to do rho sparse subtraction
+  /// @return Rho, RhoM the underlying event density
+  std::tuple<double, double> estimateRho(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub);
+
   /// @brief method that subtracts the background from jets using the area method
   /// @param jet input jet to be background subtracted
   /// @param rhoParam the underlying evvent density vs pT (to be set)
@@ -112,6 +140,8 @@ class JetBkgSubUtils
   void setJetDefinition(fastjet::JetDefinition jetdefbkg_out) { jetDefBkg = jetdefbkg_out; }
   void setAreaDefinition(fastjet::AreaDefinition areaDefBkg_out) { areaDefBkg = areaDefBkg_out; }
   void setRhoSelector(fastjet::Selector selRho_out) { selRho = selRho_out; }
+  void setRhoEstimator(BkgSubEstimator rhoEstimator_out) { rhoEstimator = rhoEstimator_out; }
+  void setGridSpacing(float gridSpacing_out) { gridSpacing = gridSpacing_out; }
 
   // Getters
   float getJetBkgR() const { return jetBkgR; }
@@ -127,6 +157,8 @@ class JetBkgSubUtils
   fastjet::JetDefinition getJetDefinition() const { return jetDefBkg; }
   fastjet::AreaDefinition getAreaDefinition() const { return areaDefBkg; }
   fastjet::Selector getRhoSelector() const { return selRho; }
+  BkgSubEstimator getRhoEstimator() const { return rhoEstimator; }
+  float getGridSpacing() const { return gridSpacing; }
 
   // Calculate the jet mass
   double getMd(fastjet::PseudoJet jet) const;
@@ -142,6 +174,8 @@ class JetBkgSubUtils
   float maxEtaEvent = 0.9;
   int nHardReject = 2;
   bool doRhoMassSub = false; /// flag whether to do jet mass subtraction with the const sub
+  float gridSpacing = 0.2;   /// patch size in eta and phi for the grid median estimator
+  BkgSubEstimator rhoEstimator = BkgSubEstimator::medianRho;
 
   fastjet::GhostedAreaSpec ghostAreaSpec = fastjet::GhostedAreaSpec();
   fastjet::JetAlgorithm algorithmBkg = fastjet::kt_algorithm;
@@ -150,6 +184,33 @@ class JetBkgSubUtils
   fastjet::AreaDefinition areaDefBkg = fastjet::AreaDefinition(fastjet::active_area_explicit_ghosts, ghostAreaSpec);
   fastjet::Selector selRho = fastjet::Selector();
 
+  void setupGrid();
+  int getGridPatch(const fastjet::PseudoJet& particle) const;
+  void fillGrid(const std::vector<fastjet::PseudoJet>& inputParticles, std::vector<double>& pt, std::vector<double>& md, std::vector<int>& n) const;
+  std::tuple<double, double> medianOfGrid(bool doSparseSub);
+
+  // buffers reused across events by the median estimators
+  std::vector<double> rhoBuffer;  //!
+  std::vector<double> rhoMBuffer; //!
+  std::vector<double> gridPt;     //!
+  std::vector<double> gridMd;     //!
+  std::vector<int> gridN;         //!
+
+  // patches of the grid median estimator, set by setupGrid
+  bool gridFullPhi = true;
+  double gridPhiMin = 0.0;
+  double gridPhiRange = 2.0 * M_PI;
+  int gridNEta = 1;
+  int gridNPhi = 1;
+  double gridPatchEta = 1.0;
+  double gridPatchPhi = 1.0;
+
+  // patches of the whole event, see fillEventGrid
+  std::vector<double> gridEventPt; //!
+  std::vector<double> gridEventMd; //!
+  std::vector<int> gridEventN;     //!
+  std::size_t nEventGridParticles = 0;
+
 }; // class JetBkgSubUtils
 
 #endif // PWGJE_CORE_JETBKGSUBUTILS_H_
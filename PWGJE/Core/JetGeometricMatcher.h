@@ -0,0 +1,246 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file JetGeometricMatcher.h
+/// \brief Allocation-free batched geometrical jet matcher
+///
+/// Replacement for the per-collision TKDTree based matching in JetMatchingUtilities.h.
+/// All jet radii of one collision are matched in a single call, phi periodicity is handled
+/// in the distance computation instead of by duplicating jets, and the index storage is kept
+/// between calls so that no allocation happens once the buffers have grown to the largest event.
+
+#ifndef PWGJE_CORE_JETGEOMETRICMATCHER_H_
+#define PWGJE_CORE_JETGEOMETRICMATCHER_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <vector>
+
+namespace jetmatchingutilities
+{
+
+/**
+ * Batched geometrical jet matcher.
+ *
+ * Usage per collision:
+ *   matcher.clear();
+ *   matcher.addBase(eta, phi, rKey, id); ... matcher.addTag(eta, phi, rKey, id); ...
+ *   matcher.match(maxMatchingDistance);
+ *   matcher.baseToTag(iBase) / matcher.tagToBase(iTag)
+ *
+ * Jets are only compared with jets of the same radius key. As in MatchJetsGeometrically, a match
+ * requires the base and tag jets to be the closest to each other (base <-> tag) with a distance
+ * below the maximum matching distance. The results are stored as CSR (offsets + flat ids) in the
+ * order in which the jets were added, with the ids passed to addBase/addTag as payload.
+ */
+class GeometricMatcher
+{
+ public:
+  void reserve(std::size_t nJetsBase, std::size_t nJetsTag)
+  {
+    mBase.reserve(nJetsBase);
+    mTag.reserve(nJetsTag);
+  }
+
+  /// removes all jets and results, keeping the allocated storage
+  void clear()
+  {
+    mBase.clear();
+    mTag.clear();
+    mBaseToTagOffsets.clear();
+    mBaseToTagIds.clear();
+    mTagToBaseOffsets.clear();
+    mTagToBaseIds.clear();
+  }
+
+  /// adds a base jet, returns its local index
+  std::size_t addBase(float eta, float phi, int rKey, int id)
+  {
+    mBase.push_back({eta, wrapPhi(phi), rKey, id});
+    return mBase.size() - 1;
+  }
+
+  /// adds a tag jet, returns its local index
+  std::size_t addTag(float eta, float phi, int rKey, int id)
+  {
+    mTag.push_back({eta, wrapPhi(phi), rKey, id});
+    return mTag.size() - 1;
+  }
+
+  /**
+   * Matches all base and tag jets added since the last clear(), for all radii at once.
+   *
+   * @param maxMatchingDistance Maximum matching distance in (eta, phi).
+   */
+  void match(float maxMatchingDistance)
+  {
+    const std::size_t nBase = mBase.size();
+    const std::size_t nTag = mTag.size();
+    mClosestTag.assign(nBase, -1);
+    mClosestBase.assign(nTag, -1);
+
+    if (nBase > 0 && nTag > 0) {
+      sortByRadiusAndEta(mBase, mBaseOrder, mBaseSortedEta);
+      sortByRadiusAndEta(mTag, mTagOrder, mTagSortedEta);
+      findClosest(mBase, mTag, mTagOrder, mTagSortedEta, maxMatchingDistance, mClosestTag);
+      findClosest(mTag, mBase, mBaseOrder, mBaseSortedEta, maxMatchingDistance, mClosestBase);
+    }
+
+    // only mutual closest pairs are kept; at most one match per jet, stored in CSR layout
+    mBaseToTagOffsets.resize(nBase + 1);
+    mTagToBaseOffsets.resize(nTag + 1);
+    mBaseToTagIds.clear();
+    mTagToBaseIds.clear();
+    mBaseToTagOffsets[0] = 0;
+    for (std::size_t iBase = 0; iBase < nBase; iBase++) {
+      const int iTag = mClosestTag[iBase];
+      if (iTag >= 0 && mClosestBase[iTag] == static_cast<int>(iBase)) {
+        mBaseToTagIds.push_back(mTag[iTag].id);
+      } else {
+        mClosestTag[iBase] = -1;
+      }
+      mBaseToTagOffsets[iBase + 1] = mBaseToTagIds.size();
+    }
+    mTagToBaseOffsets[0] = 0;
+    for (std::size_t iTag = 0; iTag < nTag; iTag++) {
+      const int iBase = mClosestBase[iTag];
+      if (iBase >= 0 && mClosestTag[iBase] == static_cast<int>(iTag)) {
+        mTagToBaseIds.push_back(mBase[iBase].id);
+      }
+      mTagToBaseOffsets[iTag + 1] = mTagToBaseIds.size();
+    }
+  }
+
+  std::size_t nBase() const { return mBase.size(); }
+  std::size_t nTag() const { return mTag.size(); }
+
+  /// ids of the tag jets matched to base jet iBase (local index)
+  std::span<const int> baseToTag(std::size_t iBase) const
+  {
+    return {mBaseToTagIds.data() + mBaseToTagOffsets[iBase], mBaseToTagIds.data() + mBaseToTagOffsets[iBase + 1]};
+  }
+
+  /// ids of the base jets matched to tag jet iTag (local index)
+  std::span<const int> tagToBase(std::size_t iTag) const
+  {
+    return {mTagToBaseIds.data() + mTagToBaseOffsets[iTag], mTagToBaseIds.data() + mTagToBaseOffsets[iTag + 1]};
+  }
+
+  /// local index of the uniquely matched tag jet for base jet iBase, -1 if none
+  int baseToTagIndex(std::size_t iBase) const { return mClosestTag[iBase]; }
+
+  /// local index of the uniquely matched base jet for tag jet iTag, -1 if none
+  int tagToBaseIndex(std::size_t iTag) const
+  {
+    const int iBase = mClosestBase[iTag];
+    return (iBase >= 0 && mClosestTag[iBase] == static_cast<int>(iTag)) ? iBase : -1;
+  }
+
+  const std::vector<std::size_t>& baseToTagOffsets() const { return mBaseToTagOffsets; }
+  const std::vector<int>& baseToTagIds() const { return mBaseToTagIds; }
+  const std::vector<std::size_t>& tagToBaseOffsets() const { return mTagToBaseOffsets; }
+  const std::vector<int>& tagToBaseIds() const { return mTagToBaseIds; }
+
+ private:
+  struct JetPoint {
+    float eta;
+    float phi;
+    int rKey;
+    int id;
+  };
+
+  static constexpr float TwoPi = 2.f * static_cast<float>(M_PI);
+
+  static float wrapPhi(float phi)
+  {
+    if (phi < 0.f || phi >= TwoPi) {
+      phi -= TwoPi * std::floor(phi / TwoPi);
+    }
+    return phi;
+  }
+
+  /// orders the jets by (radius key, eta) and caches the sorted eta values for the window search
+  static void sortByRadiusAndEta(const std::vector<JetPoint>& jets, std::vector<int>& order, std::vector<float>& sortedEta)
+  {
+    order.resize(jets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&jets](int a, int b) {
+      if (jets[a].rKey != jets[b].rKey) {
+        return jets[a].rKey < jets[b].rKey;
+      }
+      return jets[a].eta < jets[b].eta;
+    });
+    sortedEta.resize(jets.size());
+    for (std::size_t i = 0; i < order.size(); i++) {
+      sortedEta[i] = jets[order[i]].eta;
+    }
+  }
+
+  /// for every query jet, finds the closest jet of the same radius among the candidates within maxDistance
+  static void findClosest(const std::vector<JetPoint>& queries, const std::vector<JetPoint>& candidates, const std::vector<int>& candidateOrder, const std::vector<float>& candidateSortedEta, float maxDistance, std::vector<int>& closest)
+  {
+    const float maxDistance2 = maxDistance * maxDistance;
+    // radius groups are contiguous in candidateOrder; locate the group once per query radius
+    std::size_t groupBegin = 0, groupEnd = 0;
+    int groupRKey = std::numeric_limits<int>::min();
+    for (std::size_t iQuery = 0; iQuery < queries.size(); iQuery++) {
+      const JetPoint& query = queries[iQuery];
+      if (query.rKey != groupRKey) {
+        groupRKey = query.rKey;
+        auto indexLess = [&candidates](int index, int rKey) { return candidates[index].rKey < rKey; };
+        auto rKeyLess = [&candidates](int rKey, int index) { return rKey < candidates[index].rKey; };
+        groupBegin = std::lower_bound(candidateOrder.begin(), candidateOrder.end(), groupRKey, indexLess) - candidateOrder.begin();
+        groupEnd = std::upper_bound(candidateOrder.begin() + groupBegin, candidateOrder.end(), groupRKey, rKeyLess) - candidateOrder.begin();
+      }
+      if (groupBegin == groupEnd) {
+        continue;
+      }
+      std::size_t iCandidate = std::lower_bound(candidateSortedEta.begin() + groupBegin, candidateSortedEta.begin() + groupEnd, query.eta - maxDistance) - candidateSortedEta.begin();
+      float bestDistance2 = maxDistance2;
+      int best = -1;
+      for (; iCandidate < groupEnd && candidateSortedEta[iCandidate] <= query.eta + maxDistance; iCandidate++) {
+        const JetPoint& candidate = candidates[candidateOrder[iCandidate]];
+        const float dEta = candidate.eta - query.eta;
+        float dPhi = std::fabs(candidate.phi - query.phi);
+        if (dPhi > static_cast<float>(M_PI)) {
+          dPhi = TwoPi - dPhi;
+        }
+        const float distance2 = dEta * dEta + dPhi * dPhi;
+        if (distance2 < bestDistance2) {
+          bestDistance2 = distance2;
+          best = candidateOrder[iCandidate];
+        }
+      }
+      closest[iQuery] = best;
+    }
+  }
+
+  std::vector<JetPoint> mBase;
+  std::vector<JetPoint> mTag;
+  std::vector<int> mBaseOrder;
+  std::vector<int> mTagOrder;
+  std::vector<float> mBaseSortedEta;
+  std::vector<float> mTagSortedEta;
+  std::vector<int> mClosestTag;
+  std::vector<int> mClosestBase;
+  std::vector<std::size_t> mBaseToTagOffsets;
+  std::vector<int> mBaseToTagIds;
+  std::vector<std::size_t> mTagToBaseOffsets;
+  std::vector<int> mTagToBaseIds;
+};
+
+} // namespace jetmatchingutilities
+
+#endif // PWGJE_CORE_JETGEOMETRICMATCHER_H_
@@ -22,6 +22,7 @@
 
 #include "PWGJE/Core/JetCandidateUtilities.h"
 #include "PWGJE/Core/JetFindingUtilities.h"
+#include "PWGJE/Core/JetGeometricMatcher.h"
 #include "PWGJE/DataModel/JetReducedData.h"
 
 #include <Framework/Logger.h>
@@ -292,6 +293,38 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometrically(
   return std::make_tuple(baseToTagMap, tagToBaseMap);
 }
 
+/**
+ * Geometrical matching of all jet radii of one collision with a reusable GeometricMatcher.
+ *
+ * Equivalent to MatchGeo, but without the per-radius KD-tree builds and phi duplication. The matcher
+ * should be owned by the calling task so that its storage is reused across collisions.
+ */
+template <typename T, typename U>
+void MatchGeo(GeometricMatcher& matcher, T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingGeo, std::vector<std::vector<int>>& tagToBaseMatchingGeo, float maxMatchingDistance)
+{
+  matcher.clear();
+  matcher.reserve(jetsBasePerCollision.size(), jetsTagPerCollision.size());
+  for (const auto& jetBase : jetsBasePerCollision) {
+    matcher.addBase(jetBase.eta(), jetBase.phi(), std::round(jetBase.r()), jetBase.globalIndex());
+  }
+  for (const auto& jetTag : jetsTagPerCollision) {
+    matcher.addTag(jetTag.eta(), jetTag.phi(), std::round(jetTag.r()), jetTag.globalIndex());
+  }
+  matcher.match(maxMatchingDistance);
+  std::size_t jetBaseIndex = 0;
+  for (const auto& jetBase : jetsBasePerCollision) {
+    for (auto jetTagGlobalIndex : matcher.baseToTag(jetBaseIndex++)) {
+      baseToTagMatchingGeo[jetBase.globalIndex()].push_back(jetTagGlobalIndex);
+    }
+  }
+  std::size_t jetTagIndex = 0;
+  for (const auto& jetTag : jetsTagPerCollision) {
+    for (auto jetBaseGlobalIndex : matcher.tagToBase(jetTagIndex++)) {
+      tagToBaseMatchingGeo[jetTag.globalIndex()].push_back(jetBaseGlobalIndex);
+    }
+  }
+}
+
 template <typename T, typename U>
 void MatchGeo(T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingGeo, std::vector<std::vector<int>>& tagToBaseMatchingGeo, float maxMatchingDistance)
 {
@@ -576,6 +609,17 @@ void doAllMatching(T const& jetsBasePerCollision, U const& jetsTagPerCollision,
   }
 }
 
+// function that calls all the Match functions, with the geometric matching done by a reusable matcher
+template <bool jetsBaseIsMc, bool jetsTagIsMc, typename T, typename U, typename V, typename M, typename N, typename O, typename P, typename R>
+void doAllMatching(GeometricMatcher& matcher, T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingGeo, std::vector<std::vector<int>>& baseToTagMatchingPt, std::vector<std::vector<int>>& baseToTagMatchingHF, std::vector<std::vector<int>>& tagToBaseMatchingGeo, std::vector<std::vector<int>>& tagToBaseMatchingPt, std::vector<std::vector<int>>& tagToBaseMatchingHF, V const& candidatesBase, M const& tracksBase, N const& clustersBase, O const& candidatesTag, P const& tracksTag, R const& clustersTag, bool doMatchingGeo, bool doMatchingHf, bool doMatchingPt, float maxMatchingDistance, float minPtFraction)
+{
+  // geometric matching
+  if (doMatchingGeo) {
+    MatchGeo(matcher, jetsBasePerCollision, jetsTagPerCollision, baseToTagMatchingGeo, tagToBaseMatchingGeo, maxMatchingDistance);
+  }
+  doAllMatching<jetsBaseIsMc, jetsTagIsMc>(jetsBasePerCollision, jetsTagPerCollision, baseToTagMatchingGeo, baseToTagMatchingPt, baseToTagMatchingHF, tagToBaseMatchingGeo, tagToBaseMatchingPt, tagToBaseMatchingHF, candidatesBase, tracksBase, clustersBase, candidatesTag, tracksTag, clustersTag, false, doMatchingHf, doMatchingPt, maxMatchingDistance, minPtFraction);
+}
+
 // function that does pair matching
 template <bool jetsBaseIsMc, bool jetsTagIsMc, typename T, typename U, typename V, typename M, typename N, typename O>
 void doPairMatching(T const& pairsBase, U const& pairsTag, std::vector<std::vector<int>>& baseToTagMatching, std::vector<std::vector<int>>& tagToBaseMatching, V const& /*candidatesBase*/, M const& tracksBase, N const& /*candidatesTag*/, O const& tracksTag)
@@ -13,7 +13,9 @@
 //
 /// \author Nima Zardoshti <nima.zardoshti@cern.ch>
 
+#include "PWGJE/Core/FastJetUtilities.h"
 #include "PWGJE/Core/JetBkgSubUtils.h"
+#include "PWGJE/Core/JetCandidateUtilities.h"
 #include "PWGJE/Core/JetDerivedDataUtilities.h"
 #include "PWGJE/Core/JetFindingUtilities.h"
 #include "PWGJE/DataModel/Jet.h"
@@ -32,6 +34,8 @@
 #include <fastjet/JetDefinition.hh>
 #include <fastjet/PseudoJet.hh>
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -89,6 +93,9 @@ struct RhoEstimatorTask {
     Configurable<float> bkgPhiMin{"bkgPhiMin", -6.283, "minimim phi for determining background density"};
     Configurable<float> bkgPhiMax{"bkgPhiMax", 6.283, "maximum phi for determining background density"};
     Configurable<bool> doSparse{"doSparse", false, "perfom sparse estimation"};
+    Configurable<int> bkgEstimator{"bkgEstimator", 1, "rho estimator. 1 = kT jets with ghosted areas, 2 = sparse kT jets with ghosted areas, 3 = kT jets with Voronoi areas (no ghosts), 4 = median of eta-phi patches (no clustering)"};
+    Configurable<float> bkgGridSpacing{"bkgGridSpacing", 0.2, "patch size in eta and phi for the patch median estimator"};
+    Configurable<bool> gridOncePerCollision{"gridOncePerCollision", false, "with the patch median estimator, patch the tracks of a collision once and leave out the daughters of each candidate from the patches, instead of estimating rho from the tracks for each candidate"};
     Configurable<double> ghostRapMax{"ghostRapMax", 0.9, "Ghost rapidity max"};
     Configurable<int> ghostRepeat{"ghostRepeat", 1, "Ghost tiling repeats"};
     Configurable<double> ghostArea{"ghostArea", 0.005, "Area per ghost"};
@@ -115,6 +122,8 @@ struct RhoEstimatorTask {
   float bkgPhiMax_;
   float bkgPhiMin_;
   std::vector<fastjet::PseudoJet> inputParticles;
+  std::vector<fastjet::PseudoJet> excludedParticles;
+  std::vector<int> inputParticlePositions; // position in inputParticles of each track, -1 if not selected
   int trackSelection = -1;
   std::string particleSelection;
 
@@ -140,6 +149,11 @@ struct RhoEstimatorTask {
       bkgPhiMin_ = -2.0 * M_PI;
     }
     bkgSub.setPhiMinMax(bkgPhiMin_, bkgPhiMax_);
+    bkgSub.setRhoEstimator(static_cast<BkgSubEstimator>(static_cast<int>(config.bkgEstimator)));
+    bkgSub.setGridSpacing(config.bkgGridSpacing);
+    if (config.gridOncePerCollision && static_cast<BkgSubEstimator>(static_cast<int>(config.bkgEstimator)) != BkgSubEstimator::gridMedianRho) {
+      LOGP(fatal, "rhoEstimator workflow: gridOncePerCollision requires the patch median estimator (bkgEstimator 4)");
+    }
 
     fastjet::GhostedAreaSpec ghostAreaSpec(config.ghostRapMax, config.ghostRepeat, config.ghostArea,
                                            config.ghostGridScatter, config.ghostKtScatter, config.ghostMeanPt);
@@ -216,6 +230,42 @@ struct RhoEstimatorTask {
   PROCESS_SWITCH_FULL(RhoEstimatorTask, processSelectionObjects<aod::JClusters>, processSelectingClusters, "process EMCal clusters", false);
   PROCESS_SWITCH_FULL(RhoEstimatorTask, processSelectionObjects<aod::JTracks>, processSelectingTracks, "process high pt tracks", false);
 
+  // rho of all the candidates of a collision from one patching of its tracks, the daughters of each candidate
+  // being left out of the patches as analyseTracks leaves them out of the input particles
+  template <typename T, typename U, typename V, typename W>
+  void fillCandidateRhosFromEventGrid(T const& collision, U const& tracks, V const& candidates, W& rhoTable)
+  {
+    if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
+      for (int64_t iCandidate = 0; iCandidate < candidates.size(); iCandidate++) {
+        rhoTable(0.0, 0.0);
+      }
+      return;
+    }
+    inputParticles.clear();
+    inputParticlePositions.clear();
+    for (auto const& track : tracks) {
+      if (jetfindingutilities::isTrackSelected<std::decay_t<decltype(track)>, typename V::iterator>(track, trackSelection, config.applyTrackingEfficiency, config.trackingEfficiency, config.trackingEfficiencyPtBinning)) {
+        inputParticlePositions.push_back(inputParticles.size());
+        fastjetutilities::fillTracks(track, inputParticles, track.globalIndex());
+      } else {
+        inputParticlePositions.push_back(-1);
+      }
+    }
+    bkgSub.fillEventGrid(inputParticles);
+    for (auto const& candidate : candidates) {
+      excludedParticles.clear();
+      std::size_t iTrack = 0;
+      for (auto const& track : tracks) {
+        if (inputParticlePositions[iTrack] >= 0 && jetcandidateutilities::isDaughterTrack(track, candidate)) {
+          excludedParticles.push_back(inputParticles[inputParticlePositions[iTrack]]);
+        }
+        iTrack++;
+      }
+      auto [rho, rhoM] = bkgSub.estimateRhoGridMedianWithout(excludedParticles, config.doSparse);
+      rhoTable(rho, rhoM);
+    }
+  }
+
   void processChargedCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks)
   {
     if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
@@ -232,7 +282,7 @@ struct RhoEstimatorTask {
     }
     inputParticles.clear();
     jetfindingutilities::analyseTracks<soa::Filtered<aod::JetTracks>, soa::Filtered<aod::JetTracks>::iterator>(inputParticles, tracks, trackSelection, config.applyTrackingEfficiency, config.trackingEfficiency, config.trackingEfficiencyPtBinning);
-    auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+    auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
     rhoChargedTable(rho, rhoM);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processChargedCollisions, "Fill rho tables for collisions using charged tracks", true);
@@ -245,13 +295,17 @@ struct RhoEstimatorTask {
     }
     inputParticles.clear();
     jetfindingutilities::analyseParticles<false, soa::Filtered<aod::JetParticles>, soa::Filtered<aod::JetParticles>::iterator>(inputParticles, particleSelection, 1, particles, pdgDatabase);
-    auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+    auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
     rhoChargedMcTable(rho, rhoM);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processChargedMcCollisions, "Fill rho tables for MC collisions using charged tracks", false);
 
   void processD0Collisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesD0Data const& candidates)
   {
+    if (config.gridOncePerCollision) {
+      fillCandidateRhosFromEventGrid(collision, tracks, candidates, rhoD0Table);
+      return;
+    }
     for (auto& candidate : candidates) {
       if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
         rhoD0Table(0.0, 0.0);
@@ -260,7 +314,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, config.applyTrackingEfficiency, config.trackingEfficiency, config.trackingEfficiencyPtBinning, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoD0Table(rho, rhoM);
     }
   }
@@ -272,7 +326,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoD0McTable(rho, rhoM);
     }
   }
@@ -280,6 +334,10 @@ struct RhoEstimatorTask {
 
   void processDplusCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesDplusData const& candidates)
   {
+    if (config.gridOncePerCollision) {
+      fillCandidateRhosFromEventGrid(collision, tracks, candidates, rhoDplusTable);
+      return;
+    }
     for (auto& candidate : candidates) {
       if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
         rhoDplusTable(0.0, 0.0);
@@ -288,7 +346,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, config.applyTrackingEfficiency, config.trackingEfficiency, config.trackingEfficiencyPtBinning, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoDplusTable(rho, rhoM);
     }
   }
@@ -300,7 +358,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoDplusMcTable(rho, rhoM);
     }
   }
@@ -308,6 +366,10 @@ struct RhoEstimatorTask {
 
   void processDsCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesDsData const& candidates)
   {
+    if (config.gridOncePerCollision) {
+      fillCandidateRhosFromEventGrid(collision, tracks, candidates, rhoDsTable);
+      return;
+    }
     for (auto& candidate : candidates) {
       if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
         rhoDsTable(0.0, 0.0);
@@ -316,7 +378,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, config.applyTrackingEfficiency, config.trackingEfficiency, config.trackingEfficiencyPtBinning, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoDsTable(rho, rhoM);
     }
   }
@@ -328,7 +390,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoDsMcTable(rho, rhoM);
     }
   }
@@ -336,6 +398,10 @@ struct RhoEstimatorTask {
 
   void processDstarCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesDstarData const& candidates)
   {
+    if (config.gridOncePerCollision) {
+      fillCandidateRhosFromEventGrid(collision, tracks, candidates, rhoDstarTable);
+      return;
+    }
     for (auto& candidate : candidates) {
       if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
         rhoDstarTable(0.0, 0.0);
@@ -344,7 +410,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, config.applyTrackingEfficiency, config.trackingEfficiency, config.trackingEfficiencyPtBinning, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoDstarTable(rho, rhoM);
     }
   }
@@ -356,7 +422,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoDstarMcTable(rho, rhoM);
     }
   }
@@ -364,6 +430,10 @@ struct RhoEstimatorTask {
 
   void processLcCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesLcData const& candidates)
   {
+    if (config.gridOncePerCollision) {
+      fillCandidateRhosFromEventGrid(collision, tracks, candidates, rhoLcTable);
+      return;
+    }
     for (auto& candidate : candidates) {
       if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
         rhoLcTable(0.0, 0.0);
@@ -372,7 +442,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, config.applyTrackingEfficiency, config.trackingEfficiency, config.trackingEfficiencyPtBinning, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoLcTable(rho, rhoM);
     }
   }
@@ -384,7 +454,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoLcMcTable(rho, rhoM);
     }
   }
@@ -392,6 +462,10 @@ struct RhoEstimatorTask {
 
   void processB0Collisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesB0Data const& candidates)
   {
+    if (config.gridOncePerCollision) {
+      fillCandidateRhosFromEventGrid(collision, tracks, candidates, rhoB0Table);
+      return;
+    }
     for (auto& candidate : candidates) {
       if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
         rhoB0Table(0.0, 0.0);
@@ -400,7 +474,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, config.applyTrackingEfficiency, config.trackingEfficiency, config.trackingEfficiencyPtBinning, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoB0Table(rho, rhoM);
     }
   }
@@ -412,7 +486,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoB0McTable(rho, rhoM);
     }
   }
@@ -420,6 +494,10 @@ struct RhoEstimatorTask {
 
   void processBplusCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesBplusData const& candidates)
   {
+    if (config.gridOncePerCollision) {
+      fillCandidateRhosFromEventGrid(collision, tracks, candidates, rhoBplusTable);
+      return;
+    }
     for (auto& candidate : candidates) {
       if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
         rhoBplusTable(0.0, 0.0);
@@ -428,7 +506,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, config.applyTrackingEfficiency, config.trackingEfficiency, config.trackingEfficiencyPtBinning, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoBplusTable(rho, rhoM);
     }
   }
@@ -440,7 +518,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoBplusMcTable(rho, rhoM);
     }
   }
@@ -448,6 +526,10 @@ struct RhoEstimatorTask {
 
   void processXicToXiPiPiCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesXicToXiPiPiData const& candidates)
   {
+    if (config.gridOncePerCollision) {
+      fillCandidateRhosFromEventGrid(collision, tracks, candidates, rhoXicToXiPiPiTable);
+      return;
+    }
     for (auto& candidate : candidates) {
       if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
         rhoXicToXiPiPiTable(0.0, 0.0);
@@ -456,7 +538,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, config.applyTrackingEfficiency, config.trackingEfficiency, config.trackingEfficiencyPtBinning, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoXicToXiPiPiTable(rho, rhoM);
     }
   }
@@ -468,7 +550,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoXicToXiPiPiMcTable(rho, rhoM);
     }
   }
@@ -476,6 +558,10 @@ struct RhoEstimatorTask {
 
   void processDielectronCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesDielectronData const& candidates)
   {
+    if (config.gridOncePerCollision) {
+      fillCandidateRhosFromEventGrid(collision, tracks, candidates, rhoDielectronTable);
+      return;
+    }
     for (auto& candidate : candidates) {
       if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
         rhoDielectronTable(0.0, 0.0);
@@ -484,7 +570,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, config.applyTrackingEfficiency, config.trackingEfficiency, config.trackingEfficiencyPtBinning, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoDielectronTable(rho, rhoM);
     }
   }
@@ -496,7 +582,7 @@ struct RhoEstimatorTask {
       inputParticles.clear();
       jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+      auto [rho, rhoM] = bkgSub.estimateRho(inputParticles, config.doSparse);
       rhoDielectronMcTable(rho, rhoM);
     }
   }
@@ -58,6 +58,7 @@ std::shared_ptr<TH2> h2ClsMapPtDaug;
 std::shared_ptr<TH2> h2DeDxDaugSel;
 std::shared_ptr<TH2> h2KinkAnglePt;
 std::shared_ptr<TH2> h2MothMassPt;
+std::shared_ptr<TH1> hSVPoolCheck;
 } // namespace
 
 struct kinkCandidate {
@@ -127,6 +128,10 @@ struct kinkBuilder {
   Configurable<float> customVertexerTimeMargin{"customVertexerTimeMargin", 800, "Time margin for custom vertexer (ns)"};
   Configurable<bool> skipAmbiTracks{"skipAmbiTracks", false, "Skip ambiguous tracks"};
   Configurable<bool> unlikeSignBkg{"unlikeSignBkg", false, "Use unlike sign background"};
+  Configurable<float> maxDeltaEtaMothDaug{"maxDeltaEtaMothDaug", -1.f, "Max |delta eta| between mother and daughter before the kink fit, <= 0: no cut"};
+  Configurable<float> maxDeltaPhiMothDaug{"maxDeltaPhiMothDaug", -1.f, "Max |delta phi| between mother and daughter before the kink fit, <= 0: no cut"};
+  Configurable<bool> useSweepLinePool{"useSweepLinePool", false, "Build the mother-daughter pool with the sweep over the collision brackets instead of the bracket scan"};
+  Configurable<bool> checkSweepLinePool{"checkSweepLinePool", false, "Build the mother-daughter pool with both methods and fill hSVPoolCheck with the differences"};
 
   // CCDB options
   Configurable<std::string> ccdbPath{"ccdbPath", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
@@ -195,6 +200,8 @@ struct kinkBuilder {
     if (skipAmbiTracks) {
       svCreator.setSkipAmbiTracks();
     }
+    svCreator.setMaxDeltaEtaPhi(maxDeltaEtaMothDaug, maxDeltaPhiMothDaug);
+    svCreator.setUseSweepLine(useSweepLinePool);
 
     const AxisSpec itsClusterMapAxis(128, 0, 127, "ITS cluster map");
     const AxisSpec rigidityAxis{rigidityBins, "#it{p}^{TPC}/#it{z}"};
@@ -216,6 +223,13 @@ struct kinkBuilder {
     h2MothMassPt = qaRegistry.add<TH2>("h2MothMassPt", "; p_{T} (GeV/#it{c}); m (GeV/#it{c}^{2})", HistType::kTH2F, {ptAxis, massAxis});
     h2ClsMapPtMoth = qaRegistry.add<TH2>("h2ClsMapPtMoth", "; p_{T} (GeV/#it{c}); ITS cluster map", HistType::kTH2F, {ptAxis, itsClusterMapAxis});
     h2ClsMapPtDaug = qaRegistry.add<TH2>("h2ClsMapPtDaug", "; p_{T} (GeV/#it{c}); ITS cluster map", HistType::kTH2F, {ptAxis, itsClusterMapAxis});
+    if (checkSweepLinePool) {
+      hSVPoolCheck = qaRegistry.add<TH1>("hSVPoolCheck", ";; pairs", HistType::kTH1D, {{4, -0.5, 3.5}});
+      hSVPoolCheck->GetXaxis()->SetBinLabel(1, "bracket scan");
+      hSVPoolCheck->GetXaxis()->SetBinLabel(2, "sweep");
+      hSVPoolCheck->GetXaxis()->SetBinLabel(3, "scan only");
+      hSVPoolCheck->GetXaxis()->SetBinLabel(4, "sweep only");
+    }
 
     for (int i = 0; i < 5; i++) {
       mBBparamsDaug[i] = cfgBetheBlochParams->get("Daughter", Form("p%i", i));
@@ -276,6 +290,16 @@ struct kinkBuilder {
       int pdgHypo = isMoth ? 1 : 0;
       svCreator.appendTrackCand(track, collisions, pdgHypo, ambiguousTracks, bcs);
     }
+    if (checkSweepLinePool) {
+      const auto comparison = svCreator.compareSVCandPools(collisions, !unlikeSignBkg);
+      hSVPoolCheck->Fill(0., comparison.nScan);
+      hSVPoolCheck->Fill(1., comparison.nSweep);
+      hSVPoolCheck->Fill(2., comparison.nScanOnly);
+      hSVPoolCheck->Fill(3., comparison.nSweepOnly);
+      if (comparison.nScanOnly > 0) {
+        LOG(warning) << comparison.nScanOnly << " kink candidates of the bracket scan are missing in the sweep";
+      }
+    }
     auto& kinkPool = svCreator.getSVCandPool(collisions, !unlikeSignBkg);
 
     for (const auto& svCand : kinkPool) {
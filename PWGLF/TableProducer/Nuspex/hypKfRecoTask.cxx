@@ -17,6 +17,7 @@
 
 #include "PWGLF/DataModel/LFHypernucleiKfTables.h"
 
+#include "Common/Core/PID/PIDLazyCache.h"
 #include "Common/Core/PID/TPCPIDResponse.h"
 #include "Common/Core/RecoDecay.h"
 #include "Common/Core/trackUtilities.h"
@@ -458,6 +459,7 @@ struct HypKfRecoTask {
   // TPC PID Response
   bool usePidResponse;
   o2::pid::tpc::Response* response;
+  o2::pid::LazyNSigmaCache<o2::pid::FullPrecisionBinning> tpcNSigmaCache; // a track is tested as each daughter and its neighbours
   std::map<std::string, std::string> metadata;
   std::array<float, 5> betheParams;
 
@@ -589,7 +591,7 @@ struct HypKfRecoTask {
           continue;
         if (getRigidity(track) < cfgTrackPIDsettings->get(i, "minRigidity") || getRigidity(track) > cfgTrackPIDsettings->get(i, "maxRigidity"))
           continue;
-        float tpcNsigma = getTPCnSigma(track, coll, daughterParticles.at(i));
+        float tpcNsigma = getTPCnSigmaCached(track, coll, i);
         if (std::abs(tpcNsigma) > cfgTrackPIDsettings->get(i, "maxTPCnSigma"))
           continue;
         filldedx(track, i);
@@ -599,8 +601,8 @@ struct HypKfRecoTask {
           continue;
         if (cfgTrackPIDsettings->get(i, "TOFrequiredabove") >= 0 && getRigidity(track) > cfgTrackPIDsettings->get(i, "TOFrequiredabove") && (track.mass() < cfgTrackPIDsettings->get(i, "minTOFmass") || track.mass() > cfgTrackPIDsettings->get(i, "maxTOFmass")))
           continue;
-        float tpcNsigmaNHP = (i == kAlpha ? -999 : getTPCnSigma(track, coll, daughterParticles.at(i + 1)));
-        float tpcNsigmaNLP = (i == kPion ? 999 : getTPCnSigma(track, coll, daughterParticles.at(i - 1)));
+        float tpcNsigmaNHP = (i == kAlpha ? -999 : getTPCnSigmaCached(track, coll, i + 1));
+        float tpcNsigmaNLP = (i == kPion ? 999 : getTPCnSigmaCached(track, coll, i - 1));
         foundDaughterKfs.at(i).push_back(DaughterKf(i, track.globalIndex(), primVtx, tpcNsigma, tpcNsigmaNLP, tpcNsigmaNHP));
       }
     } // track loop
@@ -1010,6 +1012,7 @@ struct HypKfRecoTask {
   void processMC(CollisionsFullMC const& collisions, aod::McCollisions const& mcColls, TracksFull const& tracks, aod::BCsWithTimestamps const&, aod::McParticles const& particlesMC, aod::McTrackLabels const& trackLabelsMC, aod::McCollisionLabels const& collLabels, aod::TrackAssoc const& tracksColl, CollisionsFull const& colls)
   {
     isMC = true;
+    tpcNSigmaCache.reset(tracks.size());
     mcCollInfos.clear();
     mcCollInfos.resize(mcColls.size());
     mcPartIndices.clear();
@@ -1103,7 +1106,7 @@ struct HypKfRecoTask {
   //----------------------------------------------------------------------------------------------------------------
   void processData(CollisionsFull const& collisions, TracksFull const& tracks, aod::BCsWithTimestamps const&, aod::TrackAssoc const& tracksColl)
   {
-
+    tpcNSigmaCache.reset(tracks.size());
     for (const auto& collision : collisions) {
       auto bc = collision.bc_as<aod::BCsWithTimestamps>();
       initCCDB(bc);
@@ -1129,6 +1132,9 @@ struct HypKfRecoTask {
     if (mRunNumber == bc.runNumber()) {
       return;
     }
+    if (mRunNumber != 0) {
+      tpcNSigmaCache.report();
+    }
     auto run3grpTimestamp = bc.timestamp();
     dBz = 0;
     o2::parameters::GRPObject* grpo = ccdb->getForTimeStamp<o2::parameters::GRPObject>(grpPath, run3grpTimestamp);
@@ -1187,6 +1193,7 @@ struct HypKfRecoTask {
   template <typename T>
   void initCollision(const T& collision)
   {
+    tpcNSigmaCache.invalidate(); // the response depends on the collision
     foundDaughterKfs.clear();
     foundDaughterKfs.resize(nDaughterParticles);
     hypNucDaughterKfs.clear();
@@ -1259,6 +1266,14 @@ struct HypKfRecoTask {
   }
   //----------------------------------------------------------------------------------------------------------------
 
+  template <class T, class C>
+  float getTPCnSigmaCached(T const& track, C const& coll, size_t iDaughter)
+  {
+    auto& particle = daughterParticles.at(iDaughter);
+    return tpcNSigmaCache.get(particle.getCentralPIDIndex(), track.globalIndex(), [&]() { return getTPCnSigma(track, coll, particle); });
+  }
+  //----------------------------------------------------------------------------------------------------------------
+
   template <class T, class C>
   float getTPCnSigmaMC(T const& trk, C const& coll, DaughterParticle& particle1, DaughterParticle& particle2)
   {
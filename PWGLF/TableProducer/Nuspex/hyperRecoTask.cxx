@@ -62,6 +62,7 @@ static const std::vector<std::string> betheBlochParNames{"p0", "p1", "p2", "p3",
 static const std::vector<std::string> particleName{"He3"};
 std::shared_ptr<TH1> hEvents;
 std::shared_ptr<TH1> hEventsZorro;
+std::shared_ptr<TH1> hSVPoolCheck;
 std::shared_ptr<TH1> hZvtx;
 std::shared_ptr<TH1> hCentFT0A;
 std::shared_ptr<TH1> hCentFT0C;
@@ -176,6 +177,10 @@ struct hyperRecoTask {
   Configurable<bool> skipAmbiTracks{"skipAmbiTracks", false, "Skip ambiguous tracks"};
   Configurable<bool> disableITSROFCut{"disableITSROFCut", false, "Disable ITS ROC cut for event selection"};
   Configurable<float> customVertexerTimeMargin{"customVertexerTimeMargin", 800, "Time margin for custom vertexer (ns)"};
+  Configurable<float> customVertexerMaxDeltaEta{"customVertexerMaxDeltaEta", -1.f, "Max |delta eta| between the daughters in the custom vertexer, <= 0: no cut"};
+  Configurable<float> customVertexerMaxDeltaPhi{"customVertexerMaxDeltaPhi", -1.f, "Max |delta phi| between the daughters in the custom vertexer, <= 0: no cut"};
+  Configurable<bool> customVertexerUseSweepLine{"customVertexerUseSweepLine", false, "Build the custom vertexer pool with the sweep over the collision brackets instead of the bracket scan"};
+  Configurable<bool> customVertexerCheckSweepLine{"customVertexerCheckSweepLine", false, "Build the custom vertexer pool with both methods and fill hSVPoolCheck with the differences"};
   Configurable<LabeledArray<double>> cfgBetheBlochParams{"cfgBetheBlochParams", {betheBlochDefault[0], 1, 6, particleName, betheBlochParNames}, "TPC Bethe-Bloch parameterisation for He3"};
   Configurable<bool> cfgCompensatePIDinTracking{"cfgCompensatePIDinTracking", true, "If true, divide tpcInnerParam by the electric charge"};
   Configurable<int> cfgMaterialCorrection{"cfgMaterialCorrection", static_cast<int>(o2::base::Propagator::MatCorrType::USEMatCorrNONE), "Type of material correction"};
@@ -241,6 +246,8 @@ struct hyperRecoTask {
     if (skipAmbiTracks) {
       svCreator.setSkipAmbiTracks();
     }
+    svCreator.setMaxDeltaEtaPhi(customVertexerMaxDeltaEta, customVertexerMaxDeltaPhi);
+    svCreator.setUseSweepLine(customVertexerUseSweepLine);
 
     const AxisSpec rigidityAxis{rigidityBins, "#it{p}^{TPC}/#it{z}"};
     const AxisSpec dedxAxis{dedxBins, "d#it{E}/d#it{x}"};
@@ -257,6 +264,13 @@ struct hyperRecoTask {
     hH4LMassTracked = qaRegistry.add<TH1>("hH4LMassTracked", ";M (GeV/#it{c}^{2}); ", HistType::kTH1D, {{60, 3.76, 3.84}});
 
     hEvents = qaRegistry.add<TH1>("hEvents", ";Events; ", HistType::kTH1D, {{2, -0.5, 1.5}});
+    if (customVertexerCheckSweepLine) {
+      hSVPoolCheck = qaRegistry.add<TH1>("hSVPoolCheck", ";; pairs", HistType::kTH1D, {{4, -0.5, 3.5}});
+      hSVPoolCheck->GetXaxis()->SetBinLabel(1, "bracket scan");
+      hSVPoolCheck->GetXaxis()->SetBinLabel(2, "sweep");
+      hSVPoolCheck->GetXaxis()->SetBinLabel(3, "scan only");
+      hSVPoolCheck->GetXaxis()->SetBinLabel(4, "sweep only");
+    }
     hEvents->GetXaxis()->SetBinLabel(1, "All");
     hEvents->GetXaxis()->SetBinLabel(2, "Selected");
 
@@ -611,6 +625,16 @@ struct hyperRecoTask {
 
       svCreator.appendTrackCand(track, collisions, pdgHypo, ambiguousTracks, bcs);
     }
+    if (customVertexerCheckSweepLine) {
+      const auto comparison = svCreator.compareSVCandPools(collisions);
+      hSVPoolCheck->Fill(0., comparison.nScan);
+      hSVPoolCheck->Fill(1., comparison.nSweep);
+      hSVPoolCheck->Fill(2., comparison.nScanOnly);
+      hSVPoolCheck->Fill(3., comparison.nSweepOnly);
+      if (comparison.nScanOnly > 0) {
+        LOG(warning) << comparison.nScanOnly << " SV candidates of the bracket scan are missing in the sweep";
+      }
+    }
     auto& svPool = svCreator.getSVCandPool(collisions);
     LOG(debug) << "SV pool size: " << svPool.size();
 
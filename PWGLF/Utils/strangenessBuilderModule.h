@@ -34,11 +34,15 @@
 #include "Framework/HistogramRegistry.h"
 #include "Framework/HistogramSpec.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 //__________________________________________
@@ -281,6 +285,9 @@ struct coreConfigurables : o2::framework::ConfigurableGroup {
 
   // test the possibility of refitting with material corrections (DCA Fitter option)
   o2::framework::Configurable<bool> refitWithMaterialCorrection{"refitWithMaterialCorrection", false, "do refit after material corrections were applied"};
+
+  // two-phase building: V0 and cascade fits on worker threads, then table filling in the original order
+  o2::framework::Configurable<int> nFittingThreads{"nFittingThreads", 1, "threads for V0 and cascade fitting. 1: serial building; >1: parallel fitting, then serial table filling"};
 };
 
 // strangenessBuilder: V0 building options
@@ -508,6 +515,22 @@ class BuilderModule
   std::vector<int> ao2dV0toV0List;                     // index to relate v0s -> v0List
   std::vector<int> v0Map;                              // index to relate v0List -> v0sFromCascades
 
+  // for two-phase building (baseOpts.nFittingThreads > 1)
+  // fit results per entry of the sorted v0List / cascadeList, filled by the worker threads
+  enum fitStatus : uint8_t {
+    kNotFitted = 0, // skipped by the workers, to be fitted (or skipped) in the serial phase
+    kFitOk,
+    kFitFailed
+  };
+  static constexpr std::size_t fitChunkSize = 64; // entries taken at once by a worker thread
+  struct {
+    std::vector<o2::pwglf::strangenessBuilderHelper> helpers; // one per worker thread
+    std::vector<uint8_t> v0Status;
+    std::vector<o2::pwglf::v0candidate> v0s;
+    std::vector<uint8_t> cascadeStatus;
+    std::vector<o2::pwglf::cascadeCandidate> cascades;
+  } fitBuffer;
+
   // declaration of structs here
   // (N.B.: will be invisible to the outside, create your own copies)
   o2::pwglf::strangenessbuilder::coreConfigurables baseOpts;
@@ -1329,6 +1352,106 @@ class BuilderModule
   }
 
   //__________________________________________________
+  //__________________________________________________
+  // calls fitEntry(helper, i) for i in [0, n) on nFittingThreads threads,
+  // each with its own copy of straHelper (same selections and magnetic field)
+  template <typename TFitFunction>
+  void runOnFittingThreads(std::size_t n, TFitFunction const& fitEntry)
+  {
+    const int nThreads = std::max(1, std::min(baseOpts.nFittingThreads.value, static_cast<int>((n + fitChunkSize - 1) / fitChunkSize)));
+    fitBuffer.helpers.assign(nThreads, straHelper);
+    std::atomic<std::size_t> nextEntry{0};
+    auto work = [&](int iThread) {
+      auto& helper = fitBuffer.helpers[iThread];
+      for (std::size_t first = nextEntry.fetch_add(fitChunkSize); first < n; first = nextEntry.fetch_add(fitChunkSize)) {
+        for (std::size_t i = first; i < std::min(n, first + fitChunkSize); i++) {
+          fitEntry(helper, i);
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int iThread = 1; iThread < nThreads; iThread++) {
+      threads.emplace_back(work, iThread);
+    }
+    work(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  //__________________________________________________
+  // fit of entry iv0 of the sorted v0List, result in helper.v0
+  // TPC-only daughters are moved with the (not thread-safe) TPC drift manager only if allowed,
+  // otherwise the entry is left to the serial phase
+  template <class TBCs, typename TCollisions, typename TTracks>
+  uint8_t fitV0(o2::pwglf::strangenessBuilderHelper& helper, std::size_t iv0, TCollisions const& collisions, TTracks const& tracks, bool moveTPCTracksAllowed)
+  {
+    const auto& v0 = v0List[sorted_v0[iv0]];
+    float pvX = 0.0f, pvY = 0.0f, pvZ = 0.0f;
+    if (v0.collisionId >= 0) {
+      auto const& collision = collisions.rawIteratorAt(v0.collisionId);
+      pvX = collision.posX();
+      pvY = collision.posY();
+      pvZ = collision.posZ();
+    }
+    auto const& posTrack = tracks.rawIteratorAt(v0.posTrackId);
+    auto const& negTrack = tracks.rawIteratorAt(v0.negTrackId);
+
+    auto posTrackPar = getTrackParCov(posTrack);
+    auto negTrackPar = getTrackParCov(negTrack);
+
+    // handle TPC-only tracks properly (photon conversions)
+    if (v0BuilderOpts.moveTPCOnlyTracks) {
+      bool isPosTPCOnly = (posTrack.hasTPC() && !posTrack.hasITS() && !posTrack.hasTRD() && !posTrack.hasTOF());
+      bool isNegTPCOnly = (negTrack.hasTPC() && !negTrack.hasITS() && !negTrack.hasTRD() && !negTrack.hasTOF());
+      if ((isPosTPCOnly || isNegTPCOnly) && !moveTPCTracksAllowed) {
+        return kNotFitted;
+      }
+      if (isPosTPCOnly) {
+        // Nota bene: positive is TPC-only -> this entire V0 merits treatment as photon candidate
+        posTrackPar.setPID(o2::track::PID::Electron);
+        negTrackPar.setPID(o2::track::PID::Electron);
+
+        auto const& collision = collisions.rawIteratorAt(v0.collisionId);
+        if (!mVDriftMgr.moveTPCTrack<TBCs, TCollisions>(collision, posTrack, posTrackPar)) {
+          return kFitFailed;
+        }
+      }
+
+      if (isNegTPCOnly) {
+        // Nota bene: negative is TPC-only -> this entire V0 merits treatment as photon candidate
+        posTrackPar.setPID(o2::track::PID::Electron);
+        negTrackPar.setPID(o2::track::PID::Electron);
+
+        auto const& collision = collisions.rawIteratorAt(v0.collisionId);
+        if (!mVDriftMgr.moveTPCTrack<TBCs, TCollisions>(collision, negTrack, negTrackPar)) {
+          return kFitFailed;
+        }
+      }
+    }
+
+    return helper.buildV0Candidate(v0.collisionId, pvX, pvY, pvZ, posTrack, negTrack, posTrackPar, negTrackPar, v0.isCollinearV0, baseOpts.mEnabledTables[kV0Covs], v0BuilderOpts.generatePhotonCandidates) ? kFitOk : kFitFailed;
+  }
+
+  //__________________________________________________
+  // first phase of the two-phase building: fit all V0s that will be considered by buildV0s
+  template <class TBCs, typename TCollisions, typename TTracks>
+  void fitV0sOnThreads(TCollisions const& collisions, TTracks const& tracks)
+  {
+    fitBuffer.v0Status.assign(v0List.size(), kNotFitted);
+    fitBuffer.v0s.resize(v0List.size());
+    runOnFittingThreads(v0List.size(), [&](o2::pwglf::strangenessBuilderHelper& helper, std::size_t iv0) {
+      const auto& v0 = v0List[sorted_v0[iv0]];
+      if ((!v0BuilderOpts.generatePhotonCandidates.value && v0.v0Type > 1) || (!baseOpts.mEnabledTables[kV0CoresBase] && v0Map[iv0] == -2)) {
+        return; // skipped in buildV0s
+      }
+      fitBuffer.v0Status[iv0] = fitV0<TBCs>(helper, iv0, collisions, tracks, false);
+      if (fitBuffer.v0Status[iv0] == kFitOk) {
+        fitBuffer.v0s[iv0] = helper.v0;
+      }
+    });
+  }
+
   template <class TBCs, typename THistoRegistry, typename TCollisions, typename TTracks, typename TV0s, typename TMCParticles, typename TProducts>
   void buildV0s(THistoRegistry& histos, TCollisions const& collisions, TV0s const& v0s, TTracks const& tracks, TMCParticles const& mcParticles, TProducts& products)
   {
@@ -1341,6 +1464,11 @@ class BuilderModule
       mcParticleIsReco.resize(mcParticles.size(), false);
     }
 
+    const bool useFitBuffer = baseOpts.nFittingThreads.value > 1;
+    if (useFitBuffer) {
+      fitV0sOnThreads<TBCs>(collisions, tracks);
+    }
+
     int nV0s = 0;
     // Loops over all V0s in the time frame
     histos.fill(HIST("hInputStatistics"), kV0CoresBase, v0s.size());
@@ -1372,39 +1500,14 @@ class BuilderModule
       auto const& posTrack = tracks.rawIteratorAt(v0.posTrackId);
       auto const& negTrack = tracks.rawIteratorAt(v0.negTrackId);
 
-      auto posTrackPar = getTrackParCov(posTrack);
-      auto negTrackPar = getTrackParCov(negTrack);
-
-      // handle TPC-only tracks properly (photon conversions)
-      if (v0BuilderOpts.moveTPCOnlyTracks) {
-        bool isPosTPCOnly = (posTrack.hasTPC() && !posTrack.hasITS() && !posTrack.hasTRD() && !posTrack.hasTOF());
-        if (isPosTPCOnly) {
-          // Nota bene: positive is TPC-only -> this entire V0 merits treatment as photon candidate
-          posTrackPar.setPID(o2::track::PID::Electron);
-          negTrackPar.setPID(o2::track::PID::Electron);
-
-          auto const& collision = collisions.rawIteratorAt(v0.collisionId);
-          if (!mVDriftMgr.moveTPCTrack<TBCs, TCollisions>(collision, posTrack, posTrackPar)) {
-            products.v0dataLink(-1, -1);
-            continue;
-          }
-        }
-
-        bool isNegTPCOnly = (negTrack.hasTPC() && !negTrack.hasITS() && !negTrack.hasTRD() && !negTrack.hasTOF());
-        if (isNegTPCOnly) {
-          // Nota bene: negative is TPC-only -> this entire V0 merits treatment as photon candidate
-          posTrackPar.setPID(o2::track::PID::Electron);
-          negTrackPar.setPID(o2::track::PID::Electron);
-
-          auto const& collision = collisions.rawIteratorAt(v0.collisionId);
-          if (!mVDriftMgr.moveTPCTrack<TBCs, TCollisions>(collision, negTrack, negTrackPar)) {
-            products.v0dataLink(-1, -1);
-            continue;
-          }
-        }
+      // take the fit from the first phase if available, fit here otherwise
+      uint8_t v0FitStatus = useFitBuffer ? fitBuffer.v0Status[iv0] : kNotFitted;
+      if (v0FitStatus == kNotFitted) {
+        v0FitStatus = fitV0<TBCs>(straHelper, iv0, collisions, tracks, true);
+      } else if (v0FitStatus == kFitOk) {
+        straHelper.v0 = fitBuffer.v0s[iv0];
       }
-
-      if (!straHelper.buildV0Candidate(v0.collisionId, pvX, pvY, pvZ, posTrack, negTrack, posTrackPar, negTrackPar, v0.isCollinearV0, baseOpts.mEnabledTables[kV0Covs], v0BuilderOpts.generatePhotonCandidates)) {
+      if (v0FitStatus != kFitOk) {
         products.v0dataLink(-1, -1);
         continue;
       }
@@ -1870,6 +1973,73 @@ class BuilderModule
     } // end association check
   }
 
+  //__________________________________________________
+  // fit of entry icascade of the sorted cascade list, result in helper.cascade
+  template <typename TCollisions, typename TTracks, typename TCascades>
+  uint8_t fitCascade(o2::pwglf::strangenessBuilderHelper& helper, std::size_t icascade, TCollisions const& collisions, TCascades const& cascades, TTracks const& tracks)
+  {
+    auto const& cascade = cascades[sorted_cascade[icascade]];
+    float pvX = 0.0f, pvY = 0.0f, pvZ = 0.0f;
+    if (cascade.collisionId >= 0) {
+      auto const& collision = collisions.rawIteratorAt(cascade.collisionId);
+      pvX = collision.posX();
+      pvY = collision.posY();
+      pvZ = collision.posZ();
+    }
+    auto const& posTrack = tracks.rawIteratorAt(cascade.posTrackId);
+    auto const& negTrack = tracks.rawIteratorAt(cascade.negTrackId);
+    auto const& bachTrack = tracks.rawIteratorAt(cascade.bachTrackId);
+    if (baseOpts.useV0BufferForCascades) {
+      // this processing path uses a buffer of V0s so that no
+      // additional minimization step is redone. It consumes less
+      // CPU at the cost of more memory. Since memory is a more
+      // limited commodity, this isn't the default option.
+
+      // check if cached - if not, skip
+      if (cascade.v0Id < 0 || v0Map[cascade.v0Id] < 0) {
+        // this V0 hasn't been stored / cached
+        return kFitFailed;
+      }
+
+      return helper.buildCascadeCandidate(cascade.collisionId, pvX, pvY, pvZ,
+                                          v0sFromCascades[v0Map[cascade.v0Id]],
+                                          posTrack,
+                                          negTrack,
+                                          bachTrack,
+                                          baseOpts.mEnabledTables[kCascBBs],
+                                          cascadeBuilderOpts.useCascadeMomentumAtPrimVtx,
+                                          baseOpts.mEnabledTables[kCascCovs])
+               ? kFitOk
+               : kFitFailed;
+    }
+    // this processing path generates the entire cascade
+    // from tracks, without any need to have V0s generated.
+    return helper.buildCascadeCandidate(cascade.collisionId, pvX, pvY, pvZ,
+                                        posTrack,
+                                        negTrack,
+                                        bachTrack,
+                                        baseOpts.mEnabledTables[kCascBBs],
+                                        cascadeBuilderOpts.useCascadeMomentumAtPrimVtx,
+                                        baseOpts.mEnabledTables[kCascCovs])
+             ? kFitOk
+             : kFitFailed;
+  }
+
+  //__________________________________________________
+  // first phase of the two-phase building: fit all cascades (the V0 buffer is complete at this point)
+  template <typename TCollisions, typename TTracks, typename TCascades>
+  void fitCascadesOnThreads(TCollisions const& collisions, TCascades const& cascades, TTracks const& tracks)
+  {
+    fitBuffer.cascadeStatus.assign(cascades.size(), kNotFitted);
+    fitBuffer.cascades.resize(cascades.size());
+    runOnFittingThreads(cascades.size(), [&](o2::pwglf::strangenessBuilderHelper& helper, std::size_t icascade) {
+      fitBuffer.cascadeStatus[icascade] = fitCascade(helper, icascade, collisions, cascades, tracks);
+      if (fitBuffer.cascadeStatus[icascade] == kFitOk) {
+        fitBuffer.cascades[icascade] = helper.cascade;
+      }
+    });
+  }
+
   //__________________________________________________
   template <typename THistoRegistry, typename TCollisions, typename TTracks, typename TCascades, typename TMCParticles, typename TProducts>
   void buildCascades(THistoRegistry& histos, TCollisions const& collisions, TCascades const& cascades, TTracks const& tracks, TMCParticles const& mcParticles, TProducts& products)
@@ -1886,6 +2056,11 @@ class BuilderModule
     if (!baseOpts.mEnabledTables[kStoredCascCores]) {
       return; // don't do if no request for cascades in place
     }
+    const bool useFitBuffer = baseOpts.nFittingThreads.value > 1;
+    if (useFitBuffer) {
+      fitCascadesOnThreads(collisions, cascades, tracks);
+    }
+
     int nCascades = 0;
     // Loops over all cascades in the time frame
     histos.fill(HIST("hInputStatistics"), kStoredCascCores, cascades.size());
@@ -1904,46 +2079,18 @@ class BuilderModule
       auto const& posTrack = tracks.rawIteratorAt(cascade.posTrackId);
       auto const& negTrack = tracks.rawIteratorAt(cascade.negTrackId);
       auto const& bachTrack = tracks.rawIteratorAt(cascade.bachTrackId);
-      if (baseOpts.useV0BufferForCascades) {
-        // this processing path uses a buffer of V0s so that no
-        // additional minimization step is redone. It consumes less
-        // CPU at the cost of more memory. Since memory is a more
-        // limited commodity, this isn't the default option.
-
-        // check if cached - if not, skip
-        if (cascade.v0Id < 0 || v0Map[cascade.v0Id] < 0) {
-          // this V0 hasn't been stored / cached
-          products.cascdataLink(-1);
-          interlinks.cascadeToCascCores.push_back(-1);
-          continue; // didn't work out, skip
-        }
 
-        if (!straHelper.buildCascadeCandidate(cascade.collisionId, pvX, pvY, pvZ,
-                                              v0sFromCascades[v0Map[cascade.v0Id]],
-                                              posTrack,
-                                              negTrack,
-                                              bachTrack,
-                                              baseOpts.mEnabledTables[kCascBBs],
-                                              cascadeBuilderOpts.useCascadeMomentumAtPrimVtx,
-                                              baseOpts.mEnabledTables[kCascCovs])) {
-          products.cascdataLink(-1);
-          interlinks.cascadeToCascCores.push_back(-1);
-          continue; // didn't work out, skip
-        }
-      } else {
-        // this processing path generates the entire cascade
-        // from tracks, without any need to have V0s generated.
-        if (!straHelper.buildCascadeCandidate(cascade.collisionId, pvX, pvY, pvZ,
-                                              posTrack,
-                                              negTrack,
-                                              bachTrack,
-                                              baseOpts.mEnabledTables[kCascBBs],
-                                              cascadeBuilderOpts.useCascadeMomentumAtPrimVtx,
-                                              baseOpts.mEnabledTables[kCascCovs])) {
-          products.cascdataLink(-1);
-          interlinks.cascadeToCascCores.push_back(-1);
-          continue; // didn't work out, skip
-        }
+      // take the fit from the first phase if available, fit here otherwise
+      uint8_t cascadeFitStatus = useFitBuffer ? fitBuffer.cascadeStatus[icascade] : kNotFitted;
+      if (cascadeFitStatus == kNotFitted) {
+        cascadeFitStatus = fitCascade(straHelper, icascade, collisions, cascades, tracks);
+      } else if (cascadeFitStatus == kFitOk) {
+        straHelper.cascade = fitBuffer.cascades[icascade];
+      }
+      if (cascadeFitStatus != kFitOk) {
+        products.cascdataLink(-1);
+        interlinks.cascadeToCascCores.push_back(-1);
+        continue; // didn't work out, skip
       }
       nCascades++;
 
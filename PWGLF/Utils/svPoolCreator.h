@@ -12,13 +12,19 @@
 #ifndef PWGLF_UTILS_SVPOOLCREATOR_H_
 #define PWGLF_UTILS_SVPOOLCREATOR_H_
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
 #include <unordered_map>
 #include <vector>
 #include <utility>
 #include "Framework/AnalysisTask.h"
 #include "Framework/ASoAHelpers.h"
 #include "Common/Core/trackUtilities.h"
+#include "CommonConstants/MathConstants.h"
 #include "DCAFitter/DCAFitterN.h"
 #include "Framework/AnalysisDataModel.h"
 
@@ -34,6 +40,8 @@ constexpr uint64_t bOffsetMax = 241; // track compatibility can never go beyond
 struct TrackCand {
   int Idxtr;
   CollBracket collBracket{};
+  float eta{0.f}; // for the optional (eta, phi) compatibility of the two tracks
+  float phi{0.f};
 };
 
 struct SVCand {
@@ -42,6 +50,14 @@ struct SVCand {
   CollBracket collBracket{};
 };
 
+// pairs found by the bracket scan and by the sweep on the same pools, the sweep is expected to contain all the scan pairs
+struct SVPoolComparison {
+  std::size_t nScan{0};
+  std::size_t nSweep{0};
+  std::size_t nScanOnly{0};  // pairs missed by the sweep
+  std::size_t nSweepOnly{0}; // overlapping pairs skipped by the scan
+};
+
 class svPoolCreator
 {
  public:
@@ -70,6 +86,15 @@ class svPoolCreator
   void setTimeMargin(float timeMargin) { timeMarginNS = timeMargin; }
   void setFitter(const o2::vertexing::DCAFitterN<2>& fitter) { this->fitter = fitter; }
   void setSkipAmbiTracks() { skipAmbiTracks = true; }
+  // true: sweep over the bracket edges in getSVCandPool instead of the original bracket scan (default),
+  // to be enabled once compareSVCandPools agrees with the scan on the real pools
+  void setUseSweepLine(bool useSweep) { useSweepLine = useSweep; }
+  // pairs with |delta eta| or |delta phi| above the limits are dropped before fitSV, a limit <= 0 disables the cut
+  void setMaxDeltaEtaPhi(float maxDEta, float maxDPhi)
+  {
+    maxDeltaEta = maxDEta;
+    maxDeltaPhi = maxDPhi;
+  }
   o2::vertexing::DCAFitterN<2>* getFitter() { return &fitter; }
   std::array<std::vector<TrackCand>, 4> getTrackCandPool() { return trackCandPool; }
 
@@ -188,6 +213,8 @@ class svPoolCreator
       int poolIndex = (1 - isDau0) * 2 + (trackCand.sign() < 0);
       trForpool.Idxtr = trackCand.globalIndex();
       trForpool.collBracket = {static_cast<int>(collIdx), static_cast<int>(collIdx)};
+      trForpool.eta = trackCand.eta();
+      trForpool.phi = trackCand.phi();
       // LOG(info) << "Adding track to pool: " << trForpool.Idxtr << " with bracket: " << trForpool.collBracket.getMin() << " " << trForpool.collBracket.getMax() << " and pool index: " << poolIndex;
       trackCandPool[poolIndex].emplace_back(trForpool);
       tmap[trackCand.globalIndex()] = {trackCandPool[poolIndex].size() - 1, poolIndex};
@@ -195,8 +222,58 @@ class svPoolCreator
 
     // is Sorting Needed ? TBD
   }
+
+  // adds an already built candidate to a pool (0: dau0 pos, 1: dau0 neg, 2: dau1 pos, 3: dau1 neg)
+  void appendTrackCand(int poolIndex, const TrackCand& trackCand) { trackCandPool[poolIndex].push_back(trackCand); }
+
   template <typename C>
   std::vector<SVCand>& getSVCandPool(const C& collisions, bool combineLikeSign = false)
+  {
+    if (!useSweepLine) {
+      return getSVCandPoolBracketScan(collisions, combineLikeSign);
+    }
+    for (int pn = 0; pn < 2; pn++) {
+      int track1sign = combineLikeSign ? pn : 1 - pn;
+      sweepPools(trackCandPool[pn], trackCandPool[2 + track1sign]);
+    }
+    return svCandPool;
+  }
+
+  // builds the pool from the current track pools with both methods and compares the pairs (tracks and overlap bracket).
+  // The pool returned by getSVCandPool is not modified
+  template <typename C>
+  SVPoolComparison compareSVCandPools(const C& collisions, bool combineLikeSign = false)
+  {
+    const std::size_t nCands = svCandPool.size();
+    auto key = [](const SVCand& cand) { return std::array<int, 4>{cand.tr0Idx, cand.tr1Idx, cand.collBracket.getMin(), cand.collBracket.getMax()}; };
+    std::array<std::vector<std::array<int, 4>>, 2> pairs; // scan, sweep
+    for (int iMethod = 0; iMethod < 2; iMethod++) {
+      if (iMethod == 0) {
+        getSVCandPoolBracketScan(collisions, combineLikeSign);
+      } else {
+        for (int pn = 0; pn < 2; pn++) {
+          sweepPools(trackCandPool[pn], trackCandPool[2 + (combineLikeSign ? pn : 1 - pn)]);
+        }
+      }
+      for (std::size_t i = nCands; i < svCandPool.size(); i++) {
+        pairs[iMethod].push_back(key(svCandPool[i]));
+      }
+      svCandPool.resize(nCands);
+      std::sort(pairs[iMethod].begin(), pairs[iMethod].end());
+    }
+
+    SVPoolComparison comparison{pairs[0].size(), pairs[1].size(), 0, 0};
+    std::vector<std::array<int, 4>> difference;
+    std::set_difference(pairs[0].begin(), pairs[0].end(), pairs[1].begin(), pairs[1].end(), std::back_inserter(difference));
+    comparison.nScanOnly = difference.size();
+    difference.clear();
+    std::set_difference(pairs[1].begin(), pairs[1].end(), pairs[0].begin(), pairs[0].end(), std::back_inserter(difference));
+    comparison.nSweepOnly = difference.size();
+    return comparison;
+  }
+
+  template <typename C>
+  std::vector<SVCand>& getSVCandPoolBracketScan(const C& collisions, bool combineLikeSign = false)
   {
     gsl::span<std::vector<TrackCand>> track0Pool{trackCandPool.data(), 2};
     gsl::span<std::vector<TrackCand>> track1Pool{trackCandPool.data() + 2, 2};
@@ -246,6 +323,9 @@ class svPoolCreator
             LOG(debug) << "Brackets do not match";
             continue;
           }
+          if (!isEtaPhiCompatible(track0Seed, track1Seed)) {
+            continue;
+          }
           auto overlapBracket = track0Seed.collBracket.getOverlap(track1Seed.collBracket);
 
           svCandPool.emplace_back(SVCand{track0Seed.Idxtr, track1Seed.Idxtr, overlapBracket});
@@ -259,17 +339,137 @@ class svPoolCreator
   bool fitSV(unsigned int idxDau0, unsigned int idxDau1, T& trackTable);
 
  private:
+  bool isEtaPhiCompatible(const TrackCand& track0, const TrackCand& track1) const
+  {
+    if (maxDeltaEta > 0.f && std::abs(track0.eta - track1.eta) > maxDeltaEta) {
+      return false;
+    }
+    if (maxDeltaPhi > 0.f) {
+      float deltaPhi = std::abs(track0.phi - track1.phi);
+      if (deltaPhi > math::PI) {
+        deltaPhi = math::TwoPI - deltaPhi;
+      }
+      if (deltaPhi > maxDeltaPhi) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // eta bins at least maxDeltaEta wide, so that compatible tracks are in the same or in adjacent bins
+  int nEtaBins() const { return maxDeltaEta > 0.f ? std::clamp(static_cast<int>(2.f * EtaBinRange / maxDeltaEta), 1, MaxEtaBins) : 1; }
+  int etaBin(float eta, int nBins) const
+  {
+    return nBins == 1 ? 0 : std::clamp(static_cast<int>((eta + EtaBinRange) / (2.f * EtaBinRange) * nBins), 0, nBins - 1);
+  }
+
+  // sweep over the lower bracket edges of the two pools, ordered by collision index. When a bracket opens,
+  // the open brackets of the other pool in the adjacent eta bins either overlap with it or are already closed
+  // and dropped, so that the cost is O(n + number of collisions + number of overlapping pairs).
+  // The pairs are written ordered by track1 and then track0 pool index, as in the bracket scan
+  void sweepPools(const std::vector<TrackCand>& pool0, const std::vector<TrackCand>& pool1)
+  {
+    std::array<const std::vector<TrackCand>*, 2> pools{&pool0, &pool1};
+    for (int iPool = 0; iPool < 2; iPool++) {
+      // counting sort on the lower edge (a collision index)
+      const auto& pool = *pools[iPool];
+      int maxEdge = 0;
+      for (const auto& cand : pool) {
+        maxEdge = std::max(maxEdge, cand.collBracket.getMin());
+      }
+      sweepCounts.assign(maxEdge + 2, 0);
+      for (const auto& cand : pool) {
+        sweepCounts[cand.collBracket.getMin() + 1]++;
+      }
+      std::partial_sum(sweepCounts.begin(), sweepCounts.end(), sweepCounts.begin());
+      auto& order = sweepOrder[iPool];
+      order.resize(pool.size());
+      for (std::size_t i = 0; i < pool.size(); i++) {
+        order[sweepCounts[pool[i].collBracket.getMin()]++] = i;
+      }
+    }
+    const int nBins = nEtaBins();
+    for (auto& openBrackets : sweepOpen) {
+      openBrackets.resize(nBins);
+      for (auto& bin : openBrackets) {
+        bin.clear();
+      }
+    }
+    sweepPairs.clear();
+
+    std::array<std::size_t, 2> next{0, 0};
+    while (next[0] < pool0.size() || next[1] < pool1.size()) {
+      // next lower edge, track0 first for equal edges
+      const int iPool = (next[1] == pool1.size() || (next[0] < pool0.size() && pool0[sweepOrder[0][next[0]]].collBracket.getMin() <= pool1[sweepOrder[1][next[1]]].collBracket.getMin())) ? 0 : 1;
+      const int idx = sweepOrder[iPool][next[iPool]++];
+      const auto& cand = (*pools[iPool])[idx];
+      const auto& otherPool = *pools[1 - iPool];
+      const int bin = etaBin(cand.eta, nBins);
+      for (int iBin = std::max(0, bin - 1); iBin <= std::min(nBins - 1, bin + 1); iBin++) {
+        auto& openBrackets = sweepOpen[1 - iPool][iBin];
+        for (std::size_t k = 0; k < openBrackets.size();) {
+          const auto& other = otherPool[openBrackets[k]];
+          if (other.collBracket.getMax() < cand.collBracket.getMin()) {
+            openBrackets[k] = openBrackets.back(); // closed before this one opens
+            openBrackets.pop_back();
+            continue;
+          }
+          if (isEtaPhiCompatible(cand, other)) {
+            sweepPairs.emplace_back(iPool == 0 ? openBrackets[k] : idx, iPool == 0 ? idx : openBrackets[k]);
+          }
+          k++;
+        }
+      }
+      sweepOpen[iPool][bin].push_back(idx);
+    }
+
+    // two stable counting sorts, by track0 and then by track1 pool index
+    sortPairs(pool0.size(), false);
+    sortPairs(pool1.size(), true);
+    for (const auto& [i1, i0] : sweepPairs) {
+      svCandPool.emplace_back(SVCand{pool0[i0].Idxtr, pool1[i1].Idxtr, pool0[i0].collBracket.getOverlap(pool1[i1].collBracket)});
+    }
+  }
+
+  void sortPairs(std::size_t nKeys, bool byTrack1)
+  {
+    auto key = [byTrack1](const std::pair<int, int>& pair) { return byTrack1 ? pair.first : pair.second; };
+    sweepCounts.assign(nKeys + 1, 0);
+    for (const auto& pair : sweepPairs) {
+      sweepCounts[key(pair) + 1]++;
+    }
+    std::partial_sum(sweepCounts.begin(), sweepCounts.end(), sweepCounts.begin());
+    sweepPairsSorted.resize(sweepPairs.size());
+    for (const auto& pair : sweepPairs) {
+      sweepPairsSorted[sweepCounts[key(pair)]++] = pair;
+    }
+    sweepPairs.swap(sweepPairsSorted);
+  }
+
+  static constexpr float EtaBinRange = 4.f; // tracks beyond are put in the edge bins
+  static constexpr int MaxEtaBins = 400;
+
   o2::vertexing::DCAFitterN<2> fitter;
   int track0Pdg;
   int track1Pdg;
   float timeMarginNS = 600.;
   bool skipAmbiTracks = false;
+  bool useSweepLine = false;
+  float maxDeltaEta = -1.f;
+  float maxDeltaPhi = -1.f;
   std::unordered_map<int, std::pair<int, int>> tmap;
   std::unordered_map<uint64_t, int> bc2Coll;
 
   std::array<std::vector<TrackCand>, 4> trackCandPool; // Sorting: dau0 pos, dau0 neg, dau1 pos, dau1 neg
   std::vector<SVCand> svCandPool;                      // index of the two tracks in the track table
   TrackCand trForpool;
+
+  // sweep-line buffers, kept between calls
+  std::array<std::vector<int>, 2> sweepOrder;             // pool indices ordered by lower bracket edge
+  std::array<std::vector<std::vector<int>>, 2> sweepOpen; // open brackets per eta bin
+  std::vector<std::pair<int, int>> sweepPairs;            // (track1, track0) pool indices
+  std::vector<std::pair<int, int>> sweepPairsSorted;
+  std::vector<std::size_t> sweepCounts;
 };
 
 #endif // PWGLF_UTILS_SVPOOLCREATOR_H_
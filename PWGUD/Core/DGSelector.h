@@ -20,6 +20,7 @@
 #include "Framework/AnalysisTask.h"
 #include "PWGUD/Core/UDHelpers.h"
 #include "PWGUD/Core/DGCutparHolder.h"
+#include "PWGUD/Core/FITGapCache.h"
 
 // -----------------------------------------------------------------------------
 // add here Selectors for different types of diffractive events
@@ -67,6 +68,24 @@ class DGSelector
       }
     }
 
+    return IsSelectedTracks(diffCuts, collision, tracks, fwdtracks);
+  }
+
+  // Same as above, with the FIT veto of the compatible BCs (rows bcRange of the BCs table) taken from
+  // the FIT gap cache of the DataFrame
+  template <typename CC, typename TCs, typename FWs>
+  int IsSelected(DGCutparHolder diffCuts, CC& collision, udhelpers::FITGapCache const& gapCache, udhelpers::BCRowRange bcRange, TCs& tracks, FWs& fwdtracks)
+  {
+    if (gapCache.isVetoed(bcRange, diffCuts)) {
+      return 1;
+    }
+    return IsSelectedTracks(diffCuts, collision, tracks, fwdtracks);
+  }
+
+  // Selection of the forward and barrel tracks and of the collision, after the FIT veto
+  template <typename CC, typename TCs, typename FWs>
+  int IsSelectedTracks(DGCutparHolder& diffCuts, CC& collision, TCs& tracks, FWs& fwdtracks)
+  {
     // forward tracks
     LOGF(debug, "FwdTracks %i", fwdtracks.size());
     if (!diffCuts.withFwdTracks()) {
@@ -0,0 +1,277 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+/// \file   FITGapCache.h
+/// \brief  Per-DataFrame summary of the FIT activity of all BCs, for gap and veto decisions in BC windows
+///
+/// The FIT flags of each BC (not clean on the A/C side, TVX, TSC, TCE, ...) are computed once per
+/// DataFrame with the udhelpers::clean* functions. For each flag the cache keeps the running count
+/// over the BCs table and the list of flagged rows, so that "any flagged BC in a window", the nearest
+/// flagged BC and the next/previous flagged BC are O(1). The maximum FT0 amplitudes in a window come
+/// from sparse tables, built on the first request.
+/// The compatible-BC ranges of compatibleBCs are returned as ranges [first, last) of rows of the BCs
+/// table, found by binary search over the global BCs.
+///
+
+#ifndef PWGUD_CORE_FITGAPCACHE_H_
+#define PWGUD_CORE_FITGAPCACHE_H_
+
+#include "PWGUD/Core/DGCutparHolder.h"
+#include "PWGUD/Core/UDHelpers.h"
+
+#include "CommonConstants/LHCConstants.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace udhelpers
+{
+
+// rows [first, last) of the BCs table
+using BCRowRange = std::pair<int64_t, int64_t>;
+
+class FITGapCache
+{
+ public:
+  enum Flag : int {
+    kHasFIT = 0,  // FT0, FV0 or FDD signal
+    kNotCleanA,   // !cleanFITA: FV0, FT0A or FDDA above limits
+    kNotCleanC,   // !cleanFITC: FT0C or FDDC above limits
+    kNotCleanFIT, // !cleanFIT
+    kTVX,
+    kTSC,
+    kTCE,
+    kNFlags
+  };
+
+  /// rebuilds the cache if bcs is not the table of the last call. The clean flags are only computed
+  /// when the FIT amplitude limits (FV0A, FT0A, FT0C, FDDA, FDDC) are given
+  /// \return true if the cache was rebuilt
+  template <typename TBCs>
+  bool update(TBCs const& bcs, float maxFITtime = 0.f, std::vector<float> const& lims = {})
+  {
+    const int64_t nBCs = bcs.size();
+    const void* table = bcs.asArrowTable().get();
+    if (table == mTable && nBCs == size() &&
+        (nBCs == 0 || (mGlobalBCs.front() == bcs.iteratorAt(0).globalBC() && mGlobalBCs.back() == bcs.iteratorAt(nBCs - 1).globalBC()))) {
+      return false;
+    }
+    mTable = table;
+    build(bcs, maxFITtime, lims);
+    return true;
+  }
+
+  template <typename TBCs>
+  void build(TBCs const& bcs, float maxFITtime, std::vector<float> const& lims)
+  {
+    const int64_t nBCs = bcs.size();
+    const bool withCuts = lims.size() >= 5;
+    mGlobalBCs.resize(nBCs);
+    mAmpFT0A.resize(nBCs);
+    mAmpFT0C.resize(nBCs);
+    for (int flag = 0; flag < kNFlags; flag++) {
+      mCounts[flag].resize(nBCs + 1);
+      mCounts[flag][0] = 0;
+      mRows[flag].clear();
+    }
+    mSparseFT0A.clear();
+    mSparseFT0C.clear();
+
+    int64_t row = 0;
+    for (const auto& bc : bcs) {
+      mGlobalBCs[row] = bc.globalBC();
+      std::array<bool, kNFlags> flags{};
+      flags[kHasFIT] = bc.has_foundFT0() || bc.has_foundFV0() || bc.has_foundFDD();
+      if (withCuts) {
+        flags[kNotCleanA] = !cleanFITA(bc, maxFITtime, lims);
+        flags[kNotCleanC] = !cleanFITC(bc, maxFITtime, lims);
+        flags[kNotCleanFIT] = flags[kNotCleanA] || flags[kNotCleanC];
+      }
+      flags[kTVX] = TVX(bc);
+      flags[kTSC] = TSC(bc);
+      flags[kTCE] = TCE(bc);
+      for (int flag = 0; flag < kNFlags; flag++) {
+        mCounts[flag][row + 1] = mCounts[flag][row] + flags[flag];
+        if (flags[flag]) {
+          mRows[flag].push_back(row);
+        }
+      }
+      if (bc.has_foundFT0()) {
+        mAmpFT0A[row] = FT0AmplitudeA(bc.foundFT0());
+        mAmpFT0C[row] = FT0AmplitudeC(bc.foundFT0());
+      } else {
+        mAmpFT0A[row] = 0.f;
+        mAmpFT0C[row] = 0.f;
+      }
+      row++;
+    }
+  }
+
+  int64_t size() const { return mGlobalBCs.size(); }
+  uint64_t globalBC(int64_t row) const { return mGlobalBCs[row]; }
+  float ampFT0A(int64_t row) const { return mAmpFT0A[row]; }
+  float ampFT0C(int64_t row) const { return mAmpFT0C[row]; }
+
+  /// row of globalBC, -1 if the BC is not in the table
+  int64_t findRow(uint64_t globalBC) const
+  {
+    auto it = std::lower_bound(mGlobalBCs.begin(), mGlobalBCs.end(), globalBC);
+    return (it != mGlobalBCs.end() && *it == globalBC) ? it - mGlobalBCs.begin() : -1;
+  }
+
+  /// rows of the BCs with minBC <= globalBC <= maxBC
+  BCRowRange range(uint64_t minBC, uint64_t maxBC) const
+  {
+    const int64_t first = std::lower_bound(mGlobalBCs.begin(), mGlobalBCs.end(), minBC) - mGlobalBCs.begin();
+    const int64_t last = std::upper_bound(mGlobalBCs.begin(), mGlobalBCs.end(), maxBC) - mGlobalBCs.begin();
+    return {first, std::max(first, last)};
+  }
+
+  /// same BC window as compatibleBCs(collision, ndt, bcs, nMinBCs): meanBC +- max(ndt * time resolution, nMinBCs)
+  template <typename C>
+  BCRowRange compatibleRange(C const& collision, int ndt, int nMinBCs = 7) const
+  {
+    if (!collision.has_foundBC() || ndt < 0) {
+      return {0, 0};
+    }
+    // due to the filling scheme the most probable BC may not be the one estimated from the collision time
+    uint64_t mostProbableBC = mGlobalBCs[collision.foundBCId()];
+    uint64_t meanBC = mostProbableBC + std::lround(collision.collisionTime() / o2::constants::lhc::LHCBunchSpacingNS);
+    int deltaBC = std::ceil(collision.collisionTimeRes() / o2::constants::lhc::LHCBunchSpacingNS * ndt);
+    if (deltaBC < nMinBCs) {
+      deltaBC = nMinBCs;
+    }
+    uint64_t minBC = static_cast<uint64_t>(deltaBC) < meanBC ? meanBC - static_cast<uint64_t>(deltaBC) : 0;
+    uint64_t maxBC = meanBC + static_cast<uint64_t>(deltaBC);
+    return range(minBC, maxBC);
+  }
+
+  /// number of BCs with the flag in the rows
+  int64_t count(Flag flag, BCRowRange rows) const { return mCounts[flag][rows.second] - mCounts[flag][rows.first]; }
+  bool any(Flag flag, BCRowRange rows) const { return rows.first < rows.second && count(flag, rows) > 0; }
+
+  /// first row >= row with the flag, size() if none
+  int64_t nextWith(Flag flag, int64_t row) const
+  {
+    const int64_t rank = mCounts[flag][row];
+    return rank < static_cast<int64_t>(mRows[flag].size()) ? mRows[flag][rank] : size();
+  }
+
+  /// last row <= row with the flag, -1 if none
+  int64_t prevWith(Flag flag, int64_t row) const
+  {
+    const int64_t rank = mCounts[flag][row + 1];
+    return rank > 0 ? mRows[flag][rank - 1] : -1;
+  }
+
+  /// row with the flag in rows which is closest in BC to globalBC, the earlier one if two are equally close.
+  /// -1 if no BC in rows has the flag
+  int64_t closestWith(Flag flag, BCRowRange rows, uint64_t globalBC) const
+  {
+    const auto [first, last] = rows;
+    if (!any(flag, rows)) {
+      return -1;
+    }
+    const int64_t pos = std::clamp<int64_t>(std::lower_bound(mGlobalBCs.begin(), mGlobalBCs.end(), globalBC) - mGlobalBCs.begin(), first, last);
+    const int64_t next = pos < last ? nextWith(flag, pos) : last;
+    const int64_t prev = pos > first ? prevWith(flag, pos - 1) : -1;
+    const bool hasNext = next < last;
+    const bool hasPrev = prev >= first;
+    if (!hasNext) {
+      return prev;
+    }
+    if (!hasPrev) {
+      return next;
+    }
+    auto distance = [&](int64_t row) { return std::abs(static_cast<int64_t>(mGlobalBCs[row] - globalBC)); };
+    return distance(next) < distance(prev) ? next : prev;
+  }
+
+  /// first row of the largest FT0A (FT0C) amplitude in rows, -1 if there is no positive amplitude
+  int64_t argMaxFT0A(BCRowRange rows) { return argMax(mAmpFT0A, mSparseFT0A, rows); }
+  int64_t argMaxFT0C(BCRowRange rows) { return argMax(mAmpFT0C, mSparseFT0C, rows); }
+
+  /// same decision as FITveto(bc, diffCuts) for any BC in rows. The cache has to be built with the FIT
+  /// limits of diffCuts
+  bool isVetoed(BCRowRange rows, DGCutparHolder const& diffCuts) const
+  {
+    if (diffCuts.withTVX()) {
+      return any(kTVX, rows);
+    }
+    if (diffCuts.withTSC()) {
+      return any(kTSC, rows);
+    }
+    if (diffCuts.withTCE()) {
+      return any(kTCE, rows);
+    }
+    if (diffCuts.withTOR()) {
+      return any(kNotCleanFIT, rows);
+    }
+    return false;
+  }
+
+ private:
+  using SparseTable = std::vector<std::vector<int32_t>>;
+
+  /// level k holds the first row of the maximum of amps in [row, row + 2^k)
+  void buildSparseTable(std::vector<float> const& amps, SparseTable& table) const
+  {
+    const int64_t nBCs = amps.size();
+    table.assign(1, std::vector<int32_t>(nBCs));
+    for (int64_t row = 0; row < nBCs; row++) {
+      table[0][row] = row;
+    }
+    for (int level = 1; (int64_t{1} << level) <= nBCs; level++) {
+      const int64_t half = int64_t{1} << (level - 1);
+      const auto& below = table[level - 1];
+      std::vector<int32_t> current(nBCs - 2 * half + 1);
+      for (int64_t row = 0; row < static_cast<int64_t>(current.size()); row++) {
+        const int32_t left = below[row], right = below[row + half];
+        current[row] = amps[right] > amps[left] ? right : left;
+      }
+      table.push_back(std::move(current));
+    }
+  }
+
+  int64_t argMax(std::vector<float> const& amps, SparseTable& table, BCRowRange rows)
+  {
+    const auto [first, last] = rows;
+    if (first >= last) {
+      return -1;
+    }
+    if (table.empty()) {
+      buildSparseTable(amps, table);
+    }
+    const int level = std::bit_width(static_cast<uint64_t>(last - first)) - 1;
+    const int32_t left = table[level][first], right = table[level][last - (int64_t{1} << level)];
+    const int32_t best = amps[right] > amps[left] ? right : left;
+    return amps[best] > 0.f ? best : -1;
+  }
+
+  const void* mTable = nullptr; // table of the last update, to detect a new DataFrame
+  std::vector<uint64_t> mGlobalBCs;
+  std::array<std::vector<int32_t>, kNFlags> mCounts; // running count of each flag, size() + 1 entries
+  std::array<std::vector<int32_t>, kNFlags> mRows;   // rows with each flag
+  std::vector<float> mAmpFT0A;
+  std::vector<float> mAmpFT0C;
+  SparseTable mSparseFT0A;
+  SparseTable mSparseFT0C;
+};
+
+} // namespace udhelpers
+
+#endif // PWGUD_CORE_FITGAPCACHE_H_
@@ -19,6 +19,7 @@
 #ifndef PWGUD_CORE_SGSELECTOR_H_
 #define PWGUD_CORE_SGSELECTOR_H_
 
+#include "PWGUD/Core/FITGapCache.h"
 #include "PWGUD/Core/SGCutParHolder.h"
 #include "PWGUD/Core/UDHelpers.h"
 
@@ -31,8 +32,9 @@
 
 template <typename BC>
 struct SelectionResult {
-  int value;    // The original integer return value
-  const BC* bc; // Pointer to the BC object
+  int value;         // The original integer return value
+  const BC* bc;      // Pointer to the BC object
+  int64_t bcId = -1; // Row of the selected BC in the BCs table, set by the FITGapCache variant of IsSelected
 };
 
 namespace o2::aod::sgselector
@@ -127,6 +129,47 @@ class SGSelector
     result.value = gA && gC ? o2::aod::sgselector::DoubleGap : (gA ? o2::aod::sgselector::SingleGapA : o2::aod::sgselector::SingleGapC);
     return result;
   }
+
+  // Same selection as above, with the gap decisions taken from the FIT gap cache of the DataFrame.
+  // bcRange are the rows of the compatible BCs, e.g. from gapCache.compatibleRange(collision, ...).
+  // The selected BC is returned as row of the BCs table in result.bcId, result.bc points to oldbc
+  template <typename CC, typename BC>
+  SelectionResult<BC> IsSelected(SGCutParHolder const& diffCuts, CC const& collision, udhelpers::FITGapCache& gapCache, udhelpers::BCRowRange bcRange, BC const& oldbc)
+  {
+    SelectionResult<BC> result;
+    result.bc = &oldbc;
+    result.bcId = oldbc.globalIndex();
+    if (collision.numContrib() < diffCuts.minNTracks() || collision.numContrib() > diffCuts.maxNTracks()) {
+      result.value = o2::aod::sgselector::TrkOutOfRange; // 4
+      return result;
+    }
+    const bool gA = !gapCache.any(udhelpers::FITGapCache::kNotCleanA, bcRange);
+    const bool gC = !gapCache.any(udhelpers::FITGapCache::kNotCleanC, bcRange);
+    if (!gA && !gC) {
+      result.value = o2::aod::sgselector::NoUpc; // gap = 3
+      return result;
+    }
+    if (gA && gC) { // so-called DG events: take the most active FT0 BC
+      int64_t dgaId = gapCache.argMaxFT0A(bcRange);
+      int64_t dgcId = gapCache.argMaxFT0C(bcRange);
+      const float ampa = dgaId >= 0 ? gapCache.ampFT0A(dgaId) : 0.f;
+      const float ampc = dgcId >= 0 ? gapCache.ampFT0C(dgcId) : 0.f;
+      dgaId = dgaId >= 0 ? dgaId : oldbc.globalIndex();
+      dgcId = dgcId >= 0 ? dgcId : oldbc.globalIndex();
+      if (dgaId != dgcId) {
+        if (ampc / diffCuts.FITAmpLimits()[2] > ampa / diffCuts.FITAmpLimits()[1])
+          dgaId = dgcId;
+      }
+      result.bcId = dgaId;
+      result.value = o2::aod::sgselector::DoubleGap;
+      return result;
+    }
+    // single gap: the active BC on the other side closest to the original BC
+    auto activeSide = gA ? udhelpers::FITGapCache::kNotCleanC : udhelpers::FITGapCache::kNotCleanA;
+    result.bcId = gapCache.closestWith(activeSide, bcRange, oldbc.globalBC());
+    result.value = gA ? o2::aod::sgselector::SingleGapA : o2::aod::sgselector::SingleGapC;
+    return result;
+  }
   template <typename TFwdTrack>
   int FwdTrkSelector(TFwdTrack const& fwdtrack)
   {
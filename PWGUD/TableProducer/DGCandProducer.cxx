@@ -13,6 +13,7 @@
 // \author Paul Buehler, paul.buehler@oeaw.ac.at
 
 #include "PWGUD/Core/DGSelector.h"
+#include "PWGUD/Core/FITGapCache.h"
 #include "PWGUD/Core/UPCHelpers.h"
 #include "PWGUD/DataModel/UDTables.h"
 
@@ -60,6 +61,7 @@ struct DGCandProducer {
 
   // DG selector
   DGSelector dgSelector;
+  udhelpers::FITGapCache fitGapCache; // FIT activity of the BCs of the current DataFrame
 
   // configurables
   Configurable<bool> saveAllTracks{"saveAllTracks", true, "save only PV contributors or all tracks associated to a collision"};
@@ -317,12 +319,13 @@ struct DGCandProducer {
     // fill FIT histograms
     fillFIThistograms(bc, histdir);
 
-    // obtain slice of compatible BCs
-    auto bcRange = udhelpers::compatibleBCs(collision, diffCuts.NDtcoll(), bcs, diffCuts.minNBCs());
-    LOGF(debug, "<DGCandProducer>  Size of bcRange %d", bcRange.size());
+    // obtain range of compatible BCs, the FIT vetoes are taken from the cache of the DataFrame
+    fitGapCache.update(bcs, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
+    auto bcRange = fitGapCache.compatibleRange(collision, diffCuts.NDtcoll(), diffCuts.minNBCs());
+    LOGF(debug, "<DGCandProducer>  Size of bcRange %d", bcRange.second - bcRange.first);
 
     // apply DG selection
-    auto isDGEvent = dgSelector.IsSelected(diffCuts, collision, bcRange, tracks, fwdtracks);
+    auto isDGEvent = dgSelector.IsSelected(diffCuts, collision, fitGapCache, bcRange, tracks, fwdtracks);
 
     // save DG candidates
     getHist(TH1, histdir + "/Stat")->Fill(isDGEvent + 3, 1.);
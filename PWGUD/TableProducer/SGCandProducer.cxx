@@ -18,6 +18,7 @@
 /// \since  May 2025
 //
 
+#include "PWGUD/Core/FITGapCache.h"
 #include "PWGUD/Core/SGSelector.h"
 #include "PWGUD/Core/UPCHelpers.h"
 #include "PWGUD/DataModel/UDTables.h"
@@ -96,6 +97,7 @@ struct SGCandProducer {
 
   //  SG selector
   SGSelector sgSelector;
+  udhelpers::FITGapCache fitGapCache; // FIT activity of the BCs of the current DataFrame
   ctpRateFetcher mRateFetcher;
 
   // initialize RCT flag checker
@@ -345,13 +347,14 @@ struct SGCandProducer {
     }
     auto newbc = bc;
 
-    // obtain slice of compatible BCs
-    auto bcRange = udhelpers::compatibleBCs(collision, sameCuts.NDtcoll(), bcs, sameCuts.minNBCs());
-    auto isSGEvent = sgSelector.IsSelected(sameCuts, collision, bcRange, bc);
+    // obtain range of compatible BCs, the FIT gaps are taken from the cache of the DataFrame
+    fitGapCache.update(bcs, sameCuts.maxFITtime(), sameCuts.FITAmpLimits());
+    auto bcRange = fitGapCache.compatibleRange(collision, sameCuts.NDtcoll(), sameCuts.minNBCs());
+    auto isSGEvent = sgSelector.IsSelected(sameCuts, collision, fitGapCache, bcRange, bc);
     // auto isSGEvent = sgSelector.IsSelected(sameCuts, collision, bcRange, tracks);
     int issgevent = isSGEvent.value;
-    if (isSGEvent.bc && issgevent < 2) {
-      newbc = *(isSGEvent.bc);
+    if (isSGEvent.bcId >= 0 && issgevent < 2) {
+      newbc = bcs.iteratorAt(isSGEvent.bcId);
     } else {
       if (verboseInfo)
         LOGF(info, "No Newbc %i", bc.globalBC());
@@ -12,11 +12,13 @@
 /// \author Diana Krupova, diana.krupova@cern.ch
 /// \since 04.06.2024
 
+#include "PWGUD/Core/FITGapCache.h"
 #include "PWGUD/Core/UPCCutparHolder.h"
 #include "PWGUD/Core/UPCHelpers.h"
 #include "PWGUD/DataModel/UDTables.h"
 
 #include "Common/CCDB/EventSelectionParams.h"
+#include "Common/Core/GlobalBcTimeline.h"
 #include "Common/DataModel/EventSelection.h"
 
 #include "CommonConstants/LHCConstants.h"
@@ -29,8 +31,7 @@
 #include <algorithm>
 #include <limits>
 #include <map>
-#include <unordered_map>
-#include <unordered_set>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -104,6 +105,8 @@ struct UpcCandProducer {
   Configurable<bool> fRequireNoTimeFrameBorder{"requireNoTimeFrameBorder", true, "Require kNoTimeFrameBorder selection bit"};
   Configurable<bool> fRequireNoITSROFrameBorder{"requireNoITSROFrameBorder", true, "Require kNoITSROFrameBorder selection bit"};
 
+  Configurable<int> fNThreads{"nThreads", 1, "Threads for the selection of barrel tracks. 1: serial; >1: track table split in row ranges processed in parallel"};
+
   // QA histograms
   HistogramRegistry histRegistry{"HistRegistry", {}, OutputObjHandlingPolicy::AnalysisObject};
 
@@ -117,6 +120,28 @@ struct UpcCandProducer {
                                      o2::aod::pidTOFFullEl, o2::aod::pidTOFFullMu, o2::aod::pidTOFFullPi, o2::aod::pidTOFFullKa, o2::aod::pidTOFFullPr>;
 
   typedef std::pair<uint64_t, std::vector<int64_t>> BCTracksPair;
+  typedef std::pair<uint64_t, int64_t> BCTrackId;
+
+  // (track ID, "uncorrected" global BC) of ambiguous tracks, sorted by track ID
+  typedef std::vector<std::pair<int64_t, uint64_t>> AmbTrackBCs;
+
+  // selected barrel tracks of a range of rows of the track table, filled by one thread
+  struct BarrelTrackBuffer {
+    std::vector<BCTrackId> tof;    // tracks with TOF
+    std::vector<BCTrackId> itsTpc; // ITS-TPC tracks without TOF
+  };
+  std::vector<BarrelTrackBuffer> fBarrelTrackBuffers;
+
+  // global BCs of FIT and ZDC signals per DataFrame, with the task-specific FT0 selections as extra channels
+  enum FitBcChannels : int {
+    kBcChannelTOR = o2::common::core::kNCommonBcChannels, // FT0 with |timeA| or |timeC| within 2 ns
+    kBcChannelTSC,                                        // TVX & (TSC | TCE)
+    kBcChannelT0A                                         // TVX with |timeA| within 2 ns
+  };
+  o2::common::core::GlobalBcTimeline fBcTimeline;
+
+  // FIT activity of all BCs of the DataFrame, for the FIT info of the semiforward candidates
+  udhelpers::FITGapCache fFITGapCache;
 
   void init(InitContext&)
   {
@@ -237,17 +262,11 @@ struct UpcCandProducer {
     return true;
   }
 
-  auto findClosestBC(uint64_t globalBC, std::map<uint64_t, int32_t>& bcs)
+  // closest global BC with a signal in a (non-empty) timeline channel, and the row index of the signal
+  std::pair<uint64_t, int32_t> findClosestBC(uint64_t globalBC, int channel)
   {
-    auto it = bcs.lower_bound(globalBC);
-    auto bc1 = it->first;
-    if (it != bcs.begin())
-      --it;
-    auto bc2 = it->first;
-    auto dbc1 = bc1 >= globalBC ? bc1 - globalBC : globalBC - bc1;
-    auto dbc2 = bc2 >= globalBC ? bc2 - globalBC : globalBC - bc2;
-    auto bc = (dbc1 <= dbc2) ? bc1 : bc2;
-    return bc;
+    auto i = fBcTimeline.findClosest(channel, globalBC);
+    return {static_cast<uint64_t>(fBcTimeline.globalBC(channel, i)), fBcTimeline.row(channel, i)};
   }
 
   auto findClosestTrackBCiter(uint64_t globalBC, std::vector<BCTracksPair>& bcs)
@@ -433,7 +452,7 @@ struct UpcCandProducer {
                         uint64_t globalBC,
                         uint64_t closestBcITSTPC,
                         const o2::aod::McTrackLabels* mcTrackLabels,
-                        std::unordered_map<int64_t, uint64_t>& /*ambBarrelTrBCs*/)
+                        AmbTrackBCs const& /*ambBarrelTrBCs*/)
   {
     for (auto trackID : trackIDs) {
       const auto& track = tracks.iteratorAt(trackID);
@@ -490,18 +509,15 @@ struct UpcCandProducer {
   template <typename TBCs>
   void processFITInfo(upchelpers::FITInfo& fitInfo,
                       uint64_t midbc,
-                      std::vector<std::pair<uint64_t, int64_t>>& v,
+                      udhelpers::FITGapCache const& gapCache,
                       TBCs const& bcs,
                       o2::aod::FT0s const& /*ft0s*/,
                       o2::aod::FDDs const& /*fdds*/,
                       o2::aod::FV0As const& /*fv0as*/)
   {
-    auto it = std::find_if(v.begin(),
-                           v.end(),
-                           [midbc](const std::pair<uint64_t, int64_t>& p) { return p.first == midbc; });
+    auto bcId = gapCache.findRow(midbc);
 
-    if (it != v.end()) {
-      auto bcId = it->second;
+    if (bcId >= 0 && gapCache.any(udhelpers::FITGapCache::kHasFIT, {bcId, bcId + 1})) {
       auto bcEntry = bcs.iteratorAt(bcId);
       if (bcEntry.has_foundFT0()) {
         auto ft0 = bcEntry.foundFT0();
@@ -548,17 +564,10 @@ struct UpcCandProducer {
     uint64_t left = midbc >= range ? midbc - range : 0;
     uint64_t right = fMaxBC >= midbc + range ? midbc + range : fMaxBC;
 
-    std::pair<uint64_t, int64_t> dummyPair(left, 0);
-    auto curit = std::lower_bound(v.begin(), v.end(), dummyPair,
-                                  [](const std::pair<uint64_t, int64_t>& left, const std::pair<uint64_t, int64_t>& right) { return left.first < right.first; });
-
-    if (curit == v.end()) // no BCs with FT0 info at all
-      return;
-
-    uint64_t curbc = curit->first;
-    while (curbc <= right) {
-      uint64_t bit = curbc - (midbc - range);
-      int64_t bcGlId = curit->second;
+    // BCs with FIT info in [left, right]
+    auto [first, last] = gapCache.range(left, right);
+    for (auto bcGlId = gapCache.nextWith(udhelpers::FITGapCache::kHasFIT, first); bcGlId < last; bcGlId = gapCache.nextWith(udhelpers::FITGapCache::kHasFIT, bcGlId + 1)) {
+      uint64_t bit = gapCache.globalBC(bcGlId) - (midbc - range);
       const auto& bc = bcs.iteratorAt(bcGlId);
       if (!bc.selection_bit(o2::aod::evsel::kNoBGT0A))
         SETBIT(fitInfo.BGFT0Apf, bit);
@@ -580,10 +589,6 @@ struct UpcCandProducer {
         SETBIT(fitInfo.BBFDDApf, bit);
       if (bc.selection_bit(o2::aod::evsel::kIsBBFDC))
         SETBIT(fitInfo.BBFDDCpf, bit);
-      ++curit;
-      if (curit == v.end())
-        break;
-      curbc = curit->first;
     }
   }
 
@@ -602,9 +607,11 @@ struct UpcCandProducer {
 
   // "uncorrected" bcs
   template <int32_t tracksSwitch, typename TBCs, typename TAmbTracks>
-  void collectAmbTrackBCs(std::unordered_map<int64_t, uint64_t>& ambTrIds,
+  void collectAmbTrackBCs(AmbTrackBCs& ambTrIds,
                           TAmbTracks ambTracks)
   {
+    ambTrIds.clear();
+    ambTrIds.reserve(ambTracks.size());
     for (const auto& ambTrk : ambTracks) {
       auto trkId = getAmbTrackId<tracksSwitch>(ambTrk);
       const auto& bcSlice = ambTrk.template bc_as<TBCs>();
@@ -613,37 +620,55 @@ struct UpcCandProducer {
         auto first = bcSlice.begin();
         trackBC = first.globalBC();
       }
-      ambTrIds[trkId] = trackBC;
+      ambTrIds.emplace_back(trkId, trackBC);
     }
+    // the table is normally sorted by track ID already
+    auto lessId = [](const auto& left, const auto& right) { return left.first < right.first; };
+    if (!std::is_sorted(ambTrIds.begin(), ambTrIds.end(), lessId))
+      std::stable_sort(ambTrIds.begin(), ambTrIds.end(), lessId);
+    // for repeated track IDs the last entry is kept
+    auto last = std::unique(ambTrIds.rbegin(), ambTrIds.rend(), [](const auto& left, const auto& right) { return left.first == right.first; });
+    ambTrIds.erase(ambTrIds.begin(), last.base());
   }
 
-  void addTrack(std::vector<BCTracksPair>& v, uint64_t bc, int64_t trkId)
+  // "uncorrected" bc of an ambiguous track, false if the track is not ambiguous
+  bool findAmbTrackBC(AmbTrackBCs const& ambTrIds, int64_t trkId, uint64_t& trackBC)
   {
-    auto it = std::find_if(v.begin(), v.end(),
-                           [bc](const BCTracksPair& element) { return element.first == bc; });
-    if (it != v.end())
-      it->second.push_back(trkId);
-    else
-      v.emplace_back(std::make_pair(bc, std::vector<int64_t>({trkId})));
+    auto it = std::lower_bound(ambTrIds.begin(), ambTrIds.end(), trkId,
+                               [](const auto& p, int64_t id) { return p.first < id; });
+    if (it == ambTrIds.end() || it->first != trkId)
+      return false;
+    trackBC = it->second;
+    return true;
   }
 
-  // trackType == 0 -> hasTOF
-  // trackType == 1 -> hasITS and not hasTOF
+  // groups (BC, track ID) pairs by BC: the groups are sorted by BC, the tracks of a BC keep their order
+  void groupTracksByBC(std::vector<BCTrackId>& bcTrackIds, std::vector<BCTracksPair>& bcsMatchedTrIds)
+  {
+    std::stable_sort(bcTrackIds.begin(), bcTrackIds.end(),
+                     [](const auto& left, const auto& right) { return left.first < right.first; });
+    bcsMatchedTrIds.clear();
+    for (const auto& [bc, trkId] : bcTrackIds) {
+      if (bcsMatchedTrIds.empty() || bcsMatchedTrIds.back().first != bc)
+        bcsMatchedTrIds.emplace_back(bc, std::vector<int64_t>{});
+      bcsMatchedTrIds.back().second.push_back(trkId);
+    }
+  }
+
+  // selects the barrel tracks in rows [first, last) of the track table
   template <typename TBCs>
-  void collectBarrelTracks(std::vector<BCTracksPair>& bcsMatchedTrIds,
-                           int trackType,
-                           TBCs const& /*bcs*/,
-                           o2::aod::Collisions const& /*collisions*/,
-                           BarrelTracks const& barrelTracks,
-                           o2::aod::AmbiguousTracks const& /*ambBarrelTracks*/,
-                           std::unordered_map<int64_t, uint64_t>& ambBarrelTrBCs)
+  void selectBarrelTracks(int64_t first, int64_t last,
+                          BarrelTracks const& barrelTracks,
+                          AmbTrackBCs const& ambBarrelTrBCs,
+                          BarrelTrackBuffer& buffer)
   {
-    for (const auto& trk : barrelTracks) {
+    buffer.tof.clear();
+    buffer.itsTpc.clear();
+    for (int64_t row = first; row < last; row++) {
+      const auto& trk = barrelTracks.iteratorAt(row);
       if (!trk.hasTPC())
         continue;
-      if (trackType == 0 && !trk.hasTOF())
-        continue;
-      if (trackType == 1 && !(trk.hasITS() && !trk.hasTOF()))
+      if (!trk.hasTOF() && !trk.hasITS())
         continue;
       if (!applyBarCuts(trk))
         continue;
@@ -655,16 +680,56 @@ struct UpcCandProducer {
         nContrib = col.numContrib();
         trackBC = col.bc_as<TBCs>().globalBC();
       } else {
-        auto ambIter = ambBarrelTrBCs.find(trkId);
-        if (ambIter != ambBarrelTrBCs.end())
-          trackBC = ambIter->second;
+        findAmbTrackBC(ambBarrelTrBCs, trkId, trackBC);
       }
       int64_t tint = TMath::FloorNint(trk.trackTime() / o2::constants::lhc::LHCBunchSpacingNS + static_cast<float>(fBarrelTrackTShift));
       uint64_t bc = trackBC + tint;
       if (nContrib > upcCuts.getMaxNContrib())
         continue;
-      addTrack(bcsMatchedTrIds, bc, trkId);
+      if (trk.hasTOF())
+        buffer.tof.emplace_back(bc, trkId);
+      else
+        buffer.itsTpc.emplace_back(bc, trkId);
+    }
+  }
+
+  // barrel tracks with TOF and ITS-TPC tracks without TOF, grouped by BC.
+  // With nThreads > 1 the track table is split in contiguous row ranges, selected on worker threads
+  // and merged in the order of the rows, so that the groups are the same as with the serial selection
+  template <typename TBCs>
+  void collectBarrelTracks(std::vector<BCTracksPair>& bcsMatchedTrIdsTOF,
+                           std::vector<BCTracksPair>& bcsMatchedTrIdsITSTPC,
+                           TBCs const& /*bcs*/,
+                           BarrelTracks const& barrelTracks,
+                           AmbTrackBCs const& ambBarrelTrBCs)
+  {
+    constexpr int64_t minRowsPerThread = 1000;
+    const int64_t nTracks = barrelTracks.size();
+    const int nThreads = std::max<int64_t>(1, std::min<int64_t>(fNThreads, nTracks / minRowsPerThread));
+    fBarrelTrackBuffers.resize(nThreads);
+    if (nThreads == 1) {
+      selectBarrelTracks<TBCs>(0, nTracks, barrelTracks, ambBarrelTrBCs, fBarrelTrackBuffers[0]);
+    } else {
+      std::vector<std::thread> threads;
+      threads.reserve(nThreads);
+      for (int iThread = 0; iThread < nThreads; iThread++) {
+        int64_t first = nTracks * iThread / nThreads;
+        int64_t last = nTracks * (iThread + 1) / nThreads;
+        threads.emplace_back([this, first, last, iThread, &barrelTracks, &ambBarrelTrBCs]() {
+          selectBarrelTracks<TBCs>(first, last, barrelTracks, ambBarrelTrBCs, fBarrelTrackBuffers[iThread]);
+        });
+      }
+      for (auto& thread : threads)
+        thread.join();
+      auto& merged = fBarrelTrackBuffers[0];
+      for (int iThread = 1; iThread < nThreads; iThread++) {
+        const auto& buffer = fBarrelTrackBuffers[iThread];
+        merged.tof.insert(merged.tof.end(), buffer.tof.begin(), buffer.tof.end());
+        merged.itsTpc.insert(merged.itsTpc.end(), buffer.itsTpc.begin(), buffer.itsTpc.end());
+      }
     }
+    groupTracksByBC(fBarrelTrackBuffers[0].tof, bcsMatchedTrIdsTOF);
+    groupTracksByBC(fBarrelTrackBuffers[0].itsTpc, bcsMatchedTrIdsITSTPC);
   }
 
   template <typename TBCs>
@@ -674,8 +739,9 @@ struct UpcCandProducer {
                             o2::aod::Collisions const& /*collisions*/,
                             ForwardTracks const& fwdTracks,
                             o2::aod::AmbiguousFwdTracks const& /*ambFwdTracks*/,
-                            std::unordered_map<int64_t, uint64_t>& ambFwdTrBCs)
+                            AmbTrackBCs const& ambFwdTrBCs)
   {
+    std::vector<BCTrackId> bcTrackIds;
     for (const auto& trk : fwdTracks) {
       if (trk.trackType() != typeFilter)
         continue;
@@ -684,20 +750,18 @@ struct UpcCandProducer {
       int64_t trkId = trk.globalIndex();
       int32_t nContrib = -1;
       uint64_t trackBC = 0;
-      auto ambIter = ambFwdTrBCs.find(trkId);
-      if (ambIter == ambFwdTrBCs.end()) {
+      if (!findAmbTrackBC(ambFwdTrBCs, trkId, trackBC)) {
         const auto& col = trk.collision();
         nContrib = col.numContrib();
         trackBC = col.bc_as<TBCs>().globalBC();
-      } else {
-        trackBC = ambIter->second;
       }
       int64_t tint = TMath::FloorNint(trk.trackTime() / o2::constants::lhc::LHCBunchSpacingNS + static_cast<float>(fMuonTrackTShift));
       uint64_t bc = trackBC + tint;
       if (nContrib > upcCuts.getMaxNContrib())
         continue;
-      addTrack(bcsMatchedTrIds, bc, trkId);
+      bcTrackIds.emplace_back(bc, trkId);
     }
+    groupTracksByBC(bcTrackIds, bcsMatchedTrIds);
   }
 
   template <typename TBCs>
@@ -707,8 +771,9 @@ struct UpcCandProducer {
                                   o2::aod::Collisions const& /*collisions*/,
                                   ForwardTracks const& fwdTracks,
                                   o2::aod::AmbiguousFwdTracks const& /*ambFwdTracks*/,
-                                  std::unordered_map<int64_t, uint64_t>& ambFwdTrBCs)
+                                  AmbTrackBCs const& ambFwdTrBCs)
   {
+    std::vector<BCTrackId> bcTrackIds;
     for (const auto& trk : fwdTracks) {
       if (trk.trackType() != typeFilter)
         continue;
@@ -717,8 +782,7 @@ struct UpcCandProducer {
       int64_t trkId = trk.globalIndex();
       int32_t nContrib = -1;
       uint64_t trackBC = 0;
-      auto ambIter = ambFwdTrBCs.find(trkId);
-      if (ambIter == ambFwdTrBCs.end()) {
+      if (!findAmbTrackBC(ambFwdTrBCs, trkId, trackBC)) {
         const auto& col = trk.collision();
         nContrib = col.numContrib();
         trackBC = col.bc_as<TBCs>().globalBC();
@@ -729,21 +793,20 @@ struct UpcCandProducer {
         if (fRequireNoITSROFrameBorder && !bc.selection_bit(o2::aod::evsel::kNoITSROFrameBorder)) {
           continue; // skip this track if the kNoITSROFrameBorder bit is required but not set
         }
-      } else {
-        trackBC = ambIter->second;
       }
       int64_t tint = TMath::FloorNint(trk.trackTime() / o2::constants::lhc::LHCBunchSpacingNS + static_cast<float>(fMuonTrackTShift));
       uint64_t bc = trackBC + tint;
       if (nContrib > upcCuts.getMaxNContrib())
         continue;
-      addTrack(bcsMatchedTrIds, bc, trkId);
+      bcTrackIds.emplace_back(bc, trkId);
     }
+    groupTracksByBC(bcTrackIds, bcsMatchedTrIds);
   }
 
   int32_t searchTracks(uint64_t midbc, uint64_t range, uint32_t tracksToFind,
                        std::vector<int64_t>& tracks,
                        std::vector<BCTracksPair>& v,
-                       std::unordered_set<int64_t>& matchedTracks,
+                       std::vector<bool>& matchedTracks,
                        bool skipMidBC = false)
   {
     uint32_t count = 0;
@@ -768,9 +831,9 @@ struct UpcCandProducer {
       count += size;
       if (count > tracksToFind) // too many tracks nearby
         return -3;
-      if (matchedTracks.find(curit->second[0]) == matchedTracks.end()) {
+      if (!matchedTracks[curit->second[0]]) {
         tracks.push_back(curit->second[0]);
-        matchedTracks.insert(curit->second[0]);
+        matchedTracks[curit->second[0]] = true;
       }
       ++curit;
       if (curit == v.end())
@@ -798,35 +861,23 @@ struct UpcCandProducer {
     std::vector<BCTracksPair> bcsMatchedTrIdsITSTPC;
 
     // trackID -> index in amb. track table
-    std::unordered_map<int64_t, uint64_t> ambBarrelTrBCs;
+    AmbTrackBCs ambBarrelTrBCs;
     if (upcCuts.getAmbigSwitch() != 1)
       collectAmbTrackBCs<0, BCsWithBcSels>(ambBarrelTrBCs, ambBarrelTracks);
 
-    collectBarrelTracks(bcsMatchedTrIdsTOF,
-                        0,
-                        bcs, collisions,
-                        barrelTracks, ambBarrelTracks, ambBarrelTrBCs);
+    // sorted by BC
+    collectBarrelTracks(bcsMatchedTrIdsTOF, bcsMatchedTrIdsITSTPC,
+                        bcs, barrelTracks, ambBarrelTrBCs);
 
-    collectBarrelTracks(bcsMatchedTrIdsITSTPC,
-                        1,
-                        bcs, collisions,
-                        barrelTracks, ambBarrelTracks, ambBarrelTrBCs);
-
-    std::sort(bcsMatchedTrIdsTOF.begin(), bcsMatchedTrIdsTOF.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-    std::sort(bcsMatchedTrIdsITSTPC.begin(), bcsMatchedTrIdsITSTPC.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
-    std::map<uint64_t, int32_t> mapGlobalBcWithTOR{};
-    std::map<uint64_t, int32_t> mapGlobalBcWithTVX{};
-    std::map<uint64_t, int32_t> mapGlobalBcWithTSC{};
+    namespace bctl = o2::common::core;
+    fBcTimeline.clear();
     for (const auto& ft0 : ft0s) {
       uint64_t globalBC = ft0.bc_as<TBCs>().globalBC();
       int32_t globalIndex = ft0.globalIndex();
       if (!(std::abs(ft0.timeA()) > 2.f && std::abs(ft0.timeC()) > 2.f))
-        mapGlobalBcWithTOR[globalBC] = globalIndex;
+        fBcTimeline.add(kBcChannelTOR, globalBC, globalIndex);
       if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex)) { // TVX
-        mapGlobalBcWithTVX[globalBC] = globalIndex;
+        fBcTimeline.add(bctl::kBcChannelTVX, globalBC, globalIndex);
       }
       if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitCen)) { // TVX & TCE
         histRegistry.get<TH1>(HIST("hCountersTrg"))->Fill("TCE", 1);
@@ -834,19 +885,17 @@ struct UpcCandProducer {
       if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex) &&
           (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitCen) ||
            TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitSCen))) { // TVX & (TSC | TCE)
-        mapGlobalBcWithTSC[globalBC] = globalIndex;
+        fBcTimeline.add(kBcChannelTSC, globalBC, globalIndex);
       }
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithV0A{};
     for (const auto& fv0a : fv0as) {
       if (std::abs(fv0a.time()) > 15.f)
         continue;
       uint64_t globalBC = fv0a.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithV0A[globalBC] = fv0a.globalIndex();
+      fBcTimeline.add(bctl::kBcChannelFV0A, globalBC, fv0a.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithZdc{};
     for (const auto& zdc : zdcs) {
       if (std::abs(zdc.timeZNA()) > 2.f && std::abs(zdc.timeZNC()) > 2.f)
         continue;
@@ -855,14 +904,15 @@ struct UpcCandProducer {
       if (!(std::abs(zdc.timeZNC()) > 2.f))
         histRegistry.get<TH1>(HIST("hCountersTrg"))->Fill("ZNC", 1);
       auto globalBC = zdc.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithZdc[globalBC] = zdc.globalIndex();
+      fBcTimeline.add(bctl::kBcChannelZDC, globalBC, zdc.globalIndex());
     }
 
-    auto nTORs = mapGlobalBcWithTOR.size();
-    auto nTSCs = mapGlobalBcWithTSC.size();
-    auto nTVXs = mapGlobalBcWithTVX.size();
-    auto nFV0As = mapGlobalBcWithV0A.size();
-    auto nZdcs = mapGlobalBcWithZdc.size();
+    fBcTimeline.build();
+    auto nTORs = fBcTimeline.size(kBcChannelTOR);
+    auto nTSCs = fBcTimeline.size(kBcChannelTSC);
+    auto nTVXs = fBcTimeline.size(bctl::kBcChannelTVX);
+    auto nFV0As = fBcTimeline.size(bctl::kBcChannelFV0A);
+    auto nZdcs = fBcTimeline.size(bctl::kBcChannelZDC);
     auto nBcsWithITSTPC = bcsMatchedTrIdsITSTPC.size();
 
     // todo: calculate position of UD collision?
@@ -886,11 +936,10 @@ struct UpcCandProducer {
       fitInfo.distClosestBcTVX = 999;
       fitInfo.distClosestBcV0A = 999;
       if (nTORs > 0) {
-        uint64_t closestBcTOR = findClosestBC(globalBC, mapGlobalBcWithTOR);
+        auto [closestBcTOR, ft0Id] = findClosestBC(globalBC, kBcChannelTOR);
         fitInfo.distClosestBcTOR = globalBC - static_cast<int64_t>(closestBcTOR);
         if (std::abs(fitInfo.distClosestBcTOR) <= fFilterFT0)
           return false;
-        auto ft0Id = mapGlobalBcWithTOR.at(closestBcTOR);
         auto ft0 = ft0s.iteratorAt(ft0Id);
         fitInfo.timeFT0A = ft0.timeA();
         fitInfo.timeFT0C = ft0.timeC();
@@ -902,23 +951,22 @@ struct UpcCandProducer {
           fitInfo.ampFT0C += amp;
       }
       if (nTSCs > 0) {
-        uint64_t closestBcTSC = findClosestBC(globalBC, mapGlobalBcWithTSC);
+        uint64_t closestBcTSC = findClosestBC(globalBC, kBcChannelTSC).first;
         fitInfo.distClosestBcTSC = globalBC - static_cast<int64_t>(closestBcTSC);
         if (std::abs(fitInfo.distClosestBcTSC) <= fFilterTSC)
           return false;
       }
       if (nTVXs > 0) {
-        uint64_t closestBcTVX = findClosestBC(globalBC, mapGlobalBcWithTVX);
+        uint64_t closestBcTVX = findClosestBC(globalBC, bctl::kBcChannelTVX).first;
         fitInfo.distClosestBcTVX = globalBC - static_cast<int64_t>(closestBcTVX);
         if (std::abs(fitInfo.distClosestBcTVX) <= fFilterTVX)
           return false;
       }
       if (nFV0As > 0) {
-        uint64_t closestBcV0A = findClosestBC(globalBC, mapGlobalBcWithV0A);
+        auto [closestBcV0A, fv0aId] = findClosestBC(globalBC, bctl::kBcChannelFV0A);
         fitInfo.distClosestBcV0A = globalBC - static_cast<int64_t>(closestBcV0A);
         if (std::abs(fitInfo.distClosestBcV0A) <= fFilterFV0)
           return false;
-        auto fv0aId = mapGlobalBcWithV0A.at(closestBcV0A);
         auto fv0a = fv0as.iteratorAt(fv0aId);
         fitInfo.timeFV0A = fv0a.time();
         const auto& v0Amps = fv0a.amplitude();
@@ -957,9 +1005,9 @@ struct UpcCandProducer {
       if (!updateFitInfo(globalBC, fitInfo))
         continue;
       if (nZdcs > 0) {
-        auto itZDC = mapGlobalBcWithZdc.find(globalBC);
-        if (itZDC != mapGlobalBcWithZdc.end()) {
-          const auto& zdc = zdcs.iteratorAt(itZDC->second);
+        auto zdcId = fBcTimeline.findRow(bctl::kBcChannelZDC, globalBC);
+        if (zdcId >= 0) {
+          const auto& zdc = zdcs.iteratorAt(zdcId);
           float timeZNA = zdc.timeZNA();
           float timeZNC = zdc.timeZNC();
           float eComZNA = zdc.energyCommonZNA();
@@ -1026,9 +1074,9 @@ struct UpcCandProducer {
       if (!updateFitInfo(globalBC, fitInfo))
         continue;
       if (nZdcs > 0) {
-        auto itZDC = mapGlobalBcWithZdc.find(globalBC);
-        if (itZDC != mapGlobalBcWithZdc.end()) {
-          const auto& zdc = zdcs.iteratorAt(itZDC->second);
+        auto zdcId = fBcTimeline.findRow(bctl::kBcChannelZDC, globalBC);
+        if (zdcId >= 0) {
+          const auto& zdc = zdcs.iteratorAt(zdcId);
           float timeZNA = zdc.timeZNA();
           float timeZNC = zdc.timeZNC();
           float eComZNA = zdc.energyCommonZNA();
@@ -1100,26 +1148,20 @@ struct UpcCandProducer {
     std::vector<BCTracksPair> bcsMatchedTrIdsMID;
 
     // trackID -> index in amb. track table
-    std::unordered_map<int64_t, uint64_t> ambBarrelTrBCs;
+    AmbTrackBCs ambBarrelTrBCs;
     collectAmbTrackBCs<0, BCsWithBcSels>(ambBarrelTrBCs, ambBarrelTracks);
 
-    std::unordered_map<int64_t, uint64_t> ambFwdTrBCs;
+    AmbTrackBCs ambFwdTrBCs;
     collectAmbTrackBCs<1, BCsWithBcSels>(ambFwdTrBCs, ambFwdTracks);
 
+    // sorted by BC
     collectForwardTracks(bcsMatchedTrIdsMID,
                          o2::aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack,
                          bcs, collisions,
                          fwdTracks, ambFwdTracks, ambFwdTrBCs);
 
-    collectBarrelTracks(bcsMatchedTrIdsTOF,
-                        0,
-                        bcs, collisions,
-                        barrelTracks, ambBarrelTracks, ambBarrelTrBCs);
-
-    collectBarrelTracks(bcsMatchedTrIdsITSTPC,
-                        1,
-                        bcs, collisions,
-                        barrelTracks, ambBarrelTracks, ambBarrelTrBCs);
+    collectBarrelTracks(bcsMatchedTrIdsTOF, bcsMatchedTrIdsITSTPC,
+                        bcs, barrelTracks, ambBarrelTrBCs);
 
     LOGP(debug, "bcsMatchedTrIdsMID.size()={}", bcsMatchedTrIdsMID.size());
     LOGP(debug, "bcsMatchedTrIdsTOF.size()={}", bcsMatchedTrIdsTOF.size());
@@ -1127,15 +1169,12 @@ struct UpcCandProducer {
     uint32_t nBCsWithITSTPC = bcsMatchedTrIdsITSTPC.size();
     uint32_t nBCsWithMID = bcsMatchedTrIdsMID.size();
 
-    std::sort(bcsMatchedTrIdsMID.begin(), bcsMatchedTrIdsMID.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
     std::vector<BCTracksPair> bcsMatchedTrIdsTOFTagged(nBCsWithMID);
     for (const auto& pair : bcsMatchedTrIdsTOF) {
       uint64_t bc = pair.first;
-      auto it = std::find_if(bcsMatchedTrIdsMID.begin(), bcsMatchedTrIdsMID.end(),
-                             [bc](const auto& item) { return item.first == bc; });
-      if (it != bcsMatchedTrIdsMID.end()) {
+      auto it = std::lower_bound(bcsMatchedTrIdsMID.begin(), bcsMatchedTrIdsMID.end(), bc,
+                                 [](const auto& item, uint64_t value) { return item.first < value; });
+      if (it != bcsMatchedTrIdsMID.end() && it->first == bc) {
         uint32_t ibc = it - bcsMatchedTrIdsMID.begin();
         bcsMatchedTrIdsTOFTagged[ibc].second = pair.second;
       }
@@ -1143,11 +1182,8 @@ struct UpcCandProducer {
 
     bcsMatchedTrIdsTOF.clear();
 
-    std::sort(bcsMatchedTrIdsITSTPC.begin(), bcsMatchedTrIdsITSTPC.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
     if (nBCsWithITSTPC > 0 && fSearchITSTPC == 1) {
-      std::unordered_set<int64_t> matchedTracks;
+      std::vector<bool> matchedTracks(barrelTracks.size(), false);
       for (uint32_t ibc = 0; ibc < nBCsWithMID; ++ibc) {
         auto& pairMID = bcsMatchedTrIdsMID[ibc];
         auto& pairTOF = bcsMatchedTrIdsTOFTagged[ibc];
@@ -1186,12 +1222,7 @@ struct UpcCandProducer {
     float dummyY = 0.;
     float dummyZ = 0.;
 
-    std::vector<std::pair<uint64_t, int64_t>> indexBCglId;
-    indexBCglId.reserve(bcs.size());
-    for (const auto& bc : bcs) {
-      if (bc.has_foundFT0() || bc.has_foundFV0() || bc.has_foundFDD())
-        indexBCglId.emplace_back(std::make_pair(bc.globalBC(), bc.globalIndex()));
-    }
+    fFITGapCache.update(bcs);
 
     int32_t runNumber = bcs.iteratorAt(0).runNumber();
 
@@ -1213,7 +1244,7 @@ struct UpcCandProducer {
       // fetching FT0, FDD, FV0 information
       // if there is no relevant signal, dummy info will be used
       upchelpers::FITInfo fitInfo{};
-      processFITInfo(fitInfo, bc, indexBCglId, bcs, ft0s, fdds, fv0as);
+      processFITInfo(fitInfo, bc, fFITGapCache, bcs, ft0s, fdds, fv0as);
       if (fFilterFT0) {
         if (!checkFT0(fitInfo, false))
           continue;
@@ -1245,7 +1276,6 @@ struct UpcCandProducer {
       candID++;
     }
 
-    indexBCglId.clear();
     ambFwdTrBCs.clear();
     bcsMatchedTrIdsMID.clear();
     ambBarrelTrBCs.clear();
@@ -1254,17 +1284,17 @@ struct UpcCandProducer {
 
   template <typename T>
   void fillAmplitudes(const T& t,
-                      const std::map<uint64_t, int32_t>& mapBCs,
+                      int channel,
                       std::vector<float>& amps,
                       std::vector<int8_t>& relBCs,
                       uint64_t gbc)
   {
     auto s = gbc - fBCWindowFITAmps;
     auto e = gbc + (fBCWindowFITAmps - 1);
-    auto it = mapBCs.lower_bound(s);
-    while (it->first <= e && it != mapBCs.end()) {
-      int i = it->first - s;
-      auto id = it->second;
+    auto [first, last] = fBcTimeline.range(channel, s, e);
+    for (auto iSignal = first; iSignal < last; iSignal++) {
+      int i = fBcTimeline.globalBC(channel, iSignal) - s;
+      auto id = fBcTimeline.row(channel, iSignal);
       const auto& row = t.iteratorAt(id);
       float totalAmp = 0.f;
       if constexpr (std::is_same_v<T, o2::aod::FT0s>) {
@@ -1279,7 +1309,6 @@ struct UpcCandProducer {
         amps.push_back(totalAmp);
         relBCs.push_back(gbc - (i + s));
       }
-      ++it;
     }
   }
 
@@ -1300,9 +1329,10 @@ struct UpcCandProducer {
     std::vector<BCTracksPair> bcsMatchedTrIdsMCH;
 
     // trackID -> index in amb. track table
-    std::unordered_map<int64_t, uint64_t> ambFwdTrBCs;
+    AmbTrackBCs ambFwdTrBCs;
     collectAmbTrackBCs<1, BCsWithBcSels>(ambFwdTrBCs, ambFwdTracks);
 
+    // sorted by BC
     collectForwardTracks(bcsMatchedTrIdsMID,
                          o2::aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack,
                          bcs, collisions,
@@ -1313,13 +1343,8 @@ struct UpcCandProducer {
                          bcs, collisions,
                          fwdTracks, ambFwdTracks, ambFwdTrBCs);
 
-    std::sort(bcsMatchedTrIdsMID.begin(), bcsMatchedTrIdsMID.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
-    std::sort(bcsMatchedTrIdsMCH.begin(), bcsMatchedTrIdsMCH.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
-    std::map<uint64_t, int32_t> mapGlobalBcWithT0A{};
+    namespace bctl = o2::common::core;
+    fBcTimeline.clear();
     for (const auto& ft0 : ft0s) {
       if (!TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex))
         continue;
@@ -1329,20 +1354,18 @@ struct UpcCandProducer {
       if (std::abs(ft0.timeA()) > 2.f)
         continue;
       uint64_t globalBC = ft0.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithT0A[globalBC] = ft0.globalIndex();
+      fBcTimeline.add(kBcChannelT0A, globalBC, ft0.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithV0A{};
     for (const auto& fv0a : fv0as) {
       if (!TESTBIT(fv0a.triggerMask(), o2::fit::Triggers::bitA))
         continue;
       if (std::abs(fv0a.time()) > 15.f)
         continue;
       uint64_t globalBC = fv0a.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithV0A[globalBC] = fv0a.globalIndex();
+      fBcTimeline.add(bctl::kBcChannelFV0A, globalBC, fv0a.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithZdc{};
     for (const auto& zdc : zdcs) {
       if (std::abs(zdc.timeZNA()) > 2.f && std::abs(zdc.timeZNC()) > 2.f)
         continue;
@@ -1351,10 +1374,9 @@ struct UpcCandProducer {
       if (!(std::abs(zdc.timeZNC()) > 2.f))
         histRegistry.get<TH1>(HIST("hCountersTrg"))->Fill("ZNC", 1);
       auto globalBC = zdc.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithZdc[globalBC] = zdc.globalIndex();
+      fBcTimeline.add(bctl::kBcChannelZDC, globalBC, zdc.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithFDD{};
     uint8_t twoLayersA = 0;
     uint8_t twoLayersC = 0;
     for (const auto& fdd : fdds) {
@@ -1369,14 +1391,15 @@ struct UpcCandProducer {
       if ((twoLayersA == 0) && (twoLayersC == 0))
         continue;
       uint64_t globalBC = fdd.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithFDD[globalBC] = fdd.globalIndex();
+      fBcTimeline.add(bctl::kBcChannelFDD, globalBC, fdd.globalIndex());
     }
 
-    auto nFT0s = mapGlobalBcWithT0A.size();
-    auto nFV0As = mapGlobalBcWithV0A.size();
-    auto nZdcs = mapGlobalBcWithZdc.size();
+    fBcTimeline.build();
+    auto nFT0s = fBcTimeline.size(kBcChannelT0A);
+    auto nFV0As = fBcTimeline.size(bctl::kBcChannelFV0A);
+    auto nZdcs = fBcTimeline.size(bctl::kBcChannelZDC);
     auto nBcsWithMCH = bcsMatchedTrIdsMCH.size();
-    auto nFDDs = mapGlobalBcWithFDD.size();
+    auto nFDDs = fBcTimeline.size(bctl::kBcChannelFDD);
 
     // todo: calculate position of UD collision?
     float dummyX = 0.;
@@ -1428,12 +1451,11 @@ struct UpcCandProducer {
       uint8_t chFT0A = 0;
       uint8_t chFT0C = 0;
       if (nFT0s > 0) {
-        uint64_t closestBcT0A = findClosestBC(globalBC, mapGlobalBcWithT0A);
+        auto [closestBcT0A, ft0Id] = findClosestBC(globalBC, kBcChannelT0A);
         int64_t distClosestBcT0A = globalBC - static_cast<int64_t>(closestBcT0A);
         if (std::abs(distClosestBcT0A) <= fFilterFT0)
           continue;
         fitInfo.distClosestBcT0A = distClosestBcT0A;
-        auto ft0Id = mapGlobalBcWithT0A.at(closestBcT0A);
         auto ft0 = ft0s.iteratorAt(ft0Id);
         fitInfo.timeFT0A = ft0.timeA();
         fitInfo.timeFT0C = ft0.timeC();
@@ -1443,28 +1465,26 @@ struct UpcCandProducer {
         fitInfo.ampFT0C = std::accumulate(t0AmpsC.begin(), t0AmpsC.end(), 0.f);
         chFT0A = ft0.amplitudeA().size();
         chFT0C = ft0.amplitudeC().size();
-        fillAmplitudes(ft0s, mapGlobalBcWithT0A, amplitudesT0A, relBCsT0A, globalBC);
+        fillAmplitudes(ft0s, kBcChannelT0A, amplitudesT0A, relBCsT0A, globalBC);
       }
       uint8_t chFV0A = 0;
       if (nFV0As > 0) {
-        uint64_t closestBcV0A = findClosestBC(globalBC, mapGlobalBcWithV0A);
+        auto [closestBcV0A, fv0aId] = findClosestBC(globalBC, bctl::kBcChannelFV0A);
         int64_t distClosestBcV0A = globalBC - static_cast<int64_t>(closestBcV0A);
         if (std::abs(distClosestBcV0A) <= fFilterFV0)
           continue;
         fitInfo.distClosestBcV0A = distClosestBcV0A;
-        auto fv0aId = mapGlobalBcWithV0A.at(closestBcV0A);
         auto fv0a = fv0as.iteratorAt(fv0aId);
         fitInfo.timeFV0A = fv0a.time();
         const auto& v0Amps = fv0a.amplitude();
         fitInfo.ampFV0A = std::accumulate(v0Amps.begin(), v0Amps.end(), 0.f);
         chFV0A = fv0a.amplitude().size();
-        fillAmplitudes(fv0as, mapGlobalBcWithV0A, amplitudesV0A, relBCsV0A, globalBC);
+        fillAmplitudes(fv0as, bctl::kBcChannelFV0A, amplitudesV0A, relBCsV0A, globalBC);
       }
       uint8_t chFDDA = 0;
       uint8_t chFDDC = 0;
       if (nFDDs > 0) {
-        uint64_t closestBcFDD = findClosestBC(globalBC, mapGlobalBcWithFDD);
-        auto fddId = mapGlobalBcWithFDD.at(closestBcFDD);
+        auto fddId = findClosestBC(globalBC, bctl::kBcChannelFDD).second;
         auto fdd = fdds.iteratorAt(fddId);
         fitInfo.timeFDDA = fdd.timeA();
         fitInfo.timeFDDC = fdd.timeC();
@@ -1484,9 +1504,9 @@ struct UpcCandProducer {
         }
       }
       if (nZdcs > 0) {
-        auto itZDC = mapGlobalBcWithZdc.find(globalBC);
-        if (itZDC != mapGlobalBcWithZdc.end()) {
-          const auto& zdc = zdcs.iteratorAt(itZDC->second);
+        auto zdcId = fBcTimeline.findRow(bctl::kBcChannelZDC, globalBC);
+        if (zdcId >= 0) {
+          const auto& zdc = zdcs.iteratorAt(zdcId);
           float timeZNA = zdc.timeZNA();
           float timeZNC = zdc.timeZNC();
           float eComZNA = zdc.energyCommonZNA();
@@ -1532,9 +1552,6 @@ struct UpcCandProducer {
     ambFwdTrBCs.clear();
     bcsMatchedTrIdsMID.clear();
     bcsMatchedTrIdsMCH.clear();
-    mapGlobalBcWithT0A.clear();
-    mapGlobalBcWithV0A.clear();
-    mapGlobalBcWithFDD.clear();
   }
 
   template <typename TBCs>
@@ -1555,9 +1572,10 @@ struct UpcCandProducer {
     std::vector<BCTracksPair> bcsMatchedTrIdsGlobal;
 
     // trackID -> index in amb. track table
-    std::unordered_map<int64_t, uint64_t> ambFwdTrBCs;
+    AmbTrackBCs ambFwdTrBCs;
     collectAmbTrackBCs<1, BCsWithBcSels>(ambFwdTrBCs, ambFwdTracks);
 
+    // sorted by BC
     collectForwardTracks(bcsMatchedTrIdsMID,
                          o2::aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack,
                          bcs, collisions,
@@ -1573,16 +1591,8 @@ struct UpcCandProducer {
                                bcs, collisions,
                                fwdTracks, ambFwdTracks, ambFwdTrBCs);
 
-    std::sort(bcsMatchedTrIdsMID.begin(), bcsMatchedTrIdsMID.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
-    std::sort(bcsMatchedTrIdsMCH.begin(), bcsMatchedTrIdsMCH.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
-    std::sort(bcsMatchedTrIdsGlobal.begin(), bcsMatchedTrIdsGlobal.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
-    std::map<uint64_t, int32_t> mapGlobalBcWithT0A{};
+    namespace bctl = o2::common::core;
+    fBcTimeline.clear();
     for (const auto& ft0 : ft0s) {
       if (!TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex))
         continue;
@@ -1602,20 +1612,18 @@ struct UpcCandProducer {
       if (std::abs(ft0.timeA()) > 2.f)
         continue;
       uint64_t globalBC = ft0.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithT0A[globalBC] = ft0.globalIndex();
+      fBcTimeline.add(kBcChannelT0A, globalBC, ft0.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithV0A{};
     for (const auto& fv0a : fv0as) {
       if (!TESTBIT(fv0a.triggerMask(), o2::fit::Triggers::bitA))
         continue;
       if (std::abs(fv0a.time()) > 15.f)
         continue;
       uint64_t globalBC = fv0a.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithV0A[globalBC] = fv0a.globalIndex();
+      fBcTimeline.add(bctl::kBcChannelFV0A, globalBC, fv0a.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithZdc{};
     for (const auto& zdc : zdcs) {
       if (std::abs(zdc.timeZNA()) > 2.f && std::abs(zdc.timeZNC()) > 2.f)
         continue;
@@ -1624,10 +1632,9 @@ struct UpcCandProducer {
       if (!(std::abs(zdc.timeZNC()) > 2.f))
         histRegistry.get<TH1>(HIST("hCountersTrg"))->Fill("ZNC", 1);
       auto globalBC = zdc.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithZdc[globalBC] = zdc.globalIndex();
+      fBcTimeline.add(bctl::kBcChannelZDC, globalBC, zdc.globalIndex());
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithFDD{};
     uint8_t twoLayersA = 0;
     uint8_t twoLayersC = 0;
     for (const auto& fdd : fdds) {
@@ -1642,13 +1649,14 @@ struct UpcCandProducer {
       if ((twoLayersA == 0) && (twoLayersC == 0))
         continue;
       uint64_t globalBC = fdd.bc_as<TBCs>().globalBC();
-      mapGlobalBcWithFDD[globalBC] = fdd.globalIndex();
+      fBcTimeline.add(bctl::kBcChannelFDD, globalBC, fdd.globalIndex());
     }
 
-    auto nFT0s = mapGlobalBcWithT0A.size();
-    auto nFV0As = mapGlobalBcWithV0A.size();
-    auto nZdcs = mapGlobalBcWithZdc.size();
-    auto nFDDs = mapGlobalBcWithFDD.size();
+    fBcTimeline.build();
+    auto nFT0s = fBcTimeline.size(kBcChannelT0A);
+    auto nFV0As = fBcTimeline.size(bctl::kBcChannelFV0A);
+    auto nZdcs = fBcTimeline.size(bctl::kBcChannelZDC);
+    auto nFDDs = fBcTimeline.size(bctl::kBcChannelFDD);
 
     // todo: calculate position of UD collision?
     float dummyX = 0.;
@@ -1735,12 +1743,11 @@ struct UpcCandProducer {
       int zVtxFT0vPv = 0;
       int vtxITSTPC = 0;
       if (nFT0s > 0) {
-        uint64_t closestBcT0A = findClosestBC(globalBC, mapGlobalBcWithT0A);
+        auto [closestBcT0A, ft0Id] = findClosestBC(globalBC, kBcChannelT0A);
         int64_t distClosestBcT0A = globalBC - static_cast<int64_t>(closestBcT0A);
         if (std::abs(distClosestBcT0A) <= fFilterFT0)
           continue;
         fitInfo.distClosestBcT0A = distClosestBcT0A;
-        auto ft0Id = mapGlobalBcWithT0A.at(closestBcT0A);
         auto ft0 = ft0s.iteratorAt(ft0Id);
         fitInfo.timeFT0A = ft0.timeA();
         fitInfo.timeFT0C = ft0.timeC();
@@ -1759,28 +1766,26 @@ struct UpcCandProducer {
         sbp = ft0.bc_as<TBCs>().selection_bit(o2::aod::evsel::kNoSameBunchPileup) ? 1 : 0;
         zVtxFT0vPv = ft0.bc_as<TBCs>().selection_bit(o2::aod::evsel::kIsGoodZvtxFT0vsPV) ? 1 : 0;
         vtxITSTPC = ft0.bc_as<TBCs>().selection_bit(o2::aod::evsel::kIsVertexITSTPC) ? 1 : 0;
-        fillAmplitudes(ft0s, mapGlobalBcWithT0A, amplitudesT0A, relBCsT0A, globalBC);
+        fillAmplitudes(ft0s, kBcChannelT0A, amplitudesT0A, relBCsT0A, globalBC);
       }
       uint8_t chFV0A = 0;
       if (nFV0As > 0) {
-        uint64_t closestBcV0A = findClosestBC(globalBC, mapGlobalBcWithV0A);
+        auto [closestBcV0A, fv0aId] = findClosestBC(globalBC, bctl::kBcChannelFV0A);
         int64_t distClosestBcV0A = globalBC - static_cast<int64_t>(closestBcV0A);
         if (std::abs(distClosestBcV0A) <= fFilterFV0)
           continue;
         fitInfo.distClosestBcV0A = distClosestBcV0A;
-        auto fv0aId = mapGlobalBcWithV0A.at(closestBcV0A);
         auto fv0a = fv0as.iteratorAt(fv0aId);
         fitInfo.timeFV0A = fv0a.time();
         const auto& v0Amps = fv0a.amplitude();
         fitInfo.ampFV0A = std::accumulate(v0Amps.begin(), v0Amps.end(), 0.f);
         chFV0A = fv0a.amplitude().size();
-        fillAmplitudes(fv0as, mapGlobalBcWithV0A, amplitudesV0A, relBCsV0A, globalBC);
+        fillAmplitudes(fv0as, bctl::kBcChannelFV0A, amplitudesV0A, relBCsV0A, globalBC);
       }
       uint8_t chFDDA = 0;
       uint8_t chFDDC = 0;
       if (nFDDs > 0) {
-        uint64_t closestBcFDD = findClosestBC(globalBC, mapGlobalBcWithFDD);
-        auto fddId = mapGlobalBcWithFDD.at(closestBcFDD);
+        auto fddId = findClosestBC(globalBC, bctl::kBcChannelFDD).second;
         auto fdd = fdds.iteratorAt(fddId);
         fitInfo.timeFDDA = fdd.timeA();
         fitInfo.timeFDDC = fdd.timeC();
@@ -1800,9 +1805,9 @@ struct UpcCandProducer {
         }
       }
       if (nZdcs > 0) {
-        auto itZDC = mapGlobalBcWithZdc.find(globalBC);
-        if (itZDC != mapGlobalBcWithZdc.end()) {
-          const auto& zdc = zdcs.iteratorAt(itZDC->second);
+        auto zdcId = fBcTimeline.findRow(bctl::kBcChannelZDC, globalBC);
+        if (zdcId >= 0) {
+          const auto& zdc = zdcs.iteratorAt(zdcId);
           float timeZNA = zdc.timeZNA();
           float timeZNC = zdc.timeZNC();
           float eComZNA = zdc.energyCommonZNA();
@@ -1847,9 +1852,6 @@ struct UpcCandProducer {
     bcsMatchedTrIdsMID.clear();
     bcsMatchedTrIdsMCH.clear();
     bcsMatchedTrIdsGlobal.clear();
-    mapGlobalBcWithT0A.clear();
-    mapGlobalBcWithV0A.clear();
-    mapGlobalBcWithFDD.clear();
   }
 
   // data processors
@@ -36,7 +36,9 @@
 #include <KFPVertex.h>
 #include <KFParticle.h>
 #include <KFParticleBase.h>
+#include <KFParticleSIMD.h>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
@@ -411,4 +413,105 @@ std::pair<float, float> kfCalculateImpactParameterZ(const KFParticle& candidate,
   return std::make_pair(distanceToVertexZ, errDistanceToVertexZ);
 }
 
+/// @brief Input of the fit of a two-prong decay (e.g. V0, photon conversion)
+struct KFTwoProngCandidate {
+  KFParticle daughters[2];
+  KFParticle vertex;          // production vertex, e.g. the primary vertex
+  float point[3] = {0, 0, 0}; // point to which the mother and the daughters are transported, e.g. the DCA-fitter vertex
+};
+
+/// @brief Result of the fit of a two-prong decay
+struct KFTwoProngFit {
+  KFParticle mother;              // constructed from the daughters, with the mass constraint if any
+  KFParticle motherAtPoint;       // mother transported to the point
+  KFParticle motherWithVertex;    // mother constrained to the production vertex
+  KFParticle daughtersAtPoint[2]; // daughters transported to the point
+};
+
+/// @brief first step of the fit of a two-prong decay: mother and mother at the point
+/// @param candidate daughters, production vertex and point
+/// @param fit result, mother and motherAtPoint are set
+/// @param constructMethod construction method of KFParticle
+/// @param massConstraint mass of the nonlinear mass constraint, none if negative
+void kfConstructTwoProng(const KFTwoProngCandidate& candidate, KFTwoProngFit& fit, int constructMethod = 2, float massConstraint = -1.f)
+{
+  const KFParticle* daughters[2] = {&candidate.daughters[0], &candidate.daughters[1]};
+  fit.mother = KFParticle();
+  fit.mother.SetConstructMethod(constructMethod);
+  fit.mother.Construct(daughters, 2);
+  if (massConstraint >= 0.f) {
+    fit.mother.SetNonlinearMassConstraint(massConstraint);
+  }
+  fit.motherAtPoint = fit.mother;
+  fit.motherAtPoint.TransportToPoint(candidate.point);
+}
+
+/// @brief second step of the fit of a two-prong decay, after kfConstructTwoProng: production-vertex constraint and daughters at the point
+/// @param candidate daughters, production vertex and point
+/// @param fit result, motherWithVertex and daughtersAtPoint are set
+void kfConstrainTwoProng(const KFTwoProngCandidate& candidate, KFTwoProngFit& fit)
+{
+  fit.motherWithVertex = fit.mother;
+  fit.motherWithVertex.SetProductionVertex(candidate.vertex);
+  for (int iDaughter = 0; iDaughter < 2; iDaughter++) {
+    fit.daughtersAtPoint[iDaughter] = candidate.daughters[iDaughter];
+    fit.daughtersAtPoint[iDaughter].TransportToPoint(candidate.point);
+  }
+}
+
+/// @brief complete fit of two-prong decays, float_v::Size candidates at a time with KFParticleSIMD.
+/// The results agree with kfConstructTwoProng and kfConstrainTwoProng up to the float rounding.
+/// With HomogeneousField, the field has to be set with KFParticleSIMD::SetField as well as with KFParticle::SetField.
+/// @param candidates daughters, production vertices and points of nCandidates decays
+/// @param nCandidates number of decays
+/// @param fits results, nCandidates entries
+/// @param constructMethod construction method of KFParticle
+/// @param massConstraint mass of the nonlinear mass constraint, none if negative
+void kfFitTwoProngs(const KFTwoProngCandidate* candidates, int nCandidates, KFTwoProngFit* fits, int constructMethod = 2, float massConstraint = -1.f)
+{
+  constexpr int NLanes = float_v::Size;
+  for (int first = 0; first < nCandidates; first += NLanes) {
+    const int nFilled = std::min(NLanes, nCandidates - first);
+    // KFParticleSIMD reads the particles through non-const pointers, they are not modified.
+    // The lanes beyond the last candidate repeat it and are not unpacked
+    KFParticle* lanes[3][NLanes];
+    float_v point[3];
+    for (int lane = 0; lane < NLanes; lane++) {
+      auto& candidate = const_cast<KFTwoProngCandidate&>(candidates[first + std::min(lane, nFilled - 1)]);
+      lanes[0][lane] = &candidate.daughters[0];
+      lanes[1][lane] = &candidate.daughters[1];
+      lanes[2][lane] = &candidate.vertex;
+      for (int i = 0; i < 3; i++) {
+        point[i][lane] = candidate.point[i];
+      }
+    }
+    KFParticleSIMD daughter0(lanes[0], NLanes);
+    KFParticleSIMD daughter1(lanes[1], NLanes);
+    KFParticleSIMD vertex(lanes[2], NLanes);
+
+    const KFParticleSIMD* daughters[2] = {&daughter0, &daughter1};
+    KFParticleSIMD mother;
+    mother.SetConstructMethod(constructMethod);
+    mother.Construct(daughters, 2);
+    if (massConstraint >= 0.f) {
+      mother.SetNonlinearMassConstraint(float_v(massConstraint));
+    }
+    KFParticleSIMD motherAtPoint = mother;
+    motherAtPoint.TransportToPoint(point);
+    KFParticleSIMD motherWithVertex = mother;
+    motherWithVertex.SetProductionVertex(vertex);
+    daughter0.TransportToPoint(point);
+    daughter1.TransportToPoint(point);
+
+    for (int lane = 0; lane < nFilled; lane++) {
+      KFTwoProngFit& fit = fits[first + lane];
+      mother.GetKFParticle(fit.mother, lane);
+      motherAtPoint.GetKFParticle(fit.motherAtPoint, lane);
+      motherWithVertex.GetKFParticle(fit.motherWithVertex, lane);
+      daughter0.GetKFParticle(fit.daughtersAtPoint[0], lane);
+      daughter1.GetKFParticle(fit.daughtersAtPoint[1], lane);
+    }
+  }
+}
+
 #endif // TOOLS_KFPARTICLE_KFUTILITIES_H_